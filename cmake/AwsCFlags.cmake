@@ -109,6 +109,18 @@ function(aws_set_common_properties target)
         list(APPEND AWS_C_DEFINES_PRIVATE -DHAVE_SYSCONF)
     endif()
 
+    # stack walking for aws_backtrace; absent on Android and musl.
+    check_c_source_compiles("
+    #include <execinfo.h>
+    int main() {
+      void *frames[4];
+      return backtrace(frames, 4);
+    }"  HAVE_EXECINFO)
+
+    if (HAVE_EXECINFO)
+        list(APPEND AWS_C_DEFINES_PRIVATE -DHAVE_EXECINFO)
+    endif()
+
     if(CMAKE_BUILD_TYPE STREQUAL "" OR CMAKE_BUILD_TYPE MATCHES Debug)
         list(APPEND AWS_C_DEFINES_PRIVATE -DDEBUG_BUILD)
     endif()
@@ -0,0 +1,83 @@
+#ifndef AWS_COMMON_ARENA_ALLOCATOR_H
+#define AWS_COMMON_ARENA_ALLOCATOR_H
+/*
+ * Copyright 2010-2018 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *  http://aws.amazon.com/apache2.0
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#include <aws/common/common.h>
+
+/**
+ * An aws_allocator which hands out memory by bumping a pointer through
+ * blocks obtained from a parent allocator, for objects which all die
+ * together, such as everything built while handling one request.
+ *
+ * Releasing memory does nothing; it is all reclaimed at once by
+ * aws_arena_allocator_reset or aws_arena_allocator_clean_up. Reallocating
+ * the most recent allocation grows or shrinks it in place while it fits in
+ * its block. Allocations larger than a block get a block of their own.
+ *
+ * Allocations are aligned to twice the size of a pointer, as malloc's are on
+ * common platforms. An arena is not thread safe.
+ */
+struct aws_arena_allocator {
+    /* Pass &arena->allocator to anything that takes a struct aws_allocator * */
+    struct aws_allocator allocator;
+    struct aws_allocator *parent;
+    size_t block_size;
+    /* The block being allocated from, followed by the other blocks in use */
+    struct aws_arena_block *blocks;
+    /* Blocks kept by reset for reuse */
+    struct aws_arena_block *spare_blocks;
+    /* Blocks holding one oversized allocation each */
+    struct aws_arena_block *large_blocks;
+    /* Next free byte, and end, of the current block */
+    uint8_t *cursor;
+    uint8_t *limit;
+    /* The most recent allocation from the current block, which can be resized in place */
+    uint8_t *last;
+    /* The oldest block in use, whose next is the head of the spare blocks on reset */
+    struct aws_arena_block *oldest_block;
+};
+
+AWS_EXTERN_C_BEGIN
+
+/**
+ * Initializes an arena which takes blocks of block_size bytes from parent,
+ * the first of them on the first allocation. block_size 0 means 4KB.
+ */
+AWS_COMMON_API
+int aws_arena_allocator_init(
+    struct aws_arena_allocator *arena,
+    struct aws_allocator *parent,
+    size_t block_size);
+
+/**
+ * Returns all of the arena's blocks to the parent allocator. Any memory
+ * acquired from the arena must no longer be used.
+ */
+AWS_COMMON_API
+void aws_arena_allocator_clean_up(struct aws_arena_allocator *arena);
+
+/**
+ * Reclaims every allocation at once, so that the memory can be handed out
+ * again. Ordinary blocks are kept for reuse, in constant time; blocks made
+ * for oversized allocations are returned to the parent. Any memory acquired
+ * from the arena must no longer be used.
+ */
+AWS_COMMON_API
+void aws_arena_allocator_reset(struct aws_arena_allocator *arena);
+
+AWS_EXTERN_C_END
+
+#endif /* AWS_COMMON_ARENA_ALLOCATOR_H */
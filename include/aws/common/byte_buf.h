@@ -73,6 +73,14 @@ int aws_byte_buf_init_copy_from_cursor(
 AWS_COMMON_API
 void aws_byte_buf_clean_up(struct aws_byte_buf *buf);
 
+/**
+ * Grows buffer's capacity to at least requested_capacity with aws_mem_realloc, keeping its contents. Does nothing if
+ * the capacity is already enough. Raises AWS_ERROR_INVALID_ARGUMENT if buffer has no allocator, or AWS_ERROR_OOM if
+ * the allocation fails, leaving buffer unchanged.
+ */
+AWS_COMMON_API
+int aws_byte_buf_reserve(struct aws_byte_buf *buffer, size_t requested_capacity);
+
 /**
  * Equivalent to calling aws_byte_buf_secure_zero and then aws_byte_buf_clean_up
  * on the buffer.
@@ -213,6 +213,24 @@ void *aws_mem_acquire_many(struct aws_allocator *allocator, size_t count, ...);
 AWS_COMMON_API
 void aws_mem_release(struct aws_allocator *allocator, void *ptr);
 
+/**
+ * Returns at least `size` bytes of memory whose address is a multiple of alignment, such as AWS_CACHE_LINE for
+ * structures written by several threads, or 32 for AVX2 buffers. Returns NULL and raises AWS_ERROR_INVALID_ARGUMENT
+ * if alignment isn't a power of two, or AWS_ERROR_OOM if the allocation fails.
+ *
+ * The default allocator gets the memory from the system's aligned allocation function. Other allocators are asked
+ * for up to alignment + sizeof(void *) extra bytes.
+ * The memory must be released with aws_mem_release_aligned, and can't be passed to aws_mem_realloc.
+ */
+AWS_COMMON_API
+void *aws_mem_acquire_aligned(struct aws_allocator *allocator, size_t alignment, size_t size);
+
+/*
+ * Releases memory returned by aws_mem_acquire_aligned. Does nothing if ptr is NULL.
+ */
+AWS_COMMON_API
+void aws_mem_release_aligned(struct aws_allocator *allocator, void *ptr);
+
 /*
  * Attempts to adjust the size of the pointed-to memory buffer from oldsize to
  * newsize. The pointer (*ptr) may be changed if the memory needs to be
@@ -0,0 +1,149 @@
+#ifndef AWS_COMMON_CONCURRENT_HASH_TABLE_H
+#define AWS_COMMON_CONCURRENT_HASH_TABLE_H
+
+/*
+ * Copyright 2010-2018 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *  http://aws.amazon.com/apache2.0
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+#include <aws/common/hash_table.h>
+
+/**
+ * A hash map which may be read and written from any number of threads at
+ * once, meant for registries shared between event loops. Reads take no
+ * locks and write no shared cache lines other than a reader count chosen by
+ * thread id, so they scale with the number of reading threads.
+ *
+ * Writes are serialized per lock stripe (chosen by hash code), and are
+ * published with release stores so that readers always see a consistent
+ * chain. Elements are never modified in place: replacing a value installs
+ * a new element. Elements, and slot arrays abandoned by a resize, are
+ * retired rather than freed, and only reclaimed (running destroy_key_fn and
+ * destroy_value_fn as appropriate) once every read section which might
+ * still reference them has ended.
+ *
+ * Lookups must be made inside a read section; see
+ * aws_concurrent_hash_table_read_begin.
+ */
+struct aws_concurrent_hash_table {
+    void *p_impl;
+};
+
+/**
+ * Marks an ongoing read section. Filled in by
+ * aws_concurrent_hash_table_read_begin and passed back to
+ * aws_concurrent_hash_table_read_end; callers should not touch the fields.
+ */
+struct aws_concurrent_hash_table_read_guard {
+    size_t stripe;
+    size_t parity;
+};
+
+AWS_EXTERN_C_BEGIN
+
+/**
+ * Initializes a concurrent map with initial capacity for 'size' elements.
+ * The callbacks have the same meaning as for aws_hash_table_init, except
+ * that the destroy callbacks may run on whichever thread next writes to
+ * the map, some time after the element was removed or replaced.
+ *
+ * Raises AWS_ERROR_OOM if allocation fails.
+ */
+AWS_COMMON_API
+int aws_concurrent_hash_table_init(
+    struct aws_concurrent_hash_table *map,
+    struct aws_allocator *alloc,
+    size_t size,
+    aws_hash_fn *hash_fn,
+    aws_hash_callback_eq_fn *equals_fn,
+    aws_hash_callback_destroy_fn *destroy_key_fn,
+    aws_hash_callback_destroy_fn *destroy_value_fn);
+
+/**
+ * Destroys every element and frees all memory held by the map. No other
+ * thread may be using the map. This method is idempotent.
+ */
+AWS_COMMON_API
+void aws_concurrent_hash_table_clean_up(struct aws_concurrent_hash_table *map);
+
+/**
+ * Begins a read section on the calling thread. Elements found during the
+ * section remain valid until the matching aws_concurrent_hash_table_read_end,
+ * even if another thread removes or replaces them meanwhile.
+ *
+ * Read sections should be short: memory retired by writers can't be
+ * reclaimed while a section which began before it was retired is open.
+ * They may be nested, each with its own guard.
+ */
+AWS_COMMON_API
+void aws_concurrent_hash_table_read_begin(
+    const struct aws_concurrent_hash_table *map,
+    struct aws_concurrent_hash_table_read_guard *guard);
+
+/**
+ * Ends the read section begun with guard.
+ */
+AWS_COMMON_API
+void aws_concurrent_hash_table_read_end(
+    const struct aws_concurrent_hash_table *map,
+    struct aws_concurrent_hash_table_read_guard *guard);
+
+/**
+ * Looks up key, placing a pointer to the element in *p_elem, or NULL if
+ * there is none. Must be called inside a read section; the element must not
+ * be used after the section ends, and must not be modified. Always returns
+ * AWS_OP_SUCCESS.
+ */
+AWS_COMMON_API
+int aws_concurrent_hash_table_find(
+    const struct aws_concurrent_hash_table *map,
+    const void *key,
+    const struct aws_hash_element **p_elem);
+
+/**
+ * Inserts key with the given value, replacing any existing element with an
+ * equal key. As with aws_hash_table_put, the replaced element's value (and
+ * key, if it is a different pointer) will be destroyed, though possibly
+ * not until later.
+ *
+ * If was_created is non-NULL, *was_created is set to 0 if an existing
+ * element was replaced, or 1 if a new element was created.
+ *
+ * Raises AWS_ERROR_OOM if allocation fails, in which case the map is
+ * unchanged.
+ */
+AWS_COMMON_API
+int aws_concurrent_hash_table_put(
+    struct aws_concurrent_hash_table *map,
+    const void *key,
+    void *value,
+    int *was_created);
+
+/**
+ * Removes the element at key, if any; its key and value will be destroyed
+ * once no read section can still be using them. If was_present is
+ * non-NULL, *was_present is set to 1 if an element was removed and 0
+ * otherwise. Always returns AWS_OP_SUCCESS.
+ */
+AWS_COMMON_API
+int aws_concurrent_hash_table_remove(struct aws_concurrent_hash_table *map, const void *key, int *was_present);
+
+/**
+ * Returns the number of elements in the map. With concurrent writers, this
+ * is only a snapshot.
+ */
+AWS_COMMON_API
+size_t aws_concurrent_hash_table_get_entry_count(const struct aws_concurrent_hash_table *map);
+
+AWS_EXTERN_C_END
+
+#endif /* AWS_COMMON_CONCURRENT_HASH_TABLE_H */
@@ -31,7 +31,8 @@
  * key or value into the hash table element itself.
  *
  * Currently, this hash table implements a variant of robin hood hashing, but
- * we do not guarantee that this won't change in the future.
+ * we do not guarantee that this won't change in the future. An alternative
+ * grouped layout may be selected at init time; see enum aws_hash_table_layout.
  *
  * Associated with each hash function are four callbacks:
  *
@@ -79,15 +80,131 @@ struct aws_hash_iter {
     struct aws_hash_element element;
     size_t slot;
     size_t limit;
+    /*
+     * Implementation detail: the slot array currently being walked. While an
+     * incremental resize is in progress, a table has two of them.
+     */
+    void *state;
     /*
      * Reserving extra fields for binary compatibility with future expansion of
      * iterator in case hash table implementation changes.
      */
-    void *unused_0;
     void *unused_1;
     void *unused_2;
 };
 
+/**
+ * Slot layouts supported by the hash table. The layout only affects
+ * performance characteristics; all hash table operations behave identically
+ * regardless of which layout is in use.
+ */
+enum aws_hash_table_layout {
+    /**
+     * Robin hood hashing with backward-shift deletion. Each probe examines a
+     * full slot (key, value and hash code). This is the default.
+     */
+    AWS_HASH_TABLE_LAYOUT_ROBIN_HOOD = 0,
+
+    /**
+     * Slots are probed in groups of 16 using a separate metadata array holding
+     * a 7-bit tag of each entry's hash code. An entire group's tags are compared
+     * at once (using SIMD instructions where available), so slots are only
+     * touched when their tag matches. This favors tables which see many lookup
+     * misses, at the cost of one extra byte per slot.
+     */
+    AWS_HASH_TABLE_LAYOUT_GROUPED,
+};
+
+/**
+ * Prototype for a seeded key hashing function pointer. Distinct seeds should
+ * yield unrelated hash functions, so that a caller who does not know the seed
+ * cannot choose keys which collide.
+ */
+typedef uint64_t(aws_hash_seeded_fn)(const void *key, uint64_t seed);
+
+/**
+ * Optional settings for aws_hash_table_init_with_options. A zeroed struct
+ * yields the same behavior as aws_hash_table_init.
+ */
+struct aws_hash_table_options {
+    enum aws_hash_table_layout layout;
+
+    /**
+     * Fraction of slots which may be occupied before the table grows; must be
+     * less than 1. Lower values keep probe sequences short at the cost of
+     * memory. Zero selects the layout's default (0.95 for robin hood, 0.875
+     * for grouped).
+     */
+    double max_load_factor;
+
+    /**
+     * Factor by which the number of slots is multiplied each time the table
+     * grows. Table sizes are powers of two, so this is rounded up to a power of two.
+     * Zero selects the default of 2; 1 is invalid.
+     */
+    size_t growth_multiplier;
+
+    /**
+     * If non-zero, aws_hash_table_remove shrinks the table by growth_multiplier
+     * whenever the fraction of occupied slots drops below this value (but
+     * never below the size requested at init). Must be less than
+     * max_load_factor / growth_multiplier, so that a shrink can't leave the
+     * table on the verge of growing again. Zero (the default) means the table
+     * never shrinks.
+     */
+    double shrink_load_factor;
+
+    /**
+     * If true, resizes are performed incrementally: the new slot array is
+     * allocated when the table passes its load threshold, and each subsequent
+     * put, create or remove moves a bounded number of slots' worth of entries
+     * into it. This bounds the latency of any single operation at the cost of
+     * briefly holding both slot arrays and of lookups checking both while the
+     * resize is underway.
+     */
+    bool incremental_resize;
+
+    /**
+     * If set, keys are hashed with seeded_hash_fn instead of hash_fn (which
+     * may then be NULL), using a seed drawn from aws_device_random_u64 when
+     * the table is initialized. Because every table gets its own seed, a
+     * peer who controls the keys can't arrange for them to collide. Use this
+     * for tables keyed by untrusted input, such as header names or query
+     * parameters read off the network; an unseeded hash lets a crafted
+     * request pile every key into one probe sequence.
+     */
+    aws_hash_seeded_fn *seeded_hash_fn;
+};
+
+#define AWS_HASH_TABLE_STATS_HISTOGRAM_SIZE 16
+
+/**
+ * A snapshot of a hash table's memory use and probe behavior, as returned by
+ * aws_hash_table_get_stats.
+ *
+ * An entry's displacement is the distance between where its hash code would
+ * place it and where it actually sits; it is the number of additional probes
+ * needed to find it. Displacement is counted in slots for the robin hood
+ * layout and in groups of slots for the grouped layout. Consistently high
+ * displacements usually indicate a poorly distributed aws_hash_fn.
+ */
+struct aws_hash_table_stats {
+    size_t entry_count;
+    /* Number of slots allocated, across both slot arrays while an incremental resize is underway */
+    size_t capacity;
+    /* Bytes allocated for the table itself, not including keys or values */
+    size_t bytes_used;
+    /* Deleted slots awaiting reuse (grouped layout only) */
+    size_t tombstone_count;
+    /* Number of times the slot array has been reallocated since init */
+    size_t resize_count;
+    double average_displacement;
+    size_t median_displacement;
+    size_t max_displacement;
+    /* Entry counts by displacement; the last bucket also counts all larger displacements */
+    size_t displacement_histogram[AWS_HASH_TABLE_STATS_HISTOGRAM_SIZE];
+};
+
 /**
  * Prototype for a key hashing function pointer.
  */
@@ -126,6 +243,9 @@ AWS_EXTERN_C_BEGIN
  * removed without being returned, destroy_key_fn is run on the pointer
  * to the key and destroy_value_fn is run on the pointer to the value.
  * Either or both may be NULL if a callback is not desired in this case.
+ *
+ * Tables keyed by untrusted input should instead be initialized with
+ * aws_hash_table_init_with_options and a seeded_hash_fn.
  */
 AWS_COMMON_API
 int aws_hash_table_init(
@@ -137,6 +257,25 @@ int aws_hash_table_init(
     aws_hash_callback_destroy_fn *destroy_key_fn,
     aws_hash_callback_destroy_fn *destroy_value_fn);
 
+/**
+ * Initializes a hash map as aws_hash_table_init does, applying the settings
+ * in options. options may be NULL, in which case the defaults are used.
+ *
+ * Raises AWS_ERROR_INVALID_ARGUMENT if the options are out of range, or if
+ * neither hash_fn nor options->seeded_hash_fn is set. Fails with the error
+ * raised by aws_device_random_u64 if a seed is needed and can't be read.
+ */
+AWS_COMMON_API
+int aws_hash_table_init_with_options(
+    struct aws_hash_table *map,
+    struct aws_allocator *alloc,
+    size_t size,
+    aws_hash_fn *hash_fn,
+    aws_hash_callback_eq_fn *equals_fn,
+    aws_hash_callback_destroy_fn *destroy_key_fn,
+    aws_hash_callback_destroy_fn *destroy_value_fn,
+    const struct aws_hash_table_options *options);
+
 /**
  * Deletes every element from map and frees all associated memory.
  * destroy_fn will be called for each element.  aws_hash_table_init
@@ -177,6 +316,18 @@ void aws_hash_table_move(struct aws_hash_table *AWS_RESTRICT to, struct aws_hash
 AWS_COMMON_API
 size_t aws_hash_table_get_entry_count(const struct aws_hash_table *map);
 
+/**
+ * Fills stats with the current size, memory use and displacement statistics
+ * of the table. This walks every slot, so it is intended for periodic
+ * monitoring and benchmarking rather than hot paths. Does not modify the
+ * table.
+ *
+ * Raises AWS_ERROR_OOM if the scratch space needed to compute the median
+ * could not be allocated.
+ */
+AWS_COMMON_API
+int aws_hash_table_get_stats(const struct aws_hash_table *map, struct aws_hash_table_stats *stats);
+
 /**
  * Returns an iterator to be used for iterating through a hash table.
  * Iterator will already point to the first element of the table it finds,
@@ -240,6 +391,24 @@ void aws_hash_iter_delete(struct aws_hash_iter *iter, bool destroy_contents);
 AWS_COMMON_API
 int aws_hash_table_find(const struct aws_hash_table *map, const void *key, struct aws_hash_element **p_elem);
 
+/**
+ * Looks up count keys, placing the element found for keys[i] (or NULL) in
+ * p_elems[i], exactly as calling aws_hash_table_find on each key would.
+ * Keys are hashed a batch at a time and the slots they map to are
+ * prefetched before any of them is probed, so that the cache misses of a
+ * batch overlap rather than being taken one after another. This pays off
+ * for tables much larger than the CPU caches. Always returns
+ * AWS_OP_SUCCESS.
+ *
+ * Like aws_hash_table_find, this does not change the state of the table.
+ */
+AWS_COMMON_API
+int aws_hash_table_find_many(
+    const struct aws_hash_table *map,
+    const void *const *keys,
+    size_t count,
+    struct aws_hash_element **p_elems);
+
 /**
  * Attempts to locate an element at key. If no such element was found,
  * creates a new element, with value initialized to NULL. In either case, a
@@ -274,7 +443,26 @@ AWS_COMMON_API
 int aws_hash_table_put(struct aws_hash_table *map, const void *key, void *value, int *was_created);
 
 /**
- * Removes element at key. Always returns AWS_OP_SUCCESS.
+ * Inserts count elements, as if by calling aws_hash_table_put with keys[i]
+ * and values[i] for each i in order, with the batching and prefetching
+ * described for aws_hash_table_find_many. If was_created is non-NULL,
+ * was_created[i] is set as aws_hash_table_put would set it.
+ *
+ * Raises AWS_ERROR_OOM if hash table expansion was required and memory
+ * allocation failed; in that case, the elements before the one which
+ * failed have been inserted and the remainder have not.
+ */
+AWS_COMMON_API
+int aws_hash_table_put_many(
+    struct aws_hash_table *map,
+    const void *const *keys,
+    void *const *values,
+    size_t count,
+    int *was_created);
+
+/**
+ * Removes element at key. Always returns AWS_OP_SUCCESS. If the table was
+ * initialized with a shrink_load_factor, this may shrink the table.
  *
  * If pValue is non-NULL, the existing value (if any) is moved into
  * (*value) before removing from the table, and destroy_fn is _not_
@@ -372,6 +560,53 @@ uint64_t aws_hash_byte_cursor_ptr(const void *item);
 AWS_COMMON_API
 uint64_t aws_hash_ptr(const void *item);
 
+/**
+ * Hashes len bytes starting at data using a wide-multiply hash from the
+ * wyhash/xxh3 family. This is substantially faster than the lookup3 hash
+ * behind aws_hash_c_string and friends, especially for long keys, which are
+ * hashed with AVX2 when the CPU supports it. The result does not depend on
+ * whether AVX2 is used, or on the platform.
+ *
+ * Each seed selects an unrelated hash function.
+ */
+AWS_COMMON_API
+uint64_t aws_hash_wide_bytes(const void *data, size_t len, uint64_t seed);
+
+/**
+ * Convenience hash function for NULL-terminated C-strings, using
+ * aws_hash_wide_bytes with a zero seed.
+ */
+AWS_COMMON_API
+uint64_t aws_hash_wide_c_string(const void *item);
+
+/**
+ * Convenience hash function for struct aws_strings.
+ * Hash is same as used on the string bytes by aws_hash_wide_c_string.
+ */
+AWS_COMMON_API
+uint64_t aws_hash_wide_string(const void *item);
+
+/**
+ * Convenience hash function for struct aws_byte_cursor.
+ * Hash is same as used on the string bytes by aws_hash_wide_c_string.
+ */
+AWS_COMMON_API
+uint64_t aws_hash_wide_byte_cursor_ptr(const void *item);
+
+/**
+ * Seeded variants of aws_hash_wide_c_string, aws_hash_wide_string and
+ * aws_hash_wide_byte_cursor_ptr, for use as aws_hash_table_options'
+ * seeded_hash_fn.
+ */
+AWS_COMMON_API
+uint64_t aws_hash_wide_c_string_seeded(const void *item, uint64_t seed);
+
+AWS_COMMON_API
+uint64_t aws_hash_wide_string_seeded(const void *item, uint64_t seed);
+
+AWS_COMMON_API
+uint64_t aws_hash_wide_byte_cursor_ptr_seeded(const void *item, uint64_t seed);
+
 /**
  * Convenience eq callback for NULL-terminated C-strings
  */
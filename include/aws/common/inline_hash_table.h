@@ -0,0 +1,178 @@
+#ifndef AWS_COMMON_INLINE_HASH_TABLE_H
+#define AWS_COMMON_INLINE_HASH_TABLE_H
+
+/*
+ * Copyright 2010-2018 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *  http://aws.amazon.com/apache2.0
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+#include <aws/common/common.h>
+
+/**
+ * Open-addressed hash map whose keys and values are fixed-size blobs of bytes
+ * stored directly in the slot array, rather than pointers to them. This suits
+ * maps from small plain-old-data keys (file descriptors, stream ids, ...) to
+ * small values: there is no per-element allocation or boxing of integers into
+ * pointers, and no callbacks. Keys are compared bytewise, and hashed with a
+ * function chosen by key_size (integer mixing for 1, 2, 4 and 8 byte keys).
+ *
+ * Keys with padding bytes must have them zeroed, since all key_size bytes are
+ * hashed and compared.
+ *
+ * Uses robin hood hashing with backward-shift deletion, like aws_hash_table.
+ * Each slot holds one byte of probe distance metadata in place of a full
+ * hash code.
+ */
+struct aws_inline_hash_table {
+    struct aws_allocator *alloc;
+    size_t key_size;
+    size_t value_size;
+    /* Offset of the value within a slot, and the size of a slot, both chosen to keep values naturally aligned */
+    size_t value_offset;
+    size_t slot_size;
+    /* Number of slots (a power of two), and the number in use */
+    size_t size;
+    size_t entry_count;
+    size_t max_load;
+    /* size slots, followed by two scratch slots used while inserting */
+    uint8_t *slots;
+    /* Per slot: zero if empty, otherwise one more than the entry's distance from its home slot */
+    uint8_t *distances;
+};
+
+/**
+ * Iterator over an aws_inline_hash_table. key and value point into the
+ * table's slot array, for as long as aws_inline_hash_iter_done returns false.
+ */
+struct aws_inline_hash_iter {
+    const struct aws_inline_hash_table *table;
+    size_t slot;
+    const void *key;
+    void *value;
+};
+
+AWS_EXTERN_C_BEGIN
+
+/**
+ * Initializes a map with room for at least initial_size entries before it
+ * needs to grow. key_size must be non-zero; value_size may be zero, to use
+ * the map as a set.
+ *
+ * Raises AWS_ERROR_INVALID_ARGUMENT if key_size is zero, or AWS_ERROR_OOM if
+ * allocation fails.
+ */
+AWS_COMMON_API
+int aws_inline_hash_table_init(
+    struct aws_inline_hash_table *table,
+    struct aws_allocator *alloc,
+    size_t key_size,
+    size_t value_size,
+    size_t initial_size);
+
+/**
+ * Frees all memory held by the map. This method is idempotent.
+ */
+AWS_COMMON_API
+void aws_inline_hash_table_clean_up(struct aws_inline_hash_table *table);
+
+/**
+ * Returns a pointer to the value stored at key, or NULL if there is none. The
+ * value may be modified in place through this pointer, but the pointer is
+ * invalidated by any subsequent put, create, remove or clear.
+ *
+ * For value_size 0, a non-NULL pointer still indicates presence, but must not
+ * be dereferenced.
+ */
+AWS_COMMON_API
+void *aws_inline_hash_table_find(const struct aws_inline_hash_table *table, const void *key);
+
+/**
+ * Looks up key, adding it with a zero-filled value if not already present. In
+ * either case *p_value is set to point to the value, subject to the same
+ * lifetime rules as the result of aws_inline_hash_table_find.
+ *
+ * If was_created is non-NULL, *was_created is set to 0 if an existing
+ * element was found, or 1 if a new element was created.
+ *
+ * Raises AWS_ERROR_OOM if the map needed to grow and allocation failed.
+ */
+AWS_COMMON_API
+int aws_inline_hash_table_create(
+    struct aws_inline_hash_table *table,
+    const void *key,
+    void **p_value,
+    int *was_created);
+
+/**
+ * Copies key and value (value_size bytes; value may be NULL if value_size is
+ * 0) into the map, replacing any value already stored at key.
+ *
+ * If was_created is non-NULL, *was_created is set to 0 if an existing
+ * element was found, or 1 if a new element was created.
+ *
+ * Raises AWS_ERROR_OOM if the map needed to grow and allocation failed.
+ */
+AWS_COMMON_API
+int aws_inline_hash_table_put(
+    struct aws_inline_hash_table *table,
+    const void *key,
+    const void *value,
+    int *was_created);
+
+/**
+ * Removes the element at key, if any. If removed_value is non-NULL and an
+ * element was removed, its value is copied to removed_value. If was_present
+ * is non-NULL, it is set to 1 if an element was removed and 0 otherwise.
+ * Always returns AWS_OP_SUCCESS.
+ */
+AWS_COMMON_API
+int aws_inline_hash_table_remove(
+    struct aws_inline_hash_table *table,
+    const void *key,
+    void *removed_value,
+    int *was_present);
+
+/**
+ * Removes every element from the map, keeping its current capacity.
+ */
+AWS_COMMON_API
+void aws_inline_hash_table_clear(struct aws_inline_hash_table *table);
+
+/**
+ * Returns the number of elements in the map.
+ */
+AWS_COMMON_API
+size_t aws_inline_hash_table_get_entry_count(const struct aws_inline_hash_table *table);
+
+/**
+ * Returns an iterator positioned at the first element of the map. The map
+ * must not be modified during iteration, other than by updating values in
+ * place.
+ */
+AWS_COMMON_API
+struct aws_inline_hash_iter aws_inline_hash_iter_begin(const struct aws_inline_hash_table *table);
+
+/**
+ * Returns true once the iterator has passed the last element.
+ */
+AWS_COMMON_API
+bool aws_inline_hash_iter_done(const struct aws_inline_hash_iter *iter);
+
+/**
+ * Advances the iterator to the next element.
+ */
+AWS_COMMON_API
+void aws_inline_hash_iter_next(struct aws_inline_hash_iter *iter);
+
+AWS_EXTERN_C_END
+
+#endif /* AWS_COMMON_INLINE_HASH_TABLE_H */
@@ -18,10 +18,87 @@
 #include <aws/common/hash_table.h>
 #include <aws/common/linked_list.h>
 
+struct aws_task_scheduler;
+
+/**
+ * Eviction policies supported by aws_lru_cache.
+ */
+enum aws_lru_cache_policy {
+    /**
+     * Evict the least recently used element. Every hit moves the element to
+     * the front of the recency list. This is the default.
+     */
+    AWS_LRU_CACHE_POLICY_LRU = 0,
+
+    /**
+     * SIEVE: elements stay in insertion order and a hit only sets the
+     * element's visited bit. To evict, a hand sweeps from the oldest element
+     * towards the newest, clearing visited bits until it finds an element
+     * which hasn't been visited since the hand last passed it. Hits make no
+     * writes to the list, and hit ratios are typically as good as or better
+     * than LRU's, since elements used once are evicted ahead of those which
+     * have been reused.
+     */
+    AWS_LRU_CACHE_POLICY_SIEVE,
+
+    /**
+     * W-TinyLFU: new elements enter a small LRU window (1% of capacity).
+     * Elements leaving the window compete for a place in the main segment
+     * against its next eviction candidate, and only win it if their estimated
+     * access frequency is higher. Frequencies are counted, including for keys
+     * not in the cache, in a count-min sketch which is periodically halved so
+     * that old popularity fades. The main segment is a segmented LRU: elements
+     * hit while on probation are promoted to a protected area holding 80% of
+     * it.
+     *
+     * This keeps a bulk scan of keys seen once from flushing out the
+     * frequently used ones. Finds (hit or miss) and puts of new keys both
+     * count as accesses. The sketch costs about 16 bytes per element of
+     * capacity.
+     */
+    AWS_LRU_CACHE_POLICY_TINYLFU,
+};
+
+/**
+ * Reads the current time for per-element expiry, in the same form as
+ * aws_high_res_clock_get_ticks.
+ */
+typedef int(aws_lru_cache_clock_fn)(uint64_t *timestamp);
+
+/**
+ * Returns the weight of an element, in whatever unit max_weight is given in
+ * (typically bytes).
+ */
+typedef size_t(aws_lru_cache_weigh_fn)(const void *key, const void *value);
+
+/**
+ * Optional settings for aws_lru_cache_init_with_options. A zeroed struct
+ * yields the same behavior as aws_lru_cache_init.
+ */
+struct aws_lru_cache_options {
+    enum aws_lru_cache_policy policy;
+    /* Clock that TTLs are measured against. Defaults to aws_high_res_clock_get_ticks. */
+    aws_lru_cache_clock_fn *clock_fn;
+    /*
+     * If nonzero, elements are also evicted to keep the sum of their weights at or below max_weight. max_items still
+     * applies, but may be set as high as SIZE_MAX: the node pool starts small and grows as the cache fills.
+     */
+    size_t max_weight;
+    /* Weighs elements put without an explicit weight. If NULL, every such element weighs 1. */
+    aws_lru_cache_weigh_fn *weigh_fn;
+};
+
+struct aws_lru_cache_tinylfu;
+struct aws_lru_cache_expiry;
+
 /**
  * Simple Least-recently-used cache using the standard lazy linked hash table
  * implementation. (Yes the one that was the answer to that interview question
  * that one time).
+ *
+ * List nodes come from a pool allocated up front (or, for a cache bounded by
+ * weight, grown as it fills) and recycled on eviction, so a cache which has
+ * reached capacity makes no allocator calls per put.
  */
 struct aws_lru_cache {
     struct aws_allocator *allocator;
@@ -29,14 +106,33 @@ struct aws_lru_cache {
     struct aws_hash_table table;
     aws_hash_callback_destroy_fn *user_on_value_destroy;
     size_t max_items;
+    /* Chunks of nodes, up to max_items + 1 of them (a put allocates before it evicts), and the ones not in use */
+    void *node_pool;
+    size_t node_count;
+    struct aws_linked_list free_nodes;
+    enum aws_lru_cache_policy policy;
+    /* SIEVE only: the next element the eviction sweep will examine, or NULL to start from the back of the list */
+    struct aws_linked_list_node *sieve_hand;
+    /* TINYLFU only: the main segment and frequency sketch. list holds the window. */
+    struct aws_lru_cache_tinylfu *tinylfu;
+    aws_lru_cache_clock_fn *clock_fn;
+    /* SIZE_MAX / 2 if the cache isn't bounded by weight */
+    size_t max_weight;
+    size_t weight;
+    aws_lru_cache_weigh_fn *weigh_fn;
+    /* Elements evicted to make room for others since init; expiry and removal don't count */
+    size_t evictions;
+    /* Elements with a TTL, ordered by expiry time, and the reaper task. Allocated by the first TTL put. */
+    struct aws_lru_cache_expiry *expiry;
 };
 
 AWS_EXTERN_C_BEGIN
 
 /**
- * Initializes the cache. Sets up the underlying hash table and linked list.
- * Once `max_items` elements have been added, the least recently used item will
- * be removed. For the other parameters, see aws/common/hash_table.h. Hash table
+ * Initializes the cache. Sets up the underlying hash table and linked list,
+ * and allocates a node for each of up to `max_items` elements. Once
+ * `max_items` elements have been added, the least recently used item will be
+ * removed. For the other parameters, see aws/common/hash_table.h. Hash table
  * semantics of these arguments are preserved.
  */
 AWS_COMMON_API
@@ -49,9 +145,24 @@ int aws_lru_cache_init(
     aws_hash_callback_destroy_fn *destroy_value_fn,
     size_t max_items);
 
+/**
+ * Initializes the cache as aws_lru_cache_init does, applying the settings in
+ * options. options may be NULL, in which case the defaults are used.
+ */
+AWS_COMMON_API
+int aws_lru_cache_init_with_options(
+    struct aws_lru_cache *cache,
+    struct aws_allocator *allocator,
+    aws_hash_fn *hash_fn,
+    aws_hash_callback_eq_fn *equals_fn,
+    aws_hash_callback_destroy_fn *destroy_key_fn,
+    aws_hash_callback_destroy_fn *destroy_value_fn,
+    size_t max_items,
+    const struct aws_lru_cache_options *options);
+
 /**
  * Cleans up the cache. Elements in the cache will be evicted and cleanup
- * callbacks will be invoked.
+ * callbacks will be invoked. A running expiry reaper is canceled first.
  */
 AWS_COMMON_API
 void aws_lru_cache_clean_up(struct aws_lru_cache *cache);
@@ -60,7 +171,8 @@ void aws_lru_cache_clean_up(struct aws_lru_cache *cache);
  * Finds element in the cache by key. If found, it will become most-recently
  * used, *p_value will hold the stored value, and AWS_OP_SUCCESS will be
  * returned. If not found, AWS_OP_SUCCESS will be returned and *p_value will be
- * NULL.
+ * NULL. An element whose TTL has run out is not found: it's removed, and its
+ * cleanup callbacks invoked, as if it had been evicted.
  *
  * If any errors occur AWS_OP_ERR will be returned.
  */
@@ -74,6 +186,54 @@ int aws_lru_cache_find(struct aws_lru_cache *cache, const void *key, void **p_va
 AWS_COMMON_API
 int aws_lru_cache_put(struct aws_lru_cache *cache, const void *key, void *p_value);
 
+/**
+ * Puts `p_value` at `key` as aws_lru_cache_put does, giving the element an explicit weight instead of asking the
+ * weigh_fn. Elements are evicted, by the cache's policy, until both the element count and the total weight are within
+ * bounds. An element heavier than max_weight on its own is never stored: AWS_ERROR_INVALID_ARGUMENT is raised, the
+ * cache is left unchanged, and the caller keeps ownership of key and value.
+ */
+AWS_COMMON_API
+int aws_lru_cache_put_weighted(struct aws_lru_cache *cache, const void *key, void *p_value, size_t weight);
+
+/**
+ * Puts `p_value` at `key` as aws_lru_cache_put does, but the element expires `ttl` clock ticks (nanoseconds with the
+ * default clock) from now. Expired elements are never returned by aws_lru_cache_find, and take up space only until
+ * they're found, evicted, or reaped by aws_lru_cache_remove_expired. Replacing an element, with either kind of put,
+ * replaces its TTL too.
+ */
+AWS_COMMON_API
+int aws_lru_cache_put_with_ttl(struct aws_lru_cache *cache, const void *key, void *p_value, uint64_t ttl);
+
+/**
+ * Removes up to `max_count` expired elements, soonest expired first, and returns how many were removed. Only
+ * elements with a TTL are looked at, so this costs O(log n) per element removed however large the cache is.
+ */
+AWS_COMMON_API
+size_t aws_lru_cache_remove_expired(struct aws_lru_cache *cache, size_t max_count);
+
+/**
+ * Schedules a task on `scheduler` which calls aws_lru_cache_remove_expired every `interval` ticks, removing at most
+ * `batch_size` elements per run so that no single run stalls the scheduler's thread. A run which hits the limit
+ * schedules the next one immediately rather than waiting out the interval.
+ *
+ * The task reads the cache's clock to schedule itself, so the scheduler must be run with times from the same clock.
+ * The cache may only be used from the scheduler's thread (or under a lock the task can't contend on) while the reaper
+ * is running. Stop it with aws_lru_cache_stop_expiry_reaper or by cleaning up the cache; cleaning up the scheduler
+ * stops it too. Only one reaper may run per cache.
+ */
+AWS_COMMON_API
+int aws_lru_cache_start_expiry_reaper(
+    struct aws_lru_cache *cache,
+    struct aws_task_scheduler *scheduler,
+    uint64_t interval,
+    size_t batch_size);
+
+/**
+ * Cancels the reaper task, if one is scheduled. Must be called from the scheduler's thread.
+ */
+AWS_COMMON_API
+void aws_lru_cache_stop_expiry_reaper(struct aws_lru_cache *cache);
+
 /**
  * Removes item at `key` from the cache.
  */
@@ -88,13 +248,23 @@ void aws_lru_cache_clear(struct aws_lru_cache *cache);
 
 /**
  * Accesses the least-recently-used element, sets it to most-recently-used
- * element, and returns the value.
+ * element, and returns the value. This and aws_lru_cache_get_mru_element
+ * don't check TTLs, so may return an element which has expired.
+ *
+ * Under AWS_LRU_CACHE_POLICY_SIEVE this is the oldest element, which is
+ * marked visited. Under AWS_LRU_CACHE_POLICY_TINYLFU it is the main
+ * segment's next eviction candidate (or the window's, if the main segment is
+ * empty), which is treated as if found.
  */
 AWS_COMMON_API
 void *aws_lru_cache_use_lru_element(struct aws_lru_cache *cache);
 
 /**
  * Accesses the most-recently-used element and returns its value.
+ *
+ * Under AWS_LRU_CACHE_POLICY_SIEVE this is the newest element. Under
+ * AWS_LRU_CACHE_POLICY_TINYLFU it is the most recently used element of the
+ * window, or if that's empty, of the main segment.
  */
 AWS_COMMON_API
 void *aws_lru_cache_get_mru_element(const struct aws_lru_cache *cache);
@@ -105,6 +275,20 @@ void *aws_lru_cache_get_mru_element(const struct aws_lru_cache *cache);
 AWS_COMMON_API
 size_t aws_lru_cache_get_element_count(const struct aws_lru_cache *cache);
 
+/**
+ * Returns the sum of the weights of the elements in the cache.
+ */
+AWS_COMMON_API
+size_t aws_lru_cache_get_weight(const struct aws_lru_cache *cache);
+
+/**
+ * Returns the number of elements evicted to keep the cache within its limits
+ * since it was initialized. Elements which expired, were removed or replaced,
+ * or were cleared aren't counted.
+ */
+AWS_COMMON_API
+size_t aws_lru_cache_get_eviction_count(const struct aws_lru_cache *cache);
+
 AWS_EXTERN_C_END
 
 #endif /* AWS_COMMON_LRU_CACHE_H */
@@ -0,0 +1,64 @@
+#ifndef AWS_COMMON_MMAP_ALLOCATOR_H
+#define AWS_COMMON_MMAP_ALLOCATOR_H
+/*
+ * Copyright 2010-2018 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *  http://aws.amazon.com/apache2.0
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#include <aws/common/common.h>
+
+struct aws_mmap_allocator_options {
+    /* Requests of at least this many bytes are mapped; smaller ones go to the parent. 0 means 256KB. */
+    size_t threshold;
+    /*
+     * Asks for transparent huge pages on mappings of 2MB or more (madvise(MADV_HUGEPAGE) on Linux). Ignored where
+     * unsupported.
+     */
+    bool transparent_huge_pages;
+    /*
+     * Maps from the reserved huge page pool (MAP_HUGETLB on Linux, MEM_LARGE_PAGES on Windows), rounding every
+     * mapping up to a whole huge page. Falls back to ordinary pages when the pool is empty or unavailable.
+     */
+    bool explicit_huge_pages;
+    /* Faults every page in when it's mapped (MAP_POPULATE on Linux), so that first touch doesn't */
+    bool prefault;
+};
+
+AWS_EXTERN_C_BEGIN
+
+/**
+ * Creates an aws_allocator for large buffers, such as multi-megabyte upload parts, which maps them straight from the
+ * operating system instead of going through malloc. Smaller requests go to parent.
+ *
+ * Reallocating a mapped buffer on Linux moves its pages with mremap rather than copying them, so an aws_byte_buf
+ * grown with aws_byte_buf_reserve stops copying once it passes the threshold. Elsewhere, and when growing past the
+ * threshold from below, the contents are copied as usual. Shrinking below the threshold moves the buffer back to
+ * parent.
+ *
+ * Mapped memory is cache line aligned; the rest has parent's alignment. The allocator is thread safe if parent is.
+ * Returns NULL, with the error raised, on failure.
+ */
+AWS_COMMON_API
+struct aws_allocator *aws_mmap_allocator_new(
+    struct aws_allocator *parent,
+    const struct aws_mmap_allocator_options *options);
+
+/**
+ * Frees the allocator. Memory acquired from it must have been released first.
+ */
+AWS_COMMON_API
+void aws_mmap_allocator_destroy(struct aws_allocator *allocator);
+
+AWS_EXTERN_C_END
+
+#endif /* AWS_COMMON_MMAP_ALLOCATOR_H */
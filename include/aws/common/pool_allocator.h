@@ -0,0 +1,52 @@
+#ifndef AWS_COMMON_POOL_ALLOCATOR_H
+#define AWS_COMMON_POOL_ALLOCATOR_H
+/*
+ * Copyright 2010-2018 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *  http://aws.amazon.com/apache2.0
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#include <aws/common/common.h>
+
+AWS_EXTERN_C_BEGIN
+
+/**
+ * Creates a thread-safe aws_allocator for small objects, such as cache
+ * nodes, string headers and tasks, which serves them without locking in the
+ * common case.
+ *
+ * Requests of up to 1KB are rounded up to one of 20 size classes. Each
+ * thread keeps a free list per class for each of the first few pools it
+ * uses, filled and drained in batches from a central free list per class,
+ * which is protected by a mutex. A thread's free lists go back to the
+ * central lists when it exits. Memory released on another thread than
+ * the one that acquired it goes to the releasing thread's cache, and back to
+ * the central list once that cache is full. The central lists are carved
+ * from 64KB chunks taken from parent, which are only returned to it by
+ * aws_pool_allocator_destroy. Larger requests go straight to parent.
+ *
+ * Every allocation carries a 16 byte header, and is 16 byte aligned.
+ */
+AWS_COMMON_API
+struct aws_allocator *aws_pool_allocator_new(struct aws_allocator *parent);
+
+/**
+ * Returns every chunk to the parent allocator. Anything acquired from the
+ * pool must no longer be used, and no other thread may be using the pool.
+ * Allocations of over 1KB which haven't been released are leaked.
+ */
+AWS_COMMON_API
+void aws_pool_allocator_destroy(struct aws_allocator *allocator);
+
+AWS_EXTERN_C_END
+
+#endif /* AWS_COMMON_POOL_ALLOCATOR_H */
@@ -0,0 +1,45 @@
+#ifndef AWS_COMMON_PRIVATE_MMAP_H
+#define AWS_COMMON_PRIVATE_MMAP_H
+/*
+ * Copyright 2010-2018 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *  http://aws.amazon.com/apache2.0
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#include <aws/common/common.h>
+
+/*
+ * The operating system primitives aws_mmap_allocator is built on, implemented in source/posix and source/windows.
+ * Sizes passed in are whole multiples of the page size the mapping is made of.
+ */
+
+/* The size of an ordinary page */
+size_t aws_mmap_page_size(void);
+
+/* The size of a page from the reserved huge page pool, or 0 if there's none to map from */
+size_t aws_mmap_huge_page_size(void);
+
+/*
+ * Maps size bytes of zeroed, read-write memory, made of huge pages if huge is set. transparent_huge_pages and prefault
+ * are the aws_mmap_allocator_options of the same names. Returns NULL on failure.
+ */
+void *aws_mmap_map(size_t size, bool huge, bool transparent_huge_pages, bool prefault);
+
+void aws_mmap_unmap(void *mapping, size_t size);
+
+/*
+ * Resizes a mapping without copying it, moving its pages if need be. Returns the mapping's new address, or NULL,
+ * leaving the mapping as it was, where that isn't possible.
+ */
+void *aws_mmap_remap(void *mapping, size_t old_size, size_t new_size, bool prefault);
+
+#endif /* AWS_COMMON_PRIVATE_MMAP_H */
@@ -0,0 +1,148 @@
+#ifndef AWS_COMMON_SHARDED_LRU_CACHE_H
+#define AWS_COMMON_SHARDED_LRU_CACHE_H
+/*
+ * Copyright 2010-2018 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *  http://aws.amazon.com/apache2.0
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#include <aws/common/lru_cache.h>
+
+struct aws_sharded_lru_cache_shard;
+
+/**
+ * An LRU cache which may be used from several threads at once. Keys are
+ * spread by hash code across independently locked shards, each an
+ * aws_lru_cache holding an equal share of the capacity, so threads working
+ * on different keys rarely contend on a lock.
+ *
+ * Recency is tracked per shard: when a shard is full, the least recently
+ * used element of that shard is evicted, which may not be the least recently
+ * used element of the whole cache.
+ */
+struct aws_sharded_lru_cache {
+    struct aws_allocator *allocator;
+    aws_hash_fn *hash_fn;
+    /* A power of two; a key's shard is taken from the top shard_bits bits of its mixed hash code */
+    size_t shard_count;
+    size_t shard_bits;
+    /* Cache line aligned */
+    struct aws_sharded_lru_cache_shard *shards;
+};
+
+/**
+ * Counters summed over every shard. Each shard's counters are read under its
+ * lock, but shards are visited one at a time, so with concurrent users the
+ * totals are not a single snapshot.
+ */
+struct aws_sharded_lru_cache_stats {
+    size_t element_count;
+    size_t hits;
+    size_t misses;
+    size_t evictions;
+};
+
+AWS_EXTERN_C_BEGIN
+
+/**
+ * Initializes the cache, with room for about max_items elements split across
+ * shard_count shards. shard_count is rounded up to a power of two and
+ * capped so that each shard holds at least one element; pass 0 to pick a
+ * count from the number of processors. Each shard's capacity is max_items
+ * divided by the shard count, rounded up, so the cache may hold up to
+ * shard_count - 1 elements more than max_items.
+ *
+ * For the other parameters, see aws_lru_cache_init. The callbacks may be
+ * invoked from any thread using the cache, while that shard's lock is held.
+ */
+AWS_COMMON_API
+int aws_sharded_lru_cache_init(
+    struct aws_sharded_lru_cache *cache,
+    struct aws_allocator *allocator,
+    aws_hash_fn *hash_fn,
+    aws_hash_callback_eq_fn *equals_fn,
+    aws_hash_callback_destroy_fn *destroy_key_fn,
+    aws_hash_callback_destroy_fn *destroy_value_fn,
+    size_t max_items,
+    size_t shard_count);
+
+/**
+ * Cleans up the cache, evicting every element. No other thread may be using
+ * the cache.
+ */
+AWS_COMMON_API
+void aws_sharded_lru_cache_clean_up(struct aws_sharded_lru_cache *cache);
+
+/**
+ * Finds element in the cache by key, as aws_lru_cache_find does. The value is
+ * only guaranteed to stay in the cache while the shard lock is held, so if
+ * the cache destroys values on eviction, another thread's put may destroy it
+ * as soon as this call returns. Values which must outlive that should be
+ * reference counted, or copied out with aws_sharded_lru_cache_find_with.
+ */
+AWS_COMMON_API
+int aws_sharded_lru_cache_find(struct aws_sharded_lru_cache *cache, const void *key, void **p_value);
+
+/**
+ * Called with the value found by aws_sharded_lru_cache_find_with, while the
+ * shard lock is held. Must not use the cache.
+ */
+typedef void(aws_sharded_lru_cache_found_fn)(void *value, void *user_data);
+
+/**
+ * Finds element in the cache by key, and if it's present calls on_found with
+ * its value before releasing the shard lock, so that on_found can take a
+ * reference or copy the value out. *found is set to whether the key was
+ * present.
+ */
+AWS_COMMON_API
+int aws_sharded_lru_cache_find_with(
+    struct aws_sharded_lru_cache *cache,
+    const void *key,
+    aws_sharded_lru_cache_found_fn *on_found,
+    void *user_data,
+    bool *found);
+
+/**
+ * Puts p_value at key, replacing any element already stored at key. If the
+ * key's shard is full, its least-recently-used element is evicted.
+ */
+AWS_COMMON_API
+int aws_sharded_lru_cache_put(struct aws_sharded_lru_cache *cache, const void *key, void *p_value);
+
+/**
+ * Removes item at key from the cache.
+ */
+AWS_COMMON_API
+int aws_sharded_lru_cache_remove(struct aws_sharded_lru_cache *cache, const void *key);
+
+/**
+ * Clears all items from the cache, one shard at a time.
+ */
+AWS_COMMON_API
+void aws_sharded_lru_cache_clear(struct aws_sharded_lru_cache *cache);
+
+/**
+ * Returns the number of elements in the cache.
+ */
+AWS_COMMON_API
+size_t aws_sharded_lru_cache_get_element_count(struct aws_sharded_lru_cache *cache);
+
+/**
+ * Fills in *stats with counters summed over every shard.
+ */
+AWS_COMMON_API
+void aws_sharded_lru_cache_get_stats(struct aws_sharded_lru_cache *cache, struct aws_sharded_lru_cache_stats *stats);
+
+AWS_EXTERN_C_END
+
+#endif /* AWS_COMMON_SHARDED_LRU_CACHE_H */
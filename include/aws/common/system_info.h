@@ -24,6 +24,13 @@ AWS_EXTERN_C_BEGIN
 AWS_COMMON_API
 size_t aws_system_info_processor_count(void);
 
+/**
+ * Fills frames with the return addresses of the calling thread's stack, innermost first, starting with this
+ * function's caller. Returns how many were written, which is 0 where stack walking isn't supported.
+ */
+AWS_COMMON_API
+size_t aws_backtrace(void **frames, size_t max_frames);
+
 AWS_EXTERN_C_END
 
 #endif /* AWS_COMMON_SYSTEM_INFO_H */
@@ -16,6 +16,7 @@
  * permissions and limitations under the License.
  */
 
+#include <aws/common/atomics.h>
 #include <aws/common/common.h>
 #include <aws/common/linked_list.h>
 #include <aws/common/priority_queue.h>
@@ -56,11 +57,123 @@ AWS_STATIC_IMPL void aws_task_run(struct aws_task *task, enum aws_task_status st
     task->fn(task, task->arg, status);
 }
 
+/**
+ * How an aws_task_scheduler keeps tasks scheduled for the future.
+ */
+enum aws_task_scheduler_timers {
+    /**
+     * A binary heap. Scheduling and canceling are O(log n), and tasks run in
+     * exact timestamp order. This is the default.
+     */
+    AWS_TASK_SCHEDULER_TIMERS_HEAP = 0,
+
+    /**
+     * A hierarchical timing wheel: 11 levels of 64 slots, where a level 0
+     * slot spans one tick of wheel_resolution, and each slot of the next
+     * level spans a whole rotation of the one below. Scheduling and canceling
+     * are O(1), and a run takes whole slots of due tasks at once, so this
+     * suits schedulers holding very many timers which are mostly canceled or
+     * reset before they fire, such as idle timeouts. A task moves down a level
+     * at most 10 times on its way to running.
+     *
+     * Tasks still never run before their timestamp, but those falling in the
+     * same tick run in no particular order. The wheel costs about 23KB per
+     * scheduler.
+     */
+    AWS_TASK_SCHEDULER_TIMERS_WHEEL,
+};
+
+struct aws_task_scheduler;
+
+/**
+ * Called by aws_task_scheduler_schedule_now_threadsafe and
+ * aws_task_scheduler_schedule_future_threadsafe, on the submitting thread,
+ * when a task is submitted while none are waiting to be picked up. The owner
+ * can use it to wake its thread so that it calls
+ * aws_task_scheduler_run_all. Must be safe to call from any thread.
+ */
+typedef void(aws_task_scheduler_wake_fn)(struct aws_task_scheduler *scheduler, void *user_data);
+
+/**
+ * Optional settings for aws_task_scheduler_init_with_options. A zeroed
+ * struct yields the same behavior as aws_task_scheduler_init.
+ */
+struct aws_task_scheduler_options {
+    enum aws_task_scheduler_timers timers;
+    /* Timing wheel only: the width of a tick, in the units timestamps are given in. Defaults to 1ms in nanoseconds. */
+    uint64_t wheel_resolution;
+    /* Optional, see aws_task_scheduler_wake_fn */
+    aws_task_scheduler_wake_fn *wake_fn;
+    void *wake_user_data;
+    /*
+     * Record the statistics returned by aws_task_scheduler_get_stats. Each task run then costs two reads of the
+     * high resolution clock and a hash table lookup. Has no effect if the library was built without
+     * AWS_ENABLE_TASK_SCHEDULER_STATS.
+     */
+    bool enable_stats;
+};
+
+#define AWS_TASK_SCHEDULER_STATS_HISTOGRAM_SIZE 32
+
+/**
+ * A snapshot of a scheduler's instrumentation, as returned by
+ * aws_task_scheduler_get_stats.
+ *
+ * Lateness is how long after its timestamp a timed task ran, judged by the
+ * current_time passed to aws_task_scheduler_run_all, so it is in the units
+ * timestamps are given in. Run times are measured with
+ * aws_high_res_clock_get_ticks, in nanoseconds.
+ *
+ * In the histograms, bucket 0 counts values of 0, and bucket i counts values
+ * in [2^(i-1), 2^i). The last bucket also counts all larger values.
+ */
+struct aws_task_scheduler_stats {
+    /* Tasks waiting to run as soon as possible, at the time of the snapshot */
+    size_t asap_count;
+    /* Tasks scheduled for the future, including those with slack, at the time of the snapshot */
+    size_t timed_count;
+    /* Calls to aws_task_scheduler_run_all */
+    uint64_t run_count;
+    uint64_t tasks_run;
+    uint64_t tasks_canceled;
+    /* Most tasks executed by one call to aws_task_scheduler_run_all */
+    size_t max_batch_size;
+    uint64_t max_run_all_ns;
+    uint64_t max_task_ns;
+    uint64_t max_lateness;
+    uint64_t lateness_histogram[AWS_TASK_SCHEDULER_STATS_HISTOGRAM_SIZE];
+    uint64_t run_time_histogram[AWS_TASK_SCHEDULER_STATS_HISTOGRAM_SIZE];
+};
+
+/**
+ * Run counts and times for the tasks sharing one aws_task_fn, as returned by
+ * aws_task_scheduler_get_fn_stats. Canceled runs aren't counted.
+ */
+struct aws_task_scheduler_fn_stats {
+    aws_task_fn *fn;
+    uint64_t run_count;
+    uint64_t total_ns;
+    uint64_t max_ns;
+};
+
+struct aws_task_scheduler_stats_impl;
+
+struct aws_task_scheduler_wheel;
+
 struct aws_task_scheduler {
     struct aws_allocator *alloc;
-    struct aws_priority_queue timed_queue; /* Tasks scheduled to run at specific times */
-    struct aws_linked_list timed_list;     /* If timed_queue runs out of memory, further timed tests are stored here */
-    struct aws_linked_list asap_list;      /* Tasks scheduled to run as soon as possible */
+    struct aws_priority_queue timed_queue;  /* Tasks scheduled to run at specific times */
+    struct aws_linked_list timed_list;      /* If timed_queue runs out of memory, further timed tests are stored here */
+    struct aws_linked_list asap_list;       /* Tasks scheduled to run as soon as possible */
+    struct aws_task_scheduler_wheel *wheel; /* If non-NULL, holds timed tasks in place of timed_queue */
+    /* Tasks scheduled with slack, by timestamp, and the same tasks by deadline */
+    struct aws_priority_queue slack_queue;
+    struct aws_priority_queue slack_deadlines;
+    /* Tasks submitted from other threads, newest first, linked through task->node.next */
+    struct aws_atomic_var threadsafe_head;
+    aws_task_scheduler_wake_fn *wake_fn;
+    void *wake_user_data;
+    struct aws_task_scheduler_stats_impl *stats; /* Non-NULL if instrumentation is enabled */
 };
 
 AWS_EXTERN_C_BEGIN
@@ -71,6 +184,16 @@ AWS_EXTERN_C_BEGIN
 AWS_COMMON_API
 int aws_task_scheduler_init(struct aws_task_scheduler *scheduler, struct aws_allocator *alloc);
 
+/**
+ * Initializes a task scheduler instance as aws_task_scheduler_init does, applying the settings in options.
+ * options may be NULL, in which case the defaults are used.
+ */
+AWS_COMMON_API
+int aws_task_scheduler_init_with_options(
+    struct aws_task_scheduler *scheduler,
+    struct aws_allocator *alloc,
+    const struct aws_task_scheduler_options *options);
+
 /**
  * Empties and executes all queued tasks, passing the AWS_TASK_STATUS_CANCELED status to the task function.
  * Cleans up any memory allocated, and prepares the instance for reuse or deletion.
@@ -82,6 +205,12 @@ void aws_task_scheduler_clean_up(struct aws_task_scheduler *scheduler);
  * Returns whether the scheduler has any scheduled tasks.
  * next_task_time (optional) will be set to time of the next task, note that 0 will be set if tasks were
  * added via aws_task_scheduler_schedule_now() and UINT64_MAX will be set if no tasks are scheduled at all.
+ * Tasks submitted from other threads and not yet picked up by a run also give 0, whenever they're due.
+ * Tasks scheduled with slack count at their deadline rather than their timestamp, so next_task_time is the latest
+ * time at which a run still satisfies every task's slack.
+ * With AWS_TASK_SCHEDULER_TIMERS_WHEEL, next_task_time may be early: it's the start of the wheel slot holding the next
+ * task, unless that slot spans a single tick. A run at that time moves the slot's tasks to finer slots, after which
+ * next_task_time is closer.
  */
 AWS_COMMON_API
 bool aws_task_scheduler_has_tasks(const struct aws_task_scheduler *scheduler, uint64_t *next_task_time);
@@ -103,8 +232,45 @@ void aws_task_scheduler_schedule_future(
     struct aws_task *task,
     uint64_t time_to_run);
 
+/**
+ * Schedules a task to run at time_to_run, or at any time up to slack later, so that tasks whose windows overlap can
+ * share one wake-up. aws_task_scheduler_has_tasks reports the task at time_to_run + slack, and any run from
+ * time_to_run on executes it, so a run for some other task picks up every task whose window has opened. Tasks
+ * scheduled with slack run after the other tasks of the same run, in timestamp order.
+ * A slack of 0 is the same as aws_task_scheduler_schedule_future.
+ * The task should not be cleaned up or modified until its function is executed.
+ */
+AWS_COMMON_API
+void aws_task_scheduler_schedule_future_with_slack(
+    struct aws_task_scheduler *scheduler,
+    struct aws_task *task,
+    uint64_t time_to_run,
+    uint64_t slack);
+
+/**
+ * Schedules a task to run immediately, from any thread. The task is picked up by the next call to
+ * aws_task_scheduler_run_all, which makes it visible to the scheduler's thread, and the wake_fn is called if the
+ * scheduler had no other submissions waiting. Submitting never blocks or allocates.
+ *
+ * The task should not be cleaned up or modified until its function is executed, and the scheduler must not be cleaned
+ * up while other threads may still submit to it.
+ */
+AWS_COMMON_API
+void aws_task_scheduler_schedule_now_threadsafe(struct aws_task_scheduler *scheduler, struct aws_task *task);
+
+/**
+ * Schedules a task to run at time_to_run, from any thread, as aws_task_scheduler_schedule_now_threadsafe does.
+ */
+AWS_COMMON_API
+void aws_task_scheduler_schedule_future_threadsafe(
+    struct aws_task_scheduler *scheduler,
+    struct aws_task *task,
+    uint64_t time_to_run);
+
 /**
  * Removes task from the scheduler and invokes the task with the AWS_TASK_STATUS_CANCELED status.
+ * Must be called on the scheduler's thread; a task submitted from another thread may be canceled once that submission
+ * has returned.
  */
 AWS_COMMON_API
 void aws_task_scheduler_cancel_task(struct aws_task_scheduler *scheduler, struct aws_task *task);
@@ -112,12 +278,39 @@ void aws_task_scheduler_cancel_task(struct aws_task_scheduler *scheduler, struct
 /**
  * Sequentially execute all tasks scheduled to run at, or before current_time.
  * AWS_TASK_STATUS_RUN_READY will be passed to the task function as the task status.
+ * Tasks submitted from other threads are picked up first.
  *
  * If a task schedules another task, the new task will not be executed until the next call to this function.
  */
 AWS_COMMON_API
 void aws_task_scheduler_run_all(struct aws_task_scheduler *scheduler, uint64_t current_time);
 
+/**
+ * Fills stats with the statistics recorded since init or the last reset, and the current queue depths, which take
+ * time linear in the number of tasks to count. Raises AWS_ERROR_UNSUPPORTED_OPERATION if the scheduler wasn't
+ * initialized with enable_stats, or the library was built without AWS_ENABLE_TASK_SCHEDULER_STATS.
+ * Must be called on the scheduler's thread.
+ */
+AWS_COMMON_API
+int aws_task_scheduler_get_stats(const struct aws_task_scheduler *scheduler, struct aws_task_scheduler_stats *stats);
+
+/**
+ * Copies the statistics of up to capacity task functions into fn_stats, those with the greatest total run time
+ * first, and sets count to the number copied. Fails as aws_task_scheduler_get_stats does.
+ */
+AWS_COMMON_API
+int aws_task_scheduler_get_fn_stats(
+    const struct aws_task_scheduler *scheduler,
+    struct aws_task_scheduler_fn_stats *fn_stats,
+    size_t capacity,
+    size_t *count);
+
+/**
+ * Discards the statistics recorded so far. Does nothing if instrumentation is disabled.
+ */
+AWS_COMMON_API
+void aws_task_scheduler_reset_stats(struct aws_task_scheduler *scheduler);
+
 AWS_EXTERN_C_END
 
 #endif /* AWS_COMMON_TASK_SCHEDULER_H */
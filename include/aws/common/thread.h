@@ -42,6 +42,9 @@ typedef pthread_once_t aws_thread_once;
 #    define AWS_THREAD_ONCE_STATIC_INIT PTHREAD_ONCE_INIT
 #endif
 
+/* Called with the user_data it was registered with, on the exiting thread */
+typedef void(aws_thread_atexit_fn)(void *user_data);
+
 struct aws_thread {
     struct aws_allocator *allocator;
     enum aws_thread_detach_state detach_state;
@@ -121,6 +124,15 @@ uint64_t aws_thread_current_thread_id(void);
 AWS_COMMON_API
 void aws_thread_current_sleep(uint64_t nanos);
 
+/**
+ * Registers callback to be called when the calling thread exits, whether or
+ * not it was launched through aws_thread_launch. Callbacks run in the reverse
+ * of the order they were registered in. Nothing is called for the main
+ * thread, or for any thread when the process exits with threads still running.
+ */
+AWS_COMMON_API
+int aws_thread_current_at_exit(aws_thread_atexit_fn *callback, void *user_data);
+
 AWS_EXTERN_C_END
 
 #endif /* AWS_COMMON_THREAD_H */
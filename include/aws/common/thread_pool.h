@@ -0,0 +1,89 @@
+#ifndef AWS_COMMON_THREAD_POOL_H
+#define AWS_COMMON_THREAD_POOL_H
+/*
+ * Copyright 2010-2018 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *  http://aws.amazon.com/apache2.0
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#include <aws/common/task_scheduler.h>
+
+/**
+ * A work-stealing pool of threads for CPU-bound tasks.
+ *
+ * Each worker owns a Chase-Lev deque. Tasks submitted from a worker (for
+ * instance, the pieces a task splits its work into) go on the bottom of that
+ * worker's deque, and it takes its most recently submitted task first, while
+ * idle workers steal the oldest tasks from the top of other workers' deques.
+ * Tasks submitted from outside the pool, and any that overflow a full deque,
+ * go on a shared queue behind a mutex. Workers with nothing to run or steal
+ * park on a condition variable, and are woken as tasks are submitted.
+ *
+ * Tasks are run with AWS_TASK_STATUS_RUN_READY, in no particular order, on
+ * whichever worker gets to them; their timestamps are ignored.
+ */
+struct aws_thread_pool {
+    void *p_impl;
+};
+
+/**
+ * Optional settings for aws_thread_pool_init. A zeroed struct gives the
+ * defaults.
+ */
+struct aws_thread_pool_options {
+    /* Number of worker threads. 0 means one per processor, as reported by aws_system_info_processor_count. */
+    size_t worker_count;
+    /*
+     * Tasks each worker's deque can hold, rounded up to a power of two. 0 means 1024. Tasks submitted to a full deque
+     * go to the shared queue instead.
+     */
+    size_t deque_capacity;
+};
+
+AWS_EXTERN_C_BEGIN
+
+/**
+ * Initializes the pool and launches its workers. options may be NULL, in
+ * which case the defaults are used.
+ */
+AWS_COMMON_API
+int aws_thread_pool_init(
+    struct aws_thread_pool *pool,
+    struct aws_allocator *allocator,
+    const struct aws_thread_pool_options *options);
+
+/**
+ * Stops the workers, letting tasks which are already running finish, and
+ * waits for them to exit. Tasks which hadn't started are then run with
+ * AWS_TASK_STATUS_CANCELED, on the calling thread. No other thread may submit
+ * to the pool once this has been called. Must not be called from a worker.
+ */
+AWS_COMMON_API
+void aws_thread_pool_clean_up(struct aws_thread_pool *pool);
+
+/**
+ * Submits a task to the pool, from any thread. Never blocks on a running
+ * task, and never allocates. The task must not be modified or cleaned up
+ * until its function is executed.
+ */
+AWS_COMMON_API
+void aws_thread_pool_submit(struct aws_thread_pool *pool, struct aws_task *task);
+
+/**
+ * Returns the number of worker threads in the pool.
+ */
+AWS_COMMON_API
+size_t aws_thread_pool_get_worker_count(const struct aws_thread_pool *pool);
+
+AWS_EXTERN_C_END
+
+#endif /* AWS_COMMON_THREAD_POOL_H */
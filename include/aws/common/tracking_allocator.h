@@ -0,0 +1,116 @@
+#ifndef AWS_COMMON_TRACKING_ALLOCATOR_H
+#define AWS_COMMON_TRACKING_ALLOCATOR_H
+/*
+ * Copyright 2010-2018 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *  http://aws.amazon.com/apache2.0
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#include <aws/common/common.h>
+
+/* The most stack frames recorded for a call site */
+#define AWS_TRACKING_ALLOCATOR_MAX_FRAMES 16
+
+struct aws_tracking_allocator_options {
+    /* Names what the allocator is tracking, such as a subsystem. Not copied, so it must outlive the allocator. */
+    const char *tag;
+    /*
+     * Records the stack of one allocation in every call_site_sample_interval, and keeps live byte counts for each
+     * distinct stack. 0 disables call site recording, which is the only part that takes a lock.
+     */
+    size_t call_site_sample_interval;
+    /* The number of stack frames recorded for each call site, up to AWS_TRACKING_ALLOCATOR_MAX_FRAMES */
+    size_t call_site_frames;
+    /* The most distinct call sites kept; samples from further ones are dropped. 0 means 256. */
+    size_t max_call_sites;
+};
+
+/**
+ * Counters of a tracking allocator, as returned by aws_tracking_allocator_get_stats. Sizes are those requested;
+ * the parent allocator's own overhead isn't counted.
+ */
+struct aws_tracking_allocator_stats {
+    const char *tag;
+    size_t live_bytes;
+    size_t live_allocations;
+    /* The most live_bytes have been since the allocator was created, or since the peak was last reset */
+    size_t peak_bytes;
+    size_t total_allocations;
+    size_t total_bytes;
+    /* Sampled allocations which weren't attributed to a call site because max_call_sites had been reached */
+    size_t dropped_samples;
+};
+
+/**
+ * The sampled allocations made from one stack, as returned by aws_tracking_allocator_get_call_sites. Multiplying the
+ * counts by the sample interval estimates the real ones.
+ */
+struct aws_tracking_allocator_call_site {
+    /* Return addresses, innermost first, starting inside the allocator; symbolize with backtrace_symbols or
+     * addr2line */
+    void *frames[AWS_TRACKING_ALLOCATOR_MAX_FRAMES];
+    size_t frame_count;
+    size_t live_bytes;
+    size_t live_allocations;
+    size_t total_allocations;
+};
+
+AWS_EXTERN_C_BEGIN
+
+/**
+ * Creates an aws_allocator which passes every request on to parent, counting the bytes and allocations it holds in
+ * atomic counters, so that it can be left on in production. Give each subsystem its own, tagged with its name, to
+ * see how much memory each one is holding.
+ *
+ * Each allocation carries a header of two pointers, and keeps the alignment the parent gave it. Returns NULL, with
+ * the error raised, on failure.
+ */
+AWS_COMMON_API
+struct aws_allocator *aws_tracking_allocator_new(
+    struct aws_allocator *parent,
+    const struct aws_tracking_allocator_options *options);
+
+/**
+ * Frees the allocator's bookkeeping. Memory still live is left allocated from the parent, and must not be released
+ * through the tracking allocator afterwards.
+ */
+AWS_COMMON_API
+void aws_tracking_allocator_destroy(struct aws_allocator *allocator);
+
+/**
+ * Takes a snapshot of the counters. Each counter is read atomically, but they aren't read together, so they may be
+ * slightly out of step with each other while other threads are allocating.
+ */
+AWS_COMMON_API
+void aws_tracking_allocator_get_stats(struct aws_allocator *allocator, struct aws_tracking_allocator_stats *stats);
+
+/**
+ * Lowers the peak to the current live byte count, to measure the peak of a new phase.
+ */
+AWS_COMMON_API
+void aws_tracking_allocator_reset_peak(struct aws_allocator *allocator);
+
+/**
+ * Copies up to capacity call sites into sites, those holding the most live bytes first, and sets count to the number
+ * copied. Raises AWS_ERROR_UNSUPPORTED_OPERATION if call site recording is disabled, or stack walking isn't supported
+ * on this platform.
+ */
+AWS_COMMON_API
+int aws_tracking_allocator_get_call_sites(
+    struct aws_allocator *allocator,
+    struct aws_tracking_allocator_call_site *sites,
+    size_t capacity,
+    size_t *count);
+
+AWS_EXTERN_C_END
+
+#endif /* AWS_COMMON_TRACKING_ALLOCATOR_H */
@@ -0,0 +1,92 @@
+/*
+ * Copyright 2010-2018 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *  http://aws.amazon.com/apache2.0
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#include <immintrin.h>
+
+#include <aws/common/common.h>
+
+#if defined(_MSC_VER)
+#    include <intrin.h>
+#endif
+
+static inline unsigned s_count_trailing_zeros(uint32_t mask) {
+#if defined(_MSC_VER)
+    unsigned long index;
+    _BitScanForward(&index, mask);
+    return (unsigned)index;
+#else
+    return (unsigned)__builtin_ctz(mask);
+#endif
+}
+
+/*
+ * Scans the grouped hash table control bytes in [start, limit) for the first full slot, 32 control bytes at a time.
+ * Full slots are those whose control byte has the high bit clear; empty and deleted markers both have it set.
+ */
+size_t aws_common_private_hash_ctrl_find_full_avx2(const uint8_t *ctrl, size_t start, size_t limit) {
+    size_t i = start;
+
+    for (; i + 32 <= limit; i += 32) {
+        __m256i vec = _mm256_loadu_si256((const __m256i *)&ctrl[i]);
+        uint32_t full = ~(uint32_t)_mm256_movemask_epi8(vec);
+        if (full) {
+            return i + s_count_trailing_zeros(full);
+        }
+    }
+
+    for (; i < limit; i++) {
+        if (!(ctrl[i] & 0x80)) {
+            return i;
+        }
+    }
+
+    return limit;
+}
+
+static inline __m256i s_hash_wide_accumulate_half(__m256i acc, const uint8_t *data, const uint64_t *secret) {
+    __m256i value = _mm256_loadu_si256((const __m256i *)data);
+    __m256i key = _mm256_xor_si256(value, _mm256_loadu_si256((const __m256i *)secret));
+
+    /* Low 32 bits of each key lane times its high 32 bits */
+    __m256i product = _mm256_mul_epu32(key, _mm256_srli_epi64(key, 32));
+
+    /* Swap adjacent 64-bit lanes, so that each value is added to its neighbour's accumulator */
+    __m256i swapped = _mm256_shuffle_epi32(value, _MM_SHUFFLE(1, 0, 3, 2));
+
+    return _mm256_add_epi64(acc, _mm256_add_epi64(product, swapped));
+}
+
+/*
+ * Accumulates 64-byte stripes into the eight lanes of the wide hash, with stripe s keyed by secret[s, s + 8).
+ * This must produce exactly the same lanes as the scalar s_hash_wide_accumulate in hash_table.c.
+ */
+void aws_common_private_hash_wide_accumulate_avx2(
+    uint64_t *acc,
+    const uint8_t *data,
+    size_t stripes,
+    const uint64_t *secret) {
+
+    __m256i acc_lo = _mm256_loadu_si256((const __m256i *)acc);
+    __m256i acc_hi = _mm256_loadu_si256((const __m256i *)(acc + 4));
+
+    for (size_t s = 0; s < stripes; s++) {
+        const uint8_t *stripe = data + s * 64;
+        acc_lo = s_hash_wide_accumulate_half(acc_lo, stripe, secret + s);
+        acc_hi = s_hash_wide_accumulate_half(acc_hi, stripe + 32, secret + s + 4);
+    }
+
+    _mm256_storeu_si256((__m256i *)acc, acc_lo);
+    _mm256_storeu_si256((__m256i *)(acc + 4), acc_hi);
+}
@@ -0,0 +1,196 @@
+/*
+ * Copyright 2010-2018 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *  http://aws.amazon.com/apache2.0
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+#include <aws/common/arena_allocator.h>
+
+#include <assert.h>
+#include <string.h>
+
+#define ARENA_ALIGNMENT (2 * sizeof(void *))
+#define DEFAULT_BLOCK_SIZE 4096
+
+struct aws_arena_block {
+    struct aws_arena_block *next;
+};
+
+/* Blocks' memory starts this far in, after the header */
+#define BLOCK_HEADER_SIZE ((sizeof(struct aws_arena_block) + ARENA_ALIGNMENT - 1) & ~(ARENA_ALIGNMENT - 1))
+
+static uint8_t *s_block_data(struct aws_arena_block *block) {
+    return (uint8_t *)block + BLOCK_HEADER_SIZE;
+}
+
+/* Rounds size up to the alignment, giving 0 for sizes too large to round */
+static size_t s_aligned_size(size_t size) {
+    if (size > SIZE_MAX - ARENA_ALIGNMENT) {
+        return 0;
+    }
+    if (size == 0) {
+        /* Zero-byte allocations still get a distinct pointer */
+        return ARENA_ALIGNMENT;
+    }
+    return (size + ARENA_ALIGNMENT - 1) & ~(ARENA_ALIGNMENT - 1);
+}
+
+static void s_free_blocks(struct aws_allocator *parent, struct aws_arena_block *block) {
+    while (block) {
+        struct aws_arena_block *next = block->next;
+        aws_mem_release(parent, block);
+        block = next;
+    }
+}
+
+/* Makes a fresh ordinary block current, reusing a spare one if there is one */
+static bool s_next_block(struct aws_arena_allocator *arena) {
+    struct aws_arena_block *block = arena->spare_blocks;
+    if (block) {
+        arena->spare_blocks = block->next;
+    } else {
+        block = aws_mem_acquire(arena->parent, arena->block_size);
+        if (!block) {
+            return false;
+        }
+    }
+
+    if (!arena->blocks) {
+        arena->oldest_block = block;
+    }
+    block->next = arena->blocks;
+    arena->blocks = block;
+
+    arena->cursor = s_block_data(block);
+    arena->limit = (uint8_t *)block + arena->block_size;
+    arena->last = NULL;
+    return true;
+}
+
+static void *s_arena_acquire(struct aws_allocator *allocator, size_t size) {
+    struct aws_arena_allocator *arena = allocator->impl;
+
+    size_t aligned = s_aligned_size(size);
+    if (!aligned) {
+        return NULL;
+    }
+
+    if (aligned > (size_t)(arena->limit - arena->cursor)) {
+        if (aligned > arena->block_size - BLOCK_HEADER_SIZE) {
+            /* Too big for a block; give it its own, leaving the current block as it is */
+            if (aligned > SIZE_MAX - BLOCK_HEADER_SIZE) {
+                return NULL;
+            }
+            struct aws_arena_block *large = aws_mem_acquire(arena->parent, BLOCK_HEADER_SIZE + aligned);
+            if (!large) {
+                return NULL;
+            }
+            large->next = arena->large_blocks;
+            arena->large_blocks = large;
+            return s_block_data(large);
+        }
+
+        if (!s_next_block(arena)) {
+            return NULL;
+        }
+    }
+
+    uint8_t *mem = arena->cursor;
+    arena->cursor += aligned;
+    arena->last = mem;
+    return mem;
+}
+
+static void s_arena_release(struct aws_allocator *allocator, void *ptr) {
+    /* Everything is reclaimed together by reset or clean_up */
+    (void)allocator;
+    (void)ptr;
+}
+
+static void *s_arena_realloc(struct aws_allocator *allocator, void *oldptr, size_t oldsize, size_t newsize) {
+    struct aws_arena_allocator *arena = allocator->impl;
+
+    if (!oldptr) {
+        return s_arena_acquire(allocator, newsize);
+    }
+
+    /* The most recent allocation ends at the cursor, so it can move the cursor while it still fits in its block */
+    if (oldptr == arena->last) {
+        size_t aligned = s_aligned_size(newsize);
+        if (aligned && aligned <= (size_t)(arena->limit - arena->last)) {
+            arena->cursor = arena->last + aligned;
+            return oldptr;
+        }
+    } else if (newsize <= oldsize) {
+        return oldptr;
+    }
+
+    void *newptr = s_arena_acquire(allocator, newsize);
+    if (!newptr) {
+        return NULL;
+    }
+    memcpy(newptr, oldptr, oldsize < newsize ? oldsize : newsize);
+    return newptr;
+}
+
+int aws_arena_allocator_init(
+    struct aws_arena_allocator *arena,
+    struct aws_allocator *parent,
+    size_t block_size) {
+    assert(parent);
+
+    /* Keep every block's end aligned, so that the whole of it can be handed out */
+    block_size = block_size ? block_size & ~(ARENA_ALIGNMENT - 1) : DEFAULT_BLOCK_SIZE;
+    if (block_size <= BLOCK_HEADER_SIZE) {
+        return aws_raise_error(AWS_ERROR_INVALID_ARGUMENT);
+    }
+
+    AWS_ZERO_STRUCT(*arena);
+    arena->allocator.mem_acquire = s_arena_acquire;
+    arena->allocator.mem_release = s_arena_release;
+    arena->allocator.mem_realloc = s_arena_realloc;
+    arena->allocator.impl = arena;
+    arena->parent = parent;
+    arena->block_size = block_size;
+
+    return AWS_OP_SUCCESS;
+}
+
+void aws_arena_allocator_clean_up(struct aws_arena_allocator *arena) {
+    s_free_blocks(arena->parent, arena->blocks);
+    s_free_blocks(arena->parent, arena->spare_blocks);
+    s_free_blocks(arena->parent, arena->large_blocks);
+
+    arena->blocks = NULL;
+    arena->spare_blocks = NULL;
+    arena->large_blocks = NULL;
+    arena->oldest_block = NULL;
+    arena->cursor = NULL;
+    arena->limit = NULL;
+    arena->last = NULL;
+}
+
+void aws_arena_allocator_reset(struct aws_arena_allocator *arena) {
+    s_free_blocks(arena->parent, arena->large_blocks);
+    arena->large_blocks = NULL;
+
+    /* Splice the blocks in use onto the front of the spares */
+    if (arena->blocks) {
+        arena->oldest_block->next = arena->spare_blocks;
+        arena->spare_blocks = arena->blocks;
+        arena->blocks = NULL;
+        arena->oldest_block = NULL;
+    }
+
+    arena->cursor = NULL;
+    arena->limit = NULL;
+    arena->last = NULL;
+}
@@ -45,6 +45,31 @@ void aws_byte_buf_clean_up(struct aws_byte_buf *buf) {
     buf->capacity = 0;
 }
 
+int aws_byte_buf_reserve(struct aws_byte_buf *buffer, size_t requested_capacity) {
+    if (requested_capacity <= buffer->capacity) {
+        return AWS_OP_SUCCESS;
+    }
+    if (!buffer->allocator) {
+        return aws_raise_error(AWS_ERROR_INVALID_ARGUMENT);
+    }
+
+    void *new_buffer = buffer->buffer;
+    if (new_buffer) {
+        if (aws_mem_realloc(buffer->allocator, &new_buffer, buffer->capacity, requested_capacity)) {
+            return AWS_OP_ERR;
+        }
+    } else {
+        new_buffer = aws_mem_acquire(buffer->allocator, requested_capacity);
+        if (!new_buffer) {
+            return AWS_OP_ERR;
+        }
+    }
+
+    buffer->buffer = new_buffer;
+    buffer->capacity = requested_capacity;
+    return AWS_OP_SUCCESS;
+}
+
 void aws_byte_buf_secure_zero(struct aws_byte_buf *buf) {
     if (buf->buffer) {
         aws_secure_zero(buf->buffer, buf->capacity);
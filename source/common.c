@@ -48,6 +48,25 @@ static void *s_default_realloc(struct aws_allocator *allocator, void *ptr, size_
     return realloc(ptr, newsize);
 }
 
+static void *s_default_malloc_aligned(struct aws_allocator *allocator, size_t alignment, size_t size) {
+    (void)allocator;
+#ifdef _WIN32
+    return _aligned_malloc(size ? size : 1, alignment);
+#else
+    void *mem = NULL;
+    return posix_memalign(&mem, alignment, size ? size : 1) ? NULL : mem;
+#endif
+}
+
+static void s_default_free_aligned(struct aws_allocator *allocator, void *ptr) {
+    (void)allocator;
+#ifdef _WIN32
+    _aligned_free(ptr);
+#else
+    free(ptr);
+#endif
+}
+
 static struct aws_allocator default_allocator = {
     .mem_acquire = s_default_malloc,
     .mem_release = s_default_free,
@@ -116,8 +135,56 @@ cleanup:
     return allocation;
 }
 
+void *aws_mem_acquire_aligned(struct aws_allocator *allocator, size_t alignment, size_t size) {
+    if (!alignment || (alignment & (alignment - 1))) {
+        aws_raise_error(AWS_ERROR_INVALID_ARGUMENT);
+        return NULL;
+    }
+    if (alignment < sizeof(void *)) {
+        alignment = sizeof(void *);
+    }
+
+    /* struct aws_allocator has no aligned method, so only the default allocator can skip the over-allocation */
+    if (allocator == &default_allocator) {
+        void *mem = s_default_malloc_aligned(allocator, alignment, size);
+        if (!mem) {
+            aws_raise_error(AWS_ERROR_OOM);
+        }
+        return mem;
+    }
+
+    /* Over-allocate, and keep the pointer to release just below the aligned memory */
+    size_t padding = alignment - 1 + sizeof(void *);
+    if (size > SIZE_MAX - padding) {
+        aws_raise_error(AWS_ERROR_OOM);
+        return NULL;
+    }
+    uint8_t *raw = aws_mem_acquire(allocator, size + padding);
+    if (!raw) {
+        return NULL;
+    }
+    uint8_t *aligned = (uint8_t *)AWS_ALIGN_ROUND_UP((uintptr_t)(raw + sizeof(void *)), (uintptr_t)alignment);
+    memcpy(aligned - sizeof(void *), &raw, sizeof(void *));
+    return aligned;
+}
+
 #undef AWS_ALIGN_ROUND_UP
 
+void aws_mem_release_aligned(struct aws_allocator *allocator, void *ptr) {
+    if (!ptr) {
+        return;
+    }
+
+    if (allocator == &default_allocator) {
+        s_default_free_aligned(allocator, ptr);
+        return;
+    }
+
+    void *raw = NULL;
+    memcpy(&raw, (uint8_t *)ptr - sizeof(void *), sizeof(void *));
+    aws_mem_release(allocator, raw);
+}
+
 void aws_mem_release(struct aws_allocator *allocator, void *ptr) {
     allocator->mem_release(allocator, ptr);
 }
@@ -0,0 +1,544 @@
+/*
+ * Copyright 2010-2018 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *  http://aws.amazon.com/apache2.0
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#include <aws/common/concurrent_hash_table.h>
+
+#include <aws/common/atomics.h>
+#include <aws/common/math.h>
+#include <aws/common/mutex.h>
+#include <aws/common/thread.h>
+
+/*
+ * Separate chaining, so that writers can publish an insert, removal or replacement with a single pointer store
+ * which readers observe atomically. Resizing copies every element into a new bucket array and publishes that.
+ *
+ * Retired elements and bucket arrays are reclaimed with a two-epoch scheme: a reader registers in the counter for
+ * the current epoch's parity (on one of several padded stripes, to keep readers on different threads off each
+ * other's cache lines), and the epoch may only advance once no reader remains registered under the previous parity.
+ * Anything retired during epoch e is unreachable to readers which start in e + 1, so it is freed on the advance to
+ * e + 2.
+ */
+
+/* Writers lock the stripe chosen by the low bits of the hash; there are never fewer buckets than this */
+#define WRITE_STRIPES 16
+#define READER_STRIPES 16
+/* Grow once there are more elements than buckets */
+#define MAX_LOAD_FACTOR 1
+
+struct chained_node {
+    struct aws_hash_element element;
+    uint64_t hash_code;
+    /* struct chained_node * */
+    struct aws_atomic_var next;
+    /* Once retired: the next entry on the retired list, and what to destroy when this node is freed */
+    struct chained_node *retired_next;
+    bool destroy_key;
+    bool destroy_value;
+};
+
+struct bucket_array {
+    size_t size;
+    size_t mask;
+    struct bucket_array *retired_next;
+    /* size bucket heads, each a struct chained_node * */
+    struct aws_atomic_var buckets[1];
+};
+
+struct reader_stripe {
+    /* Readers active in an epoch of each parity */
+    struct aws_atomic_var active[2];
+    uint8_t padding[AWS_CACHE_LINE - 2 * sizeof(struct aws_atomic_var)];
+};
+
+struct concurrent_hash_table_impl {
+    struct aws_allocator *alloc;
+    aws_hash_fn *hash_fn;
+    aws_hash_callback_eq_fn *equals_fn;
+    aws_hash_callback_destroy_fn *destroy_key_fn;
+    aws_hash_callback_destroy_fn *destroy_value_fn;
+
+    /* struct bucket_array * */
+    struct aws_atomic_var table;
+    struct aws_atomic_var entry_count;
+    struct aws_mutex write_locks[WRITE_STRIPES];
+
+    /* Guards the retired lists, and serializes advancing the epoch */
+    struct aws_mutex reclaim_lock;
+    struct aws_atomic_var epoch;
+    struct chained_node *retired_nodes[2];
+    struct bucket_array *retired_arrays[2];
+
+    /* Cache line aligned */
+    struct reader_stripe *readers;
+};
+
+static struct bucket_array *s_alloc_bucket_array(struct aws_allocator *alloc, size_t size) {
+    size_t bytes = aws_mul_size_saturating(size - 1, sizeof(struct aws_atomic_var));
+    if (bytes > SIZE_MAX - sizeof(struct bucket_array)) {
+        aws_raise_error(AWS_ERROR_OOM);
+        return NULL;
+    }
+
+    struct bucket_array *array = aws_mem_acquire(alloc, sizeof(struct bucket_array) + bytes);
+    if (!array) {
+        return NULL;
+    }
+
+    array->size = size;
+    array->mask = size - 1;
+    array->retired_next = NULL;
+    for (size_t i = 0; i < size; i++) {
+        aws_atomic_init_ptr(&array->buckets[i], NULL);
+    }
+    return array;
+}
+
+/* Frees an array and the nodes chained from it, without destroying their keys or values */
+static void s_free_bucket_array(struct aws_allocator *alloc, struct bucket_array *array) {
+    for (size_t i = 0; i < array->size; i++) {
+        struct chained_node *node = aws_atomic_load_ptr_explicit(&array->buckets[i], aws_memory_order_relaxed);
+        while (node) {
+            struct chained_node *next = aws_atomic_load_ptr_explicit(&node->next, aws_memory_order_relaxed);
+            aws_mem_release(alloc, node);
+            node = next;
+        }
+    }
+    aws_mem_release(alloc, array);
+}
+
+static void s_free_retired(
+    struct concurrent_hash_table_impl *impl,
+    struct chained_node *nodes,
+    struct bucket_array *arrays) {
+
+    while (nodes) {
+        struct chained_node *next = nodes->retired_next;
+        if (nodes->destroy_key && impl->destroy_key_fn) {
+            impl->destroy_key_fn((void *)nodes->element.key);
+        }
+        if (nodes->destroy_value && impl->destroy_value_fn) {
+            impl->destroy_value_fn(nodes->element.value);
+        }
+        aws_mem_release(impl->alloc, nodes);
+        nodes = next;
+    }
+
+    while (arrays) {
+        struct bucket_array *next = arrays->retired_next;
+        s_free_bucket_array(impl->alloc, arrays);
+        arrays = next;
+    }
+}
+
+/*
+ * Advances the epoch as far as readers allow (at most twice, which is enough to free everything retired so far),
+ * detaching whatever becomes safe to free into *nodes and *arrays. Must hold reclaim_lock.
+ */
+static void s_try_advance_epoch(
+    struct concurrent_hash_table_impl *impl,
+    struct chained_node **nodes,
+    struct bucket_array **arrays) {
+
+    for (int attempt = 0; attempt < 2; attempt++) {
+        size_t epoch = aws_atomic_load_int(&impl->epoch);
+        size_t previous = (epoch + 1) & 1;
+
+        for (size_t i = 0; i < READER_STRIPES; i++) {
+            if (aws_atomic_load_int(&impl->readers[i].active[previous])) {
+                return;
+            }
+        }
+
+        aws_atomic_store_int(&impl->epoch, epoch + 1);
+
+        /* The new epoch shares a parity with epoch - 1, whose retirees no reader can reach any more */
+        struct chained_node *node = impl->retired_nodes[previous];
+        while (node) {
+            struct chained_node *next = node->retired_next;
+            node->retired_next = *nodes;
+            *nodes = node;
+            node = next;
+        }
+        impl->retired_nodes[previous] = NULL;
+
+        struct bucket_array *array = impl->retired_arrays[previous];
+        while (array) {
+            struct bucket_array *next = array->retired_next;
+            array->retired_next = *arrays;
+            *arrays = array;
+            array = next;
+        }
+        impl->retired_arrays[previous] = NULL;
+    }
+}
+
+/* Retires a node and/or array, and frees whatever earlier retirees are now safe to free */
+static void s_retire(struct concurrent_hash_table_impl *impl, struct chained_node *node, struct bucket_array *array) {
+    struct chained_node *free_nodes = NULL;
+    struct bucket_array *free_arrays = NULL;
+
+    aws_mutex_lock(&impl->reclaim_lock);
+    size_t parity = aws_atomic_load_int(&impl->epoch) & 1;
+    if (node) {
+        node->retired_next = impl->retired_nodes[parity];
+        impl->retired_nodes[parity] = node;
+    }
+    if (array) {
+        array->retired_next = impl->retired_arrays[parity];
+        impl->retired_arrays[parity] = array;
+    }
+    s_try_advance_epoch(impl, &free_nodes, &free_arrays);
+    aws_mutex_unlock(&impl->reclaim_lock);
+
+    /* Outside the lock, in case a destroy callback touches the map */
+    s_free_retired(impl, free_nodes, free_arrays);
+}
+
+int aws_concurrent_hash_table_init(
+    struct aws_concurrent_hash_table *map,
+    struct aws_allocator *alloc,
+    size_t size,
+    aws_hash_fn *hash_fn,
+    aws_hash_callback_eq_fn *equals_fn,
+    aws_hash_callback_destroy_fn *destroy_key_fn,
+    aws_hash_callback_destroy_fn *destroy_value_fn) {
+
+    AWS_ZERO_STRUCT(*map);
+
+    size_t bucket_count = WRITE_STRIPES;
+    while (bucket_count < size / MAX_LOAD_FACTOR) {
+        if (bucket_count > SIZE_MAX / 2) {
+            return aws_raise_error(AWS_ERROR_OOM);
+        }
+        bucket_count <<= 1;
+    }
+
+    struct concurrent_hash_table_impl *impl = aws_mem_acquire(alloc, sizeof(struct concurrent_hash_table_impl));
+    if (!impl) {
+        return AWS_OP_ERR;
+    }
+    AWS_ZERO_STRUCT(*impl);
+    impl->alloc = alloc;
+    impl->hash_fn = hash_fn;
+    impl->equals_fn = equals_fn;
+    impl->destroy_key_fn = destroy_key_fn;
+    impl->destroy_value_fn = destroy_value_fn;
+
+    impl->readers = aws_mem_acquire_aligned(alloc, AWS_CACHE_LINE, READER_STRIPES * sizeof(struct reader_stripe));
+    if (!impl->readers) {
+        goto clean_up_impl;
+    }
+    for (size_t i = 0; i < READER_STRIPES; i++) {
+        aws_atomic_init_int(&impl->readers[i].active[0], 0);
+        aws_atomic_init_int(&impl->readers[i].active[1], 0);
+    }
+
+    struct bucket_array *array = s_alloc_bucket_array(alloc, bucket_count);
+    if (!array) {
+        goto clean_up_readers;
+    }
+
+    size_t locks_initialized = 0;
+    for (; locks_initialized < WRITE_STRIPES; locks_initialized++) {
+        if (aws_mutex_init(&impl->write_locks[locks_initialized])) {
+            goto clean_up_locks;
+        }
+    }
+    if (aws_mutex_init(&impl->reclaim_lock)) {
+        goto clean_up_locks;
+    }
+
+    aws_atomic_init_ptr(&impl->table, array);
+    aws_atomic_init_int(&impl->entry_count, 0);
+    aws_atomic_init_int(&impl->epoch, 0);
+
+    map->p_impl = impl;
+    return AWS_OP_SUCCESS;
+
+clean_up_locks:
+    for (size_t i = 0; i < locks_initialized; i++) {
+        aws_mutex_clean_up(&impl->write_locks[i]);
+    }
+    s_free_bucket_array(alloc, array);
+clean_up_readers:
+    aws_mem_release_aligned(alloc, impl->readers);
+clean_up_impl:
+    aws_mem_release(alloc, impl);
+    return AWS_OP_ERR;
+}
+
+void aws_concurrent_hash_table_clean_up(struct aws_concurrent_hash_table *map) {
+    struct concurrent_hash_table_impl *impl = map->p_impl;
+    if (!impl) {
+        return;
+    }
+
+    /* Live elements: destroy everything */
+    struct bucket_array *array = aws_atomic_load_ptr(&impl->table);
+    for (size_t i = 0; i < array->size; i++) {
+        struct chained_node *node = aws_atomic_load_ptr_explicit(&array->buckets[i], aws_memory_order_relaxed);
+        while (node) {
+            node->destroy_key = true;
+            node->destroy_value = true;
+            node->retired_next = impl->retired_nodes[0];
+            impl->retired_nodes[0] = node;
+            node = aws_atomic_load_ptr_explicit(&node->next, aws_memory_order_relaxed);
+        }
+        aws_atomic_init_ptr(&array->buckets[i], NULL);
+    }
+    s_free_bucket_array(impl->alloc, array);
+
+    for (size_t parity = 0; parity < 2; parity++) {
+        s_free_retired(impl, impl->retired_nodes[parity], impl->retired_arrays[parity]);
+    }
+
+    for (size_t i = 0; i < WRITE_STRIPES; i++) {
+        aws_mutex_clean_up(&impl->write_locks[i]);
+    }
+    aws_mutex_clean_up(&impl->reclaim_lock);
+    aws_mem_release_aligned(impl->alloc, impl->readers);
+    aws_mem_release(impl->alloc, impl);
+    map->p_impl = NULL;
+}
+
+void aws_concurrent_hash_table_read_begin(
+    const struct aws_concurrent_hash_table *map,
+    struct aws_concurrent_hash_table_read_guard *guard) {
+
+    struct concurrent_hash_table_impl *impl = map->p_impl;
+
+    /* Thread ids are often aligned pointers, so take high bits of a multiplicative hash */
+    uint64_t thread_id = aws_thread_current_thread_id();
+    size_t stripe = (size_t)((thread_id * 0x9E3779B97F4A7C15ULL) >> 32) & (READER_STRIPES - 1);
+
+    /*
+     * Register under the current epoch, then check it hasn't moved on: if it has, the registration may have come
+     * too late to hold back reclamation, so retry under the new epoch.
+     */
+    for (;;) {
+        size_t epoch = aws_atomic_load_int(&impl->epoch);
+        size_t parity = epoch & 1;
+        aws_atomic_fetch_add(&impl->readers[stripe].active[parity], 1);
+        if (aws_atomic_load_int(&impl->epoch) == epoch) {
+            guard->stripe = stripe;
+            guard->parity = parity;
+            return;
+        }
+        aws_atomic_fetch_sub(&impl->readers[stripe].active[parity], 1);
+    }
+}
+
+void aws_concurrent_hash_table_read_end(
+    const struct aws_concurrent_hash_table *map,
+    struct aws_concurrent_hash_table_read_guard *guard) {
+
+    struct concurrent_hash_table_impl *impl = map->p_impl;
+    aws_atomic_fetch_sub_explicit(&impl->readers[guard->stripe].active[guard->parity], 1, aws_memory_order_release);
+}
+
+int aws_concurrent_hash_table_find(
+    const struct aws_concurrent_hash_table *map,
+    const void *key,
+    const struct aws_hash_element **p_elem) {
+
+    struct concurrent_hash_table_impl *impl = map->p_impl;
+    uint64_t hash_code = impl->hash_fn(key);
+
+    struct bucket_array *array = aws_atomic_load_ptr_explicit(&impl->table, aws_memory_order_acquire);
+    struct chained_node *node =
+        aws_atomic_load_ptr_explicit(&array->buckets[hash_code & array->mask], aws_memory_order_acquire);
+
+    while (node) {
+        if (node->hash_code == hash_code && impl->equals_fn(key, node->element.key)) {
+            *p_elem = &node->element;
+            return AWS_OP_SUCCESS;
+        }
+        node = aws_atomic_load_ptr_explicit(&node->next, aws_memory_order_acquire);
+    }
+
+    *p_elem = NULL;
+    return AWS_OP_SUCCESS;
+}
+
+/*
+ * Finds the link (bucket head or next pointer) which points at the node for key, or at NULL at the end of the chain
+ * if there is none. Must hold the write lock for hash_code.
+ */
+static struct aws_atomic_var *s_find_link(
+    struct concurrent_hash_table_impl *impl,
+    struct bucket_array *array,
+    const void *key,
+    uint64_t hash_code) {
+
+    struct aws_atomic_var *link = &array->buckets[hash_code & array->mask];
+    struct chained_node *node;
+    while ((node = aws_atomic_load_ptr_explicit(link, aws_memory_order_relaxed)) != NULL) {
+        if (node->hash_code == hash_code && impl->equals_fn(key, node->element.key)) {
+            break;
+        }
+        link = &node->next;
+    }
+    return link;
+}
+
+/* Doubles the bucket count, unless another writer got there first */
+static void s_grow(struct concurrent_hash_table_impl *impl) {
+    for (size_t i = 0; i < WRITE_STRIPES; i++) {
+        aws_mutex_lock(&impl->write_locks[i]);
+    }
+
+    struct bucket_array *old_array = aws_atomic_load_ptr_explicit(&impl->table, aws_memory_order_relaxed);
+    struct bucket_array *new_array = NULL;
+    size_t entry_count = aws_atomic_load_int(&impl->entry_count);
+    if (entry_count <= old_array->size * MAX_LOAD_FACTOR || old_array->size > SIZE_MAX / 2) {
+        goto unlock;
+    }
+
+    /* Growing is an optimization; on failure, keep going with longer chains */
+    int prev_err = aws_last_error();
+    new_array = s_alloc_bucket_array(impl->alloc, old_array->size * 2);
+    if (!new_array) {
+        aws_restore_error(prev_err);
+        goto unlock;
+    }
+
+    for (size_t i = 0; i < old_array->size; i++) {
+        struct chained_node *node = aws_atomic_load_ptr_explicit(&old_array->buckets[i], aws_memory_order_relaxed);
+        for (; node; node = aws_atomic_load_ptr_explicit(&node->next, aws_memory_order_relaxed)) {
+            struct chained_node *copy = aws_mem_acquire(impl->alloc, sizeof(struct chained_node));
+            if (!copy) {
+                s_free_bucket_array(impl->alloc, new_array);
+                new_array = NULL;
+                aws_restore_error(prev_err);
+                goto unlock;
+            }
+            *copy = *node;
+            copy->retired_next = NULL;
+            copy->destroy_key = false;
+            copy->destroy_value = false;
+
+            struct aws_atomic_var *head = &new_array->buckets[copy->hash_code & new_array->mask];
+            aws_atomic_init_ptr(&copy->next, aws_atomic_load_ptr_explicit(head, aws_memory_order_relaxed));
+            aws_atomic_init_ptr(head, copy);
+        }
+    }
+
+    aws_atomic_store_ptr_explicit(&impl->table, new_array, aws_memory_order_release);
+
+unlock:
+    for (size_t i = WRITE_STRIPES; i > 0; i--) {
+        aws_mutex_unlock(&impl->write_locks[i - 1]);
+    }
+
+    if (new_array) {
+        /* Readers may still be walking the old chains, so free them only after a grace period */
+        s_retire(impl, NULL, old_array);
+    }
+}
+
+int aws_concurrent_hash_table_put(
+    struct aws_concurrent_hash_table *map,
+    const void *key,
+    void *value,
+    int *was_created) {
+
+    struct concurrent_hash_table_impl *impl = map->p_impl;
+    uint64_t hash_code = impl->hash_fn(key);
+
+    struct chained_node *new_node = aws_mem_acquire(impl->alloc, sizeof(struct chained_node));
+    if (!new_node) {
+        return AWS_OP_ERR;
+    }
+    new_node->element.key = key;
+    new_node->element.value = value;
+    new_node->hash_code = hash_code;
+    new_node->retired_next = NULL;
+    new_node->destroy_key = false;
+    new_node->destroy_value = false;
+
+    struct aws_mutex *lock = &impl->write_locks[hash_code & (WRITE_STRIPES - 1)];
+    aws_mutex_lock(lock);
+
+    struct bucket_array *array = aws_atomic_load_ptr_explicit(&impl->table, aws_memory_order_relaxed);
+    struct aws_atomic_var *link = s_find_link(impl, array, key, hash_code);
+    struct chained_node *old_node = aws_atomic_load_ptr_explicit(link, aws_memory_order_relaxed);
+    bool should_grow = false;
+
+    if (old_node) {
+        /* Take the old node's place in the chain; readers see one or the other */
+        aws_atomic_init_ptr(&new_node->next, aws_atomic_load_ptr_explicit(&old_node->next, aws_memory_order_relaxed));
+        aws_atomic_store_ptr_explicit(link, new_node, aws_memory_order_release);
+        old_node->destroy_key = old_node->element.key != key;
+        old_node->destroy_value = true;
+    } else {
+        struct aws_atomic_var *head = &array->buckets[hash_code & array->mask];
+        aws_atomic_init_ptr(&new_node->next, aws_atomic_load_ptr_explicit(head, aws_memory_order_relaxed));
+        aws_atomic_store_ptr_explicit(head, new_node, aws_memory_order_release);
+        size_t entry_count = aws_atomic_fetch_add(&impl->entry_count, 1) + 1;
+        should_grow = entry_count > array->size * MAX_LOAD_FACTOR;
+    }
+
+    aws_mutex_unlock(lock);
+
+    if (was_created) {
+        *was_created = old_node == NULL;
+    }
+
+    if (old_node) {
+        s_retire(impl, old_node, NULL);
+    } else if (should_grow) {
+        s_grow(impl);
+    }
+
+    return AWS_OP_SUCCESS;
+}
+
+int aws_concurrent_hash_table_remove(struct aws_concurrent_hash_table *map, const void *key, int *was_present) {
+    struct concurrent_hash_table_impl *impl = map->p_impl;
+    uint64_t hash_code = impl->hash_fn(key);
+
+    struct aws_mutex *lock = &impl->write_locks[hash_code & (WRITE_STRIPES - 1)];
+    aws_mutex_lock(lock);
+
+    struct bucket_array *array = aws_atomic_load_ptr_explicit(&impl->table, aws_memory_order_relaxed);
+    struct aws_atomic_var *link = s_find_link(impl, array, key, hash_code);
+    struct chained_node *node = aws_atomic_load_ptr_explicit(link, aws_memory_order_relaxed);
+
+    if (node) {
+        /* The node keeps its next pointer, so readers standing on it can carry on down the chain */
+        aws_atomic_store_ptr_explicit(
+            link, aws_atomic_load_ptr_explicit(&node->next, aws_memory_order_relaxed), aws_memory_order_release);
+        aws_atomic_fetch_sub(&impl->entry_count, 1);
+        node->destroy_key = true;
+        node->destroy_value = true;
+    }
+
+    aws_mutex_unlock(lock);
+
+    if (was_present) {
+        *was_present = node != NULL;
+    }
+
+    if (node) {
+        s_retire(impl, node, NULL);
+    }
+
+    return AWS_OP_SUCCESS;
+}
+
+size_t aws_concurrent_hash_table_get_entry_count(const struct aws_concurrent_hash_table *map) {
+    struct concurrent_hash_table_impl *impl = map->p_impl;
+    return aws_atomic_load_int(&impl->entry_count);
+}
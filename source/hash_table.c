@@ -20,13 +20,61 @@
 
 #include <aws/common/hash_table.h>
 
+#include <aws/common/byte_order.h>
+#include <aws/common/device_random.h>
 #include <aws/common/math.h>
 #include <aws/common/string.h>
 
+#include <assert.h>
 #include <limits.h>
 #include <stdio.h>
 #include <stdlib.h>
 
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#    include <emmintrin.h>
+#    define HASH_TABLE_USE_SSE2
+#endif
+
+#ifdef _MSC_VER
+#    include <intrin.h>
+#endif
+
+#ifdef USE_SIMD_HASH_TABLE
+size_t aws_common_private_hash_ctrl_find_full_avx2(const uint8_t *ctrl, size_t start, size_t limit);
+void aws_common_private_hash_wide_accumulate_avx2(
+    uint64_t *acc,
+    const uint8_t *data,
+    size_t stripes,
+    const uint64_t *secret);
+bool aws_common_private_has_avx2(void);
+#else
+/*
+ * When AVX2 compilation is unavailable, we use these stubs to fall back to the SSE2 or pure-C paths.
+ * Since we force aws_common_private_has_avx2 to return false, the AVX2 routines should not be called -
+ * but we must provide it anyway to avoid link errors.
+ */
+static inline size_t aws_common_private_hash_ctrl_find_full_avx2(const uint8_t *ctrl, size_t start, size_t limit) {
+    (void)ctrl;
+    (void)start;
+    assert(false);
+    return limit; /* unreachable */
+}
+static inline void aws_common_private_hash_wide_accumulate_avx2(
+    uint64_t *acc,
+    const uint8_t *data,
+    size_t stripes,
+    const uint64_t *secret) {
+    (void)acc;
+    (void)data;
+    (void)stripes;
+    (void)secret;
+    assert(false);
+}
+static inline bool aws_common_private_has_avx2(void) {
+    return false;
+}
+#endif
+
 /* Include lookup3.c so we can (potentially) inline it and make use of the mix()
  * macro. */
 #include <aws/common/private/lookup3.c>
@@ -46,8 +94,34 @@ struct hash_table_entry {
     uint64_t hash_code; /* hash code (0 signals empty) */
 };
 
+/*
+ * In the grouped layout, each slot has a corresponding control byte in the ctrl array. A control byte is either
+ * one of the two special values below (both of which have the high bit set), or the top 7 bits of the hash code of
+ * the entry in that slot.
+ */
+#define CTRL_EMPTY ((uint8_t)0x80)
+#define CTRL_DELETED ((uint8_t)0xFE)
+#define GROUP_WIDTH 16
+
+/* Number of old slots examined by each mutating operation while an incremental resize is underway */
+#define MIGRATE_SLOTS_PER_OPERATION 16
+
+/* Number of keys hashed and prefetched together by aws_hash_table_find_many and aws_hash_table_put_many */
+#define HASH_TABLE_BATCH_SIZE 16
+
+#if defined(__GNUC__) || defined(__clang__)
+#    define HASH_TABLE_PREFETCH(addr) __builtin_prefetch((addr))
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#    define HASH_TABLE_PREFETCH(addr) _mm_prefetch((const char *)(addr), _MM_HINT_T0)
+#else
+#    define HASH_TABLE_PREFETCH(addr) ((void)(addr))
+#endif
+
 struct hash_table_state {
     aws_hash_fn *hash_fn;
+    /* If set, used in preference to hash_fn, with the per-table random hash_seed */
+    aws_hash_seeded_fn *seeded_hash_fn;
+    uint64_t hash_seed;
     aws_hash_callback_eq_fn *equals_fn;
     aws_hash_callback_destroy_fn *destroy_key_fn;
     aws_hash_callback_destroy_fn *destroy_value_fn;
@@ -58,6 +132,23 @@ struct hash_table_state {
     /* We AND a hash value with mask to get the slot index */
     size_t mask;
     double max_load_factor;
+    /* Growth policy: the table is multiplied by growth_multiplier when it passes max_load, and (if min_load is
+     * non-zero) divided by it when it drops below min_load, but never below initial_size. */
+    size_t growth_multiplier;
+    double shrink_load_factor;
+    size_t min_load;
+    size_t initial_size;
+    /* Incremental resize: entries are moved out of old_state a few slots at a time, starting from
+     * old_state->slots[migrate_index]. Every slot of old_state before migrate_index is empty. */
+    bool incremental_resize;
+    struct hash_table_state *old_state;
+    size_t migrate_index;
+    /* Number of times the slot array has been reallocated, for aws_hash_table_get_stats */
+    size_t resize_count;
+    enum aws_hash_table_layout layout;
+    /* Grouped layout only: control bytes (one per slot, stored after the slots) and the number of tombstones */
+    uint8_t *ctrl;
+    size_t deleted_count;
     /* actually variable length */
     struct hash_table_entry slots[1];
 };
@@ -65,7 +156,7 @@ struct hash_table_state {
 static uint64_t s_hash_for(struct hash_table_state *state, const void *key) {
     s_suppress_unused_lookup3_func_warnings();
 
-    uint64_t hash_code = state->hash_fn(key);
+    uint64_t hash_code = state->seeded_hash_fn ? state->seeded_hash_fn(key, state->hash_seed) : state->hash_fn(key);
     if (!hash_code) {
         hash_code = 1;
     }
@@ -77,6 +168,81 @@ static size_t s_index_for(struct hash_table_state *map, struct hash_table_entry
     return (size_t)(entry - map->slots);
 }
 
+static inline uint8_t s_ctrl_tag_for(uint64_t hash_code) {
+    return (uint8_t)(hash_code >> 57);
+}
+
+static inline unsigned s_count_trailing_zeros(uint32_t mask) {
+#if defined(__GNUC__) || defined(__clang__)
+    return (unsigned)__builtin_ctz(mask);
+#elif defined(_MSC_VER)
+    unsigned long index;
+    _BitScanForward(&index, mask);
+    return (unsigned)index;
+#else
+    unsigned index = 0;
+    while (!(mask & 1)) {
+        mask >>= 1;
+        index++;
+    }
+    return index;
+#endif
+}
+
+/* Returns a bitmask with bit i set if the control byte for slot i of the group matches tag */
+static inline uint32_t s_group_match_tag(const uint8_t *group, uint8_t tag) {
+#ifdef HASH_TABLE_USE_SSE2
+    __m128i ctrl = _mm_loadu_si128((const __m128i *)group);
+    return (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(ctrl, _mm_set1_epi8((char)tag)));
+#else
+    uint32_t mask = 0;
+    for (unsigned i = 0; i < GROUP_WIDTH; i++) {
+        mask |= (uint32_t)(group[i] == tag) << i;
+    }
+    return mask;
+#endif
+}
+
+/* Returns a bitmask with bit i set if slot i of the group is empty or deleted */
+static inline uint32_t s_group_match_available(const uint8_t *group) {
+#ifdef HASH_TABLE_USE_SSE2
+    return (uint32_t)_mm_movemask_epi8(_mm_loadu_si128((const __m128i *)group));
+#else
+    uint32_t mask = 0;
+    for (unsigned i = 0; i < GROUP_WIDTH; i++) {
+        mask |= (uint32_t)(group[i] >> 7) << i;
+    }
+    return mask;
+#endif
+}
+
+/*
+ * Returns the index of the first full slot in [start, limit), or limit if there is none. The grouped layout keeps
+ * the occupancy of each slot in a single control byte, so we can skip over empty regions of the table quickly.
+ */
+static size_t s_ctrl_find_full(const struct hash_table_state *state, size_t start, size_t limit) {
+    if (aws_common_private_has_avx2()) {
+        return aws_common_private_hash_ctrl_find_full_avx2(state->ctrl, start, limit);
+    }
+
+    size_t i = start;
+#ifdef HASH_TABLE_USE_SSE2
+    for (; i + GROUP_WIDTH <= limit; i += GROUP_WIDTH) {
+        uint32_t full = ~s_group_match_available(&state->ctrl[i]) & 0xFFFF;
+        if (full) {
+            return i + s_count_trailing_zeros(full);
+        }
+    }
+#endif
+    for (; i < limit; i++) {
+        if (!(state->ctrl[i] & 0x80)) {
+            return i;
+        }
+    }
+
+    return limit;
+}
+
 #if 0
 /* Useful debugging code for anyone working on this in the future */
 static uint64_t s_distance(struct hash_table_state *state, int index) {
@@ -102,56 +268,11 @@ void hash_dump(struct aws_hash_table *tbl) {
 }
 #endif
 
-#if 0
-/* Not currently exposed as an API. Should we have something like this? Useful for benchmarks */
-AWS_COMMON_API
-void aws_hash_table_print_stats(struct aws_hash_table *table) {
-    struct hash_table_state *state = table->p_impl;
-    uint64_t total_disp = 0;
-    uint64_t max_disp = 0;
-
-    printf("\n=== Hash table statistics ===\n");
-    printf("Table size: %zu/%zu (max load %zu, remaining %zu)\n", state->entry_count, state->size, state->max_load, state->max_load - state->entry_count);
-    printf("Load factor: %02.2lf%% (max %02.2lf%%)\n",
-        100.0 * ((double)state->entry_count / (double)state->size),
-        state->max_load_factor);
-
-    for (size_t i = 0; i < state->size; i++) {
-        if (state->slots[i].hash_code) {
-            int displacement = distance(state, i);
-            total_disp += displacement;
-            if (displacement > max_disp) {
-                max_disp = displacement;
-            }
-        }
-    }
-
-    size_t *disp_counts = calloc(sizeof(*disp_counts), max_disp + 1);
-
-    for (size_t i = 0; i < state->size; i++) {
-        if (state->slots[i].hash_code) {
-            disp_counts[distance(state, i)]++;
-        }
-    }
-
-    uint64_t median = 0;
-    uint64_t passed = 0;
-    for (uint64_t i = 0; i <= max_disp && passed < total_disp / 2; i++) {
-        median = i;
-        passed += disp_counts[i];
-    }
-
-    printf("Displacement statistics: Avg %02.2lf max %llu median %llu\n", (double)total_disp / (double)state->entry_count, max_disp, median);
-    for (uint64_t i = 0; i <= max_disp; i++) {
-        printf("Displacement %2lld: %zu entries\n", i, disp_counts[i]);
-    }
-    free(disp_counts);
-    printf("\n");
-}
-#endif
-
 size_t aws_hash_table_get_entry_count(const struct aws_hash_table *map) {
     struct hash_table_state *state = map->p_impl;
+    if (state->old_state) {
+        return state->entry_count + state->old_state->entry_count;
+    }
     return state->entry_count;
 }
 
@@ -174,6 +295,15 @@ static struct hash_table_state *s_alloc_state(const struct hash_table_state *tem
         return NULL;
     }
 
+    size_t slots_end = size;
+    if (template->layout == AWS_HASH_TABLE_LAYOUT_GROUPED) {
+        /* Control bytes live directly after the last slot */
+        size += template->size;
+        if (size < slots_end) {
+            return NULL;
+        }
+    }
+
     struct hash_table_state *state = aws_mem_acquire(template->alloc, size);
 
     if (state == NULL) {
@@ -181,7 +311,16 @@ static struct hash_table_state *s_alloc_state(const struct hash_table_state *tem
     }
 
     memcpy(state, template, sizeof(*template));
-    memset(&state->slots[0], 0, size - sizeof(*state) + sizeof(state->slots[0]));
+    memset(&state->slots[0], 0, slots_end - sizeof(*state) + sizeof(state->slots[0]));
+
+    state->ctrl = NULL;
+    state->deleted_count = 0;
+    state->old_state = NULL;
+    state->migrate_index = 0;
+    if (template->layout == AWS_HASH_TABLE_LAYOUT_GROUPED) {
+        state->ctrl = (uint8_t *)state + slots_end;
+        memset(state->ctrl, CTRL_EMPTY, state->size);
+    }
 
     return state;
 }
@@ -194,6 +333,11 @@ static int s_update_template_size(struct hash_table_state *template, size_t expe
         min_size = 2;
     }
 
+    /* The grouped layout probes whole groups, so the table must hold at least one */
+    if (template->layout == AWS_HASH_TABLE_LAYOUT_GROUPED && min_size < GROUP_WIDTH) {
+        min_size = GROUP_WIDTH;
+    }
+
     size_t mask = ~(size_t)0, size = 1;
     while (size < min_size) {
         size = size << 1;
@@ -216,9 +360,13 @@ static int s_update_template_size(struct hash_table_state *template, size_t expe
     if (template->max_load >= size) {
         template->max_load = size - 1;
     }
+    if (template->max_load == 0) {
+        template->max_load = 1;
+    }
+    template->min_load = (size_t)(template->shrink_load_factor * (double)template->size);
 
     /* Make sure we don't overflow when computing memory requirements either */
-    size_t required_mem = aws_mul_size_saturating(template->size, sizeof(struct hash_table_entry));
+    size_t required_mem = aws_mul_size_saturating(template->size, sizeof(struct hash_table_entry) + 1);
     if (required_mem == SIZE_MAX || (required_mem + sizeof(struct hash_table_state)) < required_mem) {
         return aws_raise_error(AWS_ERROR_OOM);
     }
@@ -238,17 +386,86 @@ int aws_hash_table_init(
     aws_hash_callback_destroy_fn *destroy_key_fn,
     aws_hash_callback_destroy_fn *destroy_value_fn) {
 
+    return aws_hash_table_init_with_options(
+        map, alloc, size, hash_fn, equals_fn, destroy_key_fn, destroy_value_fn, NULL);
+}
+
+int aws_hash_table_init_with_options(
+    struct aws_hash_table *map,
+    struct aws_allocator *alloc,
+    size_t size,
+    aws_hash_fn *hash_fn,
+    aws_hash_callback_eq_fn *equals_fn,
+    aws_hash_callback_destroy_fn *destroy_key_fn,
+    aws_hash_callback_destroy_fn *destroy_value_fn,
+    const struct aws_hash_table_options *options) {
+
     struct hash_table_state template;
+    AWS_ZERO_STRUCT(template);
     template.hash_fn = hash_fn;
     template.equals_fn = equals_fn;
     template.destroy_key_fn = destroy_key_fn;
     template.destroy_value_fn = destroy_value_fn;
     template.alloc = alloc;
 
+    struct aws_hash_table_options default_options;
+    AWS_ZERO_STRUCT(default_options);
+    if (!options) {
+        options = &default_options;
+    }
+
     template.entry_count = 0;
-    template.max_load_factor = 0.95; /* TODO - make configurable? */
+    template.layout = options->layout;
 
-    s_update_template_size(&template, size);
+    switch (template.layout) {
+        case AWS_HASH_TABLE_LAYOUT_ROBIN_HOOD:
+            template.max_load_factor = 0.95;
+            break;
+        case AWS_HASH_TABLE_LAYOUT_GROUPED:
+            /* Tombstones count against the load, so leave some more headroom */
+            template.max_load_factor = 0.875;
+            break;
+        default:
+            return aws_raise_error(AWS_ERROR_INVALID_ARGUMENT);
+    }
+
+    if (options->max_load_factor != 0.0) {
+        if (!(options->max_load_factor > 0.0 && options->max_load_factor < 1.0)) {
+            return aws_raise_error(AWS_ERROR_INVALID_ARGUMENT);
+        }
+        template.max_load_factor = options->max_load_factor;
+    }
+
+    template.growth_multiplier = 2;
+    if (options->growth_multiplier) {
+        if (options->growth_multiplier < 2 || options->growth_multiplier > (SIZE_MAX >> 1) + 1) {
+            return aws_raise_error(AWS_ERROR_INVALID_ARGUMENT);
+        }
+        while (template.growth_multiplier < options->growth_multiplier) {
+            template.growth_multiplier <<= 1;
+        }
+    }
+
+    if (!(options->shrink_load_factor >= 0.0 &&
+          options->shrink_load_factor * (double)template.growth_multiplier < template.max_load_factor)) {
+        return aws_raise_error(AWS_ERROR_INVALID_ARGUMENT);
+    }
+    template.shrink_load_factor = options->shrink_load_factor;
+    template.incremental_resize = options->incremental_resize;
+
+    if (options->seeded_hash_fn) {
+        template.seeded_hash_fn = options->seeded_hash_fn;
+        if (aws_device_random_u64(&template.hash_seed)) {
+            return AWS_OP_ERR;
+        }
+    } else if (!hash_fn) {
+        return aws_raise_error(AWS_ERROR_INVALID_ARGUMENT);
+    }
+
+    if (s_update_template_size(&template, size)) {
+        return AWS_OP_ERR;
+    }
+    template.initial_size = template.size;
     map->p_impl = s_alloc_state(&template);
 
     if (!map->p_impl) {
@@ -299,6 +516,13 @@ static int s_find_entry1(
     struct hash_table_entry **p_entry,
     size_t *p_probe_idx);
 
+static int s_find_entry_grouped(
+    struct hash_table_state *state,
+    uint64_t hash_code,
+    const void *key,
+    struct hash_table_entry **p_entry,
+    size_t *p_probe_idx);
+
 /* Inlined fast path: Check the first slot, only. */
 /* TODO: Force inlining? */
 static int inline s_find_entry(
@@ -307,6 +531,10 @@ static int inline s_find_entry(
     const void *key,
     struct hash_table_entry **p_entry,
     size_t *p_probe_idx) {
+    if (state->layout == AWS_HASH_TABLE_LAYOUT_GROUPED) {
+        return s_find_entry_grouped(state, hash_code, key, p_entry, p_probe_idx);
+    }
+
     struct hash_table_entry *entry = &state->slots[hash_code & state->mask];
 
     if (entry->hash_code == 0) {
@@ -377,18 +605,116 @@ static int s_find_entry1(
     return rv;
 }
 
-int aws_hash_table_find(const struct aws_hash_table *map, const void *key, struct aws_hash_element **p_elem) {
+/*
+ * Grouped layout lookup. Groups are visited in triangular order (home, home + 1, home + 3, ...), which visits every
+ * group exactly once since the number of groups is a power of two. A group containing an empty slot ends the search,
+ * as an insertion for this key would have used that slot (or an earlier one) instead of continuing on.
+ *
+ * On a miss, *p_entry is set to the first empty or deleted slot in the probe sequence, which is where the key should
+ * be inserted. The probe index is the number of groups visited before the one holding *p_entry.
+ */
+static int s_find_entry_grouped(
+    struct hash_table_state *state,
+    uint64_t hash_code,
+    const void *key,
+    struct hash_table_entry **p_entry,
+    size_t *p_probe_idx) {
 
-    struct hash_table_state *state = map->p_impl;
-    uint64_t hash_code = s_hash_for(state, key);
+    uint8_t tag = s_ctrl_tag_for(hash_code);
+    size_t group_mask = state->mask / GROUP_WIDTH;
+    size_t group = (size_t)(hash_code & state->mask) / GROUP_WIDTH;
+
+    struct hash_table_entry *available = NULL;
+    size_t available_probe_idx = 0;
+
+    for (size_t probe_idx = 0;; probe_idx++) {
+        size_t base = group * GROUP_WIDTH;
+        const uint8_t *ctrl = &state->ctrl[base];
+
+        uint32_t matches = s_group_match_tag(ctrl, tag);
+        while (matches) {
+            struct hash_table_entry *entry = &state->slots[base + s_count_trailing_zeros(matches)];
+            if (entry->hash_code == hash_code && state->equals_fn(key, entry->element.key)) {
+                *p_entry = entry;
+                if (p_probe_idx) {
+                    *p_probe_idx = probe_idx;
+                }
+                return AWS_ERROR_SUCCESS;
+            }
+            matches &= matches - 1;
+        }
+
+        uint32_t free_slots = s_group_match_available(ctrl);
+        if (free_slots && !available) {
+            available = &state->slots[base + s_count_trailing_zeros(free_slots)];
+            available_probe_idx = probe_idx;
+        }
+
+        if (s_group_match_tag(ctrl, CTRL_EMPTY)) {
+            break;
+        }
+
+        group = (group + probe_idx + 1) & group_mask;
+    }
+
+    *p_entry = available;
+    if (p_probe_idx) {
+        *p_probe_idx = available_probe_idx;
+    }
+
+    return AWS_ERROR_HASHTBL_ITEM_NOT_FOUND;
+}
+
+static struct aws_hash_element *s_find_element(struct hash_table_state *state, uint64_t hash_code, const void *key) {
     struct hash_table_entry *entry;
 
     int rv = s_find_entry(state, hash_code, key, &entry, NULL);
+    if (rv != AWS_ERROR_SUCCESS && state->old_state) {
+        rv = s_find_entry(state->old_state, hash_code, key, &entry, NULL);
+    }
 
-    if (rv == AWS_ERROR_SUCCESS) {
-        *p_elem = &entry->element;
-    } else {
-        *p_elem = NULL;
+    return rv == AWS_ERROR_SUCCESS ? &entry->element : NULL;
+}
+
+int aws_hash_table_find(const struct aws_hash_table *map, const void *key, struct aws_hash_element **p_elem) {
+
+    struct hash_table_state *state = map->p_impl;
+    *p_elem = s_find_element(state, s_hash_for(state, key), key);
+
+    return AWS_OP_SUCCESS;
+}
+
+/* Prefetches the first memory a lookup for hash_code will touch */
+static inline void s_prefetch_home(const struct hash_table_state *state, uint64_t hash_code) {
+    size_t index = (size_t)(hash_code & state->mask);
+    if (state->layout == AWS_HASH_TABLE_LAYOUT_GROUPED) {
+        index &= ~(size_t)(GROUP_WIDTH - 1);
+        HASH_TABLE_PREFETCH(&state->ctrl[index]);
+    }
+    HASH_TABLE_PREFETCH(&state->slots[index]);
+}
+
+int aws_hash_table_find_many(
+    const struct aws_hash_table *map,
+    const void *const *keys,
+    size_t count,
+    struct aws_hash_element **p_elems) {
+
+    struct hash_table_state *state = map->p_impl;
+    uint64_t hash_codes[HASH_TABLE_BATCH_SIZE];
+
+    for (size_t batch_start = 0; batch_start < count; batch_start += HASH_TABLE_BATCH_SIZE) {
+        size_t batch_len = count - batch_start < HASH_TABLE_BATCH_SIZE ? count - batch_start : HASH_TABLE_BATCH_SIZE;
+        const void *const *batch_keys = keys + batch_start;
+
+        for (size_t i = 0; i < batch_len; i++) {
+            hash_codes[i] = s_hash_for(state, batch_keys[i]);
+            s_prefetch_home(state, hash_codes[i]);
+        }
+
+        for (size_t i = 0; i < batch_len; i++) {
+            p_elems[batch_start + i] = s_find_element(state, hash_codes[i], batch_keys[i]);
+        }
     }
 
     return AWS_OP_SUCCESS;
@@ -428,22 +754,116 @@ static struct hash_table_entry *s_emplace_item(
     return initial_placement;
 }
 
-static int s_expand_table(struct aws_hash_table *map) {
+/*
+ * Grouped layout insertion of an entry known not to be present. If slot is NULL, the first available slot in the
+ * entry's probe sequence is used; otherwise slot must be the destination returned by s_find_entry_grouped.
+ */
+static struct hash_table_entry *s_emplace_item_grouped(
+    struct hash_table_state *state,
+    struct hash_table_entry entry,
+    struct hash_table_entry *slot) {
+
+    if (!slot) {
+        size_t group_mask = state->mask / GROUP_WIDTH;
+        size_t group = (size_t)(entry.hash_code & state->mask) / GROUP_WIDTH;
+
+        for (size_t probe_idx = 0;; probe_idx++) {
+            size_t base = group * GROUP_WIDTH;
+            uint32_t free_slots = s_group_match_available(&state->ctrl[base]);
+            if (free_slots) {
+                slot = &state->slots[base + s_count_trailing_zeros(free_slots)];
+                break;
+            }
+            group = (group + probe_idx + 1) & group_mask;
+        }
+    }
+
+    size_t index = s_index_for(state, slot);
+    if (state->ctrl[index] == CTRL_DELETED) {
+        state->deleted_count--;
+    }
+    state->ctrl[index] = s_ctrl_tag_for(entry.hash_code);
+    *slot = entry;
+
+    return slot;
+}
+
+/* Inserts an entry known not to be present in the table, without updating the entry count */
+static struct hash_table_entry *s_emplace_new_item(struct hash_table_state *state, struct hash_table_entry entry) {
+    if (state->layout == AWS_HASH_TABLE_LAYOUT_GROUPED) {
+        return s_emplace_item_grouped(state, entry, NULL);
+    }
+    return s_emplace_item(state, entry, 0);
+}
+
+static size_t s_remove_entry(struct hash_table_state *state, struct hash_table_entry *entry);
+
+/*
+ * Moves entries from the old slot array of an incremental resize into state, examining at most max_slots old slots.
+ * Once the old slot array is empty, it is released.
+ */
+static void s_migrate_entries(struct hash_table_state *state, size_t max_slots) {
+    struct hash_table_state *old_state = state->old_state;
+    if (!old_state) {
+        return;
+    }
+
+    for (size_t i = 0; i < max_slots && old_state->entry_count; i++) {
+        assert(state->migrate_index < old_state->size);
+        struct hash_table_entry *old_entry = &old_state->slots[state->migrate_index];
+
+        if (old_entry->hash_code) {
+            /* Removing from a robin hood table may shift the next entry back into this slot, so we leave
+             * migrate_index alone until the slot is empty. This also keeps the old table's probe sequences intact
+             * for lookups of entries which haven't been moved yet. */
+            struct hash_table_entry entry = *old_entry;
+            s_remove_entry(old_state, old_entry);
+            s_emplace_new_item(state, entry);
+            state->entry_count++;
+        } else {
+            state->migrate_index++;
+        }
+    }
+
+    if (!old_state->entry_count) {
+        aws_mem_release(state->alloc, old_state);
+        state->old_state = NULL;
+        state->migrate_index = 0;
+    }
+}
+
+/* Rebuilds the table with room for new_size slots, reinserting every entry (or arranging for them to be moved over
+ * time, if incremental resizing is enabled). */
+static int s_resize_table(struct aws_hash_table *map, size_t new_size) {
     struct hash_table_state *old_state = map->p_impl;
     struct hash_table_state template = *old_state;
 
-    s_update_template_size(&template, template.size * 2);
+    /* Only one resize may be in flight at a time */
+    assert(!old_state->old_state);
+
+    if (s_update_template_size(&template, new_size)) {
+        return AWS_OP_ERR;
+    }
+
+    template.resize_count++;
 
     struct hash_table_state *new_state = s_alloc_state(&template);
     if (!new_state) {
         return AWS_OP_ERR;
     }
 
+    if (new_state->incremental_resize) {
+        new_state->entry_count = 0;
+        new_state->old_state = old_state;
+        map->p_impl = new_state;
+        return AWS_OP_SUCCESS;
+    }
+
     for (size_t i = 0; i < old_state->size; i++) {
         struct hash_table_entry entry = old_state->slots[i];
         if (entry.hash_code) {
             /* We can directly emplace since we know we won't put the same item twice */
-            s_emplace_item(new_state, entry, 0);
+            s_emplace_new_item(new_state, entry);
         }
     }
 
@@ -453,14 +873,49 @@ static int s_expand_table(struct aws_hash_table *map) {
     return AWS_OP_SUCCESS;
 }
 
-int aws_hash_table_create(
+static int s_expand_table(struct aws_hash_table *map) {
+    struct hash_table_state *state = map->p_impl;
+
+    /* If the previous resize hasn't finished yet, we have to complete it before starting the next one */
+    s_migrate_entries(state, SIZE_MAX);
+
+    if (state->entry_count < state->max_load / 2) {
+        /* We're mostly full of tombstones; rebuilding at the same size is enough to reclaim them. */
+        return s_resize_table(map, state->size);
+    }
+
+    return s_resize_table(map, aws_mul_size_saturating(state->size, state->growth_multiplier));
+}
+
+static void s_maybe_shrink_table(struct aws_hash_table *map) {
+    struct hash_table_state *state = map->p_impl;
+
+    if (state->old_state || state->entry_count >= state->min_load || state->size <= state->initial_size) {
+        return;
+    }
+
+    size_t new_size = state->size / state->growth_multiplier;
+    if (new_size < state->initial_size) {
+        new_size = state->initial_size;
+    }
+
+    /* Shrinking is only an optimization; if we can't allocate, carry on at the current size. */
+    int prev_error = aws_last_error();
+    if (s_resize_table(map, new_size)) {
+        aws_restore_error(prev_error);
+    }
+}
+
+static int s_create_with_hash(
     struct aws_hash_table *map,
+    uint64_t hash_code,
     const void *key,
     struct aws_hash_element **p_elem,
     int *was_created) {
 
     struct hash_table_state *state = map->p_impl;
-    uint64_t hash_code = s_hash_for(state, key);
+    s_migrate_entries(state, MIGRATE_SLOTS_PER_OPERATION);
+
     struct hash_table_entry *entry;
     size_t probe_idx;
     int ignored;
@@ -469,6 +924,13 @@ int aws_hash_table_create(
     }
 
     int rv = s_find_entry(state, hash_code, key, &entry, &probe_idx);
+    if (rv != AWS_ERROR_SUCCESS && state->old_state) {
+        struct hash_table_entry *old_entry;
+        if (s_find_entry(state->old_state, hash_code, key, &old_entry, NULL) == AWS_ERROR_SUCCESS) {
+            entry = old_entry;
+            rv = AWS_ERROR_SUCCESS;
+        }
+    }
 
     if (rv == AWS_ERROR_SUCCESS) {
         if (p_elem) {
@@ -478,8 +940,10 @@ int aws_hash_table_create(
         return AWS_OP_SUCCESS;
     }
 
-    /* Okay, we need to add an entry. Check the load factor first. */
-    if (state->entry_count + 1 > state->max_load) {
+    /* Okay, we need to add an entry. Check the load factor first. Tombstones count towards the load, as they
+     * lengthen probe sequences just as live entries do. */
+    size_t pending = state->old_state ? state->old_state->entry_count : 0;
+    if (state->entry_count + state->deleted_count + pending + 1 > state->max_load) {
         rv = s_expand_table(map);
         if (rv != AWS_OP_SUCCESS) {
             /* Any error was already raised in expand_table */
@@ -494,6 +958,7 @@ int aws_hash_table_create(
          this here so we don't
          * forget when we optimize later. */
         probe_idx = 0;
+        entry = NULL;
     }
 
     state->entry_count++;
@@ -502,7 +967,11 @@ int aws_hash_table_create(
     new_entry.element.value = NULL;
     new_entry.hash_code = hash_code;
 
-    entry = s_emplace_item(state, new_entry, probe_idx);
+    if (state->layout == AWS_HASH_TABLE_LAYOUT_GROUPED) {
+        entry = s_emplace_item_grouped(state, new_entry, entry);
+    } else {
+        entry = s_emplace_item(state, new_entry, probe_idx);
+    }
 
     if (p_elem) {
         *p_elem = &entry->element;
@@ -513,8 +982,23 @@ int aws_hash_table_create(
     return AWS_OP_SUCCESS;
 }
 
-AWS_COMMON_API
-int aws_hash_table_put(struct aws_hash_table *map, const void *key, void *value, int *was_created) {
+int aws_hash_table_create(
+    struct aws_hash_table *map,
+    const void *key,
+    struct aws_hash_element **p_elem,
+    int *was_created) {
+
+    struct hash_table_state *state = map->p_impl;
+    return s_create_with_hash(map, s_hash_for(state, key), key, p_elem, was_created);
+}
+
+static int s_put_with_hash(
+    struct aws_hash_table *map,
+    uint64_t hash_code,
+    const void *key,
+    void *value,
+    int *was_created) {
+
     struct aws_hash_element *p_elem;
     int was_created_fallback;
 
@@ -522,7 +1006,7 @@ int aws_hash_table_put(struct aws_hash_table *map, const void *key, void *value,
         was_created = &was_created_fallback;
     }
 
-    if (aws_hash_table_create(map, key, &p_elem, was_created)) {
+    if (s_create_with_hash(map, hash_code, key, &p_elem, was_created)) {
         return AWS_OP_ERR;
     }
 
@@ -548,11 +1032,75 @@ int aws_hash_table_put(struct aws_hash_table *map, const void *key, void *value,
     return AWS_OP_SUCCESS;
 }
 
+AWS_COMMON_API
+int aws_hash_table_put(struct aws_hash_table *map, const void *key, void *value, int *was_created) {
+    struct hash_table_state *state = map->p_impl;
+    return s_put_with_hash(map, s_hash_for(state, key), key, value, was_created);
+}
+
+int aws_hash_table_put_many(
+    struct aws_hash_table *map,
+    const void *const *keys,
+    void *const *values,
+    size_t count,
+    int *was_created) {
+
+    uint64_t hash_codes[HASH_TABLE_BATCH_SIZE];
+
+    for (size_t batch_start = 0; batch_start < count; batch_start += HASH_TABLE_BATCH_SIZE) {
+        size_t batch_len = count - batch_start < HASH_TABLE_BATCH_SIZE ? count - batch_start : HASH_TABLE_BATCH_SIZE;
+        const void *const *batch_keys = keys + batch_start;
+
+        /* A put may resize the table, which only makes these prefetches useless, not wrong */
+        struct hash_table_state *state = map->p_impl;
+        for (size_t i = 0; i < batch_len; i++) {
+            hash_codes[i] = s_hash_for(state, batch_keys[i]);
+            s_prefetch_home(state, hash_codes[i]);
+        }
+
+        for (size_t i = 0; i < batch_len; i++) {
+            size_t idx = batch_start + i;
+            if (s_put_with_hash(map, hash_codes[i], keys[idx], values[idx], was_created ? &was_created[idx] : NULL)) {
+                return AWS_OP_ERR;
+            }
+        }
+    }
+
+    return AWS_OP_SUCCESS;
+}
+
+/* Grouped layout removal. Entries never move, so the returned slot is always the removed entry's own slot. */
+static size_t s_remove_entry_grouped(struct hash_table_state *state, struct hash_table_entry *entry) {
+    state->entry_count--;
+
+    size_t index = s_index_for(state, entry);
+    size_t base = index & ~(size_t)(GROUP_WIDTH - 1);
+
+    /* A group which still has an empty slot has never been probed past, since any insertion probing it would have
+     * stopped there. We can therefore mark the slot empty again; otherwise we must leave a tombstone so that lookups
+     * for keys further along the probe sequence don't stop here.
+     */
+    if (s_group_match_tag(&state->ctrl[base], CTRL_EMPTY)) {
+        state->ctrl[index] = CTRL_EMPTY;
+    } else {
+        state->ctrl[index] = CTRL_DELETED;
+        state->deleted_count++;
+    }
+
+    AWS_ZERO_STRUCT(state->slots[index]);
+
+    return index;
+}
+
 /* Clears an entry. Does _not_ invoke destructor callbacks.
  * Returns the last slot touched (note that if we wrap, we'll report an index
  * lower than the original entry's index)
  */
 static size_t s_remove_entry(struct hash_table_state *state, struct hash_table_entry *entry) {
+    if (state->layout == AWS_HASH_TABLE_LAYOUT_GROUPED) {
+        return s_remove_entry_grouped(state, entry);
+    }
+
     state->entry_count--;
 
     /* Shift subsequent entries back until we find an entry that belongs at its
@@ -594,6 +1142,8 @@ int aws_hash_table_remove(
     int *was_present) {
 
     struct hash_table_state *state = map->p_impl;
+    s_migrate_entries(state, MIGRATE_SLOTS_PER_OPERATION);
+
     uint64_t hash_code = s_hash_for(state, key);
     struct hash_table_entry *entry;
     int ignored;
@@ -602,7 +1152,12 @@ int aws_hash_table_remove(
         was_present = &ignored;
     }
 
+    struct hash_table_state *entry_state = state;
     int rv = s_find_entry(state, hash_code, key, &entry, NULL);
+    if (rv != AWS_ERROR_SUCCESS && state->old_state) {
+        entry_state = state->old_state;
+        rv = s_find_entry(entry_state, hash_code, key, &entry, NULL);
+    }
 
     if (rv != AWS_ERROR_SUCCESS) {
         *was_present = 0;
@@ -621,7 +1176,8 @@ int aws_hash_table_remove(
             state->destroy_value_fn(entry->element.value);
         }
     }
-    s_remove_entry(state, entry);
+    s_remove_entry(entry_state, entry);
+    s_maybe_shrink_table(map);
 
     return AWS_OP_SUCCESS;
 }
@@ -646,6 +1202,119 @@ int aws_hash_table_foreach(
     return AWS_OP_SUCCESS;
 }
 
+/* Returns how far an entry sits from its home position: in slots for robin hood, in groups for the grouped layout */
+static size_t s_displacement(const struct hash_table_state *state, size_t index) {
+    uint64_t hash_code = state->slots[index].hash_code;
+
+    if (state->layout != AWS_HASH_TABLE_LAYOUT_GROUPED) {
+        return (size_t)((index - hash_code) & state->mask);
+    }
+
+    size_t group_mask = state->mask / GROUP_WIDTH;
+    size_t group = (size_t)(hash_code & state->mask) / GROUP_WIDTH;
+    size_t target = index / GROUP_WIDTH;
+    size_t probe_idx = 0;
+    while (group != target) {
+        probe_idx++;
+        group = (group + probe_idx) & group_mask;
+    }
+
+    return probe_idx;
+}
+
+static size_t s_state_bytes(const struct hash_table_state *state) {
+    size_t bytes = sizeof(*state) + (state->size - 1) * sizeof(state->slots[0]);
+    if (state->ctrl) {
+        bytes += state->size;
+    }
+    return bytes;
+}
+
+/* Adds each entry's displacement to the histogram (if given), and otherwise to the scalar stats. */
+static void s_accumulate_displacements(
+    const struct hash_table_state *state,
+    struct aws_hash_table_stats *stats,
+    uint64_t *total_displacement,
+    size_t *histogram) {
+
+    for (size_t i = 0; i < state->size; i++) {
+        if (!state->slots[i].hash_code) {
+            continue;
+        }
+
+        size_t displacement = s_displacement(state, i);
+        if (histogram) {
+            histogram[displacement]++;
+            continue;
+        }
+
+        *total_displacement += displacement;
+        if (displacement > stats->max_displacement) {
+            stats->max_displacement = displacement;
+        }
+
+        size_t bucket = displacement;
+        if (bucket >= AWS_HASH_TABLE_STATS_HISTOGRAM_SIZE) {
+            bucket = AWS_HASH_TABLE_STATS_HISTOGRAM_SIZE - 1;
+        }
+        stats->displacement_histogram[bucket]++;
+    }
+}
+
+int aws_hash_table_get_stats(const struct aws_hash_table *map, struct aws_hash_table_stats *stats) {
+    const struct hash_table_state *state = map->p_impl;
+    const struct hash_table_state *old_state = state->old_state;
+
+    AWS_ZERO_STRUCT(*stats);
+    stats->entry_count = aws_hash_table_get_entry_count(map);
+    stats->capacity = state->size;
+    stats->bytes_used = s_state_bytes(state);
+    stats->resize_count = state->resize_count;
+    stats->tombstone_count = state->deleted_count;
+    if (old_state) {
+        stats->capacity += old_state->size;
+        stats->bytes_used += s_state_bytes(old_state);
+        stats->tombstone_count += old_state->deleted_count;
+    }
+
+    if (!stats->entry_count) {
+        return AWS_OP_SUCCESS;
+    }
+
+    uint64_t total_displacement = 0;
+    s_accumulate_displacements(state, stats, &total_displacement, NULL);
+    if (old_state) {
+        s_accumulate_displacements(old_state, stats, &total_displacement, NULL);
+    }
+    stats->average_displacement = (double)total_displacement / (double)stats->entry_count;
+
+    /* The median needs an exact histogram, which can be as long as the longest displacement */
+    size_t histogram_len = stats->max_displacement + 1;
+    size_t *histogram = aws_mem_acquire(state->alloc, histogram_len * sizeof(size_t));
+    if (!histogram) {
+        return AWS_OP_ERR;
+    }
+    memset(histogram, 0, histogram_len * sizeof(size_t));
+
+    s_accumulate_displacements(state, stats, NULL, histogram);
+    if (old_state) {
+        s_accumulate_displacements(old_state, stats, NULL, histogram);
+    }
+
+    size_t passed = 0;
+    for (size_t i = 0; i < histogram_len; i++) {
+        passed += histogram[i];
+        if (passed * 2 >= stats->entry_count) {
+            stats->median_displacement = i;
+            break;
+        }
+    }
+
+    aws_mem_release(state->alloc, histogram);
+
+    return AWS_OP_SUCCESS;
+}
+
 bool aws_hash_table_eq(
     const struct aws_hash_table *a,
     const struct aws_hash_table *b,
@@ -679,9 +1348,13 @@ bool aws_hash_table_eq(
 
 static inline void s_get_next_element(struct aws_hash_iter *iter, size_t start_slot) {
 
-    struct hash_table_state *state = iter->map->p_impl;
+    struct hash_table_state *state = iter->state;
     size_t limit = iter->limit;
 
+    if (state->layout == AWS_HASH_TABLE_LAYOUT_GROUPED) {
+        start_slot = s_ctrl_find_full(state, start_slot, limit);
+    }
+
     for (size_t i = start_slot; i < limit; i++) {
         struct hash_table_entry *entry = &state->slots[i];
 
@@ -691,6 +1364,15 @@ static inline void s_get_next_element(struct aws_hash_iter *iter, size_t start_s
             return;
         }
     }
+
+    /* If a resize is underway, continue on to the entries which haven't been moved yet */
+    if (state == iter->map->p_impl && state->old_state) {
+        iter->state = state->old_state;
+        iter->limit = state->old_state->size;
+        s_get_next_element(iter, 0);
+        return;
+    }
+
     iter->element.key = NULL;
     iter->element.value = NULL;
     iter->slot = iter->limit;
@@ -699,7 +1381,9 @@ static inline void s_get_next_element(struct aws_hash_iter *iter, size_t start_s
 struct aws_hash_iter aws_hash_iter_begin(const struct aws_hash_table *map) {
     struct hash_table_state *state = map->p_impl;
     struct aws_hash_iter iter;
+    AWS_ZERO_STRUCT(iter);
     iter.map = map;
+    iter.state = state;
     iter.limit = state->size;
     s_get_next_element(&iter, 0);
     return iter;
@@ -720,7 +1404,7 @@ void aws_hash_iter_next(struct aws_hash_iter *iter) {
 }
 
 void aws_hash_iter_delete(struct aws_hash_iter *iter, bool destroy_contents) {
-    struct hash_table_state *state = iter->map->p_impl;
+    struct hash_table_state *state = iter->state;
     if (destroy_contents) {
         state->destroy_key_fn((void *)iter->element.key);
         state->destroy_value_fn(iter->element.value);
@@ -733,8 +1417,10 @@ void aws_hash_iter_delete(struct aws_hash_iter *iter, bool destroy_contents) {
      * iter->limit - 1 position. To avoid double iteration, we'll now reduce the
      * limit to compensate.
      *
-     * Note that last_index cannot equal iter->slot, because slots[iter->slot]
-     * is empty before we start walking the table.
+     * Note that for the robin hood layout last_index cannot equal iter->slot,
+     * because slots[iter->slot] is empty before we start walking the table.
+     * The grouped layout never shifts entries, so last_index is always
+     * iter->slot and the limit is left alone.
      */
     if (last_index < iter->slot || last_index >= iter->limit) {
         iter->limit--;
@@ -756,8 +1442,7 @@ void aws_hash_iter_delete(struct aws_hash_iter *iter, bool destroy_contents) {
     iter->slot--;
 }
 
-void aws_hash_table_clear(struct aws_hash_table *map) {
-    struct hash_table_state *state = map->p_impl;
+static void s_clear_state(struct hash_table_state *state) {
     if (state->destroy_key_fn) {
         /* Check whether we have destructors once before traversing table. */
         if (state->destroy_value_fn) {
@@ -789,8 +1474,25 @@ void aws_hash_table_clear(struct aws_hash_table *map) {
     /* Since hash code 0 represents an empty slot we can just zero out the
      * entire table. */
     memset(state->slots, 0, sizeof(*state->slots) * state->size);
+    if (state->ctrl) {
+        memset(state->ctrl, CTRL_EMPTY, state->size);
+    }
 
     state->entry_count = 0;
+    state->deleted_count = 0;
+}
+
+void aws_hash_table_clear(struct aws_hash_table *map) {
+    struct hash_table_state *state = map->p_impl;
+
+    if (state->old_state) {
+        s_clear_state(state->old_state);
+        aws_mem_release(state->alloc, state->old_state);
+        state->old_state = NULL;
+        state->migrate_index = 0;
+    }
+
+    s_clear_state(state);
 }
 
 uint64_t aws_hash_c_string(const void *item) {
@@ -833,6 +1535,239 @@ uint64_t aws_hash_ptr(const void *item) {
     return ((uint64_t)b << 32) | c;
 }
 
+/*
+ * Wide hash. Keys of up to HASH_WIDE_LONG_THRESHOLD bytes are hashed wyhash-style, folding 64x64->128 bit multiplies
+ * over 16-byte (and for longer keys, 48-byte) chunks. Longer keys are hashed xxh3-style: 64-byte stripes are
+ * accumulated into eight independent 64-bit lanes using 32x32->64 bit multiplies, which map directly onto AVX2; the
+ * lanes are scrambled after every block of stripes and folded together at the end.
+ *
+ * All reads are little-endian, so hash values are the same on every platform.
+ */
+#define HASH_WIDE_LONG_THRESHOLD 1024
+#define HASH_WIDE_STRIPE_LEN 64
+#define HASH_WIDE_STRIPES_PER_BLOCK 16
+#define HASH_WIDE_LANES 8
+#define HASH_WIDE_SECRET_LEN 24
+
+static const uint64_t s_hash_wide_secret[HASH_WIDE_SECRET_LEN] = {
+    0x008f900298afbcfdULL, 0x8269cd0379b686c7ULL, 0xe91497289dc4c193ULL, 0x5bea32c95facc671ULL,
+    0xfdad5c0dbb5a743fULL, 0xb02e27cbae3473a3ULL, 0x10e2e185b5282879ULL, 0xe2b4630f063ef747ULL,
+    0x82c1f0461fc22119ULL, 0x7e92cf9d776c6903ULL, 0xf44d85b573c26855ULL, 0x703b6475915d2f55ULL,
+    0xca3e12633cb38803ULL, 0x73b903d303962f5fULL, 0x8bce856f61a071b3ULL, 0xf4887249347c3a19ULL,
+    0xd3d6f0a83fdf096bULL, 0x6cbc1d1c65d7a5e5ULL, 0x933a58948a76800fULL, 0x8b77ecc6e54af883ULL,
+    0xa6f84f771f8e6eadULL, 0x8cd08c3313d3380fULL, 0xcd18a7294d670329ULL, 0xf6c36d085d25d5f7ULL,
+};
+
+/* wyhash's multipliers */
+static const uint64_t s_hash_wide_p0 = 0xa0761d6478bd642fULL;
+static const uint64_t s_hash_wide_p1 = 0xe7037ed1a0b428dbULL;
+static const uint64_t s_hash_wide_p2 = 0x8ebc6af09c88c6e3ULL;
+static const uint64_t s_hash_wide_p3 = 0x589965cc75374cc3ULL;
+
+/* Replaces a and b with the low and high halves of their 128-bit product */
+static inline void s_hash_wide_mum(uint64_t *a, uint64_t *b) {
+#if defined(__SIZEOF_INT128__)
+    __extension__ unsigned __int128 product = (unsigned __int128)*a * *b;
+    *a = (uint64_t)product;
+    *b = (uint64_t)(product >> 64);
+#elif defined(_MSC_VER) && defined(_M_X64)
+    *a = _umul128(*a, *b, b);
+#else
+    uint64_t a_hi = *a >> 32, a_lo = (uint32_t)*a;
+    uint64_t b_hi = *b >> 32, b_lo = (uint32_t)*b;
+    uint64_t hi_hi = a_hi * b_hi, hi_lo = a_hi * b_lo, lo_hi = a_lo * b_hi, lo_lo = a_lo * b_lo;
+
+    uint64_t t = lo_lo + (hi_lo << 32);
+    uint64_t carry = t < lo_lo;
+    uint64_t lo = t + (lo_hi << 32);
+    carry += lo < t;
+
+    *a = lo;
+    *b = hi_hi + (hi_lo >> 32) + (lo_hi >> 32) + carry;
+#endif
+}
+
+static inline uint64_t s_hash_wide_mix(uint64_t a, uint64_t b) {
+    s_hash_wide_mum(&a, &b);
+    return a ^ b;
+}
+
+static inline uint64_t s_hash_wide_read64(const uint8_t *p) {
+    uint64_t v;
+    memcpy(&v, p, sizeof(v));
+    if (aws_is_big_endian()) {
+        v = (uint64_t)p[0] | (uint64_t)p[1] << 8 | (uint64_t)p[2] << 16 | (uint64_t)p[3] << 24 |
+            (uint64_t)p[4] << 32 | (uint64_t)p[5] << 40 | (uint64_t)p[6] << 48 | (uint64_t)p[7] << 56;
+    }
+    return v;
+}
+
+static inline uint64_t s_hash_wide_read32(const uint8_t *p) {
+    uint32_t v;
+    memcpy(&v, p, sizeof(v));
+    if (aws_is_big_endian()) {
+        v = (uint32_t)p[0] | (uint32_t)p[1] << 8 | (uint32_t)p[2] << 16 | (uint32_t)p[3] << 24;
+    }
+    return v;
+}
+
+static uint64_t s_hash_wide_short(const uint8_t *p, size_t len, uint64_t seed) {
+    uint64_t a, b;
+
+    seed ^= s_hash_wide_mix(seed ^ s_hash_wide_p0, s_hash_wide_p1);
+
+    if (len <= 16) {
+        if (len >= 4) {
+            /* Two possibly overlapping reads from each end cover every byte */
+            size_t offset = (len >> 3) << 2;
+            a = (s_hash_wide_read32(p) << 32) | s_hash_wide_read32(p + offset);
+            b = (s_hash_wide_read32(p + len - 4) << 32) | s_hash_wide_read32(p + len - 4 - offset);
+        } else if (len > 0) {
+            a = ((uint64_t)p[0] << 16) | ((uint64_t)p[len >> 1] << 8) | p[len - 1];
+            b = 0;
+        } else {
+            a = b = 0;
+        }
+    } else {
+        size_t remaining = len;
+        if (remaining > 48) {
+            uint64_t seed1 = seed, seed2 = seed;
+            do {
+                seed = s_hash_wide_mix(s_hash_wide_read64(p) ^ s_hash_wide_p1, s_hash_wide_read64(p + 8) ^ seed);
+                seed1 =
+                    s_hash_wide_mix(s_hash_wide_read64(p + 16) ^ s_hash_wide_p2, s_hash_wide_read64(p + 24) ^ seed1);
+                seed2 =
+                    s_hash_wide_mix(s_hash_wide_read64(p + 32) ^ s_hash_wide_p3, s_hash_wide_read64(p + 40) ^ seed2);
+                p += 48;
+                remaining -= 48;
+            } while (remaining > 48);
+            seed ^= seed1 ^ seed2;
+        }
+        while (remaining > 16) {
+            seed = s_hash_wide_mix(s_hash_wide_read64(p) ^ s_hash_wide_p1, s_hash_wide_read64(p + 8) ^ seed);
+            p += 16;
+            remaining -= 16;
+        }
+        /* The final 16 bytes, which may overlap bytes already consumed */
+        a = s_hash_wide_read64(p + remaining - 16);
+        b = s_hash_wide_read64(p + remaining - 8);
+    }
+
+    a ^= s_hash_wide_p1;
+    b ^= seed;
+    s_hash_wide_mum(&a, &b);
+
+    return s_hash_wide_mix(a ^ s_hash_wide_p0 ^ (uint64_t)len, b ^ s_hash_wide_p1);
+}
+
+/* Accumulates 64-byte stripes, with stripe s keyed by secret[s, s + 8). Must match the AVX2 implementation. */
+static void s_hash_wide_accumulate(uint64_t *acc, const uint8_t *data, size_t stripes, const uint64_t *secret) {
+    if (aws_common_private_has_avx2()) {
+        aws_common_private_hash_wide_accumulate_avx2(acc, data, stripes, secret);
+        return;
+    }
+
+    for (size_t s = 0; s < stripes; s++) {
+        const uint8_t *stripe = data + s * HASH_WIDE_STRIPE_LEN;
+        for (size_t i = 0; i < HASH_WIDE_LANES; i++) {
+            uint64_t value = s_hash_wide_read64(stripe + 8 * i);
+            uint64_t key = value ^ secret[s + i];
+            acc[i ^ 1] += value;
+            acc[i] += (key & 0xFFFFFFFF) * (key >> 32);
+        }
+    }
+}
+
+static void s_hash_wide_scramble(uint64_t *acc, const uint64_t *secret) {
+    for (size_t i = 0; i < HASH_WIDE_LANES; i++) {
+        acc[i] ^= acc[i] >> 47;
+        acc[i] ^= secret[i];
+        acc[i] *= 0x9E3779B1ULL;
+    }
+}
+
+static uint64_t s_hash_wide_long(const uint8_t *p, size_t len, uint64_t seed) {
+    uint64_t secret[HASH_WIDE_SECRET_LEN];
+    for (size_t i = 0; i < HASH_WIDE_SECRET_LEN; i++) {
+        secret[i] = s_hash_wide_secret[i] + ((i & 1) ? 0 - seed : seed);
+    }
+
+    uint64_t acc[HASH_WIDE_LANES] = {
+        0xC2B2AE3DULL,
+        0x9E3779B185EBCA87ULL,
+        0xC2B2AE3D27D4EB4FULL,
+        0x165667B19E3779F9ULL,
+        0x85EBCA77C2B2AE63ULL,
+        0x85EBCA77ULL,
+        0x27D4EB2F165667C5ULL,
+        0x9E3779B1ULL,
+    };
+
+    /* All full stripes except the last, which is handled below even if it is partial */
+    size_t stripes = (len - 1) / HASH_WIDE_STRIPE_LEN;
+    size_t blocks = stripes / HASH_WIDE_STRIPES_PER_BLOCK;
+    const size_t block_len = HASH_WIDE_STRIPE_LEN * HASH_WIDE_STRIPES_PER_BLOCK;
+
+    for (size_t b = 0; b < blocks; b++) {
+        s_hash_wide_accumulate(acc, p + b * block_len, HASH_WIDE_STRIPES_PER_BLOCK, secret);
+        s_hash_wide_scramble(acc, secret + HASH_WIDE_SECRET_LEN - HASH_WIDE_LANES);
+    }
+    s_hash_wide_accumulate(acc, p + blocks * block_len, stripes - blocks * HASH_WIDE_STRIPES_PER_BLOCK, secret);
+
+    /* The last 64 bytes, which may overlap the previous stripe */
+    s_hash_wide_accumulate(acc, p + len - HASH_WIDE_STRIPE_LEN, 1, secret + 7);
+
+    uint64_t hash = (uint64_t)len * 0x9E3779B185EBCA87ULL;
+    for (size_t i = 0; i < HASH_WIDE_LANES; i += 2) {
+        hash += s_hash_wide_mix(acc[i] ^ secret[9 + i], acc[i + 1] ^ secret[10 + i]);
+    }
+
+    hash ^= hash >> 37;
+    hash *= 0x165667919E3779F9ULL;
+    hash ^= hash >> 32;
+
+    return hash;
+}
+
+uint64_t aws_hash_wide_bytes(const void *data, size_t len, uint64_t seed) {
+    assert(data || !len);
+
+    if (len > HASH_WIDE_LONG_THRESHOLD) {
+        return s_hash_wide_long(data, len, seed);
+    }
+    return s_hash_wide_short(data, len, seed);
+}
+
+uint64_t aws_hash_wide_c_string(const void *item) {
+    return aws_hash_wide_c_string_seeded(item, 0);
+}
+
+uint64_t aws_hash_wide_string(const void *item) {
+    return aws_hash_wide_string_seeded(item, 0);
+}
+
+uint64_t aws_hash_wide_byte_cursor_ptr(const void *item) {
+    return aws_hash_wide_byte_cursor_ptr_seeded(item, 0);
+}
+
+uint64_t aws_hash_wide_c_string_seeded(const void *item, uint64_t seed) {
+    const char *str = item;
+
+    return aws_hash_wide_bytes(str, strlen(str), seed);
+}
+
+uint64_t aws_hash_wide_string_seeded(const void *item, uint64_t seed) {
+    const struct aws_string *str = item;
+
+    return aws_hash_wide_bytes(aws_string_bytes(str), str->len, seed);
+}
+
+uint64_t aws_hash_wide_byte_cursor_ptr_seeded(const void *item, uint64_t seed) {
+    const struct aws_byte_cursor *cur = item;
+
+    return aws_hash_wide_bytes(cur->ptr, cur->len, seed);
+}
+
 bool aws_hash_callback_c_str_eq(const void *a, const void *b) {
     return !strcmp(a, b);
 }
@@ -0,0 +1,423 @@
+/*
+ * Copyright 2010-2018 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *  http://aws.amazon.com/apache2.0
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#include <aws/common/inline_hash_table.h>
+
+#include <aws/common/hash_table.h>
+#include <aws/common/math.h>
+
+#include <string.h>
+
+#define MIN_TABLE_SIZE 8
+
+/* Probe distances are stored plus one in a byte, so this is the longest distance (plus one) we can represent */
+#define MAX_DISTANCE UINT8_MAX
+
+/* Largest power of two (up to 8) dividing n; values and keys of size n are aligned to this */
+static size_t s_alignment_for(size_t n) {
+    size_t alignment = 1;
+    while (alignment < 8 && n && !(n & alignment)) {
+        alignment <<= 1;
+    }
+    return alignment;
+}
+
+static size_t s_round_up(size_t n, size_t alignment) {
+    return (n + alignment - 1) & ~(alignment - 1);
+}
+
+static inline uint8_t *s_slot(const struct aws_inline_hash_table *table, size_t index) {
+    return table->slots + index * table->slot_size;
+}
+
+/* The murmur3 finalizer: a bijection on 64-bit values, so distinct integer keys never share a hash code */
+static inline uint64_t s_mix64(uint64_t h) {
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ULL;
+    h ^= h >> 33;
+    return h;
+}
+
+static inline uint64_t s_hash_key(const struct aws_inline_hash_table *table, const void *key) {
+    switch (table->key_size) {
+        case 1:
+            return s_mix64(*(const uint8_t *)key);
+        case 2: {
+            uint16_t k;
+            memcpy(&k, key, sizeof(k));
+            return s_mix64(k);
+        }
+        case 4: {
+            uint32_t k;
+            memcpy(&k, key, sizeof(k));
+            return s_mix64(k);
+        }
+        case 8: {
+            uint64_t k;
+            memcpy(&k, key, sizeof(k));
+            return s_mix64(k);
+        }
+        default:
+            return aws_hash_wide_bytes(key, table->key_size, 0);
+    }
+}
+
+static inline bool s_key_eq(const struct aws_inline_hash_table *table, const void *a, const void *b) {
+    switch (table->key_size) {
+        case 4: {
+            uint32_t ka, kb;
+            memcpy(&ka, a, sizeof(ka));
+            memcpy(&kb, b, sizeof(kb));
+            return ka == kb;
+        }
+        case 8: {
+            uint64_t ka, kb;
+            memcpy(&ka, a, sizeof(ka));
+            memcpy(&kb, b, sizeof(kb));
+            return ka == kb;
+        }
+        default:
+            return !memcmp(a, b, table->key_size);
+    }
+}
+
+/* Allocates slot and distance arrays for size slots, without touching the old arrays */
+static int s_alloc_slots(struct aws_inline_hash_table *table, size_t size) {
+    size_t slots_bytes = aws_mul_size_saturating(size + 2, table->slot_size);
+    size_t total_bytes = slots_bytes + size;
+    if (slots_bytes == SIZE_MAX || total_bytes < slots_bytes) {
+        return aws_raise_error(AWS_ERROR_OOM);
+    }
+
+    uint8_t *mem = aws_mem_acquire(table->alloc, total_bytes);
+    if (!mem) {
+        return AWS_OP_ERR;
+    }
+
+    table->slots = mem;
+    table->distances = mem + slots_bytes;
+    memset(table->distances, 0, size);
+    table->size = size;
+    table->max_load = size - size / 8;
+
+    return AWS_OP_SUCCESS;
+}
+
+/*
+ * Robin hood insertion of the entry held in the first scratch slot, starting from its home slot. On success, the
+ * index where that entry ended up is stored in *p_placed.
+ *
+ * Returns false without modifying the table if some entry would end up further from home than a distance byte can
+ * record; the caller must grow the table and try again.
+ */
+static bool s_emplace(struct aws_inline_hash_table *table, size_t home, size_t *p_placed) {
+    size_t mask = table->size - 1;
+
+    /* Dry run: only the distance of the entry being carried along matters */
+    size_t distance = 1;
+    for (size_t index = home; table->distances[index]; index = (index + 1) & mask) {
+        if (table->distances[index] < distance) {
+            distance = table->distances[index];
+        }
+        if (++distance > MAX_DISTANCE) {
+            return false;
+        }
+    }
+
+    uint8_t *carry = s_slot(table, table->size);
+    uint8_t *swap = s_slot(table, table->size + 1);
+    size_t placed = SIZE_MAX;
+    distance = 1;
+
+    for (size_t index = home;; index = (index + 1) & mask, distance++) {
+        uint8_t *slot = s_slot(table, index);
+        size_t existing = table->distances[index];
+
+        if (!existing) {
+            memcpy(slot, carry, table->slot_size);
+            table->distances[index] = (uint8_t)distance;
+            *p_placed = placed == SIZE_MAX ? index : placed;
+            return true;
+        }
+
+        if (existing < distance) {
+            memcpy(swap, slot, table->slot_size);
+            memcpy(slot, carry, table->slot_size);
+            memcpy(carry, swap, table->slot_size);
+            table->distances[index] = (uint8_t)distance;
+            distance = existing;
+            if (placed == SIZE_MAX) {
+                placed = index;
+            }
+        }
+    }
+}
+
+/* Moves every entry into new arrays of at least new_size slots */
+static int s_rehash(struct aws_inline_hash_table *table, size_t new_size) {
+    struct aws_inline_hash_table old = *table;
+
+    for (;;) {
+        if (new_size < old.size || s_alloc_slots(table, new_size)) {
+            *table = old;
+            return aws_raise_error(AWS_ERROR_OOM);
+        }
+
+        bool overflow = false;
+        for (size_t i = 0; i < old.size && !overflow; i++) {
+            if (!old.distances[i]) {
+                continue;
+            }
+
+            const uint8_t *src = s_slot(&old, i);
+            memcpy(s_slot(table, table->size), src, table->slot_size);
+
+            size_t placed;
+            overflow = !s_emplace(table, (size_t)s_hash_key(table, src) & (table->size - 1), &placed);
+        }
+
+        if (!overflow) {
+            break;
+        }
+
+        /* Pathological clustering; spread the entries out further */
+        aws_mem_release(table->alloc, table->slots);
+        new_size <<= 1;
+    }
+
+    aws_mem_release(old.alloc, old.slots);
+    return AWS_OP_SUCCESS;
+}
+
+static size_t s_find_index(const struct aws_inline_hash_table *table, uint64_t hash_code, const void *key) {
+    size_t mask = table->size - 1;
+    size_t index = (size_t)hash_code & mask;
+
+    /* Distances never exceed MAX_DISTANCE, so this terminates */
+    for (size_t distance = 1;; distance++) {
+        size_t existing = table->distances[index];
+
+        /* If key were present, it would have displaced this entry */
+        if (existing < distance) {
+            return SIZE_MAX;
+        }
+
+        if (existing == distance && s_key_eq(table, s_slot(table, index), key)) {
+            return index;
+        }
+
+        index = (index + 1) & mask;
+    }
+}
+
+int aws_inline_hash_table_init(
+    struct aws_inline_hash_table *table,
+    struct aws_allocator *alloc,
+    size_t key_size,
+    size_t value_size,
+    size_t initial_size) {
+
+    AWS_ZERO_STRUCT(*table);
+
+    if (!key_size) {
+        return aws_raise_error(AWS_ERROR_INVALID_ARGUMENT);
+    }
+
+    size_t key_alignment = s_alignment_for(key_size);
+    size_t value_alignment = s_alignment_for(value_size);
+
+    table->alloc = alloc;
+    table->key_size = key_size;
+    table->value_size = value_size;
+    table->value_offset = s_round_up(key_size, value_alignment);
+    table->slot_size = s_round_up(
+        table->value_offset + value_size, key_alignment > value_alignment ? key_alignment : value_alignment);
+
+    /* Leave room for initial_size entries at the maximum load of 7/8 */
+    size_t size = MIN_TABLE_SIZE;
+    while (size - size / 8 < initial_size) {
+        size <<= 1;
+        if (!size) {
+            return aws_raise_error(AWS_ERROR_OOM);
+        }
+    }
+
+    if (s_alloc_slots(table, size)) {
+        AWS_ZERO_STRUCT(*table);
+        return AWS_OP_ERR;
+    }
+
+    return AWS_OP_SUCCESS;
+}
+
+void aws_inline_hash_table_clean_up(struct aws_inline_hash_table *table) {
+    if (table->slots) {
+        aws_mem_release(table->alloc, table->slots);
+    }
+
+    AWS_ZERO_STRUCT(*table);
+}
+
+void *aws_inline_hash_table_find(const struct aws_inline_hash_table *table, const void *key) {
+    size_t index = s_find_index(table, s_hash_key(table, key), key);
+    if (index == SIZE_MAX) {
+        return NULL;
+    }
+
+    return s_slot(table, index) + table->value_offset;
+}
+
+/* Copies key into the first scratch slot, with a zeroed value */
+static void s_load_scratch(struct aws_inline_hash_table *table, const void *key) {
+    uint8_t *carry = s_slot(table, table->size);
+    memcpy(carry, key, table->key_size);
+    memset(carry + table->key_size, 0, table->slot_size - table->key_size);
+}
+
+int aws_inline_hash_table_create(
+    struct aws_inline_hash_table *table,
+    const void *key,
+    void **p_value,
+    int *was_created) {
+
+    uint64_t hash_code = s_hash_key(table, key);
+    size_t index = s_find_index(table, hash_code, key);
+    int created = 0;
+
+    if (index == SIZE_MAX) {
+        if (table->entry_count + 1 > table->max_load && s_rehash(table, table->size << 1)) {
+            return AWS_OP_ERR;
+        }
+
+        s_load_scratch(table, key);
+        while (!s_emplace(table, (size_t)hash_code & (table->size - 1), &index)) {
+            if (s_rehash(table, table->size << 1)) {
+                return AWS_OP_ERR;
+            }
+            /* Rehashing moves entries through the scratch slots */
+            s_load_scratch(table, key);
+        }
+
+        table->entry_count++;
+        created = 1;
+    }
+
+    if (was_created) {
+        *was_created = created;
+    }
+
+    *p_value = s_slot(table, index) + table->value_offset;
+    return AWS_OP_SUCCESS;
+}
+
+int aws_inline_hash_table_put(
+    struct aws_inline_hash_table *table,
+    const void *key,
+    const void *value,
+    int *was_created) {
+
+    void *dest;
+    if (aws_inline_hash_table_create(table, key, &dest, was_created)) {
+        return AWS_OP_ERR;
+    }
+
+    if (table->value_size) {
+        memcpy(dest, value, table->value_size);
+    }
+
+    return AWS_OP_SUCCESS;
+}
+
+int aws_inline_hash_table_remove(
+    struct aws_inline_hash_table *table,
+    const void *key,
+    void *removed_value,
+    int *was_present) {
+
+    size_t index = s_find_index(table, s_hash_key(table, key), key);
+
+    if (was_present) {
+        *was_present = index != SIZE_MAX;
+    }
+
+    if (index == SIZE_MAX) {
+        return AWS_OP_SUCCESS;
+    }
+
+    if (removed_value && table->value_size) {
+        memcpy(removed_value, s_slot(table, index) + table->value_offset, table->value_size);
+    }
+
+    /* Backward shift: pull each following displaced entry one slot closer to home */
+    size_t mask = table->size - 1;
+    size_t next = (index + 1) & mask;
+    while (table->distances[next] > 1) {
+        memcpy(s_slot(table, index), s_slot(table, next), table->slot_size);
+        table->distances[index] = (uint8_t)(table->distances[next] - 1);
+        index = next;
+        next = (next + 1) & mask;
+    }
+    table->distances[index] = 0;
+    table->entry_count--;
+
+    return AWS_OP_SUCCESS;
+}
+
+void aws_inline_hash_table_clear(struct aws_inline_hash_table *table) {
+    memset(table->distances, 0, table->size);
+    table->entry_count = 0;
+}
+
+size_t aws_inline_hash_table_get_entry_count(const struct aws_inline_hash_table *table) {
+    return table->entry_count;
+}
+
+/* Moves the iterator to the first occupied slot at or after its current position */
+static void s_iter_settle(struct aws_inline_hash_iter *iter) {
+    const struct aws_inline_hash_table *table = iter->table;
+
+    while (iter->slot < table->size && !table->distances[iter->slot]) {
+        iter->slot++;
+    }
+
+    if (iter->slot < table->size) {
+        uint8_t *slot = s_slot(table, iter->slot);
+        iter->key = slot;
+        iter->value = slot + table->value_offset;
+    } else {
+        iter->key = NULL;
+        iter->value = NULL;
+    }
+}
+
+struct aws_inline_hash_iter aws_inline_hash_iter_begin(const struct aws_inline_hash_table *table) {
+    struct aws_inline_hash_iter iter;
+    iter.table = table;
+    iter.slot = 0;
+    s_iter_settle(&iter);
+
+    return iter;
+}
+
+bool aws_inline_hash_iter_done(const struct aws_inline_hash_iter *iter) {
+    return iter->slot >= iter->table->size;
+}
+
+void aws_inline_hash_iter_next(struct aws_inline_hash_iter *iter) {
+    iter->slot++;
+    s_iter_settle(iter);
+}
@@ -14,6 +14,11 @@
  */
 #include <aws/common/lru_cache.h>
 
+#include <aws/common/clock.h>
+#include <aws/common/math.h>
+#include <aws/common/priority_queue.h>
+#include <aws/common/task_scheduler.h>
+
 #include <assert.h>
 
 struct cache_node {
@@ -21,17 +26,368 @@ struct cache_node {
     struct aws_lru_cache *cache;
     const void *key;
     void *value;
+    size_t weight;
+    /* Set by aws_lru_cache_put_with_ttl; the node is then in the expiry queue until it's destroyed */
+    bool expires;
+    uint64_t expires_at;
+    struct aws_priority_queue_node expiry_node;
+    /* SIEVE only: set on a hit, cleared as the eviction hand passes */
+    bool visited;
+    /* TINYLFU only: which list the node is on */
+    uint8_t segment;
+};
+
+/* Nodes are allocated in chunks, each headed by one of these; the cache's node_pool is the newest */
+struct node_chunk {
+    struct node_chunk *next;
+};
+
+/* A weight-bounded cache's first chunk of nodes; each later chunk doubles the pool */
+#define NODE_CHUNK_MIN 16
+
+enum tinylfu_segment {
+    TINYLFU_WINDOW,
+    TINYLFU_PROBATION,
+    TINYLFU_PROTECTED,
+};
+
+#define TINYLFU_SKETCH_DEPTH 4
+/* Counters are capped as if they were 4 bits wide, which is all a sketch halved this often needs */
+#define TINYLFU_COUNTER_MAX 15
+/* The sketch is halved after this many increments per element of capacity */
+#define TINYLFU_SAMPLES_PER_ELEMENT 10
+#define TINYLFU_COLUMNS_PER_ELEMENT 4
+
+struct aws_lru_cache_tinylfu {
+    aws_hash_fn *hash_fn;
+    struct aws_linked_list probation;
+    struct aws_linked_list protected_list;
+    /* Elements per segment; the window's list is the cache's list */
+    size_t counts[3];
+    size_t window_max;
+    size_t protected_max;
+
+    /* Count-min sketch: TINYLFU_SKETCH_DEPTH rows of sketch_mask + 1 counters */
+    uint8_t *sketch;
+    size_t sketch_mask;
+    size_t samples;
+    size_t sample_limit;
 };
 
+static uint64_t s_tinylfu_mix(uint64_t hash_code) {
+    hash_code ^= hash_code >> 33;
+    hash_code *= 0xff51afd7ed558ccdULL;
+    hash_code ^= hash_code >> 33;
+    hash_code *= 0xc4ceb9fe1a85ec53ULL;
+    hash_code ^= hash_code >> 33;
+    return hash_code;
+}
+
+/* Column of the key's counter in the given row, by double hashing */
+static size_t s_tinylfu_column(const struct aws_lru_cache_tinylfu *tinylfu, uint64_t mixed, size_t row) {
+    uint64_t step = (mixed >> 32) | 1;
+    return (size_t)(mixed + row * step) & tinylfu->sketch_mask;
+}
+
+static size_t s_tinylfu_frequency(const struct aws_lru_cache_tinylfu *tinylfu, const void *key) {
+    uint64_t mixed = s_tinylfu_mix(tinylfu->hash_fn(key));
+    size_t width = tinylfu->sketch_mask + 1;
+
+    size_t frequency = TINYLFU_COUNTER_MAX;
+    for (size_t row = 0; row < TINYLFU_SKETCH_DEPTH; row++) {
+        size_t counter = tinylfu->sketch[row * width + s_tinylfu_column(tinylfu, mixed, row)];
+        if (counter < frequency) {
+            frequency = counter;
+        }
+    }
+    return frequency;
+}
+
+static void s_tinylfu_record_access(struct aws_lru_cache_tinylfu *tinylfu, const void *key) {
+    uint64_t mixed = s_tinylfu_mix(tinylfu->hash_fn(key));
+    size_t width = tinylfu->sketch_mask + 1;
+
+    for (size_t row = 0; row < TINYLFU_SKETCH_DEPTH; row++) {
+        uint8_t *counter = &tinylfu->sketch[row * width + s_tinylfu_column(tinylfu, mixed, row)];
+        if (*counter < TINYLFU_COUNTER_MAX) {
+            ++*counter;
+        }
+    }
+
+    /* Age: halve every counter, so that keys which were popular once don't stay favored forever */
+    if (++tinylfu->samples >= tinylfu->sample_limit) {
+        for (size_t i = 0; i < TINYLFU_SKETCH_DEPTH * width; i++) {
+            tinylfu->sketch[i] >>= 1;
+        }
+        tinylfu->samples /= 2;
+    }
+}
+
+static struct aws_linked_list *s_tinylfu_list(struct aws_lru_cache *cache, uint8_t segment) {
+    switch (segment) {
+        case TINYLFU_PROBATION:
+            return &cache->tinylfu->probation;
+        case TINYLFU_PROTECTED:
+            return &cache->tinylfu->protected_list;
+        default:
+            return &cache->list;
+    }
+}
+
+/* Moves a node to the front of a segment's list */
+static void s_tinylfu_move(struct aws_lru_cache *cache, struct cache_node *cache_node, uint8_t segment) {
+    struct aws_lru_cache_tinylfu *tinylfu = cache->tinylfu;
+
+    aws_linked_list_remove(&cache_node->node);
+    tinylfu->counts[cache_node->segment]--;
+    aws_linked_list_push_front(s_tinylfu_list(cache, segment), &cache_node->node);
+    tinylfu->counts[segment]++;
+    cache_node->segment = segment;
+}
+
+static void s_tinylfu_on_hit(struct aws_lru_cache *cache, struct cache_node *cache_node) {
+    struct aws_lru_cache_tinylfu *tinylfu = cache->tinylfu;
+
+    if (cache_node->segment != TINYLFU_PROBATION) {
+        s_tinylfu_move(cache, cache_node, cache_node->segment);
+        return;
+    }
+
+    /* Promote, making room in the protected area by demoting its least recently used element */
+    s_tinylfu_move(cache, cache_node, TINYLFU_PROTECTED);
+    if (tinylfu->counts[TINYLFU_PROTECTED] > tinylfu->protected_max) {
+        struct aws_linked_list_node *demoted = aws_linked_list_back(&tinylfu->protected_list);
+        s_tinylfu_move(cache, AWS_CONTAINER_OF(demoted, struct cache_node, node), TINYLFU_PROBATION);
+    }
+}
+
+static bool s_over_capacity(const struct aws_lru_cache *cache) {
+    return aws_hash_table_get_entry_count(&cache->table) > cache->max_items || cache->weight > cache->max_weight;
+}
+
+/* The least recently used node of a list other than the two given, or NULL */
+static struct cache_node *s_tinylfu_lru_except(
+    struct aws_linked_list *list,
+    const struct cache_node *skip_a,
+    const struct cache_node *skip_b) {
+
+    for (struct aws_linked_list_node *node = list->tail.prev; node != &list->head; node = node->prev) {
+        struct cache_node *cache_node = AWS_CONTAINER_OF(node, struct cache_node, node);
+        if (cache_node != skip_a && cache_node != skip_b) {
+            return cache_node;
+        }
+    }
+    return NULL;
+}
+
+/*
+ * Called after an element is put. If the window is over its size, its least recently used element moves to
+ * probation as the candidate, and while the cache is over capacity, either the candidate or the main segment's victim
+ * is evicted, whichever has been accessed less often. Once the candidate has lost, or if there's none, victims are
+ * evicted unopposed; that only happens when a heavy element pushes the cache over its weight budget.
+ */
+static void s_tinylfu_after_insert(struct aws_lru_cache *cache, struct cache_node *inserted) {
+    struct aws_lru_cache_tinylfu *tinylfu = cache->tinylfu;
+
+    struct cache_node *candidate = NULL;
+    if (tinylfu->counts[TINYLFU_WINDOW] > tinylfu->window_max) {
+        candidate = AWS_CONTAINER_OF(aws_linked_list_back(&cache->list), struct cache_node, node);
+        s_tinylfu_move(cache, candidate, TINYLFU_PROBATION);
+    }
+
+    while (s_over_capacity(cache)) {
+        struct cache_node *victim = s_tinylfu_lru_except(&tinylfu->probation, candidate, inserted);
+        if (!victim) {
+            victim = s_tinylfu_lru_except(&tinylfu->protected_list, candidate, inserted);
+        }
+        if (!victim) {
+            victim = s_tinylfu_lru_except(&cache->list, candidate, inserted);
+        }
+
+        struct cache_node *evicted = victim;
+        if (candidate &&
+            (!victim || s_tinylfu_frequency(tinylfu, candidate->key) <= s_tinylfu_frequency(tinylfu, victim->key))) {
+            evicted = candidate;
+            candidate = NULL;
+        }
+        if (!evicted) {
+            /* only the inserted element is left, which put checked fits on its own */
+            break;
+        }
+
+        /*the callback will unlink and return the node to the pool */
+        aws_hash_table_remove(&cache->table, evicted->key, NULL, NULL);
+        cache->evictions++;
+    }
+}
+
+struct aws_lru_cache_expiry {
+    /* struct cache_node * for every element with a TTL, soonest expiry first */
+    struct aws_priority_queue queue;
+    struct aws_task reaper_task;
+    /* Where the reaper task is scheduled, or NULL if it isn't */
+    struct aws_task_scheduler *scheduler;
+    uint64_t interval;
+    size_t batch_size;
+};
+
+static int s_compare_expiry(const void *a, const void *b) {
+    uint64_t a_time = (*(struct cache_node **)a)->expires_at;
+    uint64_t b_time = (*(struct cache_node **)b)->expires_at;
+    return a_time > b_time; /* min-heap */
+}
+
+static int s_expiry_init(struct aws_lru_cache *cache) {
+    struct aws_lru_cache_expiry *expiry = aws_mem_acquire(cache->allocator, sizeof(struct aws_lru_cache_expiry));
+    if (!expiry) {
+        return AWS_OP_ERR;
+    }
+    AWS_ZERO_STRUCT(*expiry);
+
+    /* Sized so the queue only grows along with the pool: it can't hold more than every node in it */
+    if (aws_priority_queue_init_dynamic(
+            &expiry->queue, cache->allocator, cache->node_count, sizeof(struct cache_node *), s_compare_expiry)) {
+        aws_mem_release(cache->allocator, expiry);
+        return AWS_OP_ERR;
+    }
+
+    cache->expiry = expiry;
+    return AWS_OP_SUCCESS;
+}
+
+/* Moves the SIEVE hand one element towards the front of the list, or to NULL once it passes the front */
+static struct aws_linked_list_node *s_sieve_hand_advance(
+    struct aws_lru_cache *cache,
+    struct aws_linked_list_node *hand) {
+    return hand->prev == &cache->list.head ? NULL : hand->prev;
+}
+
 static void s_element_destroy(void *value) {
     struct cache_node *cache_node = value;
+    struct aws_lru_cache *cache = cache_node->cache;
+
+    if (cache->user_on_value_destroy) {
+        cache->user_on_value_destroy(cache_node->value);
+    }
 
-    if (cache_node->cache->user_on_value_destroy) {
-        cache_node->cache->user_on_value_destroy(cache_node->value);
+    if (cache->sieve_hand == &cache_node->node) {
+        cache->sieve_hand = s_sieve_hand_advance(cache, cache->sieve_hand);
+    }
+
+    if (cache->tinylfu) {
+        cache->tinylfu->counts[cache_node->segment]--;
+    }
+
+    cache->weight -= cache_node->weight;
+
+    if (cache_node->expires) {
+        struct cache_node *removed = NULL;
+        aws_priority_queue_remove(&cache->expiry->queue, &removed, &cache_node->expiry_node);
     }
 
     aws_linked_list_remove(&cache_node->node);
-    aws_mem_release(cache_node->cache->allocator, cache_node);
+    aws_linked_list_push_back(&cache_node->cache->free_nodes, &cache_node->node);
+}
+
+/*
+ * Sizes the sketch and the segments for capacity elements. A weight-bounded cache calls this again as its node pool
+ * grows; the new sketch starts empty, so the frequencies seen so far are forgotten.
+ */
+static int s_tinylfu_resize(struct aws_lru_cache *cache, size_t capacity) {
+    struct aws_lru_cache_tinylfu *tinylfu = cache->tinylfu;
+
+    /* Enough columns that a key seen once rarely collides with popular keys in every row */
+    size_t width = 16;
+    while (width < aws_mul_size_saturating(capacity, TINYLFU_COLUMNS_PER_ELEMENT)) {
+        if (width > SIZE_MAX / (2 * TINYLFU_SKETCH_DEPTH)) {
+            return aws_raise_error(AWS_ERROR_OOM);
+        }
+        width <<= 1;
+    }
+
+    if (!tinylfu->sketch || width != tinylfu->sketch_mask + 1) {
+        uint8_t *sketch = aws_mem_acquire(cache->allocator, TINYLFU_SKETCH_DEPTH * width);
+        if (!sketch) {
+            return AWS_OP_ERR;
+        }
+        memset(sketch, 0, TINYLFU_SKETCH_DEPTH * width);
+        if (tinylfu->sketch) {
+            aws_mem_release(cache->allocator, tinylfu->sketch);
+        }
+        tinylfu->sketch = sketch;
+        tinylfu->sketch_mask = width - 1;
+        tinylfu->samples = 0;
+    }
+
+    tinylfu->window_max = capacity / 100 ? capacity / 100 : 1;
+    tinylfu->protected_max = (capacity - tinylfu->window_max) / 5 * 4;
+    tinylfu->sample_limit = aws_mul_size_saturating(capacity, TINYLFU_SAMPLES_PER_ELEMENT);
+    return AWS_OP_SUCCESS;
+}
+
+static void s_tinylfu_clean_up(struct aws_lru_cache *cache) {
+    if (cache->tinylfu->sketch) {
+        aws_mem_release(cache->allocator, cache->tinylfu->sketch);
+    }
+    aws_mem_release(cache->allocator, cache->tinylfu);
+    cache->tinylfu = NULL;
+}
+
+static int s_tinylfu_init(struct aws_lru_cache *cache, aws_hash_fn *hash_fn) {
+    struct aws_lru_cache_tinylfu *tinylfu = aws_mem_acquire(cache->allocator, sizeof(struct aws_lru_cache_tinylfu));
+    if (!tinylfu) {
+        return AWS_OP_ERR;
+    }
+
+    AWS_ZERO_STRUCT(*tinylfu);
+    tinylfu->hash_fn = hash_fn;
+    aws_linked_list_init(&tinylfu->probation);
+    aws_linked_list_init(&tinylfu->protected_list);
+    cache->tinylfu = tinylfu;
+
+    size_t capacity = cache->node_count < cache->max_items ? cache->node_count : cache->max_items;
+    if (s_tinylfu_resize(cache, capacity)) {
+        s_tinylfu_clean_up(cache);
+        return AWS_OP_ERR;
+    }
+    return AWS_OP_SUCCESS;
+}
+
+/* Adds up to count nodes to the pool, as a new chunk, without going past max_items + 1 */
+static int s_node_pool_grow(struct aws_lru_cache *cache, size_t count) {
+    size_t limit = cache->max_items == SIZE_MAX ? SIZE_MAX : cache->max_items + 1;
+    if (count > limit - cache->node_count) {
+        count = limit - cache->node_count;
+    }
+
+    size_t size = aws_mul_size_saturating(count, sizeof(struct cache_node));
+    if (size > SIZE_MAX - sizeof(struct node_chunk)) {
+        return aws_raise_error(AWS_ERROR_OOM);
+    }
+    struct node_chunk *chunk = aws_mem_acquire(cache->allocator, sizeof(struct node_chunk) + size);
+    if (!chunk) {
+        return AWS_OP_ERR;
+    }
+    chunk->next = cache->node_pool;
+    cache->node_pool = chunk;
+
+    struct cache_node *nodes = (struct cache_node *)(chunk + 1);
+    for (size_t i = 0; i < count; i++) {
+        aws_linked_list_push_back(&cache->free_nodes, &nodes[i].node);
+    }
+    cache->node_count += count;
+    return AWS_OP_SUCCESS;
+}
+
+static void s_node_pool_clean_up(struct aws_lru_cache *cache) {
+    struct node_chunk *chunk = cache->node_pool;
+    while (chunk) {
+        struct node_chunk *next = chunk->next;
+        aws_mem_release(cache->allocator, chunk);
+        chunk = next;
+    }
+    cache->node_pool = NULL;
+    cache->node_count = 0;
 }
 
 int aws_lru_cache_init(
@@ -42,22 +398,102 @@ int aws_lru_cache_init(
     aws_hash_callback_destroy_fn *destroy_key_fn,
     aws_hash_callback_destroy_fn *destroy_value_fn,
     size_t max_items) {
+
+    return aws_lru_cache_init_with_options(
+        cache, allocator, hash_fn, equals_fn, destroy_key_fn, destroy_value_fn, max_items, NULL);
+}
+
+int aws_lru_cache_init_with_options(
+    struct aws_lru_cache *cache,
+    struct aws_allocator *allocator,
+    aws_hash_fn *hash_fn,
+    aws_hash_callback_eq_fn *equals_fn,
+    aws_hash_callback_destroy_fn *destroy_key_fn,
+    aws_hash_callback_destroy_fn *destroy_value_fn,
+    size_t max_items,
+    const struct aws_lru_cache_options *options) {
     assert(allocator);
     assert(max_items);
 
+    struct aws_lru_cache_options default_options;
+    if (!options) {
+        AWS_ZERO_STRUCT(default_options);
+        options = &default_options;
+    }
+
+    if (options->policy != AWS_LRU_CACHE_POLICY_LRU && options->policy != AWS_LRU_CACHE_POLICY_SIEVE &&
+        options->policy != AWS_LRU_CACHE_POLICY_TINYLFU) {
+        return aws_raise_error(AWS_ERROR_INVALID_ARGUMENT);
+    }
+
     cache->allocator = allocator;
     cache->max_items = max_items;
     cache->user_on_value_destroy = destroy_value_fn;
+    cache->policy = options->policy;
+    cache->sieve_hand = NULL;
+    cache->tinylfu = NULL;
+    cache->clock_fn = options->clock_fn ? options->clock_fn : aws_high_res_clock_get_ticks;
+    cache->expiry = NULL;
+    /* Capping the budget at half the address space keeps the running total from overflowing */
+    cache->max_weight = options->max_weight && options->max_weight <= SIZE_MAX / 2 ? options->max_weight : SIZE_MAX / 2;
+    cache->weight = 0;
+    cache->weigh_fn = options->weigh_fn;
+    cache->evictions = 0;
 
     aws_linked_list_init(&cache->list);
-    return aws_hash_table_init(
-        &cache->table, allocator, max_items, hash_fn, equals_fn, destroy_key_fn, s_element_destroy);
+    aws_linked_list_init(&cache->free_nodes);
+    cache->node_pool = NULL;
+    cache->node_count = 0;
+
+    /*
+     * A cache bounded by count gets every node it will need now. max_items may be far more than a weight budget ever
+     * holds, so a weight-bounded cache starts small and grows the pool as it fills.
+     */
+    size_t initial_nodes = 0;
+    if (options->max_weight) {
+        initial_nodes = max_items < NODE_CHUNK_MIN ? max_items + 1 : NODE_CHUNK_MIN;
+    } else if (max_items == SIZE_MAX) {
+        return aws_raise_error(AWS_ERROR_OOM);
+    } else {
+        initial_nodes = max_items + 1;
+    }
+    if (s_node_pool_grow(cache, initial_nodes)) {
+        return AWS_OP_ERR;
+    }
+
+    if (cache->policy == AWS_LRU_CACHE_POLICY_TINYLFU && s_tinylfu_init(cache, hash_fn)) {
+        goto error;
+    }
+
+    if (aws_hash_table_init(
+            &cache->table, allocator, initial_nodes - 1, hash_fn, equals_fn, destroy_key_fn, s_element_destroy)) {
+        goto error;
+    }
+
+    return AWS_OP_SUCCESS;
+
+error:
+    if (cache->tinylfu) {
+        s_tinylfu_clean_up(cache);
+    }
+    s_node_pool_clean_up(cache);
+    return AWS_OP_ERR;
 }
 
 void aws_lru_cache_clean_up(struct aws_lru_cache *cache) {
-    /* clearing the table will remove all elements. That will also deallocate
-     * any cache entries we currently have. */
+    aws_lru_cache_stop_expiry_reaper(cache);
+
+    /* clearing the table will remove all elements. That will also return
+     * any cache entries we currently have to the pool. */
     aws_hash_table_clean_up(&cache->table);
+    if (cache->expiry) {
+        aws_priority_queue_clean_up(&cache->expiry->queue);
+        aws_mem_release(cache->allocator, cache->expiry);
+    }
+    if (cache->tinylfu) {
+        s_tinylfu_clean_up(cache);
+    }
+    s_node_pool_clean_up(cache);
     AWS_ZERO_STRUCT(*cache);
 }
 
@@ -66,14 +502,44 @@ int aws_lru_cache_find(struct aws_lru_cache *cache, const void *key, void **p_va
     struct aws_hash_element *cache_element = NULL;
     int err_val = aws_hash_table_find(&cache->table, key, &cache_element);
 
+    if (!err_val && cache->tinylfu) {
+        s_tinylfu_record_access(cache->tinylfu, key);
+    }
+
     if (err_val || !cache_element) {
         *p_value = NULL;
         return err_val;
     }
 
     struct cache_node *cache_node = cache_element->value;
+    if (cache_node->expires) {
+        uint64_t now = 0;
+        if (cache->clock_fn(&now)) {
+            *p_value = NULL;
+            return AWS_OP_ERR;
+        }
+        if (now >= cache_node->expires_at) {
+            *p_value = NULL;
+            /* the callback will unlink the node and take it off the expiry queue */
+            return aws_hash_table_remove(&cache->table, cache_node->key, NULL, NULL);
+        }
+    }
+
     *p_value = cache_node->value;
 
+    if (cache->policy == AWS_LRU_CACHE_POLICY_SIEVE) {
+        /* only write when the bit changes, so repeated hits leave the cache line clean */
+        if (!cache_node->visited) {
+            cache_node->visited = true;
+        }
+        return AWS_OP_SUCCESS;
+    }
+
+    if (cache->tinylfu) {
+        s_tinylfu_on_hit(cache, cache_node);
+        return AWS_OP_SUCCESS;
+    }
+
     /* on access, remove from current place in list and move it to the head. */
     aws_linked_list_remove(&cache_node->node);
     aws_linked_list_push_front(&cache->list, &cache_node->node);
@@ -81,12 +547,65 @@ int aws_lru_cache_find(struct aws_lru_cache *cache, const void *key, void **p_va
     return AWS_OP_SUCCESS;
 }
 
-int aws_lru_cache_put(struct aws_lru_cache *cache, const void *key, void *p_value) {
+/*
+ * Sweeps the SIEVE hand from where it last stopped towards the front of the list (wrapping around to the back),
+ * clearing visited bits until it reaches an unvisited element, which is returned. The element just inserted is
+ * skipped, so that it gets a chance to be visited.
+ */
+static struct cache_node *s_sieve_find_victim(struct aws_lru_cache *cache, struct cache_node *inserted) {
+    struct aws_linked_list_node *hand = cache->sieve_hand;
+
+    for (;;) {
+        if (!hand) {
+            hand = aws_linked_list_back(&cache->list);
+        }
+
+        struct cache_node *candidate = AWS_CONTAINER_OF(hand, struct cache_node, node);
+        if (candidate != inserted) {
+            if (!candidate->visited) {
+                /* removing the victim moves the hand past it */
+                cache->sieve_hand = hand;
+                return candidate;
+            }
+            candidate->visited = false;
+        }
+
+        hand = s_sieve_hand_advance(cache, hand);
+    }
+}
 
-    struct cache_node *cache_node = aws_mem_acquire(cache->allocator, sizeof(struct cache_node));
+static int s_put(
+    struct aws_lru_cache *cache,
+    const void *key,
+    void *p_value,
+    size_t weight,
+    bool expires,
+    uint64_t expires_at) {
+
+    if (weight > cache->max_weight) {
+        return aws_raise_error(AWS_ERROR_INVALID_ARGUMENT);
+    }
 
-    if (!cache_node) {
-        return AWS_OP_ERR;
+    /* A full pool always has a node spare: there's one more than max_items, and an element over the limit is evicted
+     * before put returns. Until then, a weight-bounded cache doubles the pool whenever it runs out. */
+    if (aws_linked_list_empty(&cache->free_nodes)) {
+        size_t capacity = cache->node_count * 2 < cache->max_items ? cache->node_count * 2 : cache->max_items;
+        if ((cache->tinylfu && s_tinylfu_resize(cache, capacity)) || s_node_pool_grow(cache, cache->node_count)) {
+            return AWS_OP_ERR;
+        }
+    }
+    struct cache_node *cache_node =
+        AWS_CONTAINER_OF(aws_linked_list_pop_front(&cache->free_nodes), struct cache_node, node);
+
+    /* Queue the node for expiry first, since that can fail, and after the table is changed there's no going back */
+    cache_node->expires = expires;
+    cache_node->expires_at = expires_at;
+    if (expires) {
+        if ((!cache->expiry && s_expiry_init(cache)) ||
+            aws_priority_queue_push_ref(&cache->expiry->queue, &cache_node, &cache_node->expiry_node)) {
+            aws_linked_list_push_front(&cache->free_nodes, &cache_node->node);
+            return AWS_OP_ERR;
+        }
     }
 
     struct aws_hash_element *element = NULL;
@@ -94,36 +613,169 @@ int aws_lru_cache_put(struct aws_lru_cache *cache, const void *key, void *p_valu
     int err_val = aws_hash_table_create(&cache->table, key, &element, &was_added);
 
     if (err_val) {
-        aws_mem_release(cache->allocator, cache_node);
+        if (expires) {
+            struct cache_node *removed = NULL;
+            aws_priority_queue_remove(&cache->expiry->queue, &removed, &cache_node->expiry_node);
+        }
+        aws_linked_list_push_front(&cache->free_nodes, &cache_node->node);
         return err_val;
     }
 
+    /* a replacement keeps its predecessor's segment */
+    uint8_t segment = TINYLFU_WINDOW;
     if (element->value) {
+        segment = ((struct cache_node *)element->value)->segment;
         s_element_destroy(element->value);
     }
 
     cache_node->value = p_value;
     cache_node->key = key;
     cache_node->cache = cache;
+    cache_node->visited = false;
+    cache_node->segment = segment;
+    cache_node->weight = weight;
+    cache->weight += weight;
     element->value = cache_node;
 
+    if (cache->tinylfu) {
+        aws_linked_list_push_front(s_tinylfu_list(cache, segment), &cache_node->node);
+        cache->tinylfu->counts[segment]++;
+        if (was_added) {
+            s_tinylfu_record_access(cache->tinylfu, key);
+        }
+        s_tinylfu_after_insert(cache, cache_node);
+        return AWS_OP_SUCCESS;
+    }
+
     aws_linked_list_push_front(&cache->list, &cache_node->node);
 
-    /* we only want to manage the space if we actually added a new element. */
-    if (was_added && aws_hash_table_get_entry_count(&cache->table) > cache->max_items) {
+    /* A new element can put the cache over either limit, and a heavier replacement over the weight budget. Since
+     * put checked the element fits on its own, it's never the one evicted. */
+    while (s_over_capacity(cache)) {
 
         /* we're over the cache size limit. Remove whatever is in the back of
-         * the list. */
-        struct aws_linked_list_node *node_to_remove = aws_linked_list_back(&cache->list);
-        assert(node_to_remove);
-        struct cache_node *entry_to_remove = AWS_CONTAINER_OF(node_to_remove, struct cache_node, node);
+         * the list, or wherever the SIEVE hand stops. */
+        struct cache_node *entry_to_remove = NULL;
+        if (cache->policy == AWS_LRU_CACHE_POLICY_SIEVE) {
+            entry_to_remove = s_sieve_find_victim(cache, cache_node);
+        } else {
+            struct aws_linked_list_node *node_to_remove = aws_linked_list_back(&cache->list);
+            assert(node_to_remove);
+            entry_to_remove = AWS_CONTAINER_OF(node_to_remove, struct cache_node, node);
+        }
         /*the callback will unlink and deallocate the node */
         aws_hash_table_remove(&cache->table, entry_to_remove->key, NULL, NULL);
+        cache->evictions++;
     }
 
     return AWS_OP_SUCCESS;
 }
 
+static size_t s_weigh(const struct aws_lru_cache *cache, const void *key, const void *value) {
+    return cache->weigh_fn ? cache->weigh_fn(key, value) : 1;
+}
+
+int aws_lru_cache_put(struct aws_lru_cache *cache, const void *key, void *p_value) {
+    return s_put(cache, key, p_value, s_weigh(cache, key, p_value), false, 0);
+}
+
+int aws_lru_cache_put_weighted(struct aws_lru_cache *cache, const void *key, void *p_value, size_t weight) {
+    return s_put(cache, key, p_value, weight, false, 0);
+}
+
+int aws_lru_cache_put_with_ttl(struct aws_lru_cache *cache, const void *key, void *p_value, uint64_t ttl) {
+    uint64_t now = 0;
+    if (cache->clock_fn(&now)) {
+        return AWS_OP_ERR;
+    }
+
+    uint64_t expires_at = ttl > UINT64_MAX - now ? UINT64_MAX : now + ttl;
+    return s_put(cache, key, p_value, s_weigh(cache, key, p_value), true, expires_at);
+}
+
+size_t aws_lru_cache_remove_expired(struct aws_lru_cache *cache, size_t max_count) {
+    if (!cache->expiry) {
+        return 0;
+    }
+
+    uint64_t now = 0;
+    if (cache->clock_fn(&now)) {
+        return 0;
+    }
+
+    size_t removed = 0;
+    while (removed < max_count && aws_priority_queue_size(&cache->expiry->queue)) {
+        struct cache_node **soonest = NULL;
+        aws_priority_queue_top(&cache->expiry->queue, (void **)&soonest);
+        if ((*soonest)->expires_at > now) {
+            break;
+        }
+
+        /* the callback will unlink the node and take it off the expiry queue */
+        aws_hash_table_remove(&cache->table, (*soonest)->key, NULL, NULL);
+        removed++;
+    }
+
+    return removed;
+}
+
+static void s_reaper_task(struct aws_task *task, void *arg, enum aws_task_status status) {
+    struct aws_lru_cache *cache = arg;
+    struct aws_lru_cache_expiry *expiry = cache->expiry;
+
+    if (status == AWS_TASK_STATUS_CANCELED) {
+        expiry->scheduler = NULL;
+        return;
+    }
+
+    /* A full batch means there may be more expired elements: come back for them after whatever else is queued */
+    if (aws_lru_cache_remove_expired(cache, expiry->batch_size) == expiry->batch_size) {
+        aws_task_scheduler_schedule_now(expiry->scheduler, task);
+        return;
+    }
+
+    uint64_t now = 0;
+    if (cache->clock_fn(&now)) {
+        now = task->timestamp;
+    }
+    uint64_t next_run = expiry->interval > UINT64_MAX - now ? UINT64_MAX : now + expiry->interval;
+    aws_task_scheduler_schedule_future(expiry->scheduler, task, next_run);
+}
+
+int aws_lru_cache_start_expiry_reaper(
+    struct aws_lru_cache *cache,
+    struct aws_task_scheduler *scheduler,
+    uint64_t interval,
+    size_t batch_size) {
+    assert(scheduler);
+
+    if (!batch_size || (cache->expiry && cache->expiry->scheduler)) {
+        return aws_raise_error(AWS_ERROR_INVALID_ARGUMENT);
+    }
+
+    uint64_t now = 0;
+    if (cache->clock_fn(&now) || (!cache->expiry && s_expiry_init(cache))) {
+        return AWS_OP_ERR;
+    }
+
+    struct aws_lru_cache_expiry *expiry = cache->expiry;
+    expiry->scheduler = scheduler;
+    expiry->interval = interval;
+    expiry->batch_size = batch_size;
+    aws_task_init(&expiry->reaper_task, s_reaper_task, cache);
+
+    uint64_t first_run = interval > UINT64_MAX - now ? UINT64_MAX : now + interval;
+    aws_task_scheduler_schedule_future(scheduler, &expiry->reaper_task, first_run);
+    return AWS_OP_SUCCESS;
+}
+
+void aws_lru_cache_stop_expiry_reaper(struct aws_lru_cache *cache) {
+    if (cache->expiry && cache->expiry->scheduler) {
+        /* the task's canceled callback clears the scheduler */
+        aws_task_scheduler_cancel_task(cache->expiry->scheduler, &cache->expiry->reaper_task);
+    }
+}
+
 int aws_lru_cache_remove(struct aws_lru_cache *cache, const void *key) {
     /* allocated cache memory and the linked list entry will be removed in the
      * callback. */
@@ -137,24 +789,52 @@ void aws_lru_cache_clear(struct aws_lru_cache *cache) {
 }
 
 void *aws_lru_cache_use_lru_element(struct aws_lru_cache *cache) {
+    if (cache->tinylfu) {
+        /* the element the main segment would offer up for eviction next */
+        static const uint8_t segments[] = {TINYLFU_PROBATION, TINYLFU_PROTECTED, TINYLFU_WINDOW};
+        for (size_t i = 0; i < AWS_ARRAY_SIZE(segments); i++) {
+            struct aws_linked_list *list = s_tinylfu_list(cache, segments[i]);
+            if (!aws_linked_list_empty(list)) {
+                struct cache_node *lru_element =
+                    AWS_CONTAINER_OF(aws_linked_list_back(list), struct cache_node, node);
+                s_tinylfu_record_access(cache->tinylfu, lru_element->key);
+                s_tinylfu_on_hit(cache, lru_element);
+                return lru_element->value;
+            }
+        }
+        return NULL;
+    }
+
     if (aws_linked_list_empty(&cache->list)) {
         return NULL;
     }
 
     struct aws_linked_list_node *lru_node = aws_linked_list_back(&cache->list);
 
+    struct cache_node *lru_element = AWS_CONTAINER_OF(lru_node, struct cache_node, node);
+
+    if (cache->policy == AWS_LRU_CACHE_POLICY_SIEVE) {
+        lru_element->visited = true;
+        return lru_element->value;
+    }
+
     aws_linked_list_remove(lru_node);
     aws_linked_list_push_front(&cache->list, lru_node);
-    struct cache_node *lru_element = AWS_CONTAINER_OF(lru_node, struct cache_node, node);
     return lru_element->value;
 }
 
 void *aws_lru_cache_get_mru_element(const struct aws_lru_cache *cache) {
-    if (aws_linked_list_empty(&cache->list)) {
+    const struct aws_linked_list *list = &cache->list;
+    if (cache->tinylfu && aws_linked_list_empty(list)) {
+        list = aws_linked_list_empty(&cache->tinylfu->protected_list) ? &cache->tinylfu->probation
+                                                                       : &cache->tinylfu->protected_list;
+    }
+
+    if (aws_linked_list_empty(list)) {
         return NULL;
     }
 
-    struct aws_linked_list_node *mru_node = aws_linked_list_front(&cache->list);
+    struct aws_linked_list_node *mru_node = aws_linked_list_front(list);
 
     struct cache_node *mru_element = AWS_CONTAINER_OF(mru_node, struct cache_node, node);
     return mru_element->value;
@@ -163,3 +843,11 @@ void *aws_lru_cache_get_mru_element(const struct aws_lru_cache *cache) {
 size_t aws_lru_cache_get_element_count(const struct aws_lru_cache *cache) {
     return aws_hash_table_get_entry_count(&cache->table);
 }
+
+size_t aws_lru_cache_get_weight(const struct aws_lru_cache *cache) {
+    return cache->weight;
+}
+
+size_t aws_lru_cache_get_eviction_count(const struct aws_lru_cache *cache) {
+    return cache->evictions;
+}
@@ -0,0 +1,215 @@
+/*
+ * Copyright 2010-2018 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *  http://aws.amazon.com/apache2.0
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#include <aws/common/mmap_allocator.h>
+
+#include <aws/common/private/mmap.h>
+
+#include <assert.h>
+#include <string.h>
+
+#define DEFAULT_THRESHOLD (256 * 1024)
+/* Mapped memory starts this far into its mapping, after the header */
+#define MAPPED_OFFSET AWS_CACHE_LINE
+
+/* Sits just before every allocation, whether it came from parent or was mapped */
+struct mmap_header {
+    size_t size;
+    /* Length of the mapping, or 0 if the memory came from parent */
+    size_t mapped_size;
+    /* Whether the mapping came from the huge page pool */
+    bool huge;
+};
+
+/* Keeps parent's alignment for the memory after the header */
+#define HEADER_SIZE ((sizeof(struct mmap_header) + 15) & ~(size_t)15)
+
+struct mmap_impl {
+    struct aws_allocator allocator;
+    struct aws_allocator *parent;
+    struct aws_mmap_allocator_options options;
+    size_t page_size;
+    /* 0 if huge pages aren't available */
+    size_t huge_page_size;
+};
+
+static struct mmap_header *s_header_of(void *ptr) {
+    return (struct mmap_header *)((uint8_t *)ptr - HEADER_SIZE);
+}
+
+/* The mapping length needed to hand out size bytes, or 0 if it would overflow */
+static size_t s_mapped_size(size_t size, size_t page_size) {
+    if (size > SIZE_MAX - MAPPED_OFFSET - page_size) {
+        return 0;
+    }
+    return (size + MAPPED_OFFSET + page_size - 1) & ~(page_size - 1);
+}
+
+static uint8_t *s_map(struct mmap_impl *impl, size_t size, bool *huge, size_t *mapped_size) {
+    void *mapping = NULL;
+
+    if (impl->options.explicit_huge_pages && impl->huge_page_size) {
+        /* The pool is often empty, or needs privileges to map from */
+        *mapped_size = s_mapped_size(size, impl->huge_page_size);
+        if (*mapped_size) {
+            mapping = aws_mmap_map(*mapped_size, true, false, impl->options.prefault);
+        }
+    }
+
+    *huge = mapping != NULL;
+    if (!*huge) {
+        *mapped_size = s_mapped_size(size, impl->page_size);
+        if (!*mapped_size) {
+            return NULL;
+        }
+        mapping = aws_mmap_map(*mapped_size, false, impl->options.transparent_huge_pages, impl->options.prefault);
+    }
+
+    return mapping;
+}
+
+static void *s_mmap_acquire(struct aws_allocator *allocator, size_t size) {
+    struct mmap_impl *impl = allocator->impl;
+
+    if (size < impl->options.threshold) {
+        struct mmap_header *header = aws_mem_acquire(impl->parent, HEADER_SIZE + size);
+        if (!header) {
+            return NULL;
+        }
+        header->size = size;
+        header->mapped_size = 0;
+        header->huge = false;
+        return (uint8_t *)header + HEADER_SIZE;
+    }
+
+    bool huge = false;
+    size_t mapped_size = 0;
+    uint8_t *mapping = s_map(impl, size, &huge, &mapped_size);
+    if (!mapping) {
+        return NULL;
+    }
+
+    uint8_t *ptr = mapping + MAPPED_OFFSET;
+    struct mmap_header *header = s_header_of(ptr);
+    header->size = size;
+    header->mapped_size = mapped_size;
+    header->huge = huge;
+    return ptr;
+}
+
+static void s_mmap_release(struct aws_allocator *allocator, void *ptr) {
+    struct mmap_impl *impl = allocator->impl;
+    if (!ptr) {
+        return;
+    }
+
+    struct mmap_header *header = s_header_of(ptr);
+    if (!header->mapped_size) {
+        aws_mem_release(impl->parent, header);
+        return;
+    }
+    aws_mmap_unmap((uint8_t *)ptr - MAPPED_OFFSET, header->mapped_size);
+}
+
+/* Moves the memory to a new allocation, for when it can't be resized where it is */
+static void *s_move(struct aws_allocator *allocator, void *oldptr, size_t newsize) {
+    void *newptr = s_mmap_acquire(allocator, newsize);
+    if (!newptr) {
+        return NULL;
+    }
+    size_t oldsize = s_header_of(oldptr)->size;
+    memcpy(newptr, oldptr, oldsize < newsize ? oldsize : newsize);
+    s_mmap_release(allocator, oldptr);
+    return newptr;
+}
+
+static void *s_mmap_realloc(struct aws_allocator *allocator, void *oldptr, size_t oldsize, size_t newsize) {
+    struct mmap_impl *impl = allocator->impl;
+    (void)oldsize;
+
+    if (!oldptr) {
+        return s_mmap_acquire(allocator, newsize);
+    }
+
+    struct mmap_header *header = s_header_of(oldptr);
+    bool mapped = header->mapped_size != 0;
+    bool map = newsize >= impl->options.threshold;
+
+    if (!mapped && !map) {
+        void *block = header;
+        if (aws_mem_realloc(impl->parent, &block, HEADER_SIZE + header->size, HEADER_SIZE + newsize)) {
+            return NULL;
+        }
+        header = block;
+        header->size = newsize;
+        return (uint8_t *)header + HEADER_SIZE;
+    }
+    if (mapped != map) {
+        return s_move(allocator, oldptr, newsize);
+    }
+
+    size_t mapped_size = s_mapped_size(newsize, header->huge ? impl->huge_page_size : impl->page_size);
+    if (!mapped_size) {
+        return NULL;
+    }
+    if (mapped_size == header->mapped_size) {
+        header->size = newsize;
+        return oldptr;
+    }
+
+    /* Where the pages can be moved instead of copied, the header goes with them */
+    uint8_t *mapping = aws_mmap_remap(
+        (uint8_t *)oldptr - MAPPED_OFFSET, header->mapped_size, mapped_size, impl->options.prefault);
+    if (mapping) {
+        uint8_t *ptr = mapping + MAPPED_OFFSET;
+        header = s_header_of(ptr);
+        header->size = newsize;
+        header->mapped_size = mapped_size;
+        return ptr;
+    }
+
+    return s_move(allocator, oldptr, newsize);
+}
+
+struct aws_allocator *aws_mmap_allocator_new(
+    struct aws_allocator *parent,
+    const struct aws_mmap_allocator_options *options) {
+    assert(parent);
+    assert(options);
+
+    struct mmap_impl *impl = aws_mem_acquire(parent, sizeof(struct mmap_impl));
+    if (!impl) {
+        return NULL;
+    }
+    AWS_ZERO_STRUCT(*impl);
+    impl->allocator.mem_acquire = s_mmap_acquire;
+    impl->allocator.mem_release = s_mmap_release;
+    impl->allocator.mem_realloc = s_mmap_realloc;
+    impl->allocator.impl = impl;
+    impl->parent = parent;
+    impl->options = *options;
+    if (!impl->options.threshold) {
+        impl->options.threshold = DEFAULT_THRESHOLD;
+    }
+    impl->page_size = aws_mmap_page_size();
+    impl->huge_page_size = aws_mmap_huge_page_size();
+
+    return &impl->allocator;
+}
+
+void aws_mmap_allocator_destroy(struct aws_allocator *allocator) {
+    struct mmap_impl *impl = allocator->impl;
+    aws_mem_release(impl->parent, impl);
+}
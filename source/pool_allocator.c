@@ -0,0 +1,414 @@
+/*
+ * Copyright 2010-2018 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *  http://aws.amazon.com/apache2.0
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+#include <aws/common/pool_allocator.h>
+
+#include <aws/common/atomics.h>
+#include <aws/common/mutex.h>
+#include <aws/common/thread.h>
+
+#include <assert.h>
+#include <string.h>
+
+/*
+ * Each object is a 16 byte header holding its size class, followed by the memory handed out, which while the object
+ * is free holds the link to the next free object. Headers are written once, when a chunk is carved up.
+ *
+ * Thread caches live in thread local slots, each tagged with the id of the pool it belongs to. Ids are never reused,
+ * so a slot left behind by a destroyed pool can't be mistaken for a live one, and is reclaimed without touching the
+ * (freed) objects it still points to. When a thread exits, its caches go back to the central lists of the pools
+ * still live.
+ */
+
+#define HEADER_SIZE 16
+#define MAX_SMALL_SIZE 1024
+#define CLASS_COUNT 20
+#define LARGE_CLASS UINT32_MAX
+#define CHUNK_SIZE (64 * 1024)
+/* Objects moved between a thread cache and the central list at once */
+#define BATCH_SIZE 32
+/* Objects a thread cache holds per class before it gives a batch back */
+#define THREAD_CACHE_LIMIT 64
+/* Pools each thread can cache for at once; further ones go through the central lists */
+#define THREAD_CACHE_SLOTS 4
+
+static const uint16_t s_class_sizes[CLASS_COUNT] = {
+    16, 32, 48, 64, 80, 96, 112, 128, 160, 192, 224, 256, 320, 384, 448, 512, 640, 768, 896, 1024};
+
+struct pool_header {
+    uint32_t size_class;
+    uint8_t padding[HEADER_SIZE - sizeof(uint32_t)];
+};
+
+struct pool_free_object {
+    struct pool_free_object *next;
+};
+
+struct pool_class {
+    struct aws_mutex lock;
+    struct pool_free_object *free_list;
+    /* Chunks carved for this class, linked through their first bytes */
+    void *chunks;
+};
+
+struct pool_impl {
+    struct aws_allocator allocator;
+    struct aws_allocator *parent;
+    uint64_t id;
+    struct pool_impl *next_live;
+    struct pool_class classes[CLASS_COUNT];
+};
+
+struct pool_thread_cache {
+    /* 0 if the slot is unused */
+    uint64_t pool_id;
+    struct pool_free_object *free_lists[CLASS_COUNT];
+    uint32_t counts[CLASS_COUNT];
+};
+
+static AWS_THREAD_LOCAL struct pool_thread_cache tl_caches[THREAD_CACHE_SLOTS];
+/* Whether this thread has registered s_thread_exit */
+static AWS_THREAD_LOCAL bool tl_exit_registered;
+/* Set when every slot was found to belong to a live pool, along with s_destroyed_pools at the time */
+static AWS_THREAD_LOCAL bool tl_slots_full;
+static AWS_THREAD_LOCAL size_t tl_slots_full_at;
+
+/* Every pool which hasn't been destroyed, for telling which thread cache slots are stale */
+static struct aws_mutex s_live_pools_lock = AWS_MUTEX_INIT;
+static struct pool_impl *s_live_pools = NULL;
+static uint64_t s_next_pool_id = 1;
+/* Pools destroyed so far. Only a destroy can free up a slot that belongs to a live pool. */
+static struct aws_atomic_var s_destroyed_pools = AWS_ATOMIC_INIT_INT(0);
+
+static size_t s_size_class(size_t size) {
+    if (size <= 128) {
+        return size ? (size - 1) / 16 : 0;
+    }
+
+    /* Above 128 bytes, each doubling is split into 4 classes */
+    size_t group = 0;
+    size_t base = 128;
+    while (size > base * 2) {
+        base *= 2;
+        group++;
+    }
+    return 8 + group * 4 + (size - base - 1) / (base / 4);
+}
+
+static struct pool_header *s_header_of(void *ptr) {
+    return (struct pool_header *)((uint8_t *)ptr - HEADER_SIZE);
+}
+
+/* Finds the pool with the given id, or NULL if it's been destroyed. Must be called with s_live_pools_lock held. */
+static struct pool_impl *s_find_live_pool(uint64_t id) {
+    for (struct pool_impl *pool = s_live_pools; pool; pool = pool->next_live) {
+        if (pool->id == id) {
+            return pool;
+        }
+    }
+    return NULL;
+}
+
+/* Carves a new chunk into free objects. Must be called with the class's lock held. */
+static bool s_carve_chunk(struct pool_impl *pool, size_t size_class) {
+    struct pool_class *cls = &pool->classes[size_class];
+    uint8_t *chunk = aws_mem_acquire(pool->parent, CHUNK_SIZE);
+    if (!chunk) {
+        return false;
+    }
+
+    memcpy(chunk, &cls->chunks, sizeof(void *));
+    cls->chunks = chunk;
+
+    size_t object_size = HEADER_SIZE + s_class_sizes[size_class];
+    for (uint8_t *object = chunk + HEADER_SIZE; object + object_size <= chunk + CHUNK_SIZE; object += object_size) {
+        struct pool_header *header = (struct pool_header *)object;
+        header->size_class = (uint32_t)size_class;
+
+        struct pool_free_object *free_object = (struct pool_free_object *)(object + HEADER_SIZE);
+        free_object->next = cls->free_list;
+        cls->free_list = free_object;
+    }
+    return true;
+}
+
+/* Takes up to count objects from the central list, carving a chunk if it's empty, as a list ending in NULL */
+static struct pool_free_object *s_central_take(
+    struct pool_impl *pool,
+    size_t size_class,
+    uint32_t count,
+    uint32_t *taken) {
+
+    struct pool_class *cls = &pool->classes[size_class];
+    aws_mutex_lock(&cls->lock);
+
+    if (!cls->free_list && !s_carve_chunk(pool, size_class)) {
+        aws_mutex_unlock(&cls->lock);
+        *taken = 0;
+        return NULL;
+    }
+
+    struct pool_free_object *head = cls->free_list;
+    struct pool_free_object *tail = head;
+    uint32_t n = 1;
+    while (n < count && tail->next) {
+        tail = tail->next;
+        n++;
+    }
+    cls->free_list = tail->next;
+    tail->next = NULL;
+
+    aws_mutex_unlock(&cls->lock);
+    *taken = n;
+    return head;
+}
+
+/* Puts the list from head to tail back on the central list */
+static void s_central_give(
+    struct pool_impl *pool,
+    size_t size_class,
+    struct pool_free_object *head,
+    struct pool_free_object *tail) {
+
+    struct pool_class *cls = &pool->classes[size_class];
+    aws_mutex_lock(&cls->lock);
+    tail->next = cls->free_list;
+    cls->free_list = head;
+    aws_mutex_unlock(&cls->lock);
+}
+
+/* Gives the exiting thread's cached objects back to the central lists, so they aren't stranded with it */
+static void s_thread_exit(void *user_data) {
+    (void)user_data;
+
+    /* Holding the lock keeps the pools from being destroyed while their objects are given back */
+    aws_mutex_lock(&s_live_pools_lock);
+    for (size_t i = 0; i < THREAD_CACHE_SLOTS; i++) {
+        struct pool_thread_cache *cache = &tl_caches[i];
+        struct pool_impl *pool = cache->pool_id ? s_find_live_pool(cache->pool_id) : NULL;
+        for (size_t size_class = 0; pool && size_class < CLASS_COUNT; size_class++) {
+            struct pool_free_object *head = cache->free_lists[size_class];
+            if (!head) {
+                continue;
+            }
+            struct pool_free_object *tail = head;
+            while (tail->next) {
+                tail = tail->next;
+            }
+            s_central_give(pool, size_class, head, tail);
+        }
+        AWS_ZERO_STRUCT(*cache);
+    }
+    tl_exit_registered = false;
+    aws_mutex_unlock(&s_live_pools_lock);
+}
+
+/*
+ * Finds or claims this thread's cache for the pool, or returns NULL if every slot belongs to a live pool. Once the
+ * slots are full, a thread goes straight to the central lists for further pools, until some pool is destroyed.
+ */
+static struct pool_thread_cache *s_thread_cache(struct pool_impl *pool) {
+    for (size_t i = 0; i < THREAD_CACHE_SLOTS; i++) {
+        if (tl_caches[i].pool_id == pool->id) {
+            return &tl_caches[i];
+        }
+    }
+
+    size_t destroyed_pools = aws_atomic_load_int(&s_destroyed_pools);
+    if (tl_slots_full && tl_slots_full_at == destroyed_pools) {
+        return NULL;
+    }
+
+    /* Without the exit hook, a cache would be stranded when the thread exits, so go without */
+    if (!tl_exit_registered) {
+        if (aws_thread_current_at_exit(s_thread_exit, NULL)) {
+            return NULL;
+        }
+        tl_exit_registered = true;
+    }
+
+    struct pool_thread_cache *claimed = NULL;
+    aws_mutex_lock(&s_live_pools_lock);
+    for (size_t i = 0; i < THREAD_CACHE_SLOTS && !claimed; i++) {
+        struct pool_thread_cache *cache = &tl_caches[i];
+        if (!cache->pool_id || !s_find_live_pool(cache->pool_id)) {
+            AWS_ZERO_STRUCT(*cache);
+            cache->pool_id = pool->id;
+            claimed = cache;
+        }
+    }
+    aws_mutex_unlock(&s_live_pools_lock);
+
+    tl_slots_full = claimed == NULL;
+    tl_slots_full_at = destroyed_pools;
+    return claimed;
+}
+
+static void *s_pool_acquire(struct aws_allocator *allocator, size_t size) {
+    struct pool_impl *pool = allocator->impl;
+
+    if (size > MAX_SMALL_SIZE) {
+        if (size > SIZE_MAX - HEADER_SIZE) {
+            return NULL;
+        }
+        struct pool_header *header = aws_mem_acquire(pool->parent, HEADER_SIZE + size);
+        if (!header) {
+            return NULL;
+        }
+        header->size_class = LARGE_CLASS;
+        return (uint8_t *)header + HEADER_SIZE;
+    }
+
+    size_t size_class = s_size_class(size);
+    struct pool_thread_cache *cache = s_thread_cache(pool);
+    if (!cache) {
+        uint32_t taken = 0;
+        return s_central_take(pool, size_class, 1, &taken);
+    }
+
+    struct pool_free_object *object = cache->free_lists[size_class];
+    if (AWS_UNLIKELY(!object)) {
+        uint32_t taken = 0;
+        object = s_central_take(pool, size_class, BATCH_SIZE, &taken);
+        if (!object) {
+            return NULL;
+        }
+        cache->counts[size_class] = taken;
+    }
+
+    cache->free_lists[size_class] = object->next;
+    cache->counts[size_class]--;
+    return object;
+}
+
+static void s_pool_release(struct aws_allocator *allocator, void *ptr) {
+    struct pool_impl *pool = allocator->impl;
+    if (!ptr) {
+        return;
+    }
+
+    struct pool_header *header = s_header_of(ptr);
+    if (header->size_class == LARGE_CLASS) {
+        aws_mem_release(pool->parent, header);
+        return;
+    }
+
+    size_t size_class = header->size_class;
+    struct pool_free_object *object = ptr;
+    struct pool_thread_cache *cache = s_thread_cache(pool);
+    if (!cache) {
+        s_central_give(pool, size_class, object, object);
+        return;
+    }
+
+    object->next = cache->free_lists[size_class];
+    cache->free_lists[size_class] = object;
+    if (AWS_UNLIKELY(++cache->counts[size_class] > THREAD_CACHE_LIMIT)) {
+        /* Give the newest batch back, keeping the rest for this thread */
+        struct pool_free_object *tail = object;
+        for (size_t i = 1; i < BATCH_SIZE; i++) {
+            tail = tail->next;
+        }
+        cache->free_lists[size_class] = tail->next;
+        cache->counts[size_class] -= BATCH_SIZE;
+        s_central_give(pool, size_class, object, tail);
+    }
+}
+
+static void *s_pool_realloc(struct aws_allocator *allocator, void *oldptr, size_t oldsize, size_t newsize) {
+    if (oldptr) {
+        struct pool_header *header = s_header_of(oldptr);
+        if (header->size_class != LARGE_CLASS && newsize <= s_class_sizes[header->size_class]) {
+            /* Still fits its class */
+            return oldptr;
+        }
+    }
+
+    void *newptr = s_pool_acquire(allocator, newsize);
+    if (!newptr) {
+        return NULL;
+    }
+    if (oldptr) {
+        memcpy(newptr, oldptr, oldsize < newsize ? oldsize : newsize);
+        s_pool_release(allocator, oldptr);
+    }
+    return newptr;
+}
+
+struct aws_allocator *aws_pool_allocator_new(struct aws_allocator *parent) {
+    assert(parent);
+
+    struct pool_impl *pool = aws_mem_acquire(parent, sizeof(struct pool_impl));
+    if (!pool) {
+        return NULL;
+    }
+    AWS_ZERO_STRUCT(*pool);
+    pool->parent = parent;
+    pool->allocator.mem_acquire = s_pool_acquire;
+    pool->allocator.mem_release = s_pool_release;
+    pool->allocator.mem_realloc = s_pool_realloc;
+    pool->allocator.impl = pool;
+
+    for (size_t i = 0; i < CLASS_COUNT; i++) {
+        if (aws_mutex_init(&pool->classes[i].lock)) {
+            while (i--) {
+                aws_mutex_clean_up(&pool->classes[i].lock);
+            }
+            aws_mem_release(parent, pool);
+            return NULL;
+        }
+    }
+
+    aws_mutex_lock(&s_live_pools_lock);
+    pool->id = s_next_pool_id++;
+    pool->next_live = s_live_pools;
+    s_live_pools = pool;
+    aws_mutex_unlock(&s_live_pools_lock);
+
+    return &pool->allocator;
+}
+
+void aws_pool_allocator_destroy(struct aws_allocator *allocator) {
+    struct pool_impl *pool = allocator->impl;
+
+    aws_mutex_lock(&s_live_pools_lock);
+    for (struct pool_impl **link = &s_live_pools; *link; link = &(*link)->next_live) {
+        if (*link == pool) {
+            *link = pool->next_live;
+            break;
+        }
+    }
+    aws_mutex_unlock(&s_live_pools_lock);
+    aws_atomic_fetch_add(&s_destroyed_pools, 1);
+
+    /* Other threads' slots are reclaimed once they find the pool is gone, but this one's can be freed now */
+    for (size_t i = 0; i < THREAD_CACHE_SLOTS; i++) {
+        if (tl_caches[i].pool_id == pool->id) {
+            AWS_ZERO_STRUCT(tl_caches[i]);
+        }
+    }
+
+    for (size_t i = 0; i < CLASS_COUNT; i++) {
+        void *chunk = pool->classes[i].chunks;
+        while (chunk) {
+            void *next = NULL;
+            memcpy(&next, chunk, sizeof(void *));
+            aws_mem_release(pool->parent, chunk);
+            chunk = next;
+        }
+        aws_mutex_clean_up(&pool->classes[i].lock);
+    }
+
+    aws_mem_release(pool->parent, pool);
+}
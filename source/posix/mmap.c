@@ -0,0 +1,121 @@
+/*
+ * Copyright 2010-2018 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *  http://aws.amazon.com/apache2.0
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+/* mremap, MAP_POPULATE, MAP_HUGETLB and MADV_HUGEPAGE are all GNU extensions */
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+#    define _GNU_SOURCE
+#endif
+#if defined(__FreeBSD__) || defined(__NetBSD__)
+#    define __BSD_VISIBLE 1
+#endif
+
+#include <aws/common/private/mmap.h>
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+#if !defined(MAP_ANONYMOUS) && defined(MAP_ANON)
+#    define MAP_ANONYMOUS MAP_ANON
+#endif
+
+#define HUGE_PAGE_SIZE (2 * 1024 * 1024)
+
+size_t aws_mmap_page_size(void) {
+    long page_size = sysconf(_SC_PAGESIZE);
+    return page_size > 0 ? (size_t)page_size : 4096;
+}
+
+size_t aws_mmap_huge_page_size(void) {
+#if defined(MAP_HUGETLB)
+    return HUGE_PAGE_SIZE;
+#else
+    return 0;
+#endif
+}
+
+/* Faults in [start, end) of a mapping, where the kernel wasn't asked to */
+static void s_prefault(uint8_t *start, uint8_t *end) {
+#if defined(MADV_POPULATE_WRITE)
+    if (!madvise(start, (size_t)(end - start), MADV_POPULATE_WRITE)) {
+        return;
+    }
+#endif
+    size_t page_size = aws_mmap_page_size();
+    for (volatile uint8_t *page = start; page < end; page += page_size) {
+        *page = 0;
+    }
+}
+
+void *aws_mmap_map(size_t size, bool huge, bool transparent_huge_pages, bool prefault) {
+    int flags = MAP_PRIVATE | MAP_ANONYMOUS;
+#if defined(MAP_POPULATE)
+    if (prefault) {
+        flags |= MAP_POPULATE;
+    }
+#endif
+#if defined(MAP_HUGETLB)
+    if (huge) {
+        flags |= MAP_HUGETLB;
+    }
+#else
+    (void)huge;
+#endif
+
+    void *mapping = mmap(NULL, size, PROT_READ | PROT_WRITE, flags, -1, 0);
+    if (mapping == MAP_FAILED) {
+        return NULL;
+    }
+
+#if defined(MADV_HUGEPAGE)
+    if (transparent_huge_pages && size >= HUGE_PAGE_SIZE) {
+        /* Only advice; the mapping works the same without it */
+        madvise(mapping, size, MADV_HUGEPAGE);
+    }
+#else
+    (void)transparent_huge_pages;
+#endif
+#if !defined(MAP_POPULATE)
+    if (prefault) {
+        s_prefault(mapping, (uint8_t *)mapping + size);
+    }
+#endif
+
+    return mapping;
+}
+
+void aws_mmap_unmap(void *mapping, size_t size) {
+    munmap(mapping, size);
+}
+
+void *aws_mmap_remap(void *mapping, size_t old_size, size_t new_size, bool prefault) {
+#if defined(MREMAP_MAYMOVE)
+    /* The kernel moves the pages instead of copying them */
+    void *new_mapping = mremap(mapping, old_size, new_size, MREMAP_MAYMOVE);
+    if (new_mapping == MAP_FAILED) {
+        return NULL;
+    }
+    if (prefault && new_size > old_size) {
+        s_prefault((uint8_t *)new_mapping + old_size, (uint8_t *)new_mapping + new_size);
+    }
+    return new_mapping;
+#else
+    (void)prefault;
+    if (new_size < old_size) {
+        munmap((uint8_t *)mapping + new_size, old_size - new_size);
+        return mapping;
+    }
+    return NULL;
+#endif
+}
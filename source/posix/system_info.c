@@ -16,6 +16,7 @@
 #include <aws/common/system_info.h>
 
 #include <assert.h>
+#include <string.h>
 
 #if defined(__FreeBSD__) || defined(__NetBSD__)
 #    define __BSD_VISIBLE 1
@@ -23,6 +24,10 @@
 
 #include <unistd.h>
 
+#if defined(HAVE_EXECINFO)
+#    include <execinfo.h>
+#endif
+
 #if defined(HAVE_SYSCONF)
 size_t aws_system_info_processor_count(void) {
     long nprocs = sysconf(_SC_NPROCESSORS_ONLN);
@@ -43,3 +48,27 @@ size_t aws_system_info_processor_count(void) {
 #    endif
 }
 #endif
+
+#if defined(HAVE_EXECINFO)
+#    define BACKTRACE_MAX_FRAMES 128
+
+size_t aws_backtrace(void **frames, size_t max_frames) {
+    /* backtrace() includes this function, so take one more frame and drop it */
+    void *stack[BACKTRACE_MAX_FRAMES + 1];
+    if (max_frames > BACKTRACE_MAX_FRAMES) {
+        max_frames = BACKTRACE_MAX_FRAMES;
+    }
+    int count = backtrace(stack, (int)max_frames + 1);
+    if (count <= 1) {
+        return 0;
+    }
+    memcpy(frames, stack + 1, sizeof(void *) * (size_t)(count - 1));
+    return (size_t)(count - 1);
+}
+#else
+size_t aws_backtrace(void **frames, size_t max_frames) {
+    (void)frames;
+    (void)max_frames;
+    return 0;
+}
+#endif
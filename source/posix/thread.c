@@ -26,6 +26,17 @@ static struct aws_thread_options s_default_options = {
     /* this will make sure platform default stack size is used. */
     .stack_size = 0};
 
+/* Registered exit callbacks, newest first, hang off the calling thread's value for s_thread_exit_key */
+struct thread_atexit_callback {
+    aws_thread_atexit_fn *callback;
+    void *user_data;
+    struct thread_atexit_callback *next;
+};
+
+static pthread_once_t s_thread_exit_key_once = PTHREAD_ONCE_INIT;
+static pthread_key_t s_thread_exit_key;
+static bool s_thread_exit_key_created = false;
+
 struct thread_wrapper {
     struct aws_allocator *allocator;
     void (*func)(void *arg);
@@ -180,3 +191,39 @@ void aws_thread_current_sleep(uint64_t nanos) {
 
     nanosleep(&tm, &output);
 }
+
+static void s_thread_exit(void *arg) {
+    struct thread_atexit_callback *entry = arg;
+    while (entry) {
+        struct thread_atexit_callback *next = entry->next;
+        entry->callback(entry->user_data);
+        aws_mem_release(aws_default_allocator(), entry);
+        entry = next;
+    }
+}
+
+static void s_thread_exit_key_init(void) {
+    s_thread_exit_key_created = !pthread_key_create(&s_thread_exit_key, s_thread_exit);
+}
+
+int aws_thread_current_at_exit(aws_thread_atexit_fn *callback, void *user_data) {
+    pthread_once(&s_thread_exit_key_once, s_thread_exit_key_init);
+    if (!s_thread_exit_key_created) {
+        return aws_raise_error(AWS_ERROR_THREAD_INSUFFICIENT_RESOURCE);
+    }
+
+    struct thread_atexit_callback *entry =
+        aws_mem_acquire(aws_default_allocator(), sizeof(struct thread_atexit_callback));
+    if (!entry) {
+        return AWS_OP_ERR;
+    }
+    entry->callback = callback;
+    entry->user_data = user_data;
+    entry->next = pthread_getspecific(s_thread_exit_key);
+
+    if (pthread_setspecific(s_thread_exit_key, entry)) {
+        aws_mem_release(aws_default_allocator(), entry);
+        return aws_raise_error(AWS_ERROR_OOM);
+    }
+    return AWS_OP_SUCCESS;
+}
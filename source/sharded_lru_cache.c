@@ -0,0 +1,230 @@
+/*
+ * Copyright 2010-2018 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *  http://aws.amazon.com/apache2.0
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+#include <aws/common/sharded_lru_cache.h>
+
+#include <aws/common/mutex.h>
+#include <aws/common/system_info.h>
+
+#include <assert.h>
+
+/* With the default shard count, shards outnumber processors by this much, to make collisions between threads rare */
+#define DEFAULT_SHARDS_PER_PROCESSOR 4
+
+struct aws_sharded_lru_cache_shard {
+    struct aws_mutex lock;
+    struct aws_lru_cache cache;
+    size_t hits;
+    size_t misses;
+};
+
+/* Shards are laid out a whole number of cache lines apart, so that threads using different shards don't share lines */
+#define SHARD_STRIDE                                                                                                   \
+    ((sizeof(struct aws_sharded_lru_cache_shard) + AWS_CACHE_LINE - 1) & ~(size_t)(AWS_CACHE_LINE - 1))
+
+static struct aws_sharded_lru_cache_shard *s_shard_at(const struct aws_sharded_lru_cache *cache, size_t index) {
+    return (struct aws_sharded_lru_cache_shard *)((uint8_t *)cache->shards + index * SHARD_STRIDE);
+}
+
+static struct aws_sharded_lru_cache_shard *s_shard_for_key(const struct aws_sharded_lru_cache *cache, const void *key) {
+    if (cache->shard_bits == 0) {
+        return cache->shards;
+    }
+
+    /*
+     * The shard's hash table uses the low bits of the hash code to place the key, so pick the shard from the high
+     * bits of a remix, or every key in a shard would land in the same fraction of its table.
+     */
+    uint64_t hash_code = cache->hash_fn(key) * 0x9E3779B97F4A7C15ULL;
+    return s_shard_at(cache, (size_t)(hash_code >> (64 - cache->shard_bits)));
+}
+
+int aws_sharded_lru_cache_init(
+    struct aws_sharded_lru_cache *cache,
+    struct aws_allocator *allocator,
+    aws_hash_fn *hash_fn,
+    aws_hash_callback_eq_fn *equals_fn,
+    aws_hash_callback_destroy_fn *destroy_key_fn,
+    aws_hash_callback_destroy_fn *destroy_value_fn,
+    size_t max_items,
+    size_t shard_count) {
+    assert(allocator);
+    assert(max_items);
+
+    AWS_ZERO_STRUCT(*cache);
+
+    if (shard_count == 0) {
+        shard_count = aws_system_info_processor_count() * DEFAULT_SHARDS_PER_PROCESSOR;
+    }
+
+    /* Round down to a power of two no greater than max_items, then up to one no less than shard_count */
+    size_t max_shards = 1;
+    while (max_shards <= max_items / 2) {
+        max_shards <<= 1;
+    }
+    size_t shard_bits = 0;
+    while (((size_t)1 << shard_bits) < shard_count && ((size_t)1 << shard_bits) < max_shards) {
+        shard_bits++;
+    }
+    shard_count = (size_t)1 << shard_bits;
+    size_t shard_capacity = max_items / shard_count + (max_items % shard_count != 0);
+
+    struct aws_sharded_lru_cache_shard *shards =
+        aws_mem_acquire_aligned(allocator, AWS_CACHE_LINE, shard_count * SHARD_STRIDE);
+    if (!shards) {
+        return AWS_OP_ERR;
+    }
+
+    cache->allocator = allocator;
+    cache->hash_fn = hash_fn;
+    cache->shard_count = shard_count;
+    cache->shard_bits = shard_bits;
+    cache->shards = shards;
+
+    size_t initialized = 0;
+    for (; initialized < shard_count; initialized++) {
+        struct aws_sharded_lru_cache_shard *shard = s_shard_at(cache, initialized);
+        AWS_ZERO_STRUCT(*shard);
+        if (aws_mutex_init(&shard->lock)) {
+            goto error;
+        }
+        if (aws_lru_cache_init(
+                &shard->cache, allocator, hash_fn, equals_fn, destroy_key_fn, destroy_value_fn, shard_capacity)) {
+            aws_mutex_clean_up(&shard->lock);
+            goto error;
+        }
+    }
+
+    return AWS_OP_SUCCESS;
+
+error:
+    for (size_t i = 0; i < initialized; i++) {
+        struct aws_sharded_lru_cache_shard *shard = s_shard_at(cache, i);
+        aws_lru_cache_clean_up(&shard->cache);
+        aws_mutex_clean_up(&shard->lock);
+    }
+    aws_mem_release_aligned(allocator, shards);
+    AWS_ZERO_STRUCT(*cache);
+    return AWS_OP_ERR;
+}
+
+void aws_sharded_lru_cache_clean_up(struct aws_sharded_lru_cache *cache) {
+    if (!cache->shards) {
+        return;
+    }
+
+    for (size_t i = 0; i < cache->shard_count; i++) {
+        struct aws_sharded_lru_cache_shard *shard = s_shard_at(cache, i);
+        aws_lru_cache_clean_up(&shard->cache);
+        aws_mutex_clean_up(&shard->lock);
+    }
+    aws_mem_release_aligned(cache->allocator, cache->shards);
+    AWS_ZERO_STRUCT(*cache);
+}
+
+int aws_sharded_lru_cache_find(struct aws_sharded_lru_cache *cache, const void *key, void **p_value) {
+    struct aws_sharded_lru_cache_shard *shard = s_shard_for_key(cache, key);
+
+    aws_mutex_lock(&shard->lock);
+    int err_val = aws_lru_cache_find(&shard->cache, key, p_value);
+    if (!err_val) {
+        if (*p_value) {
+            shard->hits++;
+        } else {
+            shard->misses++;
+        }
+    }
+    aws_mutex_unlock(&shard->lock);
+
+    return err_val;
+}
+
+int aws_sharded_lru_cache_find_with(
+    struct aws_sharded_lru_cache *cache,
+    const void *key,
+    aws_sharded_lru_cache_found_fn *on_found,
+    void *user_data,
+    bool *found) {
+
+    struct aws_sharded_lru_cache_shard *shard = s_shard_for_key(cache, key);
+    void *value = NULL;
+
+    aws_mutex_lock(&shard->lock);
+    int err_val = aws_lru_cache_find(&shard->cache, key, &value);
+    if (!err_val) {
+        if (value) {
+            shard->hits++;
+            on_found(value, user_data);
+        } else {
+            shard->misses++;
+        }
+    }
+    aws_mutex_unlock(&shard->lock);
+
+    *found = value != NULL;
+    return err_val;
+}
+
+int aws_sharded_lru_cache_put(struct aws_sharded_lru_cache *cache, const void *key, void *p_value) {
+    struct aws_sharded_lru_cache_shard *shard = s_shard_for_key(cache, key);
+
+    aws_mutex_lock(&shard->lock);
+    int err_val = aws_lru_cache_put(&shard->cache, key, p_value);
+    aws_mutex_unlock(&shard->lock);
+
+    return err_val;
+}
+
+int aws_sharded_lru_cache_remove(struct aws_sharded_lru_cache *cache, const void *key) {
+    struct aws_sharded_lru_cache_shard *shard = s_shard_for_key(cache, key);
+
+    aws_mutex_lock(&shard->lock);
+    int err_val = aws_lru_cache_remove(&shard->cache, key);
+    aws_mutex_unlock(&shard->lock);
+
+    return err_val;
+}
+
+void aws_sharded_lru_cache_clear(struct aws_sharded_lru_cache *cache) {
+    for (size_t i = 0; i < cache->shard_count; i++) {
+        struct aws_sharded_lru_cache_shard *shard = s_shard_at(cache, i);
+        aws_mutex_lock(&shard->lock);
+        aws_lru_cache_clear(&shard->cache);
+        aws_mutex_unlock(&shard->lock);
+    }
+}
+
+size_t aws_sharded_lru_cache_get_element_count(struct aws_sharded_lru_cache *cache) {
+    size_t count = 0;
+    for (size_t i = 0; i < cache->shard_count; i++) {
+        struct aws_sharded_lru_cache_shard *shard = s_shard_at(cache, i);
+        aws_mutex_lock(&shard->lock);
+        count += aws_lru_cache_get_element_count(&shard->cache);
+        aws_mutex_unlock(&shard->lock);
+    }
+    return count;
+}
+
+void aws_sharded_lru_cache_get_stats(struct aws_sharded_lru_cache *cache, struct aws_sharded_lru_cache_stats *stats) {
+    AWS_ZERO_STRUCT(*stats);
+    for (size_t i = 0; i < cache->shard_count; i++) {
+        struct aws_sharded_lru_cache_shard *shard = s_shard_at(cache, i);
+        aws_mutex_lock(&shard->lock);
+        stats->element_count += aws_lru_cache_get_element_count(&shard->cache);
+        stats->hits += shard->hits;
+        stats->misses += shard->misses;
+        stats->evictions += aws_lru_cache_get_eviction_count(&shard->cache);
+        aws_mutex_unlock(&shard->lock);
+    }
+}
@@ -15,26 +15,478 @@
 
 #include <aws/common/task_scheduler.h>
 
+#include <aws/common/clock.h>
+#include <aws/common/config.h>
+#include <aws/common/hash_table.h>
+
 #include <assert.h>
+#include <stdlib.h>
+#include <string.h>
 
 static const size_t DEFAULT_QUEUE_SIZE = 7;
 
+#define WHEEL_SLOT_BITS 6
+#define WHEEL_SLOTS (1 << WHEEL_SLOT_BITS)
+/* Enough levels for every bit of a 64-bit tick */
+#define WHEEL_LEVELS ((64 + WHEEL_SLOT_BITS - 1) / WHEEL_SLOT_BITS)
+/* 1ms, for timestamps in nanoseconds */
+#define DEFAULT_WHEEL_RESOLUTION 1000000
+
+/*
+ * A task at level L of the wheel has a tick which, from the top, matches current_tick down to digit L (a digit being
+ * WHEEL_SLOT_BITS bits), and is in the slot for its digit L, which is greater than current_tick's (or at level 0, no
+ * less). So the earliest task is in the lowest occupied slot of the lowest occupied level. When a run reaches a slot
+ * above level 0, current_tick moves to the start of the slot, and its tasks are reinserted at lower levels.
+ */
+struct aws_task_scheduler_wheel {
+    uint64_t resolution;
+    /* No task is due before this tick, other than those in overdue */
+    uint64_t current_tick;
+    /* Bit i of occupied[L] is set if slots[L][i] may be non-empty. Canceling leaves the bit to be cleared later. */
+    uint64_t occupied[WHEEL_LEVELS];
+    struct aws_linked_list slots[WHEEL_LEVELS][WHEEL_SLOTS];
+    /* Tasks scheduled for a tick before current_tick */
+    struct aws_linked_list overdue;
+};
+
+static inline size_t s_count_trailing_zeros(uint64_t mask) {
+#if defined(__GNUC__) || defined(__clang__)
+    return (size_t)__builtin_ctzll(mask);
+#else
+    size_t index = 0;
+    while (!(mask & 1)) {
+        mask >>= 1;
+        index++;
+    }
+    return index;
+#endif
+}
+
+static size_t s_wheel_digit(uint64_t tick, size_t level) {
+    return (size_t)(tick >> (level * WHEEL_SLOT_BITS)) & (WHEEL_SLOTS - 1);
+}
+
+/* The first tick of a slot, given the current tick */
+static uint64_t s_wheel_slot_start(uint64_t current_tick, size_t level, size_t slot) {
+    size_t shift = level * WHEEL_SLOT_BITS;
+    uint64_t upper = 0;
+    if (shift + WHEEL_SLOT_BITS < 64) {
+        upper = current_tick >> (shift + WHEEL_SLOT_BITS) << (shift + WHEEL_SLOT_BITS);
+    }
+    return upper | ((uint64_t)slot << shift);
+}
+
+static void s_wheel_insert(struct aws_task_scheduler_wheel *wheel, struct aws_task *task) {
+    uint64_t tick = task->timestamp / wheel->resolution;
+    if (tick < wheel->current_tick) {
+        aws_linked_list_push_back(&wheel->overdue, &task->node);
+        return;
+    }
+
+    /* The level of the most significant digit in which the task's tick differs from the current one */
+    size_t level = 0;
+    for (uint64_t diff = (tick ^ wheel->current_tick) >> WHEEL_SLOT_BITS; diff; diff >>= WHEEL_SLOT_BITS) {
+        level++;
+    }
+
+    size_t slot = s_wheel_digit(tick, level);
+    aws_linked_list_push_back(&wheel->slots[level][slot], &task->node);
+    wheel->occupied[level] |= (uint64_t)1 << slot;
+}
+
+/* Finds the lowest non-empty slot of the lowest level, clearing bits of slots found empty on the way */
+static bool s_wheel_next_slot(struct aws_task_scheduler_wheel *wheel, size_t *level, size_t *slot) {
+    for (size_t l = 0; l < WHEEL_LEVELS; l++) {
+        while (wheel->occupied[l]) {
+            size_t s = s_count_trailing_zeros(wheel->occupied[l]);
+            if (!aws_linked_list_empty(&wheel->slots[l][s])) {
+                *level = l;
+                *slot = s;
+                return true;
+            }
+            wheel->occupied[l] &= ~((uint64_t)1 << s);
+        }
+    }
+    return false;
+}
+
+/* Moves the tasks in list which are due at current_time to the back of running_list */
+static void s_move_due_tasks(
+    struct aws_linked_list *list,
+    uint64_t current_time,
+    struct aws_linked_list *running_list) {
+
+    struct aws_linked_list_node *node = aws_linked_list_begin(list);
+    while (node != aws_linked_list_end(list)) {
+        struct aws_linked_list_node *next = aws_linked_list_next(node);
+        if (AWS_CONTAINER_OF(node, struct aws_task, node)->timestamp <= current_time) {
+            aws_linked_list_remove(node);
+            aws_linked_list_push_back(running_list, node);
+        }
+        node = next;
+    }
+}
+
+/* Moves every task due at current_time to running_list, in order of tick */
+static void s_wheel_take_due_tasks(
+    struct aws_task_scheduler_wheel *wheel,
+    uint64_t current_time,
+    struct aws_linked_list *running_list) {
+
+    /* Overdue tasks are due, unless the caller's clock went backwards */
+    s_move_due_tasks(&wheel->overdue, current_time, running_list);
+
+    uint64_t target_tick = current_time / wheel->resolution;
+    size_t level = 0;
+    size_t slot = 0;
+    while (s_wheel_next_slot(wheel, &level, &slot)) {
+        uint64_t slot_tick = s_wheel_slot_start(wheel->current_tick, level, slot);
+        if (slot_tick > target_tick) {
+            break;
+        }
+
+        struct aws_linked_list *list = &wheel->slots[level][slot];
+        wheel->current_tick = slot_tick;
+
+        if (level == 0 && slot_tick == target_tick) {
+            /* Only part of this tick has passed */
+            s_move_due_tasks(list, current_time, running_list);
+            break;
+        }
+
+        struct aws_linked_list tasks;
+        aws_linked_list_init(&tasks);
+        aws_linked_list_swap_contents(&tasks, list);
+        wheel->occupied[level] &= ~((uint64_t)1 << slot);
+
+        if (level == 0) {
+            /* The whole tick has passed, so every task in it is due */
+            while (!aws_linked_list_empty(&tasks)) {
+                aws_linked_list_push_back(running_list, aws_linked_list_pop_front(&tasks));
+            }
+            continue;
+        }
+
+        /* Cascade: nothing is due before this slot starts, so its tasks can be placed relative to its start */
+        while (!aws_linked_list_empty(&tasks)) {
+            s_wheel_insert(wheel, AWS_CONTAINER_OF(aws_linked_list_pop_front(&tasks), struct aws_task, node));
+        }
+    }
+}
+
+static uint64_t s_earliest_timestamp(const struct aws_linked_list *list) {
+    uint64_t timestamp = UINT64_MAX;
+    for (struct aws_linked_list_node *node = aws_linked_list_begin(list); node != aws_linked_list_end(list);
+         node = aws_linked_list_next(node)) {
+        struct aws_task *task = AWS_CONTAINER_OF(node, struct aws_task, node);
+        if (task->timestamp < timestamp) {
+            timestamp = task->timestamp;
+        }
+    }
+    return timestamp;
+}
+
+/*
+ * Reports the start of the lowest occupied slot, rather than the earliest task in it, above level 0: those slots hold
+ * every timer in spans of up to minutes, and waking early only costs a run which cascades them down a level. Overdue
+ * tasks are due now.
+ */
+static bool s_wheel_has_tasks(const struct aws_task_scheduler_wheel *wheel, uint64_t *next_task_time) {
+    if (!aws_linked_list_empty(&wheel->overdue)) {
+        *next_task_time = 0;
+        return true;
+    }
+
+    for (size_t level = 0; level < WHEEL_LEVELS; level++) {
+        for (uint64_t occupied = wheel->occupied[level]; occupied; occupied &= occupied - 1) {
+            size_t slot = s_count_trailing_zeros(occupied);
+            const struct aws_linked_list *list = &wheel->slots[level][slot];
+            if (aws_linked_list_empty(list)) {
+                continue;
+            }
+            if (level == 0) {
+                *next_task_time = s_earliest_timestamp(list);
+            } else {
+                *next_task_time = s_wheel_slot_start(wheel->current_tick, level, slot) * wheel->resolution;
+            }
+            return true;
+        }
+    }
+
+    *next_task_time = UINT64_MAX;
+    return false;
+}
+
+/*
+ * Instrumentation. Without AWS_ENABLE_TASK_SCHEDULER_STATS, stats is never allocated and s_stats_enabled is constant
+ * false, so the hooks compile away.
+ */
+#ifdef AWS_ENABLE_TASK_SCHEDULER_STATS
+#    define STATS_SUPPORTED true
+#else
+#    define STATS_SUPPORTED false
+#endif
+
+struct aws_task_scheduler_stats_impl {
+    struct aws_allocator *alloc;
+    /* Queue depths are left at 0 here, and counted for each snapshot */
+    struct aws_task_scheduler_stats totals;
+    /* Maps an aws_task_fn, through a pointer to the fn field of its entry, to its struct aws_task_scheduler_fn_stats */
+    struct aws_hash_table fn_stats;
+};
+
+static bool s_stats_enabled(const struct aws_task_scheduler *scheduler) {
+    return STATS_SUPPORTED && scheduler->stats != NULL;
+}
+
+static uint64_t s_stats_now_ns(void) {
+    uint64_t ticks = 0;
+    aws_high_res_clock_get_ticks(&ticks);
+    return ticks;
+}
+
+static size_t s_histogram_bucket(uint64_t value) {
+    size_t bucket = 0;
+#if defined(__GNUC__) || defined(__clang__)
+    bucket = value ? 64 - (size_t)__builtin_clzll(value) : 0;
+#else
+    for (; value; value >>= 1) {
+        bucket++;
+    }
+#endif
+    return bucket < AWS_TASK_SCHEDULER_STATS_HISTOGRAM_SIZE ? bucket : AWS_TASK_SCHEDULER_STATS_HISTOGRAM_SIZE - 1;
+}
+
+static uint64_t s_hash_task_fn(const void *key) {
+    /* Function pointers can't be cast to void *, so hash their bits */
+    uintptr_t bits = 0;
+    memcpy(&bits, key, sizeof(bits) < sizeof(aws_task_fn *) ? sizeof(bits) : sizeof(aws_task_fn *));
+    return aws_hash_ptr((const void *)bits);
+}
+
+static bool s_task_fn_eq(const void *a, const void *b) {
+    return *(aws_task_fn *const *)a == *(aws_task_fn *const *)b;
+}
+
+static struct aws_task_scheduler_stats_impl *s_stats_new(struct aws_allocator *alloc) {
+    struct aws_task_scheduler_stats_impl *stats = aws_mem_acquire(alloc, sizeof(struct aws_task_scheduler_stats_impl));
+    if (!stats) {
+        return NULL;
+    }
+
+    AWS_ZERO_STRUCT(*stats);
+    stats->alloc = alloc;
+    if (aws_hash_table_init(&stats->fn_stats, alloc, 16, s_hash_task_fn, s_task_fn_eq, NULL, NULL)) {
+        aws_mem_release(alloc, stats);
+        return NULL;
+    }
+    return stats;
+}
+
+/* Frees the per-function entries, leaving the table empty */
+static void s_stats_clear_fn_stats(struct aws_task_scheduler_stats_impl *stats) {
+    for (struct aws_hash_iter iter = aws_hash_iter_begin(&stats->fn_stats); !aws_hash_iter_done(&iter);
+         aws_hash_iter_next(&iter)) {
+        aws_mem_release(stats->alloc, iter.element.value);
+    }
+    aws_hash_table_clear(&stats->fn_stats);
+}
+
+static void s_stats_destroy(struct aws_task_scheduler_stats_impl *stats) {
+    s_stats_clear_fn_stats(stats);
+    aws_hash_table_clean_up(&stats->fn_stats);
+    aws_mem_release(stats->alloc, stats);
+}
+
+/* Runs a task, recording its lateness and run time */
+static void s_stats_run_task(
+    struct aws_task_scheduler_stats_impl *stats,
+    struct aws_task *task,
+    enum aws_task_status status,
+    uint64_t current_time) {
+
+    if (status != AWS_TASK_STATUS_RUN_READY) {
+        stats->totals.tasks_canceled++;
+        aws_task_run(task, status);
+        return;
+    }
+
+    /* The task may be rescheduled or freed by its own function, so read it first */
+    aws_task_fn *fn = task->fn;
+    if (task->timestamp && current_time >= task->timestamp) {
+        uint64_t lateness = current_time - task->timestamp;
+        stats->totals.lateness_histogram[s_histogram_bucket(lateness)]++;
+        if (lateness > stats->totals.max_lateness) {
+            stats->totals.max_lateness = lateness;
+        }
+    }
+
+    uint64_t start = s_stats_now_ns();
+    aws_task_run(task, status);
+    uint64_t elapsed = s_stats_now_ns() - start;
+
+    stats->totals.tasks_run++;
+    stats->totals.run_time_histogram[s_histogram_bucket(elapsed)]++;
+    if (elapsed > stats->totals.max_task_ns) {
+        stats->totals.max_task_ns = elapsed;
+    }
+
+    struct aws_hash_element *elem = NULL;
+    aws_hash_table_find(&stats->fn_stats, &fn, &elem);
+    struct aws_task_scheduler_fn_stats *fn_stats = elem ? elem->value : NULL;
+    if (!fn_stats) {
+        /* Running out of memory here only costs this function's counters */
+        fn_stats = aws_mem_acquire(stats->alloc, sizeof(struct aws_task_scheduler_fn_stats));
+        if (!fn_stats) {
+            return;
+        }
+        AWS_ZERO_STRUCT(*fn_stats);
+        fn_stats->fn = fn;
+        if (aws_hash_table_put(&stats->fn_stats, &fn_stats->fn, fn_stats, NULL)) {
+            aws_mem_release(stats->alloc, fn_stats);
+            return;
+        }
+    }
+
+    fn_stats->run_count++;
+    fn_stats->total_ns += elapsed;
+    if (elapsed > fn_stats->max_ns) {
+        fn_stats->max_ns = elapsed;
+    }
+}
+
+static void s_stats_record_run_all(struct aws_task_scheduler_stats_impl *stats, size_t batch_size, uint64_t elapsed) {
+    stats->totals.run_count++;
+    if (batch_size > stats->totals.max_batch_size) {
+        stats->totals.max_batch_size = batch_size;
+    }
+    if (elapsed > stats->totals.max_run_all_ns) {
+        stats->totals.max_run_all_ns = elapsed;
+    }
+}
+
+static size_t s_list_length(const struct aws_linked_list *list) {
+    size_t length = 0;
+    for (struct aws_linked_list_node *node = aws_linked_list_begin(list); node != aws_linked_list_end(list);
+         node = aws_linked_list_next(node)) {
+        length++;
+    }
+    return length;
+}
+
+static size_t s_wheel_count(const struct aws_task_scheduler_wheel *wheel) {
+    size_t count = s_list_length(&wheel->overdue);
+    for (size_t level = 0; level < WHEEL_LEVELS; level++) {
+        for (uint64_t occupied = wheel->occupied[level]; occupied; occupied &= occupied - 1) {
+            count += s_list_length(&wheel->slots[level][s_count_trailing_zeros(occupied)]);
+        }
+    }
+    return count;
+}
+
 static int s_compare_timestamps(const void *a, const void *b) {
     uint64_t a_time = (*(struct aws_task **)a)->timestamp;
     uint64_t b_time = (*(struct aws_task **)b)->timestamp;
     return a_time > b_time; /* min-heap */
 }
 
+/*
+ * The bookkeeping for a task scheduled with slack, kept out of struct aws_task so that its layout doesn't change.
+ * The task's reserved field points here while it waits in the slack queues, and is 0 otherwise.
+ */
+struct slack_node {
+    struct aws_task *task;
+    /* Latest time the task may run */
+    uint64_t deadline;
+    struct aws_priority_queue_node deadline_queue_node;
+};
+
+static struct slack_node *s_slack_node_of(struct aws_task *task) {
+    return (struct slack_node *)(uintptr_t)task->reserved;
+}
+
+static int s_compare_deadlines(const void *a, const void *b) {
+    uint64_t a_time = (*(struct slack_node **)a)->deadline;
+    uint64_t b_time = (*(struct slack_node **)b)->deadline;
+    return a_time > b_time; /* min-heap */
+}
+
 static void s_run_all(struct aws_task_scheduler *scheduler, uint64_t current_time, enum aws_task_status status);
 
 int aws_task_scheduler_init(struct aws_task_scheduler *scheduler, struct aws_allocator *alloc) {
+    return aws_task_scheduler_init_with_options(scheduler, alloc, NULL);
+}
+
+int aws_task_scheduler_init_with_options(
+    struct aws_task_scheduler *scheduler,
+    struct aws_allocator *alloc,
+    const struct aws_task_scheduler_options *options) {
     assert(alloc);
 
+    struct aws_task_scheduler_options default_options;
+    if (!options) {
+        AWS_ZERO_STRUCT(default_options);
+        options = &default_options;
+    }
+
+    if (options->timers != AWS_TASK_SCHEDULER_TIMERS_HEAP && options->timers != AWS_TASK_SCHEDULER_TIMERS_WHEEL) {
+        return aws_raise_error(AWS_ERROR_INVALID_ARGUMENT);
+    }
+
     scheduler->alloc = alloc;
+    scheduler->wheel = NULL;
+    scheduler->stats = NULL;
+    aws_atomic_init_ptr(&scheduler->threadsafe_head, NULL);
+    scheduler->wake_fn = options->wake_fn;
+    scheduler->wake_user_data = options->wake_user_data;
     aws_linked_list_init(&scheduler->timed_list);
     aws_linked_list_init(&scheduler->asap_list);
-    return aws_priority_queue_init_dynamic(
-        &scheduler->timed_queue, alloc, DEFAULT_QUEUE_SIZE, sizeof(struct aws_task *), &s_compare_timestamps);
+
+    if (options->timers == AWS_TASK_SCHEDULER_TIMERS_WHEEL) {
+        struct aws_task_scheduler_wheel *wheel = aws_mem_acquire(alloc, sizeof(struct aws_task_scheduler_wheel));
+        if (!wheel) {
+            return AWS_OP_ERR;
+        }
+
+        AWS_ZERO_STRUCT(*wheel);
+        wheel->resolution = options->wheel_resolution ? options->wheel_resolution : DEFAULT_WHEEL_RESOLUTION;
+        for (size_t level = 0; level < WHEEL_LEVELS; level++) {
+            for (size_t slot = 0; slot < WHEEL_SLOTS; slot++) {
+                aws_linked_list_init(&wheel->slots[level][slot]);
+            }
+        }
+        aws_linked_list_init(&wheel->overdue);
+        scheduler->wheel = wheel;
+    }
+
+    if (aws_priority_queue_init_dynamic(
+            &scheduler->timed_queue, alloc, DEFAULT_QUEUE_SIZE, sizeof(struct aws_task *), &s_compare_timestamps)) {
+        if (scheduler->wheel) {
+            aws_mem_release(alloc, scheduler->wheel);
+            scheduler->wheel = NULL;
+        }
+        return AWS_OP_ERR;
+    }
+
+    /* Most schedulers never see a task with slack, so these don't allocate until one does */
+    aws_priority_queue_init_dynamic(
+        &scheduler->slack_queue, alloc, 0, sizeof(struct aws_task *), &s_compare_timestamps);
+    aws_priority_queue_init_dynamic(
+        &scheduler->slack_deadlines, alloc, 0, sizeof(struct slack_node *), &s_compare_deadlines);
+
+    if (STATS_SUPPORTED && options->enable_stats) {
+        scheduler->stats = s_stats_new(alloc);
+        if (!scheduler->stats) {
+            aws_priority_queue_clean_up(&scheduler->timed_queue);
+            if (scheduler->wheel) {
+                aws_mem_release(alloc, scheduler->wheel);
+                scheduler->wheel = NULL;
+            }
+            return AWS_OP_ERR;
+        }
+    }
+
+    return AWS_OP_SUCCESS;
 }
 
 void aws_task_scheduler_clean_up(struct aws_task_scheduler *scheduler) {
@@ -47,6 +499,16 @@ void aws_task_scheduler_clean_up(struct aws_task_scheduler *scheduler) {
     }
 
     aws_priority_queue_clean_up(&scheduler->timed_queue);
+    aws_priority_queue_clean_up(&scheduler->slack_queue);
+    aws_priority_queue_clean_up(&scheduler->slack_deadlines);
+    if (scheduler->stats) {
+        s_stats_destroy(scheduler->stats);
+        scheduler->stats = NULL;
+    }
+    if (scheduler->wheel) {
+        aws_mem_release(scheduler->alloc, scheduler->wheel);
+        scheduler->wheel = NULL;
+    }
     AWS_ZERO_STRUCT(scheduler);
 }
 
@@ -56,10 +518,14 @@ bool aws_task_scheduler_has_tasks(const struct aws_task_scheduler *scheduler, ui
     uint64_t timestamp = UINT64_MAX;
     bool has_tasks = false;
 
-    if (!aws_linked_list_empty(&scheduler->asap_list)) {
+    if (!aws_linked_list_empty(&scheduler->asap_list) ||
+        aws_atomic_load_ptr_explicit(&scheduler->threadsafe_head, aws_memory_order_relaxed)) {
         timestamp = 0;
         has_tasks = true;
 
+    } else if (scheduler->wheel) {
+        has_tasks = s_wheel_has_tasks(scheduler->wheel, &timestamp);
+
     } else {
         /* Check whether timed_list or timed_queue has the earlier task */
         if (AWS_UNLIKELY(!aws_linked_list_empty(&scheduler->timed_list))) {
@@ -78,6 +544,15 @@ bool aws_task_scheduler_has_tasks(const struct aws_task_scheduler *scheduler, ui
         }
     }
 
+    /* A task with slack holds off the next run only until its deadline */
+    struct slack_node **slack_node_ptrptr = NULL;
+    if (aws_priority_queue_top(&scheduler->slack_deadlines, (void **)&slack_node_ptrptr) == AWS_OP_SUCCESS) {
+        if ((*slack_node_ptrptr)->deadline < timestamp) {
+            timestamp = (*slack_node_ptrptr)->deadline;
+        }
+        has_tasks = true;
+    }
+
     if (next_task_time) {
         *next_task_time = timestamp;
     }
@@ -92,6 +567,7 @@ void aws_task_scheduler_schedule_now(struct aws_task_scheduler *scheduler, struc
     task->priority_queue_node.current_index = SIZE_MAX;
     aws_linked_list_node_reset(&task->node);
     task->timestamp = 0;
+    task->reserved = 0;
 
     aws_linked_list_push_back(&scheduler->asap_list, &task->node);
 }
@@ -109,6 +585,13 @@ void aws_task_scheduler_schedule_future(
 
     task->priority_queue_node.current_index = SIZE_MAX;
     aws_linked_list_node_reset(&task->node);
+    task->reserved = 0;
+
+    if (scheduler->wheel) {
+        s_wheel_insert(scheduler->wheel, task);
+        return;
+    }
+
     int err = aws_priority_queue_push_ref(&scheduler->timed_queue, &task, &task->priority_queue_node);
     if (AWS_UNLIKELY(err)) {
         /* In the (very unlikely) case that we can't push into the timed_queue,
@@ -127,6 +610,123 @@ void aws_task_scheduler_schedule_future(
     }
 }
 
+void aws_task_scheduler_schedule_future_with_slack(
+    struct aws_task_scheduler *scheduler,
+    struct aws_task *task,
+    uint64_t time_to_run,
+    uint64_t slack) {
+
+    assert(scheduler);
+    assert(task);
+    assert(task->fn);
+
+    if (!slack) {
+        aws_task_scheduler_schedule_future(scheduler, task, time_to_run);
+        return;
+    }
+
+    /* Without memory for the slack bookkeeping, the task just loses its slack */
+    struct slack_node *slack_node = aws_mem_acquire(scheduler->alloc, sizeof(struct slack_node));
+    if (AWS_UNLIKELY(!slack_node)) {
+        aws_task_scheduler_schedule_future(scheduler, task, time_to_run);
+        return;
+    }
+    slack_node->task = task;
+    slack_node->deadline = slack > UINT64_MAX - time_to_run ? UINT64_MAX : time_to_run + slack;
+    slack_node->deadline_queue_node.current_index = SIZE_MAX;
+
+    task->timestamp = time_to_run;
+    task->priority_queue_node.current_index = SIZE_MAX;
+    aws_linked_list_node_reset(&task->node);
+
+    int err = aws_priority_queue_push_ref(&scheduler->slack_queue, &task, &task->priority_queue_node);
+    if (AWS_UNLIKELY(err)) {
+        goto no_slack;
+    }
+    err = aws_priority_queue_push_ref(&scheduler->slack_deadlines, &slack_node, &slack_node->deadline_queue_node);
+    if (AWS_UNLIKELY(err)) {
+        aws_priority_queue_remove(&scheduler->slack_queue, &task, &task->priority_queue_node);
+        goto no_slack;
+    }
+    task->reserved = (size_t)(uintptr_t)slack_node;
+    return;
+
+no_slack:
+    aws_mem_release(scheduler->alloc, slack_node);
+    aws_task_scheduler_schedule_future(scheduler, task, time_to_run);
+}
+
+/* Frees the bookkeeping of a task with slack, once it is out of slack_queue */
+static void s_remove_slack(struct aws_task_scheduler *scheduler, struct aws_task *task) {
+    struct slack_node *slack_node = s_slack_node_of(task);
+    aws_priority_queue_remove(&scheduler->slack_deadlines, &slack_node, &slack_node->deadline_queue_node);
+    aws_mem_release(scheduler->alloc, slack_node);
+    task->reserved = 0;
+}
+
+static void s_push_threadsafe(struct aws_task_scheduler *scheduler, struct aws_task *task) {
+    void *head = aws_atomic_load_ptr_explicit(&scheduler->threadsafe_head, aws_memory_order_relaxed);
+    do {
+        task->node.next = head;
+    } while (!aws_atomic_compare_exchange_ptr_explicit(
+        &scheduler->threadsafe_head, &head, &task->node, aws_memory_order_release, aws_memory_order_relaxed));
+
+    /* Only the first submission since the last drain wakes the owner; it will pick up the rest too */
+    if (!head && scheduler->wake_fn) {
+        scheduler->wake_fn(scheduler, scheduler->wake_user_data);
+    }
+}
+
+void aws_task_scheduler_schedule_now_threadsafe(struct aws_task_scheduler *scheduler, struct aws_task *task) {
+    assert(scheduler);
+    assert(task);
+    assert(task->fn);
+
+    task->timestamp = 0;
+    s_push_threadsafe(scheduler, task);
+}
+
+void aws_task_scheduler_schedule_future_threadsafe(
+    struct aws_task_scheduler *scheduler,
+    struct aws_task *task,
+    uint64_t time_to_run) {
+
+    assert(scheduler);
+    assert(task);
+    assert(task->fn);
+
+    task->timestamp = time_to_run;
+    s_push_threadsafe(scheduler, task);
+}
+
+/* Moves tasks submitted from other threads into the scheduler, in the order they were submitted */
+static void s_drain_threadsafe(struct aws_task_scheduler *scheduler) {
+    if (!aws_atomic_load_ptr_explicit(&scheduler->threadsafe_head, aws_memory_order_relaxed)) {
+        return;
+    }
+
+    struct aws_linked_list_node *node =
+        aws_atomic_exchange_ptr_explicit(&scheduler->threadsafe_head, NULL, aws_memory_order_acquire);
+
+    struct aws_linked_list_node *oldest_first = NULL;
+    while (node) {
+        struct aws_linked_list_node *next = node->next;
+        node->next = oldest_first;
+        oldest_first = node;
+        node = next;
+    }
+
+    while (oldest_first) {
+        struct aws_task *task = AWS_CONTAINER_OF(oldest_first, struct aws_task, node);
+        oldest_first = oldest_first->next;
+        if (task->timestamp) {
+            aws_task_scheduler_schedule_future(scheduler, task, task->timestamp);
+        } else {
+            aws_task_scheduler_schedule_now(scheduler, task);
+        }
+    }
+}
+
 void aws_task_scheduler_run_all(struct aws_task_scheduler *scheduler, uint64_t current_time) {
     assert(scheduler);
 
@@ -141,9 +741,15 @@ static void s_run_all(struct aws_task_scheduler *scheduler, uint64_t current_tim
     struct aws_linked_list running_list;
     aws_linked_list_init(&running_list);
 
+    s_drain_threadsafe(scheduler);
+
     /* First move everything from asap_list */
     aws_linked_list_swap_contents(&running_list, &scheduler->asap_list);
 
+    if (scheduler->wheel) {
+        s_wheel_take_due_tasks(scheduler->wheel, current_time, &running_list);
+    }
+
     /* Next move tasks from timed_queue and timed_list, based on whichever's next-task is sooner.
      * It's very unlikely that any tasks are in timed_list, so once it has no more valid tasks,
      * break out of this complex loop in favor of a simpler one. */
@@ -187,7 +793,35 @@ static void s_run_all(struct aws_task_scheduler *scheduler, uint64_t current_tim
         aws_linked_list_push_back(&running_list, &next_timed_task->node);
     }
 
+    /* Then every task with slack whose window has opened, due or not, so that it shares this run */
+    struct aws_task **slack_task_ptrptr = NULL;
+    while (aws_priority_queue_top(&scheduler->slack_queue, (void **)&slack_task_ptrptr) == AWS_OP_SUCCESS) {
+        if ((*slack_task_ptrptr)->timestamp > current_time) {
+            break;
+        }
+
+        struct aws_task *slack_task;
+        aws_priority_queue_pop(&scheduler->slack_queue, &slack_task);
+        s_remove_slack(scheduler, slack_task);
+        aws_linked_list_push_back(&running_list, &slack_task->node);
+    }
+
     /* Run tasks */
+    if (s_stats_enabled(scheduler)) {
+        uint64_t start = s_stats_now_ns();
+        size_t batch_size = 0;
+        while (!aws_linked_list_empty(&running_list)) {
+            struct aws_linked_list_node *task_node = aws_linked_list_pop_front(&running_list);
+            struct aws_task *task = AWS_CONTAINER_OF(task_node, struct aws_task, node);
+            s_stats_run_task(scheduler->stats, task, status, current_time);
+            batch_size++;
+        }
+        if (status == AWS_TASK_STATUS_RUN_READY) {
+            s_stats_record_run_all(scheduler->stats, batch_size, s_stats_now_ns() - start);
+        }
+        return;
+    }
+
     while (!aws_linked_list_empty(&running_list)) {
         struct aws_linked_list_node *task_node = aws_linked_list_pop_front(&running_list);
         struct aws_task *task = AWS_CONTAINER_OF(task_node, struct aws_task, node);
@@ -196,13 +830,101 @@ static void s_run_all(struct aws_task_scheduler *scheduler, uint64_t current_tim
 }
 
 void aws_task_scheduler_cancel_task(struct aws_task_scheduler *scheduler, struct aws_task *task) {
+    /* the task may still be waiting in the threadsafe queue, where it can't be unlinked */
+    s_drain_threadsafe(scheduler);
+
     /* attempt the linked lists first since those will be faster access and more likely to occur
      * anyways.
      */
     if (task->node.next) {
         aws_linked_list_remove(&task->node);
+    } else if (task->reserved) {
+        aws_priority_queue_remove(&scheduler->slack_queue, &task, &task->priority_queue_node);
+        s_remove_slack(scheduler, task);
     } else {
         aws_priority_queue_remove(&scheduler->timed_queue, &task, &task->priority_queue_node);
     }
+
+    if (s_stats_enabled(scheduler)) {
+        scheduler->stats->totals.tasks_canceled++;
+    }
     aws_task_run(task, AWS_TASK_STATUS_CANCELED);
 }
+
+int aws_task_scheduler_get_stats(const struct aws_task_scheduler *scheduler, struct aws_task_scheduler_stats *stats) {
+    assert(scheduler);
+    assert(stats);
+
+    if (!s_stats_enabled(scheduler)) {
+        return aws_raise_error(AWS_ERROR_UNSUPPORTED_OPERATION);
+    }
+
+    *stats = scheduler->stats->totals;
+    stats->asap_count = s_list_length(&scheduler->asap_list);
+    stats->timed_count = aws_priority_queue_size(&scheduler->timed_queue) + s_list_length(&scheduler->timed_list) +
+                         aws_priority_queue_size(&scheduler->slack_queue);
+    if (scheduler->wheel) {
+        stats->timed_count += s_wheel_count(scheduler->wheel);
+    }
+    return AWS_OP_SUCCESS;
+}
+
+static int s_compare_fn_stats_by_total(const void *a, const void *b) {
+    uint64_t a_total = (*(struct aws_task_scheduler_fn_stats *const *)a)->total_ns;
+    uint64_t b_total = (*(struct aws_task_scheduler_fn_stats *const *)b)->total_ns;
+    return a_total < b_total ? 1 : a_total > b_total ? -1 : 0;
+}
+
+int aws_task_scheduler_get_fn_stats(
+    const struct aws_task_scheduler *scheduler,
+    struct aws_task_scheduler_fn_stats *fn_stats,
+    size_t capacity,
+    size_t *count) {
+
+    assert(scheduler);
+    assert(count);
+
+    if (!s_stats_enabled(scheduler)) {
+        return aws_raise_error(AWS_ERROR_UNSUPPORTED_OPERATION);
+    }
+
+    /* Sort pointers to the entries, then copy the first capacity of them */
+    size_t entry_count = aws_hash_table_get_entry_count(&scheduler->stats->fn_stats);
+    struct aws_task_scheduler_fn_stats **sorted = NULL;
+    if (entry_count) {
+        sorted = aws_mem_acquire(scheduler->alloc, sizeof(struct aws_task_scheduler_fn_stats *) * entry_count);
+        if (!sorted) {
+            return AWS_OP_ERR;
+        }
+    }
+
+    size_t i = 0;
+    for (struct aws_hash_iter iter = aws_hash_iter_begin(&scheduler->stats->fn_stats); !aws_hash_iter_done(&iter);
+         aws_hash_iter_next(&iter)) {
+        sorted[i++] = iter.element.value;
+    }
+    if (entry_count > 1) {
+        qsort(sorted, entry_count, sizeof(struct aws_task_scheduler_fn_stats *), s_compare_fn_stats_by_total);
+    }
+
+    *count = entry_count < capacity ? entry_count : capacity;
+    for (i = 0; i < *count; i++) {
+        fn_stats[i] = *sorted[i];
+    }
+
+    if (sorted) {
+        aws_mem_release(scheduler->alloc, sorted);
+    }
+    return AWS_OP_SUCCESS;
+}
+
+void aws_task_scheduler_reset_stats(struct aws_task_scheduler *scheduler) {
+    assert(scheduler);
+
+    if (!s_stats_enabled(scheduler)) {
+        return;
+    }
+
+    AWS_ZERO_STRUCT(scheduler->stats->totals);
+    s_stats_clear_fn_stats(scheduler->stats);
+}
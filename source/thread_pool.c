@@ -0,0 +1,448 @@
+/*
+ * Copyright 2010-2018 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *  http://aws.amazon.com/apache2.0
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+#include <aws/common/thread_pool.h>
+
+#include <aws/common/atomics.h>
+#include <aws/common/condition_variable.h>
+#include <aws/common/math.h>
+#include <aws/common/mutex.h>
+#include <aws/common/system_info.h>
+#include <aws/common/thread.h>
+
+#include <assert.h>
+
+/*
+ * The deques follow Lê, Pop, Cohen and Zappa Nardelli, "Correct and Efficient Work-Stealing for Weak Memory Models",
+ * with a fixed-size ring: the owner pushes and pops at the bottom, thieves take from the top by compare-and-swap,
+ * and the owner only races a thief for the very last task. top and bottom are accessed with sequentially consistent
+ * operations where that paper uses fences.
+ *
+ * Parking avoids lost wake-ups Dekker style: a worker counts itself in sleepers before its last look for work, and a
+ * submitter publishes its task before checking sleepers, so either the worker sees the task or the submitter sees
+ * the worker and signals it, under the lock the worker waits with.
+ */
+
+#define DEFAULT_DEQUE_CAPACITY 1024
+/* Rounds of looking for work before a worker parks */
+#define IDLE_ROUNDS_BEFORE_PARKING 16
+/* Most tasks a worker moves from the shared queue to its deque at once, where others can steal them */
+#define SHARED_QUEUE_BATCH 32
+
+struct thread_pool_impl;
+
+struct thread_pool_worker {
+    /* Index of the oldest task in the deque; thieves advance it */
+    struct aws_atomic_var top;
+    uint8_t top_padding[AWS_CACHE_LINE - sizeof(struct aws_atomic_var)];
+    /* One past the index of the newest task; only the owner moves it */
+    struct aws_atomic_var bottom;
+    /* mask + 1 slots, each a struct aws_task * */
+    struct aws_atomic_var *slots;
+    size_t mask;
+    struct thread_pool_impl *pool;
+    struct aws_thread thread;
+    uint64_t rand_state;
+};
+
+/* Workers are laid out a whole number of cache lines apart, so that deques don't share lines */
+#define WORKER_STRIDE ((sizeof(struct thread_pool_worker) + AWS_CACHE_LINE - 1) & ~(size_t)(AWS_CACHE_LINE - 1))
+
+struct thread_pool_impl {
+    struct aws_allocator *alloc;
+    size_t worker_count;
+    /* Both cache line aligned, so that no two workers' deques share a line */
+    struct thread_pool_worker *workers;
+    struct aws_atomic_var *slots;
+
+    struct aws_mutex lock;
+    struct aws_condition_variable wakeup;
+    /* Guarded by lock */
+    struct aws_linked_list shared_queue;
+    size_t shared_count;
+    /* shared_count, for checking without the lock */
+    struct aws_atomic_var shared_hint;
+    /* Workers which are parked, or about to be */
+    struct aws_atomic_var sleepers;
+    struct aws_atomic_var shutting_down;
+};
+
+/* The worker running on this thread, if any */
+static AWS_THREAD_LOCAL struct thread_pool_worker *tl_worker = NULL;
+
+static struct thread_pool_worker *s_worker_at(const struct thread_pool_impl *impl, size_t index) {
+    return (struct thread_pool_worker *)((uint8_t *)impl->workers + index * WORKER_STRIDE);
+}
+
+/* Indices only grow, so compare them by signed difference, which stays correct if they wrap */
+static intptr_t s_index_diff(size_t a, size_t b) {
+    return (intptr_t)(a - b);
+}
+
+static bool s_deque_push(struct thread_pool_worker *worker, struct aws_task *task) {
+    size_t bottom = aws_atomic_load_int_explicit(&worker->bottom, aws_memory_order_relaxed);
+    size_t top = aws_atomic_load_int_explicit(&worker->top, aws_memory_order_acquire);
+    if (s_index_diff(bottom, top) > (intptr_t)worker->mask) {
+        return false;
+    }
+
+    aws_atomic_store_ptr_explicit(&worker->slots[bottom & worker->mask], task, aws_memory_order_relaxed);
+    aws_atomic_store_int(&worker->bottom, bottom + 1);
+    return true;
+}
+
+static struct aws_task *s_deque_pop(struct thread_pool_worker *worker) {
+    size_t bottom = aws_atomic_load_int_explicit(&worker->bottom, aws_memory_order_relaxed) - 1;
+    aws_atomic_store_int(&worker->bottom, bottom);
+    size_t top = aws_atomic_load_int(&worker->top);
+
+    if (s_index_diff(bottom, top) < 0) {
+        aws_atomic_store_int_explicit(&worker->bottom, bottom + 1, aws_memory_order_relaxed);
+        return NULL;
+    }
+
+    struct aws_task *task =
+        aws_atomic_load_ptr_explicit(&worker->slots[bottom & worker->mask], aws_memory_order_relaxed);
+    if (bottom != top) {
+        return task;
+    }
+
+    /* The last task: whoever moves top past it gets it */
+    if (!aws_atomic_compare_exchange_int(&worker->top, &top, top + 1)) {
+        task = NULL;
+    }
+    aws_atomic_store_int_explicit(&worker->bottom, bottom + 1, aws_memory_order_relaxed);
+    return task;
+}
+
+/* Takes the oldest task from another worker's deque. *contended is set if a task was there but another thief won it. */
+static struct aws_task *s_deque_steal(struct thread_pool_worker *victim, bool *contended) {
+    size_t top = aws_atomic_load_int(&victim->top);
+    size_t bottom = aws_atomic_load_int(&victim->bottom);
+    if (s_index_diff(bottom, top) <= 0) {
+        return NULL;
+    }
+
+    struct aws_task *task = aws_atomic_load_ptr_explicit(&victim->slots[top & victim->mask], aws_memory_order_relaxed);
+    if (!aws_atomic_compare_exchange_int(&victim->top, &top, top + 1)) {
+        *contended = true;
+        return NULL;
+    }
+    return task;
+}
+
+static bool s_deque_empty(struct thread_pool_worker *worker) {
+    size_t top = aws_atomic_load_int(&worker->top);
+    size_t bottom = aws_atomic_load_int(&worker->bottom);
+    return s_index_diff(bottom, top) <= 0;
+}
+
+/* Must be called with the lock held */
+static bool s_has_work(struct thread_pool_impl *impl) {
+    if (impl->shared_count || aws_atomic_load_int(&impl->shutting_down)) {
+        return true;
+    }
+    for (size_t i = 0; i < impl->worker_count; i++) {
+        if (!s_deque_empty(s_worker_at(impl, i))) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static void s_wake_one(struct thread_pool_impl *impl) {
+    if (aws_atomic_load_int(&impl->sleepers)) {
+        aws_mutex_lock(&impl->lock);
+        aws_condition_variable_notify_one(&impl->wakeup);
+        aws_mutex_unlock(&impl->lock);
+    }
+}
+
+/* Takes a task from the shared queue, and moves a batch more to the worker's deque where others can steal them */
+static struct aws_task *s_take_shared(struct thread_pool_impl *impl, struct thread_pool_worker *worker) {
+    if (!aws_atomic_load_int_explicit(&impl->shared_hint, aws_memory_order_relaxed)) {
+        return NULL;
+    }
+
+    aws_mutex_lock(&impl->lock);
+    struct aws_task *task = NULL;
+    if (impl->shared_count) {
+        task = AWS_CONTAINER_OF(aws_linked_list_pop_front(&impl->shared_queue), struct aws_task, node);
+        impl->shared_count--;
+
+        size_t batch = impl->shared_count / impl->worker_count;
+        if (batch > SHARED_QUEUE_BATCH) {
+            batch = SHARED_QUEUE_BATCH;
+        }
+        for (; batch; batch--) {
+            struct aws_linked_list_node *node = aws_linked_list_pop_front(&impl->shared_queue);
+            if (!s_deque_push(worker, AWS_CONTAINER_OF(node, struct aws_task, node))) {
+                aws_linked_list_push_front(&impl->shared_queue, node);
+                break;
+            }
+            impl->shared_count--;
+        }
+        aws_atomic_store_int_explicit(&impl->shared_hint, impl->shared_count, aws_memory_order_relaxed);
+
+        if (impl->shared_count || !s_deque_empty(worker)) {
+            aws_condition_variable_notify_one(&impl->wakeup);
+        }
+    }
+    aws_mutex_unlock(&impl->lock);
+
+    return task;
+}
+
+static struct aws_task *s_steal_any(struct thread_pool_impl *impl, struct thread_pool_worker *thief) {
+    thief->rand_state = thief->rand_state * 6364136223846793005ULL + 1442695040888963407ULL;
+    size_t start = (size_t)(thief->rand_state >> 33) % impl->worker_count;
+
+    bool contended = false;
+    do {
+        contended = false;
+        for (size_t i = 0; i < impl->worker_count; i++) {
+            struct thread_pool_worker *victim = s_worker_at(impl, (start + i) % impl->worker_count);
+            if (victim == thief) {
+                continue;
+            }
+            struct aws_task *task = s_deque_steal(victim, &contended);
+            if (task) {
+                return task;
+            }
+        }
+    } while (contended);
+
+    return NULL;
+}
+
+static void s_park(struct thread_pool_impl *impl) {
+    aws_mutex_lock(&impl->lock);
+    aws_atomic_fetch_add(&impl->sleepers, 1);
+    while (!s_has_work(impl)) {
+        aws_condition_variable_wait(&impl->wakeup, &impl->lock);
+    }
+    aws_atomic_fetch_sub(&impl->sleepers, 1);
+    aws_mutex_unlock(&impl->lock);
+}
+
+static void s_worker_main(void *arg) {
+    struct thread_pool_worker *worker = arg;
+    struct thread_pool_impl *impl = worker->pool;
+    tl_worker = worker;
+
+    size_t idle_rounds = 0;
+    while (!aws_atomic_load_int_explicit(&impl->shutting_down, aws_memory_order_relaxed)) {
+        struct aws_task *task = s_deque_pop(worker);
+        if (!task) {
+            task = s_take_shared(impl, worker);
+        }
+        if (!task) {
+            task = s_steal_any(impl, worker);
+        }
+
+        if (task) {
+            idle_rounds = 0;
+            aws_task_run(task, AWS_TASK_STATUS_RUN_READY);
+        } else if (++idle_rounds >= IDLE_ROUNDS_BEFORE_PARKING) {
+            idle_rounds = 0;
+            s_park(impl);
+        }
+    }
+
+    tl_worker = NULL;
+}
+
+/* Runs every task which never started as canceled, once the workers have exited */
+static void s_cancel_remaining(struct thread_pool_impl *impl) {
+    bool canceled_any = true;
+    while (canceled_any) {
+        canceled_any = false;
+        for (size_t i = 0; i < impl->worker_count; i++) {
+            struct aws_task *task = NULL;
+            while ((task = s_deque_pop(s_worker_at(impl, i)))) {
+                aws_task_run(task, AWS_TASK_STATUS_CANCELED);
+                canceled_any = true;
+            }
+        }
+
+        /* Canceled tasks may submit more, which land on the shared queue */
+        aws_mutex_lock(&impl->lock);
+        struct aws_linked_list canceled;
+        aws_linked_list_init(&canceled);
+        aws_linked_list_swap_contents(&canceled, &impl->shared_queue);
+        impl->shared_count = 0;
+        aws_mutex_unlock(&impl->lock);
+
+        while (!aws_linked_list_empty(&canceled)) {
+            struct aws_task *task = AWS_CONTAINER_OF(aws_linked_list_pop_front(&canceled), struct aws_task, node);
+            aws_task_run(task, AWS_TASK_STATUS_CANCELED);
+            canceled_any = true;
+        }
+    }
+}
+
+static void s_destroy_impl(struct thread_pool_impl *impl) {
+    aws_condition_variable_clean_up(&impl->wakeup);
+    aws_mutex_clean_up(&impl->lock);
+    aws_mem_release_aligned(impl->alloc, impl->slots);
+    aws_mem_release_aligned(impl->alloc, impl->workers);
+    aws_mem_release(impl->alloc, impl);
+}
+
+/* Stops and joins the first launched workers */
+static void s_stop_workers(struct thread_pool_impl *impl, size_t launched) {
+    aws_atomic_store_int(&impl->shutting_down, 1);
+    aws_mutex_lock(&impl->lock);
+    aws_condition_variable_notify_all(&impl->wakeup);
+    aws_mutex_unlock(&impl->lock);
+
+    for (size_t i = 0; i < launched; i++) {
+        struct thread_pool_worker *worker = s_worker_at(impl, i);
+        aws_thread_join(&worker->thread);
+        aws_thread_clean_up(&worker->thread);
+    }
+}
+
+int aws_thread_pool_init(
+    struct aws_thread_pool *pool,
+    struct aws_allocator *allocator,
+    const struct aws_thread_pool_options *options) {
+    assert(allocator);
+
+    struct aws_thread_pool_options default_options;
+    if (!options) {
+        AWS_ZERO_STRUCT(default_options);
+        options = &default_options;
+    }
+
+    AWS_ZERO_STRUCT(*pool);
+
+    size_t worker_count = options->worker_count ? options->worker_count : aws_system_info_processor_count();
+    if (worker_count == 0) {
+        worker_count = 1;
+    }
+
+    size_t requested_capacity = options->deque_capacity ? options->deque_capacity : DEFAULT_DEQUE_CAPACITY;
+    size_t capacity = 1;
+    while (capacity < requested_capacity) {
+        if (capacity > SIZE_MAX / 4) {
+            return aws_raise_error(AWS_ERROR_INVALID_ARGUMENT);
+        }
+        capacity <<= 1;
+    }
+
+    struct thread_pool_impl *impl = aws_mem_acquire(allocator, sizeof(struct thread_pool_impl));
+    if (!impl) {
+        return AWS_OP_ERR;
+    }
+    AWS_ZERO_STRUCT(*impl);
+    impl->alloc = allocator;
+    impl->worker_count = worker_count;
+    aws_linked_list_init(&impl->shared_queue);
+    aws_atomic_init_int(&impl->shared_hint, 0);
+    aws_atomic_init_int(&impl->sleepers, 0);
+    aws_atomic_init_int(&impl->shutting_down, 0);
+
+    size_t workers_size = aws_mul_size_saturating(worker_count, WORKER_STRIDE);
+    size_t slots_size =
+        aws_mul_size_saturating(aws_mul_size_saturating(worker_count, capacity), sizeof(struct aws_atomic_var));
+    if (workers_size == SIZE_MAX || slots_size == SIZE_MAX) {
+        aws_mem_release(allocator, impl);
+        return aws_raise_error(AWS_ERROR_OOM);
+    }
+
+    impl->workers = aws_mem_acquire_aligned(allocator, AWS_CACHE_LINE, workers_size);
+    impl->slots = aws_mem_acquire_aligned(allocator, AWS_CACHE_LINE, slots_size);
+    if (!impl->workers || !impl->slots || aws_mutex_init(&impl->lock)) {
+        goto error_free;
+    }
+    if (aws_condition_variable_init(&impl->wakeup)) {
+        aws_mutex_clean_up(&impl->lock);
+        goto error_free;
+    }
+
+    for (size_t i = 0; i < worker_count; i++) {
+        struct thread_pool_worker *worker = s_worker_at(impl, i);
+        AWS_ZERO_STRUCT(*worker);
+        aws_atomic_init_int(&worker->top, 0);
+        aws_atomic_init_int(&worker->bottom, 0);
+        worker->slots = impl->slots + i * capacity;
+        worker->mask = capacity - 1;
+        worker->pool = impl;
+        worker->rand_state = i + 1;
+        for (size_t s = 0; s < capacity; s++) {
+            aws_atomic_init_ptr(&worker->slots[s], NULL);
+        }
+    }
+
+    for (size_t i = 0; i < worker_count; i++) {
+        struct thread_pool_worker *worker = s_worker_at(impl, i);
+        if (aws_thread_init(&worker->thread, allocator) ||
+            aws_thread_launch(&worker->thread, s_worker_main, worker, NULL)) {
+            int error_code = aws_last_error();
+            aws_thread_clean_up(&worker->thread);
+            s_stop_workers(impl, i);
+            s_destroy_impl(impl);
+            return aws_raise_error(error_code);
+        }
+    }
+
+    pool->p_impl = impl;
+    return AWS_OP_SUCCESS;
+
+error_free:
+    aws_mem_release_aligned(allocator, impl->slots);
+    aws_mem_release_aligned(allocator, impl->workers);
+    aws_mem_release(allocator, impl);
+    return AWS_OP_ERR;
+}
+
+void aws_thread_pool_clean_up(struct aws_thread_pool *pool) {
+    struct thread_pool_impl *impl = pool->p_impl;
+    if (!impl) {
+        return;
+    }
+    assert(!tl_worker || tl_worker->pool != impl);
+
+    s_stop_workers(impl, impl->worker_count);
+    s_cancel_remaining(impl);
+    s_destroy_impl(impl);
+    pool->p_impl = NULL;
+}
+
+void aws_thread_pool_submit(struct aws_thread_pool *pool, struct aws_task *task) {
+    struct thread_pool_impl *impl = pool->p_impl;
+    assert(task->fn);
+
+    /* From one of our own workers, the task goes on its deque, and stays local unless someone idle steals it */
+    if (tl_worker && tl_worker->pool == impl && s_deque_push(tl_worker, task)) {
+        s_wake_one(impl);
+        return;
+    }
+
+    aws_linked_list_node_reset(&task->node);
+    aws_mutex_lock(&impl->lock);
+    aws_linked_list_push_back(&impl->shared_queue, &task->node);
+    impl->shared_count++;
+    aws_atomic_store_int_explicit(&impl->shared_hint, impl->shared_count, aws_memory_order_relaxed);
+    if (aws_atomic_load_int(&impl->sleepers)) {
+        aws_condition_variable_notify_one(&impl->wakeup);
+    }
+    aws_mutex_unlock(&impl->lock);
+}
+
+size_t aws_thread_pool_get_worker_count(const struct aws_thread_pool *pool) {
+    const struct thread_pool_impl *impl = pool->p_impl;
+    return impl->worker_count;
+}
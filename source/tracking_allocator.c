@@ -0,0 +1,351 @@
+/*
+ * Copyright 2010-2018 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *  http://aws.amazon.com/apache2.0
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+#include <aws/common/tracking_allocator.h>
+
+#include <aws/common/atomics.h>
+#include <aws/common/hash_table.h>
+#include <aws/common/mutex.h>
+#include <aws/common/system_info.h>
+
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define DEFAULT_MAX_CALL_SITES 256
+
+/* Precedes every allocation. Two pointers in size, so the parent's alignment carries over. */
+struct tracking_header {
+    size_t size;
+    /* The call site the allocation was sampled from, or NULL */
+    struct aws_tracking_allocator_call_site *site;
+};
+
+#define HEADER_SIZE sizeof(struct tracking_header)
+
+struct tracking_impl {
+    struct aws_allocator allocator;
+    struct aws_allocator *parent;
+    const char *tag;
+
+    struct aws_atomic_var live_bytes;
+    struct aws_atomic_var live_allocations;
+    struct aws_atomic_var peak_bytes;
+    struct aws_atomic_var total_allocations;
+    struct aws_atomic_var total_bytes;
+    struct aws_atomic_var dropped_samples;
+    struct aws_atomic_var sample_counter;
+
+    /* 0 if call sites aren't recorded */
+    size_t sample_interval;
+    size_t frame_count;
+    size_t max_call_sites;
+    /* Guards call_sites, and the counts in the sites it holds */
+    struct aws_mutex call_sites_lock;
+    /* Keys and values are the same struct aws_tracking_allocator_call_site *, owned by the table */
+    struct aws_hash_table call_sites;
+};
+
+static uint64_t s_hash_call_site(const void *key) {
+    const struct aws_tracking_allocator_call_site *site = key;
+    return aws_hash_wide_bytes(site->frames, sizeof(void *) * site->frame_count, 0);
+}
+
+static bool s_call_site_eq(const void *a, const void *b) {
+    const struct aws_tracking_allocator_call_site *site_a = a;
+    const struct aws_tracking_allocator_call_site *site_b = b;
+    return site_a->frame_count == site_b->frame_count &&
+           !memcmp(site_a->frames, site_b->frames, sizeof(void *) * site_a->frame_count);
+}
+
+static void s_raise_peak(struct tracking_impl *impl, size_t live_bytes) {
+    size_t peak = aws_atomic_load_int_explicit(&impl->peak_bytes, aws_memory_order_relaxed);
+    while (live_bytes > peak && !aws_atomic_compare_exchange_int_explicit(
+                                    &impl->peak_bytes,
+                                    &peak,
+                                    live_bytes,
+                                    aws_memory_order_relaxed,
+                                    aws_memory_order_relaxed)) {
+    }
+}
+
+static void s_count_acquire(struct tracking_impl *impl, size_t size) {
+    size_t live_bytes = aws_atomic_fetch_add_explicit(&impl->live_bytes, size, aws_memory_order_relaxed) + size;
+    s_raise_peak(impl, live_bytes);
+    aws_atomic_fetch_add_explicit(&impl->live_allocations, 1, aws_memory_order_relaxed);
+    aws_atomic_fetch_add_explicit(&impl->total_allocations, 1, aws_memory_order_relaxed);
+    aws_atomic_fetch_add_explicit(&impl->total_bytes, size, aws_memory_order_relaxed);
+}
+
+static void s_count_release(struct tracking_impl *impl, size_t size) {
+    aws_atomic_fetch_sub_explicit(&impl->live_bytes, size, aws_memory_order_relaxed);
+    aws_atomic_fetch_sub_explicit(&impl->live_allocations, 1, aws_memory_order_relaxed);
+}
+
+/* Returns the call site to attribute this allocation to, if it's sampled, having counted it there */
+static struct aws_tracking_allocator_call_site *s_sample_call_site(struct tracking_impl *impl, size_t size) {
+    if (!impl->sample_interval ||
+        aws_atomic_fetch_add_explicit(&impl->sample_counter, 1, aws_memory_order_relaxed) % impl->sample_interval) {
+        return NULL;
+    }
+
+    struct aws_tracking_allocator_call_site key;
+    AWS_ZERO_STRUCT(key);
+    key.frame_count = aws_backtrace(key.frames, impl->frame_count);
+
+    aws_mutex_lock(&impl->call_sites_lock);
+    struct aws_tracking_allocator_call_site *site = NULL;
+    struct aws_hash_element *elem = NULL;
+    aws_hash_table_find(&impl->call_sites, &key, &elem);
+    if (elem) {
+        site = elem->value;
+    } else if (aws_hash_table_get_entry_count(&impl->call_sites) < impl->max_call_sites) {
+        site = aws_mem_acquire(impl->parent, sizeof(struct aws_tracking_allocator_call_site));
+        if (site) {
+            *site = key;
+            if (aws_hash_table_put(&impl->call_sites, site, site, NULL)) {
+                aws_mem_release(impl->parent, site);
+                site = NULL;
+            }
+        }
+    }
+
+    if (site) {
+        site->live_bytes += size;
+        site->live_allocations++;
+        site->total_allocations++;
+    } else {
+        aws_atomic_fetch_add_explicit(&impl->dropped_samples, 1, aws_memory_order_relaxed);
+    }
+    aws_mutex_unlock(&impl->call_sites_lock);
+    return site;
+}
+
+static void s_unsample_call_site(
+    struct tracking_impl *impl,
+    struct aws_tracking_allocator_call_site *site,
+    size_t size) {
+
+    aws_mutex_lock(&impl->call_sites_lock);
+    site->live_bytes -= size;
+    site->live_allocations--;
+    aws_mutex_unlock(&impl->call_sites_lock);
+}
+
+static void *s_tracking_acquire(struct aws_allocator *allocator, size_t size) {
+    struct tracking_impl *impl = allocator->impl;
+
+    if (size > SIZE_MAX - HEADER_SIZE) {
+        return NULL;
+    }
+    struct tracking_header *header = aws_mem_acquire(impl->parent, HEADER_SIZE + size);
+    if (!header) {
+        return NULL;
+    }
+
+    header->size = size;
+    header->site = s_sample_call_site(impl, size);
+    s_count_acquire(impl, size);
+    return (uint8_t *)header + HEADER_SIZE;
+}
+
+static void s_tracking_release(struct aws_allocator *allocator, void *ptr) {
+    struct tracking_impl *impl = allocator->impl;
+    if (!ptr) {
+        return;
+    }
+
+    struct tracking_header *header = (struct tracking_header *)((uint8_t *)ptr - HEADER_SIZE);
+    if (header->site) {
+        s_unsample_call_site(impl, header->site, header->size);
+    }
+    s_count_release(impl, header->size);
+    aws_mem_release(impl->parent, header);
+}
+
+static void *s_tracking_realloc(struct aws_allocator *allocator, void *oldptr, size_t oldsize, size_t newsize) {
+    struct tracking_impl *impl = allocator->impl;
+    (void)oldsize;
+
+    if (!oldptr) {
+        return s_tracking_acquire(allocator, newsize);
+    }
+    if (newsize > SIZE_MAX - HEADER_SIZE) {
+        return NULL;
+    }
+
+    /* The header knows the true old size, whatever the caller passed */
+    void *block = (uint8_t *)oldptr - HEADER_SIZE;
+    size_t size = ((struct tracking_header *)block)->size;
+    if (aws_mem_realloc(impl->parent, &block, HEADER_SIZE + size, HEADER_SIZE + newsize)) {
+        return NULL;
+    }
+
+    struct tracking_header *header = block;
+    header->size = newsize;
+    if (newsize > size) {
+        size_t growth = newsize - size;
+        size_t live_bytes =
+            aws_atomic_fetch_add_explicit(&impl->live_bytes, growth, aws_memory_order_relaxed) + growth;
+        s_raise_peak(impl, live_bytes);
+        aws_atomic_fetch_add_explicit(&impl->total_bytes, growth, aws_memory_order_relaxed);
+    } else {
+        aws_atomic_fetch_sub_explicit(&impl->live_bytes, size - newsize, aws_memory_order_relaxed);
+    }
+
+    if (header->site) {
+        aws_mutex_lock(&impl->call_sites_lock);
+        header->site->live_bytes = header->site->live_bytes - size + newsize;
+        aws_mutex_unlock(&impl->call_sites_lock);
+    }
+    return (uint8_t *)header + HEADER_SIZE;
+}
+
+struct aws_allocator *aws_tracking_allocator_new(
+    struct aws_allocator *parent,
+    const struct aws_tracking_allocator_options *options) {
+    assert(parent);
+    assert(options);
+
+    struct tracking_impl *impl = aws_mem_acquire(parent, sizeof(struct tracking_impl));
+    if (!impl) {
+        return NULL;
+    }
+    AWS_ZERO_STRUCT(*impl);
+    impl->allocator.mem_acquire = s_tracking_acquire;
+    impl->allocator.mem_release = s_tracking_release;
+    impl->allocator.mem_realloc = s_tracking_realloc;
+    impl->allocator.impl = impl;
+    impl->parent = parent;
+    impl->tag = options->tag;
+
+    aws_atomic_init_int(&impl->live_bytes, 0);
+    aws_atomic_init_int(&impl->live_allocations, 0);
+    aws_atomic_init_int(&impl->peak_bytes, 0);
+    aws_atomic_init_int(&impl->total_allocations, 0);
+    aws_atomic_init_int(&impl->total_bytes, 0);
+    aws_atomic_init_int(&impl->dropped_samples, 0);
+    aws_atomic_init_int(&impl->sample_counter, 0);
+
+    impl->frame_count = options->call_site_frames;
+    if (!impl->frame_count || impl->frame_count > AWS_TRACKING_ALLOCATOR_MAX_FRAMES) {
+        impl->frame_count = AWS_TRACKING_ALLOCATOR_MAX_FRAMES;
+    }
+    impl->max_call_sites = options->max_call_sites ? options->max_call_sites : DEFAULT_MAX_CALL_SITES;
+
+    /* Leave call sites off where there's no way to walk the stack */
+    void *probe[1];
+    if (options->call_site_sample_interval && aws_backtrace(probe, 1)) {
+        impl->sample_interval = options->call_site_sample_interval;
+    }
+
+    if (aws_mutex_init(&impl->call_sites_lock)) {
+        goto cleanup_impl;
+    }
+    if (aws_hash_table_init(&impl->call_sites, parent, 16, s_hash_call_site, s_call_site_eq, NULL, NULL)) {
+        goto cleanup_mutex;
+    }
+
+    return &impl->allocator;
+
+cleanup_mutex:
+    aws_mutex_clean_up(&impl->call_sites_lock);
+cleanup_impl:
+    aws_mem_release(parent, impl);
+    return NULL;
+}
+
+void aws_tracking_allocator_destroy(struct aws_allocator *allocator) {
+    struct tracking_impl *impl = allocator->impl;
+
+    for (struct aws_hash_iter iter = aws_hash_iter_begin(&impl->call_sites); !aws_hash_iter_done(&iter);
+         aws_hash_iter_next(&iter)) {
+        aws_mem_release(impl->parent, iter.element.value);
+    }
+    aws_hash_table_clean_up(&impl->call_sites);
+    aws_mutex_clean_up(&impl->call_sites_lock);
+    aws_mem_release(impl->parent, impl);
+}
+
+void aws_tracking_allocator_get_stats(struct aws_allocator *allocator, struct aws_tracking_allocator_stats *stats) {
+    struct tracking_impl *impl = allocator->impl;
+
+    stats->tag = impl->tag;
+    stats->live_bytes = aws_atomic_load_int(&impl->live_bytes);
+    stats->live_allocations = aws_atomic_load_int(&impl->live_allocations);
+    stats->peak_bytes = aws_atomic_load_int(&impl->peak_bytes);
+    stats->total_allocations = aws_atomic_load_int(&impl->total_allocations);
+    stats->total_bytes = aws_atomic_load_int(&impl->total_bytes);
+    stats->dropped_samples = aws_atomic_load_int(&impl->dropped_samples);
+}
+
+void aws_tracking_allocator_reset_peak(struct aws_allocator *allocator) {
+    struct tracking_impl *impl = allocator->impl;
+    aws_atomic_store_int(&impl->peak_bytes, aws_atomic_load_int(&impl->live_bytes));
+}
+
+static int s_compare_call_sites_by_live_bytes(const void *a, const void *b) {
+    size_t a_live = (*(struct aws_tracking_allocator_call_site *const *)a)->live_bytes;
+    size_t b_live = (*(struct aws_tracking_allocator_call_site *const *)b)->live_bytes;
+    return a_live < b_live ? 1 : a_live > b_live ? -1 : 0;
+}
+
+int aws_tracking_allocator_get_call_sites(
+    struct aws_allocator *allocator,
+    struct aws_tracking_allocator_call_site *sites,
+    size_t capacity,
+    size_t *count) {
+
+    struct tracking_impl *impl = allocator->impl;
+    assert(count);
+
+    if (!impl->sample_interval) {
+        return aws_raise_error(AWS_ERROR_UNSUPPORTED_OPERATION);
+    }
+
+    aws_mutex_lock(&impl->call_sites_lock);
+
+    /* Sort pointers to the sites, then copy the first capacity of them */
+    size_t site_count = aws_hash_table_get_entry_count(&impl->call_sites);
+    struct aws_tracking_allocator_call_site **sorted = NULL;
+    if (site_count) {
+        sorted = aws_mem_acquire(impl->parent, sizeof(struct aws_tracking_allocator_call_site *) * site_count);
+        if (!sorted) {
+            aws_mutex_unlock(&impl->call_sites_lock);
+            return AWS_OP_ERR;
+        }
+    }
+
+    size_t i = 0;
+    for (struct aws_hash_iter iter = aws_hash_iter_begin(&impl->call_sites); !aws_hash_iter_done(&iter);
+         aws_hash_iter_next(&iter)) {
+        sorted[i++] = iter.element.value;
+    }
+    if (site_count > 1) {
+        qsort(
+            sorted, site_count, sizeof(struct aws_tracking_allocator_call_site *), s_compare_call_sites_by_live_bytes);
+    }
+
+    *count = site_count < capacity ? site_count : capacity;
+    for (i = 0; i < *count; i++) {
+        sites[i] = *sorted[i];
+    }
+
+    aws_mutex_unlock(&impl->call_sites_lock);
+
+    if (sorted) {
+        aws_mem_release(impl->parent, sorted);
+    }
+    return AWS_OP_SUCCESS;
+}
@@ -0,0 +1,64 @@
+/*
+ * Copyright 2010-2018 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *  http://aws.amazon.com/apache2.0
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#include <aws/common/private/mmap.h>
+
+#include <windows.h>
+
+size_t aws_mmap_page_size(void) {
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return info.dwPageSize;
+}
+
+size_t aws_mmap_huge_page_size(void) {
+    return GetLargePageMinimum();
+}
+
+/* Windows has no transparent huge pages, so transparent_huge_pages is ignored */
+void *aws_mmap_map(size_t size, bool huge, bool transparent_huge_pages, bool prefault) {
+    (void)transparent_huge_pages;
+
+    /* Large pages need SeLockMemoryPrivilege, so this often fails */
+    DWORD flags = MEM_RESERVE | MEM_COMMIT | (huge ? MEM_LARGE_PAGES : 0);
+    void *mapping = VirtualAlloc(NULL, size, flags, PAGE_READWRITE);
+    if (!mapping) {
+        return NULL;
+    }
+
+    /* Large pages are always resident, so only ordinary ones need faulting in */
+    if (prefault && !huge) {
+        size_t page_size = aws_mmap_page_size();
+        for (volatile uint8_t *page = mapping; page < (uint8_t *)mapping + size; page += page_size) {
+            *page = 0;
+        }
+    }
+
+    return mapping;
+}
+
+void aws_mmap_unmap(void *mapping, size_t size) {
+    (void)size;
+    VirtualFree(mapping, 0, MEM_RELEASE);
+}
+
+/* There's no way to grow a mapping in place, so the memory is copied instead */
+void *aws_mmap_remap(void *mapping, size_t old_size, size_t new_size, bool prefault) {
+    (void)mapping;
+    (void)old_size;
+    (void)new_size;
+    (void)prefault;
+    return NULL;
+}
@@ -22,3 +22,8 @@ size_t aws_system_info_processor_count(void) {
     GetSystemInfo(&info);
     return info.dwNumberOfProcessors;
 }
+
+size_t aws_backtrace(void **frames, size_t max_frames) {
+    /* Skip this function's own frame */
+    return (size_t)CaptureStackBackTrace(1, (DWORD)(max_frames > MAXDWORD ? MAXDWORD : max_frames), frames, NULL);
+}
@@ -25,6 +25,16 @@ static struct aws_thread_options s_default_options = {
     .stack_size = 0,
 };
 
+/* Registered exit callbacks, newest first, hang off the calling fiber's value for s_thread_exit_index */
+struct thread_atexit_callback {
+    aws_thread_atexit_fn *callback;
+    void *user_data;
+    struct thread_atexit_callback *next;
+};
+
+static INIT_ONCE s_thread_exit_index_once = INIT_ONCE_STATIC_INIT;
+static DWORD s_thread_exit_index = FLS_OUT_OF_INDEXES;
+
 struct thread_wrapper {
     struct aws_allocator *allocator;
     void (*func)(void *arg);
@@ -131,3 +141,45 @@ void aws_thread_current_sleep(uint64_t nanos) {
      * arises put the effort in here. */
     Sleep((DWORD)aws_timestamp_convert(nanos, AWS_TIMESTAMP_NANOS, AWS_TIMESTAMP_MILLIS, NULL));
 }
+
+static void WINAPI s_thread_exit(void *arg) {
+    struct thread_atexit_callback *entry = arg;
+    while (entry) {
+        struct thread_atexit_callback *next = entry->next;
+        entry->callback(entry->user_data);
+        aws_mem_release(aws_default_allocator(), entry);
+        entry = next;
+    }
+}
+
+static BOOL WINAPI s_thread_exit_index_init(PINIT_ONCE init_once, void *param, void **context) {
+    (void)init_once;
+    (void)param;
+    (void)context;
+
+    /* FLS callbacks run as each thread exits, which TLS has no equivalent for */
+    s_thread_exit_index = FlsAlloc(s_thread_exit);
+    return TRUE;
+}
+
+int aws_thread_current_at_exit(aws_thread_atexit_fn *callback, void *user_data) {
+    InitOnceExecuteOnce(&s_thread_exit_index_once, s_thread_exit_index_init, NULL, NULL);
+    if (s_thread_exit_index == FLS_OUT_OF_INDEXES) {
+        return aws_raise_error(AWS_ERROR_THREAD_INSUFFICIENT_RESOURCE);
+    }
+
+    struct thread_atexit_callback *entry =
+        aws_mem_acquire(aws_default_allocator(), sizeof(struct thread_atexit_callback));
+    if (!entry) {
+        return AWS_OP_ERR;
+    }
+    entry->callback = callback;
+    entry->user_data = user_data;
+    entry->next = FlsGetValue(s_thread_exit_index);
+
+    if (!FlsSetValue(s_thread_exit_index, entry)) {
+        aws_mem_release(aws_default_allocator(), entry);
+        return aws_raise_error(AWS_ERROR_OOM);
+    }
+    return AWS_OP_SUCCESS;
+}
@@ -0,0 +1,201 @@
+/*
+ * Copyright 2010-2018 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *  http://aws.amazon.com/apache2.0
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#include <aws/common/arena_allocator.h>
+
+#include <aws/common/array_list.h>
+#include <aws/common/string.h>
+
+#include <aws/testing/aws_test_harness.h>
+
+/* A parent allocator which counts its live allocations */
+struct counting_allocator {
+    struct aws_allocator allocator;
+    struct aws_allocator *inner;
+    size_t live;
+    size_t acquired;
+};
+
+static void *s_counting_acquire(struct aws_allocator *allocator, size_t size) {
+    struct counting_allocator *counting = allocator->impl;
+    void *mem = aws_mem_acquire(counting->inner, size);
+    if (mem) {
+        counting->live++;
+        counting->acquired++;
+    }
+    return mem;
+}
+
+static void s_counting_release(struct aws_allocator *allocator, void *ptr) {
+    struct counting_allocator *counting = allocator->impl;
+    counting->live--;
+    aws_mem_release(counting->inner, ptr);
+}
+
+static void s_counting_init(struct counting_allocator *counting, struct aws_allocator *inner) {
+    AWS_ZERO_STRUCT(*counting);
+    counting->allocator.mem_acquire = s_counting_acquire;
+    counting->allocator.mem_release = s_counting_release;
+    counting->allocator.impl = counting;
+    counting->inner = inner;
+}
+
+#define IS_ALIGNED(ptr) (((uintptr_t)(ptr) & (2 * sizeof(void *) - 1)) == 0)
+
+static int s_test_arena_allocator_bump_fn(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    struct counting_allocator parent;
+    s_counting_init(&parent, allocator);
+
+    struct aws_arena_allocator arena;
+    ASSERT_SUCCESS(aws_arena_allocator_init(&arena, &parent.allocator, 256));
+    struct aws_allocator *alloc = &arena.allocator;
+
+    /* Nothing is taken from the parent until the first allocation */
+    ASSERT_UINT_EQUALS(0, parent.live);
+
+    uint8_t *a = aws_mem_acquire(alloc, 1);
+    uint8_t *b = aws_mem_acquire(alloc, 13);
+    uint8_t *c = aws_mem_acquire(alloc, 0);
+    ASSERT_NOT_NULL(a);
+    ASSERT_NOT_NULL(b);
+    ASSERT_NOT_NULL(c);
+    ASSERT_TRUE(IS_ALIGNED(a) && IS_ALIGNED(b) && IS_ALIGNED(c));
+    ASSERT_TRUE(b > a && c > b);
+    ASSERT_UINT_EQUALS(1, parent.live);
+
+    /* Releasing does nothing, so the next allocation doesn't reuse the memory */
+    aws_mem_release(alloc, c);
+    uint8_t *d = aws_mem_acquire(alloc, 8);
+    ASSERT_TRUE(d > c);
+
+    /* Filling the block moves on to another */
+    for (size_t i = 0; i < 32; i++) {
+        memset(aws_mem_acquire(alloc, 24), 0xAB, 24);
+    }
+    ASSERT_TRUE(parent.live > 1);
+
+    /* An allocation bigger than a block gets its own */
+    size_t live_before = parent.live;
+    uint8_t *big = aws_mem_acquire(alloc, 1000);
+    ASSERT_NOT_NULL(big);
+    ASSERT_TRUE(IS_ALIGNED(big));
+    memset(big, 0xCD, 1000);
+    ASSERT_UINT_EQUALS(live_before + 1, parent.live);
+
+    aws_arena_allocator_clean_up(&arena);
+    ASSERT_UINT_EQUALS(0, parent.live);
+
+    /* Blocks too small to hold anything are rejected */
+    ASSERT_ERROR(AWS_ERROR_INVALID_ARGUMENT, aws_arena_allocator_init(&arena, &parent.allocator, 4));
+    return 0;
+}
+
+AWS_TEST_CASE(test_arena_allocator_bump, s_test_arena_allocator_bump_fn)
+
+static int s_test_arena_allocator_realloc_fn(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    struct aws_arena_allocator arena;
+    ASSERT_SUCCESS(aws_arena_allocator_init(&arena, allocator, 256));
+    struct aws_allocator *alloc = &arena.allocator;
+
+    /* The most recent allocation grows and shrinks in place */
+    void *first = aws_mem_acquire(alloc, 16);
+    void *ptr = aws_mem_acquire(alloc, 16);
+    void *original = ptr;
+    memset(ptr, 0x11, 16);
+    ASSERT_SUCCESS(aws_mem_realloc(alloc, &ptr, 16, 64));
+    ASSERT_PTR_EQUALS(original, ptr);
+    ASSERT_SUCCESS(aws_mem_realloc(alloc, &ptr, 64, 8));
+    ASSERT_PTR_EQUALS(original, ptr);
+
+    /* Shrinking gave the space back */
+    uint8_t *next = aws_mem_acquire(alloc, 8);
+    ASSERT_PTR_EQUALS((uint8_t *)original + 16, next);
+
+    /* Anything older is copied to grow, but shrinks in place */
+    void *older = first;
+    memset(older, 0x22, 16);
+    ASSERT_SUCCESS(aws_mem_realloc(alloc, &older, 16, 4));
+    ASSERT_PTR_EQUALS(first, older);
+    ASSERT_SUCCESS(aws_mem_realloc(alloc, &older, 16, 32));
+    ASSERT_TRUE(older != first);
+    for (size_t i = 0; i < 16; i++) {
+        ASSERT_UINT_EQUALS(0x22, ((uint8_t *)older)[i]);
+    }
+
+    /* Growing the most recent allocation past its block copies it to a new one */
+    ptr = older;
+    ASSERT_SUCCESS(aws_mem_realloc(alloc, &ptr, 32, 200));
+    ASSERT_TRUE(ptr != older);
+    for (size_t i = 0; i < 16; i++) {
+        ASSERT_UINT_EQUALS(0x22, ((uint8_t *)ptr)[i]);
+    }
+
+    aws_arena_allocator_clean_up(&arena);
+    return 0;
+}
+
+AWS_TEST_CASE(test_arena_allocator_realloc, s_test_arena_allocator_realloc_fn)
+
+static int s_test_arena_allocator_reset_fn(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    struct counting_allocator parent;
+    s_counting_init(&parent, allocator);
+
+    struct aws_arena_allocator arena;
+    ASSERT_SUCCESS(aws_arena_allocator_init(&arena, &parent.allocator, 0));
+    struct aws_allocator *alloc = &arena.allocator;
+
+    /* Build a request's worth of objects through the usual containers, ten times over */
+    size_t acquired_by_first_request = 0;
+    for (size_t request = 0; request < 10; request++) {
+        struct aws_array_list headers;
+        ASSERT_SUCCESS(aws_array_list_init_dynamic(&headers, alloc, 4, sizeof(struct aws_string *)));
+        for (size_t i = 0; i < 100; i++) {
+            struct aws_string *header = aws_string_new_from_c_str(alloc, "x-amz-header: value");
+            ASSERT_NOT_NULL(header);
+            ASSERT_SUCCESS(aws_array_list_push_back(&headers, &header));
+        }
+
+        struct aws_string *header = NULL;
+        ASSERT_SUCCESS(aws_array_list_get_at(&headers, &header, 99));
+        ASSERT_BIN_ARRAYS_EQUALS("x-amz-header: value", 19, aws_string_bytes(header), header->len);
+        aws_mem_release(alloc, aws_mem_acquire(alloc, 10000));
+
+        if (request == 0) {
+            acquired_by_first_request = parent.acquired;
+            ASSERT_TRUE(parent.live > 2);
+        }
+        aws_arena_allocator_reset(&arena);
+
+        /* Only the large block went back to the parent */
+        ASSERT_UINT_EQUALS(acquired_by_first_request - 1, parent.live);
+    }
+
+    /* Blocks were kept across resets, so later requests only took their large block from the parent */
+    ASSERT_UINT_EQUALS(acquired_by_first_request + 9, parent.acquired);
+
+    aws_arena_allocator_reset(&arena);
+    aws_arena_allocator_reset(&arena);
+    aws_arena_allocator_clean_up(&arena);
+    ASSERT_UINT_EQUALS(0, parent.live);
+    return 0;
+}
+
+AWS_TEST_CASE(test_arena_allocator_reset, s_test_arena_allocator_reset_fn)
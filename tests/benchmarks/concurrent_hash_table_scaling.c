@@ -0,0 +1,188 @@
+/*
+ * Copyright 2010-2018 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *  http://aws.amazon.com/apache2.0
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+/*
+ * Measures aggregate lookup throughput of aws_concurrent_hash_table against an aws_hash_table guarded by an
+ * aws_rw_lock, from 1 thread up to the processor count in powers of two. Each thread looks up random keys, and
+ * replaces one in every 'write_ratio' (0 for a read-only run).
+ *
+ * Usage: aws-c-common-benchmark-concurrent_hash_table_scaling [log2 entries, default 16] [write ratio, default 0]
+ */
+
+#include <aws/common/clock.h>
+#include <aws/common/concurrent_hash_table.h>
+#include <aws/common/rw_lock.h>
+#include <aws/common/system_info.h>
+#include <aws/common/thread.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#define OPS_PER_THREAD 2000000
+/* Lookups per read section, or per read lock acquisition */
+#define OPS_PER_SECTION 16
+
+static size_t s_entries;
+static size_t s_write_ratio;
+
+static struct aws_concurrent_hash_table s_concurrent;
+static struct aws_hash_table s_locked;
+static struct aws_rw_lock s_lock;
+
+static uint64_t s_now_ns(void) {
+    uint64_t ticks = 0;
+    aws_high_res_clock_get_ticks(&ticks);
+    return ticks;
+}
+
+static uint64_t s_hash_int(const void *key) {
+    uint64_t h = (uint64_t)(uintptr_t)key;
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    return h;
+}
+
+static bool s_int_eq(const void *a, const void *b) {
+    return a == b;
+}
+
+struct worker {
+    struct aws_thread thread;
+    bool use_concurrent;
+    uint64_t rand_state;
+    size_t found;
+};
+
+static size_t s_next_key(struct worker *worker) {
+    worker->rand_state = worker->rand_state * 6364136223846793005ULL + 1442695040888963407ULL;
+    return (size_t)(worker->rand_state >> 33) % s_entries + 1;
+}
+
+static void s_worker_fn(void *arg) {
+    struct worker *worker = arg;
+
+    for (size_t op = 0; op < OPS_PER_THREAD; op += OPS_PER_SECTION) {
+        if (s_write_ratio && (op / OPS_PER_SECTION) % s_write_ratio == 0) {
+            void *key = (void *)(uintptr_t)s_next_key(worker);
+            if (worker->use_concurrent) {
+                aws_concurrent_hash_table_put(&s_concurrent, key, key, NULL);
+            } else {
+                aws_rw_lock_wlock(&s_lock);
+                aws_hash_table_put(&s_locked, key, key, NULL);
+                aws_rw_lock_wunlock(&s_lock);
+            }
+        }
+
+        if (worker->use_concurrent) {
+            struct aws_concurrent_hash_table_read_guard guard;
+            aws_concurrent_hash_table_read_begin(&s_concurrent, &guard);
+            for (size_t i = 0; i < OPS_PER_SECTION; i++) {
+                const struct aws_hash_element *elem = NULL;
+                aws_concurrent_hash_table_find(&s_concurrent, (void *)(uintptr_t)s_next_key(worker), &elem);
+                worker->found += elem != NULL;
+            }
+            aws_concurrent_hash_table_read_end(&s_concurrent, &guard);
+        } else {
+            aws_rw_lock_rlock(&s_lock);
+            for (size_t i = 0; i < OPS_PER_SECTION; i++) {
+                struct aws_hash_element *elem = NULL;
+                aws_hash_table_find(&s_locked, (void *)(uintptr_t)s_next_key(worker), &elem);
+                worker->found += elem != NULL;
+            }
+            aws_rw_lock_runlock(&s_lock);
+        }
+    }
+}
+
+/* Returns aggregate millions of lookups per second */
+static double s_run(size_t thread_count, bool use_concurrent) {
+    struct worker *workers = calloc(thread_count, sizeof(struct worker));
+    if (!workers) {
+        fprintf(stderr, "allocation failed\n");
+        exit(1);
+    }
+
+    uint64_t start = s_now_ns();
+    for (size_t i = 0; i < thread_count; i++) {
+        workers[i].use_concurrent = use_concurrent;
+        workers[i].rand_state = i + 1;
+        aws_thread_init(&workers[i].thread, aws_default_allocator());
+        if (aws_thread_launch(&workers[i].thread, s_worker_fn, &workers[i], NULL)) {
+            fprintf(stderr, "thread launch failed: %s\n", aws_error_str(aws_last_error()));
+            exit(1);
+        }
+    }
+    for (size_t i = 0; i < thread_count; i++) {
+        aws_thread_join(&workers[i].thread);
+        aws_thread_clean_up(&workers[i].thread);
+    }
+    uint64_t elapsed = s_now_ns() - start;
+
+    free(workers);
+    return (double)(thread_count * OPS_PER_THREAD) * 1000.0 / (double)elapsed;
+}
+
+int main(int argc, char **argv) {
+    size_t log2_entries = 16;
+    if (argc > 1) {
+        log2_entries = (size_t)atoi(argv[1]);
+    }
+    if (argc > 2) {
+        s_write_ratio = (size_t)atoi(argv[2]);
+    }
+    s_entries = (size_t)1 << log2_entries;
+
+    struct aws_allocator *alloc = aws_default_allocator();
+    if (aws_concurrent_hash_table_init(&s_concurrent, alloc, s_entries, s_hash_int, s_int_eq, NULL, NULL) ||
+        aws_hash_table_init(&s_locked, alloc, s_entries * 2, s_hash_int, s_int_eq, NULL, NULL) ||
+        aws_rw_lock_init(&s_lock)) {
+        fprintf(stderr, "init failed: %s\n", aws_error_str(aws_last_error()));
+        return 1;
+    }
+
+    for (size_t i = 1; i <= s_entries; i++) {
+        void *key = (void *)(uintptr_t)i;
+        if (aws_concurrent_hash_table_put(&s_concurrent, key, key, NULL) ||
+            aws_hash_table_put(&s_locked, key, key, NULL)) {
+            fprintf(stderr, "put failed: %s\n", aws_error_str(aws_last_error()));
+            return 1;
+        }
+    }
+
+    size_t max_threads = aws_system_info_processor_count();
+    printf("%zu entries, %zu lookups per thread", s_entries, (size_t)OPS_PER_THREAD);
+    if (s_write_ratio) {
+        printf(", one put per %zu read sections", s_write_ratio);
+    }
+    printf("\n%-8s %18s %18s %8s\n", "threads", "rw_lock Mops/s", "concurrent Mops/s", "ratio");
+
+    for (size_t threads = 1;; threads *= 2) {
+        if (threads > max_threads) {
+            threads = max_threads;
+        }
+        double locked = s_run(threads, false);
+        double concurrent = s_run(threads, true);
+        printf("%-8zu %18.1f %18.1f %7.2fx\n", threads, locked, concurrent, concurrent / locked);
+        if (threads == max_threads) {
+            break;
+        }
+    }
+
+    aws_concurrent_hash_table_clean_up(&s_concurrent);
+    aws_hash_table_clean_up(&s_locked);
+    aws_rw_lock_clean_up(&s_lock);
+    return 0;
+}
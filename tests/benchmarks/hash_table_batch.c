@@ -0,0 +1,164 @@
+/*
+ * Copyright 2010-2017 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *  http://aws.amazon.com/apache2.0
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+/*
+ * Compares aws_hash_table_find_many and aws_hash_table_put_many against loops of aws_hash_table_find and
+ * aws_hash_table_put, for each layout, with keys visited in random order. The interesting case is a table much
+ * larger than the last-level cache, where every lookup is a cache miss.
+ *
+ * Usage: aws-c-common-benchmark-hash_table_batch [log2 entries, default 22] [batch size, default 256]
+ */
+
+#include <aws/common/clock.h>
+#include <aws/common/hash_table.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+
+static uint64_t s_rand_state = 0x9E3779B97F4A7C15ULL;
+
+static uint64_t s_rand(void) {
+    s_rand_state = s_rand_state * 6364136223846793005ULL + 1442695040888963407ULL;
+    return s_rand_state >> 1;
+}
+
+static uint64_t s_now_ns(void) {
+    uint64_t ticks = 0;
+    aws_high_res_clock_get_ticks(&ticks);
+    return ticks;
+}
+
+static const char *s_layout_name(enum aws_hash_table_layout layout) {
+    return layout == AWS_HASH_TABLE_LAYOUT_GROUPED ? "grouped" : "robin_hood";
+}
+
+static int s_init_table(struct aws_hash_table *table, size_t entries, enum aws_hash_table_layout layout) {
+    struct aws_hash_table_options options;
+    AWS_ZERO_STRUCT(options);
+    options.layout = layout;
+
+    /* Sized up front, so that no resizes happen during the measurements */
+    return aws_hash_table_init_with_options(
+        table, aws_default_allocator(), entries * 2, aws_hash_ptr, aws_ptr_eq, NULL, NULL, &options);
+}
+
+int main(int argc, char **argv) {
+    size_t log2_entries = 22;
+    size_t batch_size = 256;
+    if (argc > 1) {
+        log2_entries = (size_t)atoi(argv[1]);
+    }
+    if (argc > 2) {
+        batch_size = (size_t)atoi(argv[2]);
+    }
+    size_t entries = (size_t)1 << log2_entries;
+
+    static const enum aws_hash_table_layout layouts[] = {AWS_HASH_TABLE_LAYOUT_ROBIN_HOOD,
+                                                         AWS_HASH_TABLE_LAYOUT_GROUPED};
+
+    const void **keys = malloc(entries * sizeof(void *));
+    void **values = malloc(entries * sizeof(void *));
+    struct aws_hash_element **elems = malloc(batch_size * sizeof(struct aws_hash_element *));
+    if (!keys || !values || !elems) {
+        fprintf(stderr, "allocation failed\n");
+        return 1;
+    }
+
+    for (size_t i = 0; i < entries; i++) {
+        keys[i] = (void *)(uintptr_t)(s_rand() | 1);
+        values[i] = (void *)(uintptr_t)i;
+    }
+
+    printf("%zu entries, batches of %zu\n", entries, batch_size);
+    printf("%-12s %-6s %14s %14s %8s\n", "layout", "op", "single ns/op", "batch ns/op", "speedup");
+
+    for (size_t l = 0; l < AWS_ARRAY_SIZE(layouts); l++) {
+        struct aws_hash_table single;
+        struct aws_hash_table batch;
+        if (s_init_table(&single, entries, layouts[l]) || s_init_table(&batch, entries, layouts[l])) {
+            fprintf(stderr, "init failed: %s\n", aws_error_str(aws_last_error()));
+            return 1;
+        }
+
+        uint64_t start = s_now_ns();
+        for (size_t i = 0; i < entries; i++) {
+            aws_hash_table_put(&single, keys[i], values[i], NULL);
+        }
+        double single_put_ns = (double)(s_now_ns() - start) / (double)entries;
+
+        start = s_now_ns();
+        for (size_t i = 0; i < entries; i += batch_size) {
+            size_t count = entries - i < batch_size ? entries - i : batch_size;
+            aws_hash_table_put_many(&batch, keys + i, values + i, count, NULL);
+        }
+        double batch_put_ns = (double)(s_now_ns() - start) / (double)entries;
+
+        /* Look the keys up in a different random order than they were inserted in */
+        for (size_t i = entries - 1; i > 0; i--) {
+            size_t j = (size_t)(s_rand() % (i + 1));
+            const void *tmp = keys[i];
+            keys[i] = keys[j];
+            keys[j] = tmp;
+        }
+
+        size_t found = 0;
+        start = s_now_ns();
+        for (size_t i = 0; i < entries; i++) {
+            struct aws_hash_element *elem = NULL;
+            aws_hash_table_find(&single, keys[i], &elem);
+            found += elem != NULL;
+        }
+        double single_find_ns = (double)(s_now_ns() - start) / (double)entries;
+
+        start = s_now_ns();
+        for (size_t i = 0; i < entries; i += batch_size) {
+            size_t count = entries - i < batch_size ? entries - i : batch_size;
+            aws_hash_table_find_many(&batch, keys + i, count, elems);
+            for (size_t j = 0; j < count; j++) {
+                found += elems[j] != NULL;
+            }
+        }
+        double batch_find_ns = (double)(s_now_ns() - start) / (double)entries;
+
+        if (found != 2 * entries) {
+            fprintf(stderr, "found %zu of %zu keys\n", found, 2 * entries);
+            return 1;
+        }
+
+        printf(
+            "%-12s %-6s %14.1f %14.1f %7.2fx\n",
+            s_layout_name(layouts[l]),
+            "put",
+            single_put_ns,
+            batch_put_ns,
+            single_put_ns / batch_put_ns);
+        printf(
+            "%-12s %-6s %14.1f %14.1f %7.2fx\n",
+            s_layout_name(layouts[l]),
+            "find",
+            single_find_ns,
+            batch_find_ns,
+            single_find_ns / batch_find_ns);
+
+        aws_hash_table_clean_up(&single);
+        aws_hash_table_clean_up(&batch);
+    }
+
+    free(keys);
+    free(values);
+    free(elems);
+
+    return 0;
+}
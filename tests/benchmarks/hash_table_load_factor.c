@@ -0,0 +1,144 @@
+/*
+ * Copyright 2010-2017 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *  http://aws.amazon.com/apache2.0
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+/*
+ * Measures lookup cost as a function of max load factor. For each layout and load factor, a table with a fixed
+ * number of slots is filled to just below its resize threshold (the worst case for probe lengths), and then probed
+ * with every present key and an equal number of absent keys. Average and maximum displacement (in slots for robin
+ * hood, in groups for the grouped layout) are reported alongside, from aws_hash_table_get_stats.
+ *
+ * Usage: aws-c-common-benchmark-hash_table_load_factor [log2 slots, default 20]
+ */
+
+#include <aws/common/clock.h>
+#include <aws/common/hash_table.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+
+static uint64_t s_rand_state = 0x9E3779B97F4A7C15ULL;
+
+static uintptr_t s_rand_key(void) {
+    s_rand_state = s_rand_state * 6364136223846793005ULL + 1442695040888963407ULL;
+    /* Keep keys non-zero and odd; absent keys are generated even. */
+    return (uintptr_t)((s_rand_state >> 1) | 1);
+}
+
+static uint64_t s_now_ns(void) {
+    uint64_t ticks = 0;
+    aws_high_res_clock_get_ticks(&ticks);
+    return ticks;
+}
+
+static double s_time_lookups(const struct aws_hash_table *table, const uintptr_t *keys, size_t count) {
+    size_t found = 0;
+    uint64_t start = s_now_ns();
+    for (size_t i = 0; i < count; i++) {
+        struct aws_hash_element *elem = NULL;
+        aws_hash_table_find(table, (void *)keys[i], &elem);
+        found += elem != NULL;
+    }
+    uint64_t end = s_now_ns();
+
+    /* Keep the result live so the loop isn't optimized out */
+    if (found == SIZE_MAX) {
+        printf("impossible\n");
+    }
+
+    return (double)(end - start) / (double)count;
+}
+
+static const char *s_layout_name(enum aws_hash_table_layout layout) {
+    return layout == AWS_HASH_TABLE_LAYOUT_GROUPED ? "grouped" : "robin_hood";
+}
+
+int main(int argc, char **argv) {
+    size_t log2_slots = 20;
+    if (argc > 1) {
+        log2_slots = (size_t)atoi(argv[1]);
+    }
+    size_t slots = (size_t)1 << log2_slots;
+
+    static const double load_factors[] = {0.5, 0.6, 0.7, 0.8, 0.875, 0.9, 0.95};
+    static const enum aws_hash_table_layout layouts[] = {AWS_HASH_TABLE_LAYOUT_ROBIN_HOOD,
+                                                         AWS_HASH_TABLE_LAYOUT_GROUPED};
+
+    uintptr_t *present = malloc(slots * sizeof(uintptr_t));
+    uintptr_t *absent = malloc(slots * sizeof(uintptr_t));
+    if (!present || !absent) {
+        fprintf(stderr, "allocation failed\n");
+        return 1;
+    }
+
+    printf(
+        "%-12s %-6s %10s %12s %12s %10s %10s\n",
+        "layout",
+        "load",
+        "entries",
+        "hit ns/op",
+        "miss ns/op",
+        "avg disp",
+        "max disp");
+
+    for (size_t l = 0; l < AWS_ARRAY_SIZE(layouts); l++) {
+        for (size_t f = 0; f < AWS_ARRAY_SIZE(load_factors); f++) {
+            struct aws_hash_table_options options;
+            AWS_ZERO_STRUCT(options);
+            options.layout = layouts[l];
+            options.max_load_factor = load_factors[f];
+
+            struct aws_hash_table table;
+            if (aws_hash_table_init_with_options(
+                    &table, aws_default_allocator(), slots, aws_hash_ptr, aws_ptr_eq, NULL, NULL, &options)) {
+                fprintf(stderr, "init failed: %s\n", aws_error_str(aws_last_error()));
+                return 1;
+            }
+
+            /* Fill to one below the resize threshold */
+            size_t entries = (size_t)(load_factors[f] * (double)slots) - 1;
+            for (size_t i = 0; i < entries; i++) {
+                present[i] = s_rand_key();
+                absent[i] = present[i] & ~(uintptr_t)1;
+                aws_hash_table_put(&table, (void *)present[i], NULL, NULL);
+            }
+
+            double hit_ns = s_time_lookups(&table, present, entries);
+            double miss_ns = s_time_lookups(&table, absent, entries);
+
+            struct aws_hash_table_stats stats;
+            if (aws_hash_table_get_stats(&table, &stats)) {
+                fprintf(stderr, "get_stats failed: %s\n", aws_error_str(aws_last_error()));
+                return 1;
+            }
+
+            printf(
+                "%-12s %-6.3f %10zu %12.1f %12.1f %10.2f %10zu\n",
+                s_layout_name(layouts[l]),
+                load_factors[f],
+                stats.entry_count,
+                hit_ns,
+                miss_ns,
+                stats.average_displacement,
+                stats.max_displacement);
+
+            aws_hash_table_clean_up(&table);
+        }
+    }
+
+    free(present);
+    free(absent);
+
+    return 0;
+}
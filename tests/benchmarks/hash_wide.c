@@ -0,0 +1,124 @@
+/*
+ * Copyright 2010-2017 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *  http://aws.amazon.com/apache2.0
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+/*
+ * Compares the throughput of the lookup3-based aws_hash_byte_cursor_ptr with aws_hash_wide_byte_cursor_ptr, for
+ * key lengths from 4 bytes to 4 KB. Each measurement hashes the same number of bytes in total.
+ *
+ * Set AWS_COMMON_AVX2=0 in the environment to measure the wide hash without its AVX2 path.
+ *
+ * Usage: aws-c-common-benchmark-hash_wide [MB hashed per measurement, default 256]
+ */
+
+#include <aws/common/byte_buf.h>
+#include <aws/common/clock.h>
+#include <aws/common/hash_table.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+
+static uint64_t s_now_ns(void) {
+    uint64_t ticks = 0;
+    aws_high_res_clock_get_ticks(&ticks);
+    return ticks;
+}
+
+static double s_time_hash(aws_hash_fn *hash_fn, struct aws_byte_cursor *cursors, size_t count, size_t rounds) {
+    uint64_t sink = 0;
+    uint64_t start = s_now_ns();
+    for (size_t r = 0; r < rounds; r++) {
+        for (size_t i = 0; i < count; i++) {
+            sink ^= hash_fn(&cursors[i]);
+        }
+    }
+    uint64_t end = s_now_ns();
+
+    /* Keep the result live so the loop isn't optimized out */
+    if (sink == 42) {
+        printf("impossible\n");
+    }
+
+    return (double)(end - start) / (double)(count * rounds);
+}
+
+int main(int argc, char **argv) {
+    size_t total_mb = 256;
+    if (argc > 1) {
+        total_mb = (size_t)atoi(argv[1]);
+    }
+
+    static const size_t key_lens[] = {4, 8, 16, 24, 32, 48, 64, 128, 256, 512, 1024, 2048, 4096};
+
+    /* Enough distinct keys that the working set is not a single cache line, but still fits in L2 */
+    const size_t buffer_size = 64 * 1024;
+    uint8_t *buffer = malloc(buffer_size + 4096);
+    if (!buffer) {
+        fprintf(stderr, "allocation failed\n");
+        return 1;
+    }
+    for (size_t i = 0; i < buffer_size + 4096; i++) {
+        buffer[i] = (uint8_t)(i * 2654435761U >> 13);
+    }
+
+    printf(
+        "%8s %14s %14s %14s %14s %8s\n",
+        "key len",
+        "lookup3 ns",
+        "lookup3 GB/s",
+        "wide ns",
+        "wide GB/s",
+        "speedup");
+
+    for (size_t k = 0; k < AWS_ARRAY_SIZE(key_lens); k++) {
+        size_t key_len = key_lens[k];
+        size_t count = buffer_size / key_len;
+        if (count > 1024) {
+            count = 1024;
+        }
+
+        struct aws_byte_cursor *cursors = malloc(count * sizeof(struct aws_byte_cursor));
+        if (!cursors) {
+            fprintf(stderr, "allocation failed\n");
+            return 1;
+        }
+        for (size_t i = 0; i < count; i++) {
+            /* Stagger the keys so that most are not 8-byte aligned */
+            cursors[i] = aws_byte_cursor_from_array(buffer + (i * key_len * 5 + i) % buffer_size, key_len);
+        }
+
+        size_t rounds = total_mb * 1024 * 1024 / (count * key_len);
+        if (rounds == 0) {
+            rounds = 1;
+        }
+
+        double lookup3_ns = s_time_hash(aws_hash_byte_cursor_ptr, cursors, count, rounds);
+        double wide_ns = s_time_hash(aws_hash_wide_byte_cursor_ptr, cursors, count, rounds);
+
+        printf(
+            "%8zu %14.2f %14.2f %14.2f %14.2f %7.2fx\n",
+            key_len,
+            lookup3_ns,
+            (double)key_len / lookup3_ns,
+            wide_ns,
+            (double)key_len / wide_ns,
+            lookup3_ns / wide_ns);
+
+        free(cursors);
+    }
+
+    free(buffer);
+
+    return 0;
+}
@@ -0,0 +1,182 @@
+/*
+ * Copyright 2010-2018 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *  http://aws.amazon.com/apache2.0
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+/*
+ * Replays a key trace against aws_lru_cache with each eviction policy, and reports hit ratios side by side. Every
+ * access is a find, followed by a put on a miss.
+ *
+ * The trace file has one unsigned integer key per line. Without one, a synthetic trace is generated: Zipf-distributed
+ * accesses over 100k keys, interrupted periodically by a scan of keys never seen before, which is the pattern that
+ * flushes a plain LRU.
+ *
+ * Usage: aws-c-common-benchmark-lru_cache_trace [trace file]
+ */
+
+#include <aws/common/clock.h>
+#include <aws/common/lru_cache.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#define SYNTHETIC_KEYS 100000
+#define SYNTHETIC_ACCESSES 2000000
+#define SYNTHETIC_SCAN_INTERVAL 250000
+#define SYNTHETIC_SCAN_LENGTH 50000
+
+static uint64_t s_rand_state = 0x9E3779B97F4A7C15ULL;
+
+static uint64_t s_rand(void) {
+    s_rand_state = s_rand_state * 6364136223846793005ULL + 1442695040888963407ULL;
+    return s_rand_state >> 11;
+}
+
+static uint64_t *s_synthetic_trace(size_t *length) {
+    uint64_t *trace = malloc(SYNTHETIC_ACCESSES * sizeof(uint64_t));
+    double *cdf = malloc(SYNTHETIC_KEYS * sizeof(double));
+    if (!trace || !cdf) {
+        return NULL;
+    }
+
+    double total = 0;
+    for (size_t i = 0; i < SYNTHETIC_KEYS; i++) {
+        /* Zipf with exponent 1: the key of rank i is accessed in proportion to 1 / i */
+        total += 1.0 / (double)(i + 1);
+        cdf[i] = total;
+    }
+
+    uint64_t scan_key = SYNTHETIC_KEYS;
+    for (size_t i = 0; i < SYNTHETIC_ACCESSES; i++) {
+        if (i % SYNTHETIC_SCAN_INTERVAL >= SYNTHETIC_SCAN_INTERVAL - SYNTHETIC_SCAN_LENGTH) {
+            trace[i] = scan_key++;
+            continue;
+        }
+
+        /* Invert the CDF by binary search */
+        double target = (double)s_rand() / (double)(1ULL << 53) * total;
+        size_t lo = 0;
+        size_t hi = SYNTHETIC_KEYS - 1;
+        while (lo < hi) {
+            size_t mid = lo + (hi - lo) / 2;
+            if (cdf[mid] < target) {
+                lo = mid + 1;
+            } else {
+                hi = mid;
+            }
+        }
+        /* Scatter popularity ranks over the key space */
+        trace[i] = (lo * 2654435761ULL) % SYNTHETIC_KEYS;
+    }
+
+    free(cdf);
+    *length = SYNTHETIC_ACCESSES;
+    return trace;
+}
+
+static uint64_t *s_read_trace(const char *path, size_t *length) {
+    FILE *file = fopen(path, "r");
+    if (!file) {
+        return NULL;
+    }
+
+    size_t capacity = 1 << 20;
+    size_t count = 0;
+    uint64_t *trace = malloc(capacity * sizeof(uint64_t));
+    unsigned long long key = 0;
+    while (trace && fscanf(file, "%llu", &key) == 1) {
+        if (count == capacity) {
+            capacity *= 2;
+            uint64_t *grown = realloc(trace, capacity * sizeof(uint64_t));
+            if (!grown) {
+                free(trace);
+                trace = NULL;
+                break;
+            }
+            trace = grown;
+        }
+        trace[count++] = key;
+    }
+
+    fclose(file);
+    *length = count;
+    return trace;
+}
+
+static const char *s_policy_name(enum aws_lru_cache_policy policy) {
+    switch (policy) {
+        case AWS_LRU_CACHE_POLICY_SIEVE:
+            return "sieve";
+        case AWS_LRU_CACHE_POLICY_TINYLFU:
+            return "tinylfu";
+        default:
+            return "lru";
+    }
+}
+
+int main(int argc, char **argv) {
+    size_t length = 0;
+    uint64_t *trace = argc > 1 ? s_read_trace(argv[1], &length) : s_synthetic_trace(&length);
+    if (!trace || !length) {
+        fprintf(stderr, "couldn't load a trace\n");
+        return 1;
+    }
+
+    static const enum aws_lru_cache_policy policies[] = {
+        AWS_LRU_CACHE_POLICY_LRU, AWS_LRU_CACHE_POLICY_SIEVE, AWS_LRU_CACHE_POLICY_TINYLFU};
+    static const size_t cache_sizes[] = {1000, 5000, 20000};
+
+    printf("%zu accesses%s\n", length, argc > 1 ? "" : " (synthetic: zipf with periodic scans)");
+    printf("%-8s", "size");
+    for (size_t p = 0; p < AWS_ARRAY_SIZE(policies); p++) {
+        printf(" %10s hit%%  ns/op", s_policy_name(policies[p]));
+    }
+    printf("\n");
+
+    for (size_t s = 0; s < AWS_ARRAY_SIZE(cache_sizes); s++) {
+        printf("%-8zu", cache_sizes[s]);
+        for (size_t p = 0; p < AWS_ARRAY_SIZE(policies); p++) {
+            struct aws_lru_cache_options options = {.policy = policies[p]};
+            struct aws_lru_cache cache;
+            if (aws_lru_cache_init_with_options(
+                    &cache, aws_default_allocator(), aws_hash_ptr, aws_ptr_eq, NULL, NULL, cache_sizes[s], &options)) {
+                fprintf(stderr, "init failed: %s\n", aws_error_str(aws_last_error()));
+                return 1;
+            }
+
+            size_t hits = 0;
+            uint64_t start = 0;
+            aws_high_res_clock_get_ticks(&start);
+            for (size_t i = 0; i < length; i++) {
+                /* Offset by one, since a NULL value means a miss */
+                void *key = (void *)(uintptr_t)(trace[i] + 1);
+                void *value = NULL;
+                aws_lru_cache_find(&cache, key, &value);
+                if (value) {
+                    hits++;
+                } else {
+                    aws_lru_cache_put(&cache, key, key);
+                }
+            }
+            uint64_t end = 0;
+            aws_high_res_clock_get_ticks(&end);
+
+            printf(" %15.2f %6.1f", 100.0 * (double)hits / (double)length, (double)(end - start) / (double)length);
+            aws_lru_cache_clean_up(&cache);
+        }
+        printf("\n");
+    }
+
+    free(trace);
+    return 0;
+}
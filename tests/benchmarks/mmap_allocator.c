@@ -0,0 +1,100 @@
+/*
+ * Copyright 2010-2018 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *  http://aws.amazon.com/apache2.0
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+/*
+ * Compares aws_mmap_allocator with aws_default_allocator for building large buffers: an aws_byte_buf starts at 4KB
+ * and is filled 64KB at a time, doubling its capacity with aws_byte_buf_reserve whenever it runs out, up to the final
+ * size. Reports milliseconds per buffer for each allocator, and for the mmap allocator with each of its options.
+ *
+ * Usage: aws-c-common-benchmark-mmap_allocator [final size in MB, default 64]
+ */
+
+#include <aws/common/byte_buf.h>
+#include <aws/common/clock.h>
+#include <aws/common/mmap_allocator.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define CHUNK_SIZE (64 * 1024)
+#define ROUNDS 5
+
+static uint64_t s_now_ns(void) {
+    uint64_t ticks = 0;
+    aws_high_res_clock_get_ticks(&ticks);
+    return ticks;
+}
+
+static double s_run_growth(struct aws_allocator *allocator, size_t final_size) {
+    static uint8_t chunk[CHUNK_SIZE];
+    memset(chunk, 0x5A, sizeof(chunk));
+    struct aws_byte_cursor cursor = aws_byte_cursor_from_array(chunk, sizeof(chunk));
+
+    uint64_t start = s_now_ns();
+    for (size_t round = 0; round < ROUNDS; round++) {
+        struct aws_byte_buf buf;
+        if (aws_byte_buf_init(&buf, allocator, 4096)) {
+            fprintf(stderr, "out of memory\n");
+            exit(1);
+        }
+        while (buf.len < final_size) {
+            if (buf.capacity - buf.len < CHUNK_SIZE && aws_byte_buf_reserve(&buf, buf.capacity * 2)) {
+                fprintf(stderr, "out of memory\n");
+                exit(1);
+            }
+            aws_byte_buf_append(&buf, &cursor);
+        }
+        aws_byte_buf_clean_up(&buf);
+    }
+    uint64_t elapsed = s_now_ns() - start;
+
+    return (double)elapsed / 1e6 / ROUNDS;
+}
+
+static void s_run_mmap(const char *name, struct aws_mmap_allocator_options *options, size_t final_size) {
+    struct aws_allocator *allocator = aws_mmap_allocator_new(aws_default_allocator(), options);
+    if (!allocator) {
+        fprintf(stderr, "out of memory\n");
+        exit(1);
+    }
+    printf("%-22s %10.2f\n", name, s_run_growth(allocator, final_size));
+    aws_mmap_allocator_destroy(allocator);
+}
+
+int main(int argc, char **argv) {
+    size_t final_mb = argc > 1 ? (size_t)strtoull(argv[1], NULL, 10) : 64;
+    if (final_mb == 0) {
+        final_mb = 1;
+    }
+    size_t final_size = final_mb * 1024 * 1024;
+
+    printf("growing to %zu MB in %d KB appends, %d rounds\n", final_mb, CHUNK_SIZE / 1024, ROUNDS);
+    printf("%-22s %10s\n", "allocator", "ms/buffer");
+
+    printf("%-22s %10.2f\n", "default", s_run_growth(aws_default_allocator(), final_size));
+
+    struct aws_mmap_allocator_options options = {0};
+    s_run_mmap("mmap", &options, final_size);
+    options.transparent_huge_pages = true;
+    s_run_mmap("mmap, thp", &options, final_size);
+    options.prefault = true;
+    s_run_mmap("mmap, thp, prefault", &options, final_size);
+    options.transparent_huge_pages = false;
+    options.explicit_huge_pages = true;
+    s_run_mmap("mmap, hugetlb, prefault", &options, final_size);
+
+    return 0;
+}
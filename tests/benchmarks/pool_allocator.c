@@ -0,0 +1,158 @@
+/*
+ * Copyright 2010-2018 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *  http://aws.amazon.com/apache2.0
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+/*
+ * Compares aws_pool_allocator with aws_default_allocator under small-object churn from several threads at once.
+ *
+ * - local: each thread keeps a window of live objects of random sizes between 8 and 512 bytes, replacing a random one
+ *   on every operation, so everything is released by the thread that acquired it.
+ * - shared: the threads replace objects in one window they all share, so most objects are released by another thread
+ *   than the one that acquired them.
+ *
+ * The pool is also run with every thread's cache slots taken by other pools, so that it only uses its central lists.
+ *
+ * Reports nanoseconds per acquire/release pair, over all threads.
+ *
+ * Usage: aws-c-common-benchmark-pool_allocator [thread count, default one per processor]
+ */
+
+#include <aws/common/atomics.h>
+#include <aws/common/clock.h>
+#include <aws/common/pool_allocator.h>
+#include <aws/common/system_info.h>
+#include <aws/common/thread.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#define OPS_PER_THREAD 2000000
+#define WINDOW_SIZE 1024
+#define MAX_THREADS 64
+/* Pools a thread keeps caches for; using this many others first leaves none for the pool measured */
+#define CACHED_POOLS 4
+
+static uint64_t s_now_ns(void) {
+    uint64_t ticks = 0;
+    aws_high_res_clock_get_ticks(&ticks);
+    return ticks;
+}
+
+struct churn_thread {
+    struct aws_allocator *allocator;
+    /* The thread's own window, or the shared one */
+    struct aws_atomic_var *window;
+    uint64_t seed;
+    /* Pools to use once before starting, or NULL */
+    struct aws_allocator **other_pools;
+};
+
+static void s_churn_fn(void *arg) {
+    struct churn_thread *data = arg;
+    for (size_t i = 0; data->other_pools && i < CACHED_POOLS; i++) {
+        aws_mem_release(data->other_pools[i], aws_mem_acquire(data->other_pools[i], 8));
+    }
+
+    uint64_t state = data->seed;
+    for (size_t op = 0; op < OPS_PER_THREAD; op++) {
+        state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+        size_t size = 8 + (size_t)(state >> 33) % 505;
+        size_t slot = (size_t)(state >> 16) % WINDOW_SIZE;
+
+        uint8_t *object = aws_mem_acquire(data->allocator, size);
+        object[0] = (uint8_t)op;
+        void *old = aws_atomic_exchange_ptr_explicit(&data->window[slot], object, aws_memory_order_acq_rel);
+        aws_mem_release(data->allocator, old);
+    }
+}
+
+static double s_run_churn(
+    struct aws_allocator *allocator,
+    size_t thread_count,
+    bool shared,
+    struct aws_allocator **other_pools) {
+    struct aws_atomic_var *windows = malloc(sizeof(struct aws_atomic_var) * WINDOW_SIZE * thread_count);
+    for (size_t i = 0; i < WINDOW_SIZE * thread_count; i++) {
+        aws_atomic_init_ptr(&windows[i], NULL);
+    }
+
+    struct aws_thread threads[MAX_THREADS];
+    struct churn_thread data[MAX_THREADS];
+    uint64_t start = s_now_ns();
+    for (size_t i = 0; i < thread_count; i++) {
+        data[i].allocator = allocator;
+        data[i].window = shared ? windows : &windows[i * WINDOW_SIZE];
+        data[i].seed = i + 1;
+        data[i].other_pools = other_pools;
+        aws_thread_init(&threads[i], aws_default_allocator());
+        aws_thread_launch(&threads[i], s_churn_fn, &data[i], NULL);
+    }
+    for (size_t i = 0; i < thread_count; i++) {
+        aws_thread_join(&threads[i]);
+        aws_thread_clean_up(&threads[i]);
+    }
+    uint64_t elapsed = s_now_ns() - start;
+
+    for (size_t i = 0; i < WINDOW_SIZE * thread_count; i++) {
+        aws_mem_release(allocator, aws_atomic_load_ptr(&windows[i]));
+    }
+    free(windows);
+
+    return (double)elapsed / ((double)OPS_PER_THREAD * (double)thread_count);
+}
+
+int main(int argc, char **argv) {
+    size_t thread_count = argc > 1 ? (size_t)strtoull(argv[1], NULL, 10) : aws_system_info_processor_count();
+    if (thread_count == 0) {
+        thread_count = 1;
+    }
+    if (thread_count > MAX_THREADS) {
+        thread_count = MAX_THREADS;
+    }
+
+    printf("%zu threads, %d operations each\n", thread_count, OPS_PER_THREAD);
+    printf("%-10s %14s %14s\n", "allocator", "local ns/op", "shared ns/op");
+
+    struct aws_allocator *default_allocator = aws_default_allocator();
+    double default_local = s_run_churn(default_allocator, thread_count, false, NULL);
+    double default_shared = s_run_churn(default_allocator, thread_count, true, NULL);
+    printf("%-10s %14.1f %14.1f\n", "default", default_local, default_shared);
+
+    struct aws_allocator *pool = aws_pool_allocator_new(aws_default_allocator());
+    if (!pool) {
+        fprintf(stderr, "out of memory\n");
+        return 1;
+    }
+    double pool_local = s_run_churn(pool, thread_count, false, NULL);
+    double pool_shared = s_run_churn(pool, thread_count, true, NULL);
+    printf("%-10s %14.1f %14.1f\n", "pool", pool_local, pool_shared);
+
+    struct aws_allocator *other_pools[CACHED_POOLS];
+    for (size_t i = 0; i < CACHED_POOLS; i++) {
+        other_pools[i] = aws_pool_allocator_new(aws_default_allocator());
+        if (!other_pools[i]) {
+            fprintf(stderr, "out of memory\n");
+            return 1;
+        }
+    }
+    double uncached_local = s_run_churn(pool, thread_count, false, other_pools);
+    double uncached_shared = s_run_churn(pool, thread_count, true, other_pools);
+    printf("%-10s %14.1f %14.1f\n", "uncached", uncached_local, uncached_shared);
+    for (size_t i = 0; i < CACHED_POOLS; i++) {
+        aws_pool_allocator_destroy(other_pools[i]);
+    }
+    aws_pool_allocator_destroy(pool);
+
+    return 0;
+}
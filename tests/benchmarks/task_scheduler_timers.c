@@ -0,0 +1,141 @@
+/*
+ * Copyright 2010-2018 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *  http://aws.amazon.com/apache2.0
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+/*
+ * Simulates idle timeouts on an event loop: a large population of pending timers, most of which are reset (canceled
+ * and rescheduled) before they fire, while the loop runs every millisecond of simulated time and then asks when it
+ * next needs to wake. Reports the cost per reset, per run and per has_tasks call with the heap and with the timing
+ * wheel.
+ *
+ * Usage: aws-c-common-benchmark-task_scheduler_timers [timer count, default 500000]
+ */
+
+#include <aws/common/clock.h>
+#include <aws/common/task_scheduler.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#define TIMEOUT_NS 30000000000ULL /* 30s idle timeout */
+#define TICK_NS 1000000ULL        /* the loop runs once per simulated millisecond */
+#define RESETS_PER_TICK 2000
+#define TICKS 5000
+
+static size_t s_fired;
+
+/* Each task's arg points to its entry here, which is set while it's scheduled */
+static bool *s_pending;
+
+static void s_timeout_fn(struct aws_task *task, void *arg, enum aws_task_status status) {
+    (void)task;
+    *(bool *)arg = false;
+    if (status == AWS_TASK_STATUS_RUN_READY) {
+        s_fired++;
+    }
+}
+
+static uint64_t s_rand_state = 1;
+
+static uint64_t s_rand(void) {
+    s_rand_state = s_rand_state * 6364136223846793005ULL + 1442695040888963407ULL;
+    return s_rand_state >> 11;
+}
+
+static uint64_t s_now_ns(void) {
+    uint64_t ticks = 0;
+    aws_high_res_clock_get_ticks(&ticks);
+    return ticks;
+}
+
+static void s_run(const char *name, enum aws_task_scheduler_timers timers, struct aws_task *tasks, size_t count) {
+    struct aws_task_scheduler_options options = {.timers = timers};
+    struct aws_task_scheduler scheduler;
+    if (aws_task_scheduler_init_with_options(&scheduler, aws_default_allocator(), &options)) {
+        fprintf(stderr, "init failed: %s\n", aws_error_str(aws_last_error()));
+        exit(1);
+    }
+
+    s_rand_state = 1;
+    s_fired = 0;
+
+    /* Stagger the initial deadlines over one timeout */
+    for (size_t i = 0; i < count; i++) {
+        aws_task_init(&tasks[i], s_timeout_fn, &s_pending[i]);
+        s_pending[i] = true;
+        aws_task_scheduler_schedule_future(&scheduler, &tasks[i], TIMEOUT_NS / count * i + TICK_NS);
+    }
+
+    uint64_t reset_ns = 0;
+    uint64_t run_ns = 0;
+    uint64_t has_tasks_ns = 0;
+    uint64_t now = 0;
+    for (size_t tick = 0; tick < TICKS; tick++) {
+        now += TICK_NS;
+
+        uint64_t start = s_now_ns();
+        for (size_t r = 0; r < RESETS_PER_TICK; r++) {
+            /* Activity on a connection pushes its timeout back; a timer that already fired is simply rearmed */
+            size_t index = s_rand() % count;
+            if (s_pending[index]) {
+                aws_task_scheduler_cancel_task(&scheduler, &tasks[index]);
+            }
+            s_pending[index] = true;
+            aws_task_scheduler_schedule_future(&scheduler, &tasks[index], now + TIMEOUT_NS);
+        }
+        uint64_t mid = s_now_ns();
+        aws_task_scheduler_run_all(&scheduler, now);
+        uint64_t ran = s_now_ns();
+        /* An event loop asks for the next task's time to set its poll timeout */
+        uint64_t next_task_time = 0;
+        aws_task_scheduler_has_tasks(&scheduler, &next_task_time);
+        uint64_t end = s_now_ns();
+
+        reset_ns += mid - start;
+        run_ns += ran - mid;
+        has_tasks_ns += end - ran;
+    }
+
+    printf(
+        "%-6s %10.1f ns/reset %10.1f us/run %10.1f ns/has_tasks %10zu fired\n",
+        name,
+        (double)reset_ns / (double)(TICKS * RESETS_PER_TICK),
+        (double)run_ns / 1000.0 / (double)TICKS,
+        (double)has_tasks_ns / (double)TICKS,
+        s_fired);
+
+    aws_task_scheduler_clean_up(&scheduler);
+}
+
+int main(int argc, char **argv) {
+    size_t count = 500000;
+    if (argc > 1) {
+        count = (size_t)atoi(argv[1]);
+    }
+
+    struct aws_task *tasks = calloc(count, sizeof(struct aws_task));
+    s_pending = calloc(count, sizeof(bool));
+    if (!tasks || !s_pending) {
+        fprintf(stderr, "allocation failed\n");
+        return 1;
+    }
+
+    printf("%zu timers, %d resets per simulated ms, %d ms\n", count, RESETS_PER_TICK, TICKS);
+    s_run("heap", AWS_TASK_SCHEDULER_TIMERS_HEAP, tasks, count);
+    s_run("wheel", AWS_TASK_SCHEDULER_TIMERS_WHEEL, tasks, count);
+
+    free(tasks);
+    free(s_pending);
+    return 0;
+}
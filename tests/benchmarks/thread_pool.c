@@ -0,0 +1,276 @@
+/*
+ * Copyright 2010-2018 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *  http://aws.amazon.com/apache2.0
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+/*
+ * Compares aws_thread_pool with the pool consumers tend to write for themselves: the same number of threads taking
+ * tasks from one linked list behind one mutex and condition variable.
+ *
+ * - fan-out: one task splits recursively into a binary tree of small tasks, each submitted by the task before it.
+ *   Reports tasks per second.
+ * - latency: tasks are submitted one at a time from outside the pool, each after the previous one has started.
+ *   Reports the median and 99th percentile time from submission to start.
+ *
+ * Usage: aws-c-common-benchmark-thread_pool [worker count, default one per processor]
+ */
+
+#include <aws/common/atomics.h>
+#include <aws/common/clock.h>
+#include <aws/common/condition_variable.h>
+#include <aws/common/mutex.h>
+#include <aws/common/system_info.h>
+#include <aws/common/thread.h>
+#include <aws/common/thread_pool.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#define FAN_OUT_DEPTH 20
+#define FAN_OUT_TASKS ((1 << (FAN_OUT_DEPTH + 1)) - 1)
+/* Busy work per task, in iterations of a small hash loop */
+#define FAN_OUT_WORK 200
+#define LATENCY_SAMPLES 20000
+
+static uint64_t s_now_ns(void) {
+    uint64_t ticks = 0;
+    aws_high_res_clock_get_ticks(&ticks);
+    return ticks;
+}
+
+/* The single-mutex pool */
+struct mutex_pool {
+    struct aws_mutex lock;
+    struct aws_condition_variable signal;
+    struct aws_linked_list queue;
+    bool stopping;
+    size_t thread_count;
+    struct aws_thread *threads;
+};
+
+static void s_mutex_pool_thread(void *arg) {
+    struct mutex_pool *pool = arg;
+    aws_mutex_lock(&pool->lock);
+    while (true) {
+        while (aws_linked_list_empty(&pool->queue) && !pool->stopping) {
+            aws_condition_variable_wait(&pool->signal, &pool->lock);
+        }
+        if (aws_linked_list_empty(&pool->queue)) {
+            break;
+        }
+        struct aws_task *task = AWS_CONTAINER_OF(aws_linked_list_pop_front(&pool->queue), struct aws_task, node);
+        aws_mutex_unlock(&pool->lock);
+        aws_task_run(task, AWS_TASK_STATUS_RUN_READY);
+        aws_mutex_lock(&pool->lock);
+    }
+    aws_mutex_unlock(&pool->lock);
+}
+
+static void s_mutex_pool_init(struct mutex_pool *pool, size_t thread_count) {
+    aws_mutex_init(&pool->lock);
+    aws_condition_variable_init(&pool->signal);
+    aws_linked_list_init(&pool->queue);
+    pool->stopping = false;
+    pool->thread_count = thread_count;
+    pool->threads = malloc(sizeof(struct aws_thread) * thread_count);
+    for (size_t i = 0; i < thread_count; i++) {
+        aws_thread_init(&pool->threads[i], aws_default_allocator());
+        aws_thread_launch(&pool->threads[i], s_mutex_pool_thread, pool, NULL);
+    }
+}
+
+static void s_mutex_pool_submit(struct mutex_pool *pool, struct aws_task *task) {
+    aws_mutex_lock(&pool->lock);
+    aws_linked_list_push_back(&pool->queue, &task->node);
+    aws_condition_variable_notify_one(&pool->signal);
+    aws_mutex_unlock(&pool->lock);
+}
+
+static void s_mutex_pool_clean_up(struct mutex_pool *pool) {
+    aws_mutex_lock(&pool->lock);
+    pool->stopping = true;
+    aws_condition_variable_notify_all(&pool->signal);
+    aws_mutex_unlock(&pool->lock);
+    for (size_t i = 0; i < pool->thread_count; i++) {
+        aws_thread_join(&pool->threads[i]);
+        aws_thread_clean_up(&pool->threads[i]);
+    }
+    free(pool->threads);
+    aws_condition_variable_clean_up(&pool->signal);
+    aws_mutex_clean_up(&pool->lock);
+}
+
+/* Either pool, behind one submit function */
+struct bench_pool {
+    struct aws_thread_pool *stealing;
+    struct mutex_pool *mutex;
+};
+
+static void s_submit(struct bench_pool *pool, struct aws_task *task) {
+    if (pool->stealing) {
+        aws_thread_pool_submit(pool->stealing, task);
+    } else {
+        s_mutex_pool_submit(pool->mutex, task);
+    }
+}
+
+/* Completion signalling shared by both scenarios */
+static struct aws_mutex s_done_lock = AWS_MUTEX_INIT;
+static struct aws_condition_variable s_done_signal = AWS_CONDITION_VARIABLE_INIT;
+static struct aws_atomic_var s_remaining;
+
+static void s_finish_one(void) {
+    if (aws_atomic_fetch_sub(&s_remaining, 1) == 1) {
+        aws_mutex_lock(&s_done_lock);
+        aws_condition_variable_notify_all(&s_done_signal);
+        aws_mutex_unlock(&s_done_lock);
+    }
+}
+
+static bool s_all_done(void *arg) {
+    (void)arg;
+    return aws_atomic_load_int(&s_remaining) == 0;
+}
+
+static void s_wait_all(void) {
+    aws_mutex_lock(&s_done_lock);
+    aws_condition_variable_wait_pred(&s_done_signal, &s_done_lock, s_all_done, NULL);
+    aws_mutex_unlock(&s_done_lock);
+}
+
+static struct bench_pool *s_pool;
+static struct aws_task *s_tree;
+static struct aws_atomic_var s_sink;
+
+static void s_fan_out_fn(struct aws_task *task, void *arg, enum aws_task_status status) {
+    (void)status;
+    size_t index = (size_t)(uintptr_t)arg;
+    size_t child = index * 2 + 1;
+    if (child < FAN_OUT_TASKS) {
+        s_submit(s_pool, &s_tree[child]);
+        s_submit(s_pool, &s_tree[child + 1]);
+    }
+
+    uint64_t h = (uint64_t)(uintptr_t)task;
+    for (size_t i = 0; i < FAN_OUT_WORK; i++) {
+        h = (h ^ (h >> 29)) * 0xbf58476d1ce4e5b9ULL;
+    }
+    aws_atomic_fetch_add_explicit(&s_sink, (size_t)h & 1, aws_memory_order_relaxed);
+    s_finish_one();
+}
+
+static double s_run_fan_out(struct bench_pool *pool) {
+    s_pool = pool;
+    for (size_t i = 0; i < FAN_OUT_TASKS; i++) {
+        aws_task_init(&s_tree[i], s_fan_out_fn, (void *)(uintptr_t)i);
+    }
+    aws_atomic_store_int(&s_remaining, FAN_OUT_TASKS);
+
+    uint64_t start = s_now_ns();
+    s_submit(pool, &s_tree[0]);
+    s_wait_all();
+    uint64_t elapsed = s_now_ns() - start;
+
+    return (double)FAN_OUT_TASKS / ((double)elapsed / 1e9);
+}
+
+static struct aws_atomic_var s_started_at;
+
+static void s_latency_fn(struct aws_task *task, void *arg, enum aws_task_status status) {
+    (void)task;
+    (void)arg;
+    (void)status;
+    aws_atomic_store_int(&s_started_at, (size_t)s_now_ns());
+    s_finish_one();
+}
+
+static int s_compare_u64(const void *a, const void *b) {
+    uint64_t x = *(const uint64_t *)a;
+    uint64_t y = *(const uint64_t *)b;
+    return x < y ? -1 : x > y;
+}
+
+static void s_run_latency(struct bench_pool *pool, uint64_t *p50, uint64_t *p99) {
+    static uint64_t samples[LATENCY_SAMPLES];
+    struct aws_task task;
+
+    for (size_t i = 0; i < LATENCY_SAMPLES; i++) {
+        aws_task_init(&task, s_latency_fn, NULL);
+        aws_atomic_store_int(&s_remaining, 1);
+
+        uint64_t submitted = s_now_ns();
+        s_submit(pool, &task);
+        s_wait_all();
+        samples[i] = (uint64_t)aws_atomic_load_int(&s_started_at) - submitted;
+    }
+
+    qsort(samples, LATENCY_SAMPLES, sizeof(uint64_t), s_compare_u64);
+    *p50 = samples[LATENCY_SAMPLES / 2];
+    *p99 = samples[LATENCY_SAMPLES * 99 / 100];
+}
+
+int main(int argc, char **argv) {
+    size_t workers = argc > 1 ? (size_t)strtoull(argv[1], NULL, 10) : aws_system_info_processor_count();
+    if (workers == 0) {
+        workers = 1;
+    }
+
+    s_tree = malloc(sizeof(struct aws_task) * FAN_OUT_TASKS);
+    if (!s_tree) {
+        fprintf(stderr, "out of memory\n");
+        return 1;
+    }
+    aws_atomic_init_int(&s_sink, 0);
+    aws_atomic_init_int(&s_remaining, 0);
+    aws_atomic_init_int(&s_started_at, 0);
+
+    printf("%zu workers, %d fan-out tasks, %d latency samples\n", workers, FAN_OUT_TASKS, LATENCY_SAMPLES);
+    printf("%-14s %16s %14s %14s\n", "pool", "fan-out tasks/s", "latency p50", "latency p99");
+
+    struct mutex_pool mutex_pool;
+    s_mutex_pool_init(&mutex_pool, workers);
+    struct bench_pool mutex_bench = {.mutex = &mutex_pool};
+    double mutex_rate = s_run_fan_out(&mutex_bench);
+    uint64_t mutex_p50 = 0;
+    uint64_t mutex_p99 = 0;
+    s_run_latency(&mutex_bench, &mutex_p50, &mutex_p99);
+    s_mutex_pool_clean_up(&mutex_pool);
+    printf(
+        "%-14s %16.0f %11llu ns %11llu ns\n",
+        "single mutex",
+        mutex_rate,
+        (unsigned long long)mutex_p50,
+        (unsigned long long)mutex_p99);
+
+    struct aws_thread_pool_options options = {.worker_count = workers};
+    struct aws_thread_pool stealing_pool;
+    if (aws_thread_pool_init(&stealing_pool, aws_default_allocator(), &options)) {
+        fprintf(stderr, "init failed: %s\n", aws_error_str(aws_last_error()));
+        return 1;
+    }
+    struct bench_pool stealing_bench = {.stealing = &stealing_pool};
+    double stealing_rate = s_run_fan_out(&stealing_bench);
+    uint64_t stealing_p50 = 0;
+    uint64_t stealing_p99 = 0;
+    s_run_latency(&stealing_bench, &stealing_p50, &stealing_p99);
+    aws_thread_pool_clean_up(&stealing_pool);
+    printf(
+        "%-14s %16.0f %11llu ns %11llu ns\n",
+        "work stealing",
+        stealing_rate,
+        (unsigned long long)stealing_p50,
+        (unsigned long long)stealing_p99);
+
+    free(s_tree);
+    return 0;
+}
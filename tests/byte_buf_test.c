@@ -283,4 +283,29 @@ static int s_test_buffer_advance(struct aws_allocator *allocator, void *ctx) {
     ASSERT_INT_EQUALS(src_buf.len, 12);
 
     return 0;
-}
\ No newline at end of file
+}
+
+AWS_TEST_CASE(test_buffer_reserve, s_test_buffer_reserve)
+static int s_test_buffer_reserve(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    struct aws_byte_buf buf;
+    ASSERT_SUCCESS(aws_byte_buf_init(&buf, allocator, 4));
+    struct aws_byte_cursor cursor = aws_byte_cursor_from_c_str("test");
+    ASSERT_SUCCESS(aws_byte_buf_append(&buf, &cursor));
+
+    ASSERT_SUCCESS(aws_byte_buf_reserve(&buf, 2));
+    ASSERT_INT_EQUALS(4, buf.capacity);
+
+    ASSERT_SUCCESS(aws_byte_buf_reserve(&buf, 8));
+    ASSERT_INT_EQUALS(8, buf.capacity);
+    ASSERT_SUCCESS(aws_byte_buf_append(&buf, &cursor));
+    ASSERT_BIN_ARRAYS_EQUALS("testtest", 8, buf.buffer, buf.len);
+    aws_byte_buf_clean_up(&buf);
+
+    uint8_t arr[4];
+    struct aws_byte_buf fixed = aws_byte_buf_from_array(arr, sizeof(arr));
+    ASSERT_ERROR(AWS_ERROR_INVALID_ARGUMENT, aws_byte_buf_reserve(&fixed, 8));
+
+    return 0;
+}
@@ -0,0 +1,259 @@
+/*
+ * Copyright 2010-2018 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *  http://aws.amazon.com/apache2.0
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#include <aws/common/concurrent_hash_table.h>
+
+#include <aws/common/atomics.h>
+#include <aws/common/thread.h>
+
+#include <aws/testing/aws_test_harness.h>
+
+static uint64_t s_hash_int(const void *key) {
+    uint64_t h = (uint64_t)(uintptr_t)key;
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    return h;
+}
+
+static bool s_int_eq(const void *a, const void *b) {
+    return a == b;
+}
+
+/* Keys and values are small integers smuggled through pointers */
+#define INT_PTR(i) ((void *)(uintptr_t)(i))
+
+AWS_TEST_CASE(test_concurrent_hash_table_model, s_test_concurrent_hash_table_model_fn)
+static int s_test_concurrent_hash_table_model_fn(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    enum { KEY_SPACE = 2048, OPERATIONS = 30000 };
+
+    /* The model: zero means absent, since values are always non-zero */
+    size_t *values = aws_mem_acquire(allocator, KEY_SPACE * sizeof(size_t));
+    ASSERT_NOT_NULL(values);
+    memset(values, 0, KEY_SPACE * sizeof(size_t));
+    size_t present_count = 0;
+
+    struct aws_concurrent_hash_table map;
+    ASSERT_SUCCESS(aws_concurrent_hash_table_init(&map, allocator, 0, s_hash_int, s_int_eq, NULL, NULL));
+
+    uint64_t rand_state = 1;
+    for (size_t op = 0; op < OPERATIONS; op++) {
+        rand_state = rand_state * 6364136223846793005ULL + 1442695040888963407ULL;
+        size_t key = (size_t)(rand_state >> 33) % KEY_SPACE + 1;
+        bool put = ((rand_state >> 20) % 8) < (op < OPERATIONS / 2 ? 6u : 2u);
+
+        if (put) {
+            size_t value = op + 1;
+            int was_created = -1;
+            ASSERT_SUCCESS(aws_concurrent_hash_table_put(&map, INT_PTR(key), INT_PTR(value), &was_created));
+            ASSERT_INT_EQUALS(values[key - 1] == 0, was_created);
+            present_count += values[key - 1] == 0;
+            values[key - 1] = value;
+        } else {
+            int was_present = -1;
+            ASSERT_SUCCESS(aws_concurrent_hash_table_remove(&map, INT_PTR(key), &was_present));
+            ASSERT_INT_EQUALS(values[key - 1] != 0, was_present);
+            present_count -= values[key - 1] != 0;
+            values[key - 1] = 0;
+        }
+        ASSERT_UINT_EQUALS(present_count, aws_concurrent_hash_table_get_entry_count(&map));
+
+        if (op % 1000 == 0) {
+            struct aws_concurrent_hash_table_read_guard guard;
+            aws_concurrent_hash_table_read_begin(&map, &guard);
+            for (size_t k = 1; k <= KEY_SPACE; k++) {
+                const struct aws_hash_element *elem = NULL;
+                ASSERT_SUCCESS(aws_concurrent_hash_table_find(&map, INT_PTR(k), &elem));
+                if (values[k - 1]) {
+                    ASSERT_NOT_NULL(elem);
+                    ASSERT_PTR_EQUALS(INT_PTR(values[k - 1]), elem->value);
+                } else {
+                    ASSERT_NULL(elem);
+                }
+            }
+            aws_concurrent_hash_table_read_end(&map, &guard);
+        }
+    }
+
+    aws_concurrent_hash_table_clean_up(&map);
+    aws_concurrent_hash_table_clean_up(&map);
+    aws_mem_release(allocator, values);
+    return 0;
+}
+
+static size_t s_keys_destroyed;
+static size_t s_values_destroyed;
+
+static void s_count_key_destroy(void *key) {
+    (void)key;
+    s_keys_destroyed++;
+}
+
+static void s_count_value_destroy(void *value) {
+    (void)value;
+    s_values_destroyed++;
+}
+
+AWS_TEST_CASE(test_concurrent_hash_table_deferred_destroy, s_test_concurrent_hash_table_deferred_destroy_fn)
+static int s_test_concurrent_hash_table_deferred_destroy_fn(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    s_keys_destroyed = 0;
+    s_values_destroyed = 0;
+
+    struct aws_concurrent_hash_table map;
+    ASSERT_SUCCESS(aws_concurrent_hash_table_init(
+        &map, allocator, 0, s_hash_int, s_int_eq, s_count_key_destroy, s_count_value_destroy));
+
+    for (size_t i = 1; i <= 100; i++) {
+        ASSERT_SUCCESS(aws_concurrent_hash_table_put(&map, INT_PTR(i), INT_PTR(i), NULL));
+    }
+
+    /* Nothing removed while this section is open may be destroyed */
+    struct aws_concurrent_hash_table_read_guard guard;
+    aws_concurrent_hash_table_read_begin(&map, &guard);
+    const struct aws_hash_element *elem = NULL;
+    ASSERT_SUCCESS(aws_concurrent_hash_table_find(&map, INT_PTR(7), &elem));
+    ASSERT_NOT_NULL(elem);
+
+    /* Same key pointer: only the old value is destroyed */
+    ASSERT_SUCCESS(aws_concurrent_hash_table_put(&map, INT_PTR(7), INT_PTR(700), NULL));
+    for (size_t i = 50; i <= 100; i++) {
+        ASSERT_SUCCESS(aws_concurrent_hash_table_remove(&map, INT_PTR(i), NULL));
+    }
+    ASSERT_UINT_EQUALS(0, s_keys_destroyed);
+    ASSERT_UINT_EQUALS(0, s_values_destroyed);
+    ASSERT_PTR_EQUALS(INT_PTR(7), elem->value);
+
+    aws_concurrent_hash_table_read_end(&map, &guard);
+
+    /* With no readers, retirees are freed by later writes */
+    for (size_t i = 1; i <= 3; i++) {
+        ASSERT_SUCCESS(aws_concurrent_hash_table_remove(&map, INT_PTR(i), NULL));
+    }
+    ASSERT_TRUE(s_keys_destroyed >= 51);
+    ASSERT_TRUE(s_values_destroyed >= 52);
+
+    ASSERT_UINT_EQUALS(46, aws_concurrent_hash_table_get_entry_count(&map));
+    aws_concurrent_hash_table_clean_up(&map);
+
+    /* Every key was destroyed once, and every value put */
+    ASSERT_UINT_EQUALS(100, s_keys_destroyed);
+    ASSERT_UINT_EQUALS(101, s_values_destroyed);
+    return 0;
+}
+
+#define VALUE_ALIVE 0x600DF00DU
+#define VALUE_DEAD 0xDEADBEEFU
+
+struct checked_value {
+    size_t key;
+    uint32_t magic;
+};
+
+struct concurrent_test_data {
+    struct aws_allocator *allocator;
+    struct aws_concurrent_hash_table map;
+    struct aws_atomic_var done;
+    struct aws_atomic_var failures;
+    struct aws_atomic_var lookups;
+};
+
+static void s_destroy_checked_value(void *value) {
+    struct checked_value *checked = value;
+    /* Poison it, so that a reader which could still see it notices */
+    checked->magic = VALUE_DEAD;
+    aws_mem_release(aws_default_allocator(), checked);
+}
+
+enum { CONCURRENT_KEY_SPACE = 512 };
+
+static void s_reader_thread_fn(void *arg) {
+    struct concurrent_test_data *data = arg;
+    size_t key = 1;
+    size_t lookups = 0;
+
+    while (!aws_atomic_load_int(&data->done)) {
+        struct aws_concurrent_hash_table_read_guard guard;
+        aws_concurrent_hash_table_read_begin(&data->map, &guard);
+        for (int i = 0; i < 64; i++) {
+            key = key % CONCURRENT_KEY_SPACE + 1;
+            const struct aws_hash_element *elem = NULL;
+            aws_concurrent_hash_table_find(&data->map, INT_PTR(key), &elem);
+            if (elem) {
+                const struct checked_value *value = elem->value;
+                if (value->magic != VALUE_ALIVE || value->key != key) {
+                    aws_atomic_fetch_add(&data->failures, 1);
+                }
+            }
+            lookups++;
+        }
+        aws_concurrent_hash_table_read_end(&data->map, &guard);
+    }
+
+    aws_atomic_fetch_add(&data->lookups, lookups);
+}
+
+AWS_TEST_CASE(test_concurrent_hash_table_threaded, s_test_concurrent_hash_table_threaded_fn)
+static int s_test_concurrent_hash_table_threaded_fn(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+    (void)allocator;
+
+    enum { READERS = 4, WRITES = 200000 };
+
+    struct concurrent_test_data data;
+    data.allocator = aws_default_allocator();
+    aws_atomic_init_int(&data.done, 0);
+    aws_atomic_init_int(&data.failures, 0);
+    aws_atomic_init_int(&data.lookups, 0);
+    ASSERT_SUCCESS(aws_concurrent_hash_table_init(
+        &data.map, data.allocator, 0, s_hash_int, s_int_eq, NULL, s_destroy_checked_value));
+
+    struct aws_thread readers[READERS];
+    for (size_t i = 0; i < READERS; i++) {
+        ASSERT_SUCCESS(aws_thread_init(&readers[i], data.allocator));
+        ASSERT_SUCCESS(aws_thread_launch(&readers[i], s_reader_thread_fn, &data, NULL));
+    }
+
+    /* Puts (replacing as often as not) and removes, growing the table along the way */
+    uint64_t rand_state = 7;
+    for (size_t i = 0; i < WRITES; i++) {
+        rand_state = rand_state * 6364136223846793005ULL + 1442695040888963407ULL;
+        size_t key = (size_t)(rand_state >> 33) % CONCURRENT_KEY_SPACE + 1;
+        if ((rand_state >> 20) & 3) {
+            struct checked_value *value = aws_mem_acquire(data.allocator, sizeof(struct checked_value));
+            ASSERT_NOT_NULL(value);
+            value->key = key;
+            value->magic = VALUE_ALIVE;
+            ASSERT_SUCCESS(aws_concurrent_hash_table_put(&data.map, INT_PTR(key), value, NULL));
+        } else {
+            ASSERT_SUCCESS(aws_concurrent_hash_table_remove(&data.map, INT_PTR(key), NULL));
+        }
+    }
+
+    aws_atomic_store_int(&data.done, 1);
+    for (size_t i = 0; i < READERS; i++) {
+        ASSERT_SUCCESS(aws_thread_join(&readers[i]));
+        aws_thread_clean_up(&readers[i]);
+    }
+
+    ASSERT_UINT_EQUALS(0, aws_atomic_load_int(&data.failures));
+    ASSERT_TRUE(aws_atomic_load_int(&data.lookups) > 0);
+
+    aws_concurrent_hash_table_clean_up(&data.map);
+    return 0;
+}
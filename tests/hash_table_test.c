@@ -1246,3 +1246,722 @@ static int s_test_hash_table_byte_cursor_create_find_fn(struct aws_allocator *al
 
     return 0;
 }
+
+/*
+ * Drives a table through a deterministic sequence of random puts, removes and iterator deletes, checking it against
+ * a shadow model after every step. Keys are small integers encoded as pointers.
+ */
+#define MODEL_KEY_SPACE 2000
+#define MODEL_OPERATIONS 50000
+
+static uint64_t s_model_rand(uint64_t *state) {
+    *state = *state * 6364136223846793005ULL + 1442695040888963407ULL;
+    return *state >> 33;
+}
+
+static uint64_t s_hash_low_bits_only(const void *key) {
+    /* Deliberately weak: nothing in the upper bits, and only 32 distinct values */
+    return (uintptr_t)key & 0x1F;
+}
+
+static int s_hash_table_model_check(
+    struct aws_allocator *allocator,
+    aws_hash_fn *hash_fn,
+    const struct aws_hash_table_options *options) {
+
+    struct aws_hash_table hash_table;
+    ASSERT_SUCCESS(aws_hash_table_init_with_options(
+        &hash_table, allocator, 4, hash_fn, aws_ptr_eq, NULL, NULL, options));
+
+    uintptr_t *model = calloc(MODEL_KEY_SPACE, sizeof(*model));
+    ASSERT_NOT_NULL(model);
+    size_t model_count = 0;
+    uint64_t rng = 0x1234;
+
+    for (size_t op = 0; op < MODEL_OPERATIONS; op++) {
+        uintptr_t key = 1 + (uintptr_t)(s_model_rand(&rng) % MODEL_KEY_SPACE);
+        uint64_t action = s_model_rand(&rng) % 8;
+
+        if (action < 4) {
+            uintptr_t value = (uintptr_t)s_model_rand(&rng) + 1;
+            int was_created = 0;
+            ASSERT_SUCCESS(aws_hash_table_put(&hash_table, (void *)key, (void *)value, &was_created));
+            ASSERT_INT_EQUALS(model[key - 1] == 0, was_created);
+            if (was_created) {
+                model_count++;
+            }
+            model[key - 1] = value;
+        } else if (action < 7) {
+            int was_present = 0;
+            ASSERT_SUCCESS(aws_hash_table_remove(&hash_table, (void *)key, NULL, &was_present));
+            ASSERT_INT_EQUALS(model[key - 1] != 0, was_present);
+            if (was_present) {
+                model_count--;
+            }
+            model[key - 1] = 0;
+        } else if (s_model_rand(&rng) % 64 == 0) {
+            /* Occasionally sweep the table, deleting every other element we see */
+            size_t seen = 0;
+            for (struct aws_hash_iter iter = aws_hash_iter_begin(&hash_table); !aws_hash_iter_done(&iter);
+                 aws_hash_iter_next(&iter)) {
+                uintptr_t iter_key = (uintptr_t)iter.element.key;
+                ASSERT_TRUE(model[iter_key - 1] == (uintptr_t)iter.element.value);
+                if (seen++ % 2) {
+                    aws_hash_iter_delete(&iter, false);
+                    model[iter_key - 1] = 0;
+                    model_count--;
+                }
+            }
+        }
+
+        ASSERT_UINT_EQUALS(model_count, aws_hash_table_get_entry_count(&hash_table));
+
+        struct aws_hash_element *elem = NULL;
+        ASSERT_SUCCESS(aws_hash_table_find(&hash_table, (void *)key, &elem));
+        if (model[key - 1]) {
+            ASSERT_NOT_NULL(elem);
+            ASSERT_PTR_EQUALS((void *)model[key - 1], elem->value);
+        } else {
+            ASSERT_NULL(elem);
+        }
+    }
+
+    size_t iterated = 0;
+    for (struct aws_hash_iter iter = aws_hash_iter_begin(&hash_table); !aws_hash_iter_done(&iter);
+         aws_hash_iter_next(&iter)) {
+        ASSERT_TRUE(model[(uintptr_t)iter.element.key - 1] == (uintptr_t)iter.element.value);
+        iterated++;
+    }
+    ASSERT_UINT_EQUALS(model_count, iterated);
+
+    aws_hash_table_clear(&hash_table);
+    ASSERT_HASH_TABLE_ENTRY_COUNT(&hash_table, 0);
+
+    aws_hash_table_clean_up(&hash_table);
+    free(model);
+
+    return 0;
+}
+
+AWS_TEST_CASE(test_hash_table_robin_hood_model, s_test_hash_table_robin_hood_model_fn)
+static int s_test_hash_table_robin_hood_model_fn(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    return s_hash_table_model_check(allocator, aws_hash_ptr, NULL);
+}
+
+AWS_TEST_CASE(test_hash_table_grouped_model, s_test_hash_table_grouped_model_fn)
+static int s_test_hash_table_grouped_model_fn(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    struct aws_hash_table_options options = {.layout = AWS_HASH_TABLE_LAYOUT_GROUPED};
+    return s_hash_table_model_check(allocator, aws_hash_ptr, &options);
+}
+
+AWS_TEST_CASE(test_hash_table_grouped_weak_hash, s_test_hash_table_grouped_weak_hash_fn)
+static int s_test_hash_table_grouped_weak_hash_fn(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    struct aws_hash_table_options options = {.layout = AWS_HASH_TABLE_LAYOUT_GROUPED};
+    return s_hash_table_model_check(allocator, s_hash_low_bits_only, &options);
+}
+
+AWS_TEST_CASE(test_hash_table_grouped_string_keys, s_test_hash_table_grouped_string_keys_fn)
+static int s_test_hash_table_grouped_string_keys_fn(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    struct aws_hash_table_options options = {.layout = AWS_HASH_TABLE_LAYOUT_GROUPED};
+    struct aws_hash_table hash_table;
+    ASSERT_SUCCESS(aws_hash_table_init_with_options(
+        &hash_table,
+        allocator,
+        10,
+        aws_hash_string,
+        aws_hash_callback_string_eq,
+        aws_hash_callback_string_destroy,
+        aws_hash_callback_string_destroy,
+        &options));
+
+    AWS_STATIC_STRING_FROM_LITERAL(key_1, "tweedle dee");
+    AWS_STATIC_STRING_FROM_LITERAL(val_1, "tweedle dum");
+    struct aws_string *key_2 = aws_string_new_from_c_str(allocator, "what's for dinner?");
+    struct aws_string *val_2 = aws_string_new_from_c_str(allocator, "deadbeef");
+
+    ASSERT_SUCCESS(aws_hash_table_put(&hash_table, key_1, (void *)val_1, NULL));
+    ASSERT_SUCCESS(aws_hash_table_put(&hash_table, key_2, val_2, NULL));
+    ASSERT_HASH_TABLE_ENTRY_COUNT(&hash_table, 2);
+
+    ASSERT_KEY_VALUE(&hash_table, "tweedle dee", "tweedle dum");
+    ASSERT_KEY_VALUE(&hash_table, "what's for dinner?", "deadbeef");
+    ASSERT_NO_KEY(&hash_table, "hunter2");
+
+    int was_present = 0;
+    ASSERT_SUCCESS(aws_hash_table_remove(&hash_table, key_1, NULL, &was_present));
+    ASSERT_INT_EQUALS(1, was_present);
+    ASSERT_NO_KEY(&hash_table, "tweedle dee");
+    ASSERT_HASH_TABLE_ENTRY_COUNT(&hash_table, 1);
+
+    aws_hash_table_clean_up(&hash_table);
+    return 0;
+}
+
+AWS_TEST_CASE(test_hash_table_options_validation, s_test_hash_table_options_validation_fn)
+static int s_test_hash_table_options_validation_fn(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    struct aws_hash_table hash_table;
+    struct aws_hash_table_options options;
+
+    AWS_ZERO_STRUCT(options);
+    options.max_load_factor = 1.0;
+    ASSERT_ERROR(
+        AWS_ERROR_INVALID_ARGUMENT,
+        aws_hash_table_init_with_options(&hash_table, allocator, 10, aws_hash_ptr, aws_ptr_eq, NULL, NULL, &options));
+
+    AWS_ZERO_STRUCT(options);
+    options.max_load_factor = -0.5;
+    ASSERT_ERROR(
+        AWS_ERROR_INVALID_ARGUMENT,
+        aws_hash_table_init_with_options(&hash_table, allocator, 10, aws_hash_ptr, aws_ptr_eq, NULL, NULL, &options));
+
+    AWS_ZERO_STRUCT(options);
+    options.growth_multiplier = 1;
+    ASSERT_ERROR(
+        AWS_ERROR_INVALID_ARGUMENT,
+        aws_hash_table_init_with_options(&hash_table, allocator, 10, aws_hash_ptr, aws_ptr_eq, NULL, NULL, &options));
+
+    /* A shrink threshold this close to the growth threshold would thrash */
+    AWS_ZERO_STRUCT(options);
+    options.max_load_factor = 0.5;
+    options.shrink_load_factor = 0.25;
+    ASSERT_ERROR(
+        AWS_ERROR_INVALID_ARGUMENT,
+        aws_hash_table_init_with_options(&hash_table, allocator, 10, aws_hash_ptr, aws_ptr_eq, NULL, NULL, &options));
+
+    options.shrink_load_factor = 0.2;
+    ASSERT_SUCCESS(
+        aws_hash_table_init_with_options(&hash_table, allocator, 10, aws_hash_ptr, aws_ptr_eq, NULL, NULL, &options));
+    aws_hash_table_clean_up(&hash_table);
+
+    return 0;
+}
+
+AWS_TEST_CASE(test_hash_table_growth_policy_model, s_test_hash_table_growth_policy_model_fn)
+static int s_test_hash_table_growth_policy_model_fn(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    struct aws_hash_table_options options;
+    AWS_ZERO_STRUCT(options);
+    options.max_load_factor = 0.5;
+    options.growth_multiplier = 3; /* rounded up to 4 */
+    options.shrink_load_factor = 0.1;
+
+    ASSERT_SUCCESS(s_hash_table_model_check(allocator, aws_hash_ptr, &options));
+
+    options.layout = AWS_HASH_TABLE_LAYOUT_GROUPED;
+    ASSERT_SUCCESS(s_hash_table_model_check(allocator, aws_hash_ptr, &options));
+
+    return 0;
+}
+
+AWS_TEST_CASE(test_hash_table_incremental_resize_model, s_test_hash_table_incremental_resize_model_fn)
+static int s_test_hash_table_incremental_resize_model_fn(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    struct aws_hash_table_options options;
+    AWS_ZERO_STRUCT(options);
+    options.incremental_resize = true;
+    ASSERT_SUCCESS(s_hash_table_model_check(allocator, aws_hash_ptr, &options));
+
+    options.shrink_load_factor = 0.2;
+    ASSERT_SUCCESS(s_hash_table_model_check(allocator, aws_hash_ptr, &options));
+
+    options.layout = AWS_HASH_TABLE_LAYOUT_GROUPED;
+    ASSERT_SUCCESS(s_hash_table_model_check(allocator, aws_hash_ptr, &options));
+    ASSERT_SUCCESS(s_hash_table_model_check(allocator, s_hash_low_bits_only, &options));
+
+    return 0;
+}
+
+static bool s_value_in_range(uintptr_t value, uintptr_t limit) {
+    return value >= 1 && value <= limit;
+}
+
+AWS_TEST_CASE(test_hash_table_incremental_resize_iteration, s_test_hash_table_incremental_resize_iteration_fn)
+static int s_test_hash_table_incremental_resize_iteration_fn(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    struct aws_hash_table_options options;
+    AWS_ZERO_STRUCT(options);
+    options.incremental_resize = true;
+
+    struct aws_hash_table hash_table;
+    ASSERT_SUCCESS(
+        aws_hash_table_init_with_options(&hash_table, allocator, 16, aws_hash_ptr, aws_ptr_eq, NULL, NULL, &options));
+
+    const uintptr_t key_count = 5000;
+    uint8_t *seen = calloc(key_count + 1, 1);
+    ASSERT_NOT_NULL(seen);
+
+    for (uintptr_t key = 1; key <= key_count; key++) {
+        ASSERT_SUCCESS(aws_hash_table_put(&hash_table, (void *)key, (void *)key, NULL));
+
+        if (key % 37) {
+            continue;
+        }
+
+        /* Iteration must see every entry exactly once, wherever it currently lives */
+        memset(seen, 0, key_count + 1);
+        size_t iterated = 0;
+        for (struct aws_hash_iter iter = aws_hash_iter_begin(&hash_table); !aws_hash_iter_done(&iter);
+             aws_hash_iter_next(&iter)) {
+            uintptr_t iter_key = (uintptr_t)iter.element.key;
+            ASSERT_TRUE(s_value_in_range(iter_key, key));
+            ASSERT_PTR_EQUALS(iter.element.key, iter.element.value);
+            ASSERT_UINT_EQUALS(0, seen[iter_key]);
+            seen[iter_key] = 1;
+            iterated++;
+        }
+        ASSERT_UINT_EQUALS(key, iterated);
+        ASSERT_UINT_EQUALS(key, aws_hash_table_get_entry_count(&hash_table));
+    }
+
+    /* Delete the even keys through an iterator, then make sure exactly the odd ones remain */
+    for (struct aws_hash_iter iter = aws_hash_iter_begin(&hash_table); !aws_hash_iter_done(&iter);
+         aws_hash_iter_next(&iter)) {
+        if (!((uintptr_t)iter.element.key % 2)) {
+            aws_hash_iter_delete(&iter, false);
+        }
+    }
+    ASSERT_UINT_EQUALS(key_count / 2, aws_hash_table_get_entry_count(&hash_table));
+
+    for (uintptr_t key = 1; key <= key_count; key++) {
+        struct aws_hash_element *elem = NULL;
+        ASSERT_SUCCESS(aws_hash_table_find(&hash_table, (void *)key, &elem));
+        ASSERT_TRUE((key % 2) == (elem != NULL));
+    }
+
+    free(seen);
+    aws_hash_table_clean_up(&hash_table);
+    return 0;
+}
+
+AWS_TEST_CASE(test_hash_table_stats, s_test_hash_table_stats_fn)
+static int s_test_hash_table_stats_fn(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    struct aws_hash_table hash_table;
+    struct aws_hash_table_stats stats;
+    ASSERT_SUCCESS(aws_hash_table_init(&hash_table, allocator, 16, hash_collide, aws_ptr_eq, NULL, NULL));
+
+    ASSERT_SUCCESS(aws_hash_table_get_stats(&hash_table, &stats));
+    ASSERT_UINT_EQUALS(0, stats.entry_count);
+    ASSERT_UINT_EQUALS(16, stats.capacity);
+    ASSERT_TRUE(stats.bytes_used >= 16 * (2 * sizeof(void *) + sizeof(uint64_t)));
+    ASSERT_UINT_EQUALS(0, stats.max_displacement);
+
+    /* With every key colliding, displacements are exactly 0, 1, 2, 3, 4 */
+    for (uintptr_t key = 1; key <= 5; key++) {
+        ASSERT_SUCCESS(aws_hash_table_put(&hash_table, (void *)key, NULL, NULL));
+    }
+
+    ASSERT_SUCCESS(aws_hash_table_get_stats(&hash_table, &stats));
+    ASSERT_UINT_EQUALS(5, stats.entry_count);
+    ASSERT_UINT_EQUALS(16, stats.capacity);
+    ASSERT_UINT_EQUALS(0, stats.resize_count);
+    ASSERT_UINT_EQUALS(4, stats.max_displacement);
+    ASSERT_UINT_EQUALS(2, stats.median_displacement);
+    ASSERT_TRUE(stats.average_displacement > 1.99 && stats.average_displacement < 2.01);
+    for (size_t i = 0; i < 5; i++) {
+        ASSERT_UINT_EQUALS(1, stats.displacement_histogram[i]);
+    }
+
+    /* 20 colliding keys overflow the histogram into its last bucket and force a resize */
+    for (uintptr_t key = 6; key <= 20; key++) {
+        ASSERT_SUCCESS(aws_hash_table_put(&hash_table, (void *)key, NULL, NULL));
+    }
+
+    ASSERT_SUCCESS(aws_hash_table_get_stats(&hash_table, &stats));
+    ASSERT_UINT_EQUALS(20, stats.entry_count);
+    ASSERT_UINT_EQUALS(32, stats.capacity);
+    ASSERT_UINT_EQUALS(1, stats.resize_count);
+    ASSERT_UINT_EQUALS(19, stats.max_displacement);
+    ASSERT_UINT_EQUALS(5, stats.displacement_histogram[AWS_HASH_TABLE_STATS_HISTOGRAM_SIZE - 1]);
+
+    aws_hash_table_clean_up(&hash_table);
+    return 0;
+}
+
+AWS_TEST_CASE(test_hash_table_stats_grouped, s_test_hash_table_stats_grouped_fn)
+static int s_test_hash_table_stats_grouped_fn(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    struct aws_hash_table_options options;
+    AWS_ZERO_STRUCT(options);
+    options.layout = AWS_HASH_TABLE_LAYOUT_GROUPED;
+
+    struct aws_hash_table hash_table;
+    struct aws_hash_table_stats stats;
+    ASSERT_SUCCESS(
+        aws_hash_table_init_with_options(&hash_table, allocator, 64, hash_collide, aws_ptr_eq, NULL, NULL, &options));
+
+    /* The first 16 colliding keys fill the home group; the rest spill into the next group probed */
+    for (uintptr_t key = 1; key <= 20; key++) {
+        ASSERT_SUCCESS(aws_hash_table_put(&hash_table, (void *)key, NULL, NULL));
+    }
+
+    ASSERT_SUCCESS(aws_hash_table_get_stats(&hash_table, &stats));
+    ASSERT_UINT_EQUALS(20, stats.entry_count);
+    ASSERT_UINT_EQUALS(64, stats.capacity);
+    ASSERT_UINT_EQUALS(1, stats.max_displacement);
+    ASSERT_UINT_EQUALS(0, stats.median_displacement);
+    ASSERT_UINT_EQUALS(16, stats.displacement_histogram[0]);
+    ASSERT_UINT_EQUALS(4, stats.displacement_histogram[1]);
+
+    /* Removing from a full group leaves a tombstone */
+    ASSERT_SUCCESS(aws_hash_table_remove(&hash_table, (void *)1, NULL, NULL));
+    ASSERT_SUCCESS(aws_hash_table_get_stats(&hash_table, &stats));
+    ASSERT_UINT_EQUALS(19, stats.entry_count);
+    ASSERT_UINT_EQUALS(1, stats.tombstone_count);
+
+    aws_hash_table_clean_up(&hash_table);
+    return 0;
+}
+
+AWS_TEST_CASE(test_hash_table_stats_resize_policy, s_test_hash_table_stats_resize_policy_fn)
+static int s_test_hash_table_stats_resize_policy_fn(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    struct aws_hash_table_options options;
+    AWS_ZERO_STRUCT(options);
+    options.max_load_factor = 0.5;
+    options.growth_multiplier = 4;
+    options.shrink_load_factor = 0.1;
+    options.incremental_resize = true;
+
+    struct aws_hash_table hash_table;
+    struct aws_hash_table_stats stats;
+    ASSERT_SUCCESS(
+        aws_hash_table_init_with_options(&hash_table, allocator, 16, aws_hash_ptr, aws_ptr_eq, NULL, NULL, &options));
+
+    /* Crossing the threshold starts a resize to 4x, with both slot arrays live until the move completes */
+    for (uintptr_t key = 1; key <= 9; key++) {
+        ASSERT_SUCCESS(aws_hash_table_put(&hash_table, (void *)key, NULL, NULL));
+    }
+    ASSERT_SUCCESS(aws_hash_table_get_stats(&hash_table, &stats));
+    ASSERT_UINT_EQUALS(9, stats.entry_count);
+    ASSERT_UINT_EQUALS(1, stats.resize_count);
+    ASSERT_UINT_EQUALS(64 + 16, stats.capacity);
+
+    /* Each operation examines a bounded number of old slots, so two more puts are enough to finish the move */
+    ASSERT_SUCCESS(aws_hash_table_put(&hash_table, (void *)10, NULL, NULL));
+    ASSERT_SUCCESS(aws_hash_table_put(&hash_table, (void *)11, NULL, NULL));
+    ASSERT_SUCCESS(aws_hash_table_get_stats(&hash_table, &stats));
+    ASSERT_UINT_EQUALS(11, stats.entry_count);
+    ASSERT_UINT_EQUALS(64, stats.capacity);
+
+    /* Dropping below 10% occupancy (6 of 64 slots) shrinks back to the initial size */
+    for (uintptr_t key = 1; key <= 5; key++) {
+        ASSERT_SUCCESS(aws_hash_table_remove(&hash_table, (void *)key, NULL, NULL));
+    }
+    ASSERT_SUCCESS(aws_hash_table_get_stats(&hash_table, &stats));
+    ASSERT_UINT_EQUALS(1, stats.resize_count);
+    ASSERT_SUCCESS(aws_hash_table_remove(&hash_table, (void *)6, NULL, NULL));
+    ASSERT_SUCCESS(aws_hash_table_get_stats(&hash_table, &stats));
+    ASSERT_UINT_EQUALS(5, stats.entry_count);
+    ASSERT_UINT_EQUALS(2, stats.resize_count);
+
+    /* Removing absent keys still moves entries along */
+    for (uintptr_t key = 1; key <= 6; key++) {
+        ASSERT_SUCCESS(aws_hash_table_remove(&hash_table, (void *)key, NULL, NULL));
+    }
+    ASSERT_SUCCESS(aws_hash_table_get_stats(&hash_table, &stats));
+    ASSERT_UINT_EQUALS(5, stats.entry_count);
+    ASSERT_UINT_EQUALS(16, stats.capacity);
+
+    aws_hash_table_clean_up(&hash_table);
+    return 0;
+}
+
+static void s_fill_hash_wide_input(uint8_t *buf, size_t len) {
+    for (size_t i = 0; i < len; i++) {
+        buf[i] = (uint8_t)(i * 131 + 7);
+    }
+}
+
+/*
+ * Hash values are fixed across platforms, and must not change depending on whether the AVX2 path is used; this test
+ * is run a second time with AWS_COMMON_AVX2=0.
+ */
+AWS_TEST_CASE(test_hash_wide_known_values, s_test_hash_wide_known_values_fn)
+static int s_test_hash_wide_known_values_fn(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    static const struct {
+        size_t len;
+        uint64_t hash;
+        uint64_t seeded_hash;
+    } known_values[] = {
+        {0, 0x0409638ee2bde459ULL, 0x2b4e3df129b1f482ULL},
+        {1, 0xfddeeeea8cc2709cULL, 0x9238c26d4f1abae8ULL},
+        {3, 0x8e4fbcba74db6389ULL, 0xf63df5be5f89db5eULL},
+        {4, 0xe51e02146ebec632ULL, 0x5bb3f19f5f9b0819ULL},
+        {7, 0xdb77847ec664fba9ULL, 0x07d5d867b77de141ULL},
+        {8, 0x6ad2fe40e65970edULL, 0x60c19ebfa927db43ULL},
+        {16, 0x47340008ff15ca56ULL, 0x3a2aa0157d823d7cULL},
+        {17, 0x8700d4e8fbdc902bULL, 0x92d1265818c04409ULL},
+        {48, 0xb61c237f7239a6efULL, 0x407c0e04666300e2ULL},
+        {49, 0x601195ce2f825428ULL, 0x29a0aef7dc5822c2ULL},
+        {97, 0xdcc086aedff28caeULL, 0xae8e46007293bd80ULL},
+        {1024, 0x765f7942b87ed23eULL, 0xc0815900aea75f88ULL},
+        {1025, 0x550b45498618834aULL, 0x16607ce36c9e8703ULL},
+        {1088, 0x0bffba1f50eb6649ULL, 0xbe04f7f61cb9d36eULL},
+        {2049, 0x4a12bc5eceeb0f0eULL, 0x1c839f1be6a9286dULL},
+        {5000, 0x66905c135431a456ULL, 0x0b7b8f15d564d03eULL},
+    };
+
+    size_t buf_len = 5000;
+    uint8_t *buf = aws_mem_acquire(allocator, buf_len);
+    ASSERT_NOT_NULL(buf);
+    s_fill_hash_wide_input(buf, buf_len);
+
+    for (size_t i = 0; i < AWS_ARRAY_SIZE(known_values); i++) {
+        ASSERT_UINT_EQUALS(known_values[i].hash, aws_hash_wide_bytes(buf, known_values[i].len, 0));
+        ASSERT_UINT_EQUALS(
+            known_values[i].seeded_hash, aws_hash_wide_bytes(buf, known_values[i].len, 0x0123456789abcdefULL));
+    }
+
+    aws_mem_release(allocator, buf);
+    return 0;
+}
+
+AWS_TEST_CASE(test_hash_wide_consistency, s_test_hash_wide_consistency_fn)
+static int s_test_hash_wide_consistency_fn(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    /* The convenience functions agree with each other */
+    const char *c_str = "x-amz-content-sha256";
+    struct aws_string *str = aws_string_new_from_c_str(allocator, c_str);
+    struct aws_byte_cursor cursor = aws_byte_cursor_from_c_str(c_str);
+    ASSERT_UINT_EQUALS(aws_hash_wide_bytes(c_str, strlen(c_str), 0), aws_hash_wide_c_string(c_str));
+    ASSERT_UINT_EQUALS(aws_hash_wide_c_string(c_str), aws_hash_wide_string(str));
+    ASSERT_UINT_EQUALS(aws_hash_wide_c_string(c_str), aws_hash_wide_byte_cursor_ptr(&cursor));
+    aws_string_destroy(str);
+
+    size_t max_len = 2200;
+    uint8_t *buf = aws_mem_acquire(allocator, max_len + 8);
+    uint8_t *copy = aws_mem_acquire(allocator, max_len + 8);
+    ASSERT_NOT_NULL(buf);
+    ASSERT_NOT_NULL(copy);
+    s_fill_hash_wide_input(buf, max_len + 8);
+
+    for (size_t len = 0; len <= max_len; len++) {
+        uint64_t hash = aws_hash_wide_bytes(buf, len, 0);
+
+        /* Alignment doesn't matter */
+        size_t offset = len % 8;
+        memcpy(copy + offset, buf, len);
+        ASSERT_UINT_EQUALS(hash, aws_hash_wide_bytes(copy + offset, len, 0));
+
+        /* Neither the seed nor the length is ignored */
+        ASSERT_FALSE(hash == aws_hash_wide_bytes(buf, len, 1));
+        ASSERT_FALSE(hash == aws_hash_wide_bytes(buf, len + 1, 0));
+
+        /* Every byte contributes: flip a bit at the start, the end, and a position that moves through the key */
+        if (len > 0) {
+            size_t positions[] = {0, len - 1, (len * 7) / 13};
+            for (size_t p = 0; p < AWS_ARRAY_SIZE(positions); p++) {
+                copy[offset + positions[p]] ^= 0x10;
+                ASSERT_FALSE(hash == aws_hash_wide_bytes(copy + offset, len, 0));
+                copy[offset + positions[p]] ^= 0x10;
+            }
+        }
+    }
+
+    aws_mem_release(allocator, copy);
+    aws_mem_release(allocator, buf);
+    return 0;
+}
+
+AWS_TEST_CASE(test_hash_table_seeded_hash, s_test_hash_table_seeded_hash_fn)
+static int s_test_hash_table_seeded_hash_fn(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    const char *c_str = "content-type";
+    struct aws_byte_cursor cursor = aws_byte_cursor_from_c_str(c_str);
+    struct aws_string *str = aws_string_new_from_c_str(allocator, c_str);
+    ASSERT_UINT_EQUALS(aws_hash_wide_bytes(c_str, strlen(c_str), 42), aws_hash_wide_c_string_seeded(c_str, 42));
+    ASSERT_UINT_EQUALS(aws_hash_wide_c_string_seeded(c_str, 42), aws_hash_wide_string_seeded(str, 42));
+    ASSERT_UINT_EQUALS(aws_hash_wide_c_string_seeded(c_str, 42), aws_hash_wide_byte_cursor_ptr_seeded(&cursor, 42));
+    ASSERT_UINT_EQUALS(aws_hash_wide_c_string(c_str), aws_hash_wide_c_string_seeded(c_str, 0));
+    aws_string_destroy(str);
+
+    struct aws_hash_table_options options;
+    AWS_ZERO_STRUCT(options);
+
+    /* Some hash function is required */
+    struct aws_hash_table hash_table;
+    ASSERT_ERROR(
+        AWS_ERROR_INVALID_ARGUMENT,
+        aws_hash_table_init_with_options(
+            &hash_table, allocator, 10, NULL, aws_hash_callback_c_str_eq, NULL, NULL, &options));
+
+    /* With a seeded hash, hash_fn may be NULL */
+    options.seeded_hash_fn = aws_hash_wide_c_string_seeded;
+    ASSERT_SUCCESS(aws_hash_table_init_with_options(
+        &hash_table, allocator, 10, NULL, aws_hash_callback_c_str_eq, NULL, NULL, &options));
+
+    char keys[100][8];
+    for (size_t i = 0; i < AWS_ARRAY_SIZE(keys); i++) {
+        snprintf(keys[i], sizeof(keys[i]), "key%zu", i);
+        ASSERT_SUCCESS(aws_hash_table_put(&hash_table, keys[i], (void *)(i + 1), NULL));
+    }
+    for (size_t i = 0; i < AWS_ARRAY_SIZE(keys); i++) {
+        struct aws_hash_element *elem = NULL;
+        ASSERT_SUCCESS(aws_hash_table_find(&hash_table, keys[i], &elem));
+        ASSERT_NOT_NULL(elem);
+        ASSERT_PTR_EQUALS((void *)(i + 1), elem->value);
+    }
+    ASSERT_SUCCESS(aws_hash_table_remove(&hash_table, keys[7], NULL, NULL));
+    ASSERT_HASH_TABLE_ENTRY_COUNT(&hash_table, 99);
+
+    aws_hash_table_clean_up(&hash_table);
+    return 0;
+}
+
+/*
+ * Keys chosen so that their unseeded hashes all land in the same slot pile into one long probe sequence; with a
+ * per-table seed, the same keys spread out.
+ */
+AWS_TEST_CASE(test_hash_table_seeded_hash_flooding, s_test_hash_table_seeded_hash_flooding_fn)
+static int s_test_hash_table_seeded_hash_flooding_fn(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    enum { TABLE_SIZE = 1024, KEY_COUNT = 200 };
+
+    uint64_t key_values[KEY_COUNT];
+    struct aws_byte_cursor keys[KEY_COUNT];
+    size_t found = 0;
+    for (uint64_t candidate = 0; found < KEY_COUNT; candidate++) {
+        if ((aws_hash_wide_bytes(&candidate, sizeof(candidate), 0) & (TABLE_SIZE - 1)) == 0) {
+            key_values[found] = candidate;
+            keys[found] = aws_byte_cursor_from_array(&key_values[found], sizeof(key_values[found]));
+            found++;
+        }
+    }
+
+    struct aws_hash_table_options options;
+    AWS_ZERO_STRUCT(options);
+
+    struct aws_hash_table unseeded;
+    ASSERT_SUCCESS(aws_hash_table_init_with_options(
+        &unseeded,
+        allocator,
+        TABLE_SIZE,
+        aws_hash_wide_byte_cursor_ptr,
+        (aws_hash_callback_eq_fn *)aws_byte_cursor_eq,
+        NULL,
+        NULL,
+        &options));
+
+    options.seeded_hash_fn = aws_hash_wide_byte_cursor_ptr_seeded;
+    struct aws_hash_table seeded;
+    ASSERT_SUCCESS(aws_hash_table_init_with_options(
+        &seeded, allocator, TABLE_SIZE, NULL, (aws_hash_callback_eq_fn *)aws_byte_cursor_eq, NULL, NULL, &options));
+
+    for (size_t i = 0; i < KEY_COUNT; i++) {
+        ASSERT_SUCCESS(aws_hash_table_put(&unseeded, &keys[i], NULL, NULL));
+        ASSERT_SUCCESS(aws_hash_table_put(&seeded, &keys[i], NULL, NULL));
+    }
+
+    struct aws_hash_table_stats stats;
+    ASSERT_SUCCESS(aws_hash_table_get_stats(&unseeded, &stats));
+    ASSERT_UINT_EQUALS(TABLE_SIZE, stats.capacity);
+    ASSERT_UINT_EQUALS(KEY_COUNT - 1, stats.max_displacement);
+
+    ASSERT_SUCCESS(aws_hash_table_get_stats(&seeded, &stats));
+    ASSERT_UINT_EQUALS(TABLE_SIZE, stats.capacity);
+    ASSERT_TRUE(stats.max_displacement < 32);
+
+    aws_hash_table_clean_up(&unseeded);
+    aws_hash_table_clean_up(&seeded);
+    return 0;
+}
+
+static int s_hash_table_batch_check(struct aws_allocator *allocator, const struct aws_hash_table_options *options) {
+    enum { PUT_COUNT = 1000, DISTINCT_KEYS = 700, FIND_COUNT = 2 * DISTINCT_KEYS };
+
+    struct aws_hash_table hash_table;
+    ASSERT_SUCCESS(
+        aws_hash_table_init_with_options(&hash_table, allocator, 8, aws_hash_ptr, aws_ptr_eq, NULL, NULL, options));
+
+    /* The tail of the batch repeats keys from the head, and the table starts small enough to resize mid-batch */
+    const void *keys[PUT_COUNT];
+    void *values[PUT_COUNT];
+    int was_created[PUT_COUNT];
+    for (size_t i = 0; i < PUT_COUNT; i++) {
+        keys[i] = (void *)(uintptr_t)(i % DISTINCT_KEYS + 1);
+        values[i] = (void *)(uintptr_t)(i + 1);
+    }
+    ASSERT_SUCCESS(aws_hash_table_put_many(&hash_table, keys, values, PUT_COUNT, was_created));
+    ASSERT_UINT_EQUALS(DISTINCT_KEYS, aws_hash_table_get_entry_count(&hash_table));
+    for (size_t i = 0; i < PUT_COUNT; i++) {
+        ASSERT_INT_EQUALS(i < DISTINCT_KEYS, was_created[i]);
+    }
+
+    /* Half of these are absent */
+    const void *find_keys[FIND_COUNT];
+    struct aws_hash_element *elems[FIND_COUNT];
+    for (size_t i = 0; i < FIND_COUNT; i++) {
+        find_keys[i] = (void *)(uintptr_t)(FIND_COUNT - i);
+    }
+    ASSERT_SUCCESS(aws_hash_table_find_many(&hash_table, find_keys, FIND_COUNT, elems));
+
+    for (size_t i = 0; i < FIND_COUNT; i++) {
+        struct aws_hash_element *elem = NULL;
+        ASSERT_SUCCESS(aws_hash_table_find(&hash_table, find_keys[i], &elem));
+        ASSERT_PTR_EQUALS(elem, elems[i]);
+
+        uintptr_t key = (uintptr_t)find_keys[i];
+        if (key > DISTINCT_KEYS) {
+            ASSERT_NULL(elem);
+            continue;
+        }
+
+        /* The last put of each key wins */
+        uintptr_t expected = key - 1;
+        while (expected + DISTINCT_KEYS < PUT_COUNT) {
+            expected += DISTINCT_KEYS;
+        }
+        ASSERT_NOT_NULL(elem);
+        ASSERT_PTR_EQUALS((void *)(expected + 1), elem->value);
+    }
+
+    /* An empty batch is a no-op */
+    ASSERT_SUCCESS(aws_hash_table_put_many(&hash_table, NULL, NULL, 0, NULL));
+    ASSERT_SUCCESS(aws_hash_table_find_many(&hash_table, NULL, 0, NULL));
+
+    aws_hash_table_clean_up(&hash_table);
+    return 0;
+}
+
+AWS_TEST_CASE(test_hash_table_batch_operations, s_test_hash_table_batch_operations_fn)
+static int s_test_hash_table_batch_operations_fn(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    struct aws_hash_table_options options;
+    AWS_ZERO_STRUCT(options);
+    ASSERT_SUCCESS(s_hash_table_batch_check(allocator, &options));
+
+    options.layout = AWS_HASH_TABLE_LAYOUT_GROUPED;
+    ASSERT_SUCCESS(s_hash_table_batch_check(allocator, &options));
+
+    /* Lookups must also check the old slot array while a resize is underway */
+    options.incremental_resize = true;
+    ASSERT_SUCCESS(s_hash_table_batch_check(allocator, &options));
+
+    options.layout = AWS_HASH_TABLE_LAYOUT_ROBIN_HOOD;
+    ASSERT_SUCCESS(s_hash_table_batch_check(allocator, &options));
+
+    return 0;
+}
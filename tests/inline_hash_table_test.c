@@ -0,0 +1,244 @@
+/*
+ * Copyright 2010-2018 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *  http://aws.amazon.com/apache2.0
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#include <aws/common/inline_hash_table.h>
+
+#include <aws/testing/aws_test_harness.h>
+
+static uint64_t s_rand_state;
+
+static uint64_t s_rand(void) {
+    s_rand_state = s_rand_state * 6364136223846793005ULL + 1442695040888963407ULL;
+    return s_rand_state >> 17;
+}
+
+AWS_TEST_CASE(test_inline_hash_table_model, s_test_inline_hash_table_model_fn)
+static int s_test_inline_hash_table_model_fn(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    enum { KEY_SPACE = 4096, OPERATIONS = 50000 };
+
+    /* The model: values[k] is meaningful when present[k] */
+    uint32_t *values = aws_mem_acquire(allocator, KEY_SPACE * sizeof(uint32_t));
+    bool *present = aws_mem_acquire(allocator, KEY_SPACE * sizeof(bool));
+    ASSERT_NOT_NULL(values);
+    ASSERT_NOT_NULL(present);
+    memset(present, 0, KEY_SPACE * sizeof(bool));
+    size_t present_count = 0;
+
+    struct aws_inline_hash_table table;
+    ASSERT_SUCCESS(aws_inline_hash_table_init(&table, allocator, sizeof(uint64_t), sizeof(uint32_t), 4));
+
+    s_rand_state = 1;
+    for (size_t op = 0; op < OPERATIONS; op++) {
+        uint64_t key = s_rand() % KEY_SPACE;
+
+        /* Bias towards puts for the first half, and removes for the second, so the table grows and then drains */
+        uint64_t choice = s_rand() % 8;
+        bool put = op < OPERATIONS / 2 ? choice < 5 : choice < 3;
+
+        if (put) {
+            uint32_t value = (uint32_t)s_rand();
+            int was_created = -1;
+            ASSERT_SUCCESS(aws_inline_hash_table_put(&table, &key, &value, &was_created));
+            ASSERT_INT_EQUALS(!present[key], was_created);
+            if (!present[key]) {
+                present[key] = true;
+                present_count++;
+            }
+            values[key] = value;
+        } else {
+            uint32_t removed = 0;
+            int was_present = -1;
+            ASSERT_SUCCESS(aws_inline_hash_table_remove(&table, &key, &removed, &was_present));
+            ASSERT_INT_EQUALS(present[key], was_present);
+            if (present[key]) {
+                ASSERT_UINT_EQUALS(values[key], removed);
+                present[key] = false;
+                present_count--;
+            }
+        }
+
+        ASSERT_UINT_EQUALS(present_count, aws_inline_hash_table_get_entry_count(&table));
+
+        if (op % 1000 == 0) {
+            for (uint64_t k = 0; k < KEY_SPACE; k++) {
+                uint32_t *found = aws_inline_hash_table_find(&table, &k);
+                if (present[k]) {
+                    ASSERT_NOT_NULL(found);
+                    ASSERT_UINT_EQUALS(values[k], *found);
+                } else {
+                    ASSERT_NULL(found);
+                }
+            }
+
+            size_t iterated = 0;
+            for (struct aws_inline_hash_iter iter = aws_inline_hash_iter_begin(&table);
+                 !aws_inline_hash_iter_done(&iter);
+                 aws_inline_hash_iter_next(&iter)) {
+                uint64_t k;
+                memcpy(&k, iter.key, sizeof(k));
+                ASSERT_TRUE(k < KEY_SPACE && present[k]);
+                ASSERT_UINT_EQUALS(values[k], *(uint32_t *)iter.value);
+                iterated++;
+            }
+            ASSERT_UINT_EQUALS(present_count, iterated);
+        }
+    }
+
+    aws_inline_hash_table_clear(&table);
+    ASSERT_UINT_EQUALS(0, aws_inline_hash_table_get_entry_count(&table));
+    struct aws_inline_hash_iter iter = aws_inline_hash_iter_begin(&table);
+    ASSERT_TRUE(aws_inline_hash_iter_done(&iter));
+
+    aws_inline_hash_table_clean_up(&table);
+    aws_inline_hash_table_clean_up(&table);
+    aws_mem_release(allocator, values);
+    aws_mem_release(allocator, present);
+    return 0;
+}
+
+AWS_TEST_CASE(test_inline_hash_table_sizes, s_test_inline_hash_table_sizes_fn)
+static int s_test_inline_hash_table_sizes_fn(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    static const size_t key_sizes[] = {1, 2, 3, 4, 8, 12, 16, 24};
+    static const size_t value_sizes[] = {0, 1, 2, 4, 6, 8, 12, 32};
+
+    struct aws_inline_hash_table table;
+    ASSERT_ERROR(AWS_ERROR_INVALID_ARGUMENT, aws_inline_hash_table_init(&table, allocator, 0, 8, 0));
+
+    for (size_t k = 0; k < AWS_ARRAY_SIZE(key_sizes); k++) {
+        for (size_t v = 0; v < AWS_ARRAY_SIZE(value_sizes); v++) {
+            size_t key_size = key_sizes[k];
+            size_t value_size = value_sizes[v];
+            ASSERT_SUCCESS(aws_inline_hash_table_init(&table, allocator, key_size, value_size, 0));
+
+            /* A 1-byte key only has 256 values */
+            size_t count = key_size == 1 ? 256 : 1000;
+            uint8_t key[24];
+            uint8_t value[32];
+            for (size_t i = 0; i < count; i++) {
+                memset(key, 0, sizeof(key));
+                memset(value, 0, sizeof(value));
+                memcpy(key, &i, key_size < sizeof(i) ? key_size : sizeof(i));
+                memcpy(value, &i, value_size < sizeof(i) ? value_size : sizeof(i));
+                ASSERT_SUCCESS(aws_inline_hash_table_put(&table, key, value_size ? value : NULL, NULL));
+            }
+            ASSERT_UINT_EQUALS(count, aws_inline_hash_table_get_entry_count(&table));
+
+            for (size_t i = 0; i < count; i++) {
+                memset(key, 0, sizeof(key));
+                memset(value, 0, sizeof(value));
+                memcpy(key, &i, key_size < sizeof(i) ? key_size : sizeof(i));
+                memcpy(value, &i, value_size < sizeof(i) ? value_size : sizeof(i));
+
+                uint8_t *found = aws_inline_hash_table_find(&table, key);
+                ASSERT_NOT_NULL(found);
+                ASSERT_BIN_ARRAYS_EQUALS(value, value_size, found, value_size);
+
+                /* Values are aligned for in-place access */
+                size_t alignment = 1;
+                while (alignment < 8 && !(value_size & alignment) && value_size) {
+                    alignment <<= 1;
+                }
+                ASSERT_UINT_EQUALS(0, (uintptr_t)found % alignment);
+
+                /* create finds the existing element rather than adding a new one */
+                void *created = NULL;
+                int was_created = -1;
+                ASSERT_SUCCESS(aws_inline_hash_table_create(&table, key, &created, &was_created));
+                ASSERT_INT_EQUALS(0, was_created);
+                ASSERT_PTR_EQUALS(found, created);
+            }
+
+            for (size_t i = 0; i < count; i += 2) {
+                memset(key, 0, sizeof(key));
+                memcpy(key, &i, key_size < sizeof(i) ? key_size : sizeof(i));
+                ASSERT_SUCCESS(aws_inline_hash_table_remove(&table, key, NULL, NULL));
+                ASSERT_NULL(aws_inline_hash_table_find(&table, key));
+            }
+            ASSERT_UINT_EQUALS(count / 2, aws_inline_hash_table_get_entry_count(&table));
+
+            aws_inline_hash_table_clean_up(&table);
+        }
+    }
+
+    return 0;
+}
+
+/* The mixing function the table applies to 8-byte keys */
+static uint64_t s_mix64(uint64_t h) {
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ULL;
+    h ^= h >> 33;
+    return h;
+}
+
+/*
+ * More keys share a home slot than a probe distance byte can describe, which forces the table to grow early to
+ * spread them out.
+ */
+AWS_TEST_CASE(test_inline_hash_table_clustered_keys, s_test_inline_hash_table_clustered_keys_fn)
+static int s_test_inline_hash_table_clustered_keys_fn(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    enum { KEY_COUNT = 300 };
+
+    struct aws_inline_hash_table table;
+    ASSERT_SUCCESS(aws_inline_hash_table_init(&table, allocator, sizeof(uint64_t), sizeof(uint64_t), KEY_COUNT));
+    size_t initial_size = table.size;
+
+    uint64_t keys[KEY_COUNT];
+    size_t found = 0;
+    for (uint64_t candidate = 0; found < KEY_COUNT; candidate++) {
+        if ((s_mix64(candidate) & (initial_size - 1)) == 0) {
+            keys[found++] = candidate;
+        }
+    }
+
+    for (size_t i = 0; i < KEY_COUNT; i++) {
+        uint64_t value = i;
+        ASSERT_SUCCESS(aws_inline_hash_table_put(&table, &keys[i], &value, NULL));
+    }
+    ASSERT_TRUE(table.size > initial_size);
+    ASSERT_UINT_EQUALS(KEY_COUNT, aws_inline_hash_table_get_entry_count(&table));
+
+    for (size_t i = 0; i < KEY_COUNT; i++) {
+        uint64_t *value = aws_inline_hash_table_find(&table, &keys[i]);
+        ASSERT_NOT_NULL(value);
+        ASSERT_UINT_EQUALS(i, *value);
+    }
+
+    for (size_t i = 0; i < KEY_COUNT; i += 3) {
+        int was_present = 0;
+        ASSERT_SUCCESS(aws_inline_hash_table_remove(&table, &keys[i], NULL, &was_present));
+        ASSERT_INT_EQUALS(1, was_present);
+    }
+    for (size_t i = 0; i < KEY_COUNT; i++) {
+        uint64_t *value = aws_inline_hash_table_find(&table, &keys[i]);
+        if (i % 3 == 0) {
+            ASSERT_NULL(value);
+        } else {
+            ASSERT_NOT_NULL(value);
+            ASSERT_UINT_EQUALS(i, *value);
+        }
+    }
+
+    aws_inline_hash_table_clean_up(&table);
+    return 0;
+}
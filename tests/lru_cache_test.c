@@ -14,6 +14,8 @@
  */
 
 #include <aws/common/lru_cache.h>
+#include <aws/common/task_scheduler.h>
+#include <aws/common/tracking_allocator.h>
 #include <aws/testing/aws_test_harness.h>
 
 #include <aws/testing/aws_test_harness.h>
@@ -266,3 +268,623 @@ static int s_test_lru_cache_element_access_members_fn(struct aws_allocator *allo
 }
 
 AWS_TEST_CASE(test_lru_cache_element_access_members, s_test_lru_cache_element_access_members_fn)
+
+struct counting_allocator {
+    struct aws_allocator *wrapped;
+    size_t acquires;
+    size_t releases;
+};
+
+static void *s_counting_acquire(struct aws_allocator *allocator, size_t size) {
+    struct counting_allocator *counting = allocator->impl;
+    counting->acquires++;
+    return aws_mem_acquire(counting->wrapped, size);
+}
+
+static void s_counting_release(struct aws_allocator *allocator, void *ptr) {
+    struct counting_allocator *counting = allocator->impl;
+    counting->releases++;
+    aws_mem_release(counting->wrapped, ptr);
+}
+
+static uint64_t s_hash_int(const void *key) {
+    return (uint64_t)(uintptr_t)key;
+}
+
+static bool s_int_eq(const void *a, const void *b) {
+    return a == b;
+}
+
+static int s_test_lru_cache_steady_state_no_allocations_fn(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    struct counting_allocator counting = {.wrapped = allocator};
+    struct aws_allocator counting_allocator = {
+        .mem_acquire = s_counting_acquire,
+        .mem_release = s_counting_release,
+        .impl = &counting,
+    };
+
+    enum { MAX_ITEMS = 64 };
+
+    struct aws_lru_cache cache;
+    ASSERT_SUCCESS(aws_lru_cache_init(&cache, &counting_allocator, s_hash_int, s_int_eq, NULL, NULL, MAX_ITEMS));
+
+    /* Fill the cache, and churn through enough keys for the hash table to settle at its final size */
+    size_t key = 1;
+    for (; key <= 4 * MAX_ITEMS; key++) {
+        ASSERT_SUCCESS(aws_lru_cache_put(&cache, (void *)key, (void *)key));
+    }
+
+    size_t acquires = counting.acquires;
+    size_t releases = counting.releases;
+    for (size_t i = 0; i < 1000; i++, key++) {
+        /* New keys evict, and repeated keys replace */
+        ASSERT_SUCCESS(aws_lru_cache_put(&cache, (void *)key, (void *)key));
+        ASSERT_SUCCESS(aws_lru_cache_put(&cache, (void *)key, (void *)(key + 1)));
+    }
+    ASSERT_UINT_EQUALS(acquires, counting.acquires);
+    ASSERT_UINT_EQUALS(releases, counting.releases);
+    ASSERT_UINT_EQUALS(MAX_ITEMS, aws_lru_cache_get_element_count(&cache));
+    ASSERT_UINT_EQUALS(3 * MAX_ITEMS + 1000, aws_lru_cache_get_eviction_count(&cache));
+
+    void *value = NULL;
+    ASSERT_SUCCESS(aws_lru_cache_find(&cache, (void *)(key - 1), &value));
+    ASSERT_PTR_EQUALS((void *)key, value);
+
+    aws_lru_cache_clear(&cache);
+    for (size_t i = 1; i <= MAX_ITEMS; i++) {
+        ASSERT_SUCCESS(aws_lru_cache_put(&cache, (void *)i, (void *)i));
+    }
+    ASSERT_UINT_EQUALS(MAX_ITEMS, aws_lru_cache_get_element_count(&cache));
+
+    aws_lru_cache_clean_up(&cache);
+    ASSERT_UINT_EQUALS(counting.acquires, counting.releases);
+    return 0;
+}
+
+AWS_TEST_CASE(test_lru_cache_steady_state_no_allocations, s_test_lru_cache_steady_state_no_allocations_fn)
+
+static int s_test_lru_cache_sieve_eviction_fn(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    struct aws_lru_cache_options options = {.policy = AWS_LRU_CACHE_POLICY_SIEVE};
+    struct aws_lru_cache cache;
+    ASSERT_SUCCESS(aws_lru_cache_init_with_options(&cache, allocator, s_hash_int, s_int_eq, NULL, NULL, 3, &options));
+
+    void *value = NULL;
+    ASSERT_SUCCESS(aws_lru_cache_put(&cache, (void *)1, (void *)10));
+    ASSERT_SUCCESS(aws_lru_cache_put(&cache, (void *)2, (void *)20));
+    ASSERT_SUCCESS(aws_lru_cache_put(&cache, (void *)3, (void *)30));
+
+    /* A hit marks 1 visited but leaves it at the back: the hand passes over it and evicts 2 */
+    ASSERT_SUCCESS(aws_lru_cache_find(&cache, (void *)1, &value));
+    ASSERT_PTR_EQUALS((void *)10, value);
+    ASSERT_PTR_EQUALS((void *)10, aws_lru_cache_use_lru_element(&cache));
+    ASSERT_SUCCESS(aws_lru_cache_put(&cache, (void *)4, (void *)40));
+    ASSERT_SUCCESS(aws_lru_cache_find(&cache, (void *)2, &value));
+    ASSERT_NULL(value);
+
+    /* The hand carries on from where it stopped, so 3 goes next even though 1 is now unvisited */
+    ASSERT_SUCCESS(aws_lru_cache_put(&cache, (void *)5, (void *)50));
+    ASSERT_SUCCESS(aws_lru_cache_find(&cache, (void *)3, &value));
+    ASSERT_NULL(value);
+    ASSERT_PTR_EQUALS((void *)50, aws_lru_cache_get_mru_element(&cache));
+
+    /* With everything visited, the hand wraps around, clearing bits, and evicts where it started */
+    ASSERT_SUCCESS(aws_lru_cache_find(&cache, (void *)1, &value));
+    ASSERT_SUCCESS(aws_lru_cache_find(&cache, (void *)4, &value));
+    ASSERT_SUCCESS(aws_lru_cache_find(&cache, (void *)5, &value));
+    ASSERT_SUCCESS(aws_lru_cache_put(&cache, (void *)6, (void *)60));
+    ASSERT_SUCCESS(aws_lru_cache_find(&cache, (void *)4, &value));
+    ASSERT_NULL(value);
+    ASSERT_UINT_EQUALS(3, aws_lru_cache_get_element_count(&cache));
+
+    /* Removing the element under the hand moves it along */
+    ASSERT_SUCCESS(aws_lru_cache_remove(&cache, (void *)5));
+    ASSERT_SUCCESS(aws_lru_cache_put(&cache, (void *)7, (void *)70));
+    ASSERT_SUCCESS(aws_lru_cache_put(&cache, (void *)8, (void *)80));
+    ASSERT_UINT_EQUALS(3, aws_lru_cache_get_element_count(&cache));
+
+    aws_lru_cache_clear(&cache);
+    ASSERT_NULL(cache.sieve_hand);
+    ASSERT_SUCCESS(aws_lru_cache_put(&cache, (void *)9, (void *)90));
+    ASSERT_SUCCESS(aws_lru_cache_find(&cache, (void *)9, &value));
+    ASSERT_PTR_EQUALS((void *)90, value);
+
+    aws_lru_cache_clean_up(&cache);
+    return 0;
+}
+
+AWS_TEST_CASE(test_lru_cache_sieve_eviction, s_test_lru_cache_sieve_eviction_fn)
+
+/*
+ * Looks up random keys from a small hot set, putting each miss, with a stream of one-off keys put in between, and
+ * returns how often the hot keys missed.
+ */
+static int s_count_hot_misses(struct aws_allocator *allocator, enum aws_lru_cache_policy policy, size_t *hot_misses) {
+    enum { MAX_ITEMS = 100, HOT_KEYS = 30, ONE_OFFS_PER_LOOKUP = 2, LOOKUPS = 20000 };
+
+    struct aws_lru_cache_options options = {.policy = policy};
+    struct aws_lru_cache cache;
+    ASSERT_SUCCESS(
+        aws_lru_cache_init_with_options(&cache, allocator, s_hash_int, s_int_eq, NULL, NULL, MAX_ITEMS, &options));
+
+    uint64_t rand_state = 1;
+    size_t one_off_key = 1000;
+    *hot_misses = 0;
+    for (size_t lookup = 0; lookup < LOOKUPS; lookup++) {
+        rand_state = rand_state * 6364136223846793005ULL + 1442695040888963407ULL;
+        size_t hot = (size_t)(rand_state >> 33) % HOT_KEYS + 1;
+
+        void *value = NULL;
+        ASSERT_SUCCESS(aws_lru_cache_find(&cache, (void *)hot, &value));
+        if (!value) {
+            ++*hot_misses;
+            ASSERT_SUCCESS(aws_lru_cache_put(&cache, (void *)hot, (void *)hot));
+        }
+        for (size_t i = 0; i < ONE_OFFS_PER_LOOKUP; i++, one_off_key++) {
+            ASSERT_SUCCESS(aws_lru_cache_put(&cache, (void *)one_off_key, (void *)one_off_key));
+        }
+    }
+
+    aws_lru_cache_clean_up(&cache);
+    return 0;
+}
+
+static int s_test_lru_cache_sieve_scan_resistance_fn(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    size_t lru_misses = 0;
+    size_t sieve_misses = 0;
+    ASSERT_SUCCESS(s_count_hot_misses(allocator, AWS_LRU_CACHE_POLICY_LRU, &lru_misses));
+    ASSERT_SUCCESS(s_count_hot_misses(allocator, AWS_LRU_CACHE_POLICY_SIEVE, &sieve_misses));
+
+    /* Under LRU the one-offs keep pushing hot keys out; SIEVE evicts the unvisited one-offs instead */
+    ASSERT_TRUE(sieve_misses * 10 < lru_misses);
+
+    return 0;
+}
+
+AWS_TEST_CASE(test_lru_cache_sieve_scan_resistance, s_test_lru_cache_sieve_scan_resistance_fn)
+
+static int s_test_lru_cache_tinylfu_model_fn(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    enum { MAX_ITEMS = 200, KEY_SPACE = 1000, OPERATIONS = 50000 };
+
+    struct aws_lru_cache_options options = {.policy = AWS_LRU_CACHE_POLICY_TINYLFU};
+    struct aws_lru_cache cache;
+    ASSERT_SUCCESS(
+        aws_lru_cache_init_with_options(&cache, allocator, s_hash_int, s_int_eq, NULL, NULL, MAX_ITEMS, &options));
+
+    /* The cache may drop anything, but what it returns must be the latest value put */
+    size_t *latest = aws_mem_acquire(allocator, (KEY_SPACE + 1) * sizeof(size_t));
+    ASSERT_NOT_NULL(latest);
+    memset(latest, 0, (KEY_SPACE + 1) * sizeof(size_t));
+
+    uint64_t rand_state = 3;
+    for (size_t op = 1; op <= OPERATIONS; op++) {
+        rand_state = rand_state * 6364136223846793005ULL + 1442695040888963407ULL;
+        /* Skewed towards small keys, so that there is a frequently used set to keep */
+        size_t key = (size_t)(rand_state >> 33) % KEY_SPACE + 1;
+        if ((rand_state >> 20) & 1) {
+            key = key % 50 + 1;
+        }
+
+        void *value = NULL;
+        switch ((rand_state >> 24) % 8) {
+            case 0:
+                ASSERT_SUCCESS(aws_lru_cache_remove(&cache, (void *)key));
+                latest[key] = 0;
+                break;
+            case 1:
+            case 2:
+                ASSERT_SUCCESS(aws_lru_cache_put(&cache, (void *)key, (void *)op));
+                latest[key] = op;
+                break;
+            case 3:
+                value = aws_lru_cache_use_lru_element(&cache);
+                ASSERT_NOT_NULL(value);
+                break;
+            default:
+                ASSERT_SUCCESS(aws_lru_cache_find(&cache, (void *)key, &value));
+                if (value) {
+                    ASSERT_UINT_EQUALS(latest[key], (size_t)value);
+                } else {
+                    ASSERT_SUCCESS(aws_lru_cache_put(&cache, (void *)key, (void *)op));
+                    latest[key] = op;
+                }
+                break;
+        }
+
+        ASSERT_TRUE(aws_lru_cache_get_element_count(&cache) <= MAX_ITEMS);
+        ASSERT_NOT_NULL(aws_lru_cache_get_mru_element(&cache));
+    }
+
+    /* Once full, the cache stays full */
+    ASSERT_UINT_EQUALS(MAX_ITEMS, aws_lru_cache_get_element_count(&cache));
+
+    aws_lru_cache_clear(&cache);
+    ASSERT_UINT_EQUALS(0, aws_lru_cache_get_element_count(&cache));
+    ASSERT_NULL(aws_lru_cache_get_mru_element(&cache));
+    ASSERT_NULL(aws_lru_cache_use_lru_element(&cache));
+
+    aws_lru_cache_clean_up(&cache);
+    aws_mem_release(allocator, latest);
+    return 0;
+}
+
+AWS_TEST_CASE(test_lru_cache_tinylfu_model, s_test_lru_cache_tinylfu_model_fn)
+
+/* Warms a cache up with a hot set, runs a scan of one-off keys through it, and counts the hot keys left */
+static int s_count_hot_keys_after_scan(
+    struct aws_allocator *allocator,
+    enum aws_lru_cache_policy policy,
+    size_t *hot_keys_left) {
+
+    enum { MAX_ITEMS = 100, HOT_KEYS = 60, WARMUP_ROUNDS = 5, SCAN_KEYS = 1000 };
+
+    struct aws_lru_cache_options options = {.policy = policy};
+    struct aws_lru_cache cache;
+    ASSERT_SUCCESS(
+        aws_lru_cache_init_with_options(&cache, allocator, s_hash_int, s_int_eq, NULL, NULL, MAX_ITEMS, &options));
+
+    for (size_t round = 0; round < WARMUP_ROUNDS; round++) {
+        for (size_t key = 1; key <= HOT_KEYS; key++) {
+            void *value = NULL;
+            ASSERT_SUCCESS(aws_lru_cache_find(&cache, (void *)key, &value));
+            if (!value) {
+                ASSERT_SUCCESS(aws_lru_cache_put(&cache, (void *)key, (void *)key));
+            }
+        }
+    }
+
+    for (size_t key = 1000; key < 1000 + SCAN_KEYS; key++) {
+        void *value = NULL;
+        ASSERT_SUCCESS(aws_lru_cache_find(&cache, (void *)key, &value));
+        ASSERT_NULL(value);
+        ASSERT_SUCCESS(aws_lru_cache_put(&cache, (void *)key, (void *)key));
+    }
+
+    *hot_keys_left = 0;
+    for (size_t key = 1; key <= HOT_KEYS; key++) {
+        struct aws_hash_element *element = NULL;
+        ASSERT_SUCCESS(aws_hash_table_find(&cache.table, (void *)key, &element));
+        *hot_keys_left += element != NULL;
+    }
+
+    aws_lru_cache_clean_up(&cache);
+    return 0;
+}
+
+static int s_test_lru_cache_tinylfu_scan_resistance_fn(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    size_t lru_left = 0;
+    size_t tinylfu_left = 0;
+    ASSERT_SUCCESS(s_count_hot_keys_after_scan(allocator, AWS_LRU_CACHE_POLICY_LRU, &lru_left));
+    ASSERT_SUCCESS(s_count_hot_keys_after_scan(allocator, AWS_LRU_CACHE_POLICY_TINYLFU, &tinylfu_left));
+
+    /*
+     * The scan flushes LRU completely, but can't win admission against the hot set (bar the odd scan key whose
+     * sketch counters all collide with hot keys')
+     */
+    ASSERT_UINT_EQUALS(0, lru_left);
+    ASSERT_TRUE(tinylfu_left >= 55);
+    return 0;
+}
+
+AWS_TEST_CASE(test_lru_cache_tinylfu_scan_resistance, s_test_lru_cache_tinylfu_scan_resistance_fn)
+
+static uint64_t s_fake_now;
+
+static int s_fake_clock(uint64_t *timestamp) {
+    *timestamp = s_fake_now;
+    return AWS_OP_SUCCESS;
+}
+
+static size_t s_ttl_destroyed;
+
+static void s_ttl_value_destroy(void *value) {
+    (void)value;
+    s_ttl_destroyed++;
+}
+
+static int s_test_lru_cache_ttl_expiry_fn(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    s_fake_now = 1000;
+    s_ttl_destroyed = 0;
+
+    struct aws_lru_cache_options options = {.clock_fn = s_fake_clock};
+    struct aws_lru_cache cache;
+    ASSERT_SUCCESS(aws_lru_cache_init_with_options(
+        &cache, allocator, s_hash_int, s_int_eq, NULL, s_ttl_value_destroy, 10, &options));
+
+    ASSERT_SUCCESS(aws_lru_cache_put_with_ttl(&cache, (void *)1, (void *)10, 100));
+    ASSERT_SUCCESS(aws_lru_cache_put_with_ttl(&cache, (void *)2, (void *)20, 200));
+    ASSERT_SUCCESS(aws_lru_cache_put_with_ttl(&cache, (void *)3, (void *)30, 300));
+    ASSERT_SUCCESS(aws_lru_cache_put(&cache, (void *)4, (void *)40));
+    ASSERT_SUCCESS(aws_lru_cache_put_with_ttl(&cache, (void *)5, (void *)50, 100));
+
+    /* Nothing has expired yet, so nothing is reaped */
+    s_fake_now = 1099;
+    void *value = NULL;
+    ASSERT_SUCCESS(aws_lru_cache_find(&cache, (void *)1, &value));
+    ASSERT_PTR_EQUALS((void *)10, value);
+    ASSERT_UINT_EQUALS(0, aws_lru_cache_remove_expired(&cache, 10));
+
+    /* Replacing an element replaces its TTL: 5 no longer expires */
+    ASSERT_SUCCESS(aws_lru_cache_put(&cache, (void *)5, (void *)51));
+    ASSERT_UINT_EQUALS(1, s_ttl_destroyed);
+
+    /* An expired element is rejected by find, and removed */
+    s_fake_now = 1100;
+    ASSERT_SUCCESS(aws_lru_cache_find(&cache, (void *)1, &value));
+    ASSERT_NULL(value);
+    ASSERT_UINT_EQUALS(2, s_ttl_destroyed);
+    ASSERT_UINT_EQUALS(4, aws_lru_cache_get_element_count(&cache));
+
+    /* Reaping is bounded, and goes soonest expiry first */
+    s_fake_now = 5000;
+    ASSERT_UINT_EQUALS(1, aws_lru_cache_remove_expired(&cache, 1));
+    ASSERT_UINT_EQUALS(3, aws_lru_cache_get_element_count(&cache));
+    ASSERT_SUCCESS(aws_lru_cache_find(&cache, (void *)2, &value));
+    ASSERT_NULL(value);
+    ASSERT_UINT_EQUALS(1, aws_lru_cache_remove_expired(&cache, 10));
+    ASSERT_UINT_EQUALS(0, aws_lru_cache_remove_expired(&cache, 10));
+    ASSERT_UINT_EQUALS(4, s_ttl_destroyed);
+
+    /* Elements without a TTL never expire */
+    ASSERT_SUCCESS(aws_lru_cache_find(&cache, (void *)4, &value));
+    ASSERT_PTR_EQUALS((void *)40, value);
+    ASSERT_SUCCESS(aws_lru_cache_find(&cache, (void *)5, &value));
+    ASSERT_PTR_EQUALS((void *)51, value);
+
+    /* An element evicted while waiting to expire leaves the expiry queue too */
+    for (size_t i = 100; i < 120; i++) {
+        ASSERT_SUCCESS(aws_lru_cache_put_with_ttl(&cache, (void *)i, (void *)i, i));
+    }
+    ASSERT_UINT_EQUALS(10, aws_lru_cache_get_element_count(&cache));
+    s_fake_now = UINT64_MAX;
+    ASSERT_UINT_EQUALS(10, aws_lru_cache_remove_expired(&cache, SIZE_MAX));
+    ASSERT_UINT_EQUALS(0, aws_lru_cache_get_element_count(&cache));
+
+    /* A huge TTL saturates rather than wrapping around into the past */
+    s_fake_now = 1000;
+    ASSERT_SUCCESS(aws_lru_cache_put_with_ttl(&cache, (void *)6, (void *)60, UINT64_MAX));
+    ASSERT_SUCCESS(aws_lru_cache_find(&cache, (void *)6, &value));
+    ASSERT_PTR_EQUALS((void *)60, value);
+
+    aws_lru_cache_clean_up(&cache);
+    return 0;
+}
+
+AWS_TEST_CASE(test_lru_cache_ttl_expiry, s_test_lru_cache_ttl_expiry_fn)
+
+static int s_test_lru_cache_ttl_reaper_fn(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    s_fake_now = 0;
+    s_ttl_destroyed = 0;
+
+    struct aws_task_scheduler scheduler;
+    ASSERT_SUCCESS(aws_task_scheduler_init(&scheduler, allocator));
+
+    struct aws_lru_cache_options options = {.policy = AWS_LRU_CACHE_POLICY_TINYLFU, .clock_fn = s_fake_clock};
+    struct aws_lru_cache cache;
+    ASSERT_SUCCESS(aws_lru_cache_init_with_options(
+        &cache, allocator, s_hash_int, s_int_eq, NULL, s_ttl_value_destroy, 100, &options));
+
+    ASSERT_SUCCESS(aws_lru_cache_start_expiry_reaper(&cache, &scheduler, 10, 4));
+    ASSERT_FAILS(aws_lru_cache_start_expiry_reaper(&cache, &scheduler, 10, 4));
+
+    for (size_t i = 1; i <= 10; i++) {
+        ASSERT_SUCCESS(aws_lru_cache_put_with_ttl(&cache, (void *)i, (void *)i, 5));
+    }
+    ASSERT_SUCCESS(aws_lru_cache_put(&cache, (void *)11, (void *)11));
+
+    /* The first run reaps a full batch, so reschedules itself straight away until the backlog is gone */
+    s_fake_now = 10;
+    aws_task_scheduler_run_all(&scheduler, s_fake_now);
+    ASSERT_UINT_EQUALS(4, s_ttl_destroyed);
+    aws_task_scheduler_run_all(&scheduler, s_fake_now);
+    ASSERT_UINT_EQUALS(8, s_ttl_destroyed);
+    aws_task_scheduler_run_all(&scheduler, s_fake_now);
+    ASSERT_UINT_EQUALS(10, s_ttl_destroyed);
+    ASSERT_UINT_EQUALS(1, aws_lru_cache_get_element_count(&cache));
+
+    /* Then it waits out the interval */
+    uint64_t next_run = 0;
+    ASSERT_TRUE(aws_task_scheduler_has_tasks(&scheduler, &next_run));
+    ASSERT_UINT_EQUALS(20, next_run);
+
+    ASSERT_SUCCESS(aws_lru_cache_put_with_ttl(&cache, (void *)12, (void *)12, 5));
+    s_fake_now = 20;
+    aws_task_scheduler_run_all(&scheduler, s_fake_now);
+    ASSERT_UINT_EQUALS(11, s_ttl_destroyed);
+
+    /* Once stopped, nothing more is reaped, and the reaper may be started again */
+    aws_lru_cache_stop_expiry_reaper(&cache);
+    ASSERT_FALSE(aws_task_scheduler_has_tasks(&scheduler, NULL));
+    ASSERT_SUCCESS(aws_lru_cache_put_with_ttl(&cache, (void *)13, (void *)13, 5));
+    s_fake_now = 100;
+    aws_task_scheduler_run_all(&scheduler, s_fake_now);
+    ASSERT_UINT_EQUALS(2, aws_lru_cache_get_element_count(&cache));
+
+    ASSERT_SUCCESS(aws_lru_cache_start_expiry_reaper(&cache, &scheduler, 10, 4));
+    s_fake_now = 110;
+    aws_task_scheduler_run_all(&scheduler, s_fake_now);
+    ASSERT_UINT_EQUALS(12, s_ttl_destroyed);
+
+    /* Cleaning up the cache cancels the reaper */
+    aws_lru_cache_clean_up(&cache);
+    ASSERT_FALSE(aws_task_scheduler_has_tasks(&scheduler, NULL));
+    ASSERT_UINT_EQUALS(13, s_ttl_destroyed);
+
+    aws_task_scheduler_clean_up(&scheduler);
+    return 0;
+}
+
+AWS_TEST_CASE(test_lru_cache_ttl_reaper, s_test_lru_cache_ttl_reaper_fn)
+
+static size_t s_weigh_value(const void *key, const void *value) {
+    (void)key;
+    return (size_t)(uintptr_t)value;
+}
+
+static size_t s_destroyed_weight;
+
+static void s_weighted_value_destroy(void *value) {
+    s_destroyed_weight += (size_t)(uintptr_t)value;
+}
+
+static int s_test_lru_cache_weighted_lru_fn(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    /* Values are their own weights */
+    struct aws_lru_cache_options options = {.max_weight = 1000, .weigh_fn = s_weigh_value};
+    struct aws_lru_cache cache;
+    ASSERT_SUCCESS(
+        aws_lru_cache_init_with_options(&cache, allocator, s_hash_int, s_int_eq, NULL, NULL, 100, &options));
+
+    ASSERT_SUCCESS(aws_lru_cache_put(&cache, (void *)1, (void *)400));
+    ASSERT_SUCCESS(aws_lru_cache_put(&cache, (void *)2, (void *)400));
+    ASSERT_UINT_EQUALS(800, aws_lru_cache_get_weight(&cache));
+
+    /* Over budget: the least recently used element goes */
+    ASSERT_SUCCESS(aws_lru_cache_put(&cache, (void *)3, (void *)400));
+    ASSERT_UINT_EQUALS(2, aws_lru_cache_get_element_count(&cache));
+    ASSERT_UINT_EQUALS(800, aws_lru_cache_get_weight(&cache));
+    void *value = NULL;
+    ASSERT_SUCCESS(aws_lru_cache_find(&cache, (void *)1, &value));
+    ASSERT_NULL(value);
+
+    /* A heavier replacement evicts too */
+    ASSERT_SUCCESS(aws_lru_cache_put(&cache, (void *)3, (void *)900));
+    ASSERT_UINT_EQUALS(1, aws_lru_cache_get_element_count(&cache));
+    ASSERT_UINT_EQUALS(900, aws_lru_cache_get_weight(&cache));
+
+    /* Explicit weights override the callback; several small elements may go to make room for one big one */
+    for (size_t i = 10; i < 20; i++) {
+        ASSERT_SUCCESS(aws_lru_cache_put_weighted(&cache, (void *)i, (void *)i, 10));
+    }
+    ASSERT_UINT_EQUALS(1000, aws_lru_cache_get_weight(&cache));
+    ASSERT_SUCCESS(aws_lru_cache_put_weighted(&cache, (void *)20, (void *)20, 1000));
+    ASSERT_UINT_EQUALS(1, aws_lru_cache_get_element_count(&cache));
+
+    /* Something too big to ever fit is refused, and the cache is left alone */
+    ASSERT_FAILS(aws_lru_cache_put_weighted(&cache, (void *)21, (void *)21, 1001));
+    ASSERT_FAILS(aws_lru_cache_put(&cache, (void *)20, (void *)1001));
+    ASSERT_SUCCESS(aws_lru_cache_find(&cache, (void *)20, &value));
+    ASSERT_PTR_EQUALS((void *)20, value);
+    ASSERT_UINT_EQUALS(1000, aws_lru_cache_get_weight(&cache));
+
+    aws_lru_cache_remove(&cache, (void *)20);
+    ASSERT_UINT_EQUALS(0, aws_lru_cache_get_weight(&cache));
+
+    aws_lru_cache_clean_up(&cache);
+    return 0;
+}
+
+AWS_TEST_CASE(test_lru_cache_weighted_lru, s_test_lru_cache_weighted_lru_fn)
+
+static int s_test_lru_cache_weighted_policies_fn(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    static const enum aws_lru_cache_policy policies[] = {
+        AWS_LRU_CACHE_POLICY_LRU, AWS_LRU_CACHE_POLICY_SIEVE, AWS_LRU_CACHE_POLICY_TINYLFU};
+
+    enum { MAX_ITEMS = 50, MAX_WEIGHT = 2000, KEY_SPACE = 200 };
+
+    for (size_t p = 0; p < AWS_ARRAY_SIZE(policies); p++) {
+        struct aws_lru_cache_options options = {
+            .policy = policies[p],
+            .max_weight = MAX_WEIGHT,
+            .weigh_fn = s_weigh_value,
+        };
+        struct aws_lru_cache cache;
+        ASSERT_SUCCESS(aws_lru_cache_init_with_options(
+            &cache, allocator, s_hash_int, s_int_eq, NULL, s_weighted_value_destroy, MAX_ITEMS, &options));
+
+        s_destroyed_weight = 0;
+        size_t put_weight = 0;
+        uint64_t rand_state = 1;
+        for (size_t i = 0; i < 20000; i++) {
+            rand_state = rand_state * 6364136223846793005ULL + 1442695040888963407ULL;
+            size_t key = (size_t)(rand_state >> 33) % KEY_SPACE + 1;
+            /* Mostly small values, with the odd one taking half the budget */
+            size_t weight = (rand_state >> 20) % 16 == 0 ? MAX_WEIGHT / 2 : (size_t)(rand_state >> 40) % 60 + 1;
+
+            void *value = NULL;
+            ASSERT_SUCCESS(aws_lru_cache_find(&cache, (void *)key, &value));
+            if (!value) {
+                ASSERT_SUCCESS(aws_lru_cache_put(&cache, (void *)key, (void *)weight));
+                put_weight += weight;
+            }
+
+            ASSERT_TRUE(aws_lru_cache_get_weight(&cache) <= MAX_WEIGHT);
+            ASSERT_TRUE(aws_lru_cache_get_element_count(&cache) <= MAX_ITEMS);
+            ASSERT_UINT_EQUALS(put_weight - s_destroyed_weight, aws_lru_cache_get_weight(&cache));
+        }
+
+        aws_lru_cache_clean_up(&cache);
+        ASSERT_UINT_EQUALS(put_weight, s_destroyed_weight);
+    }
+
+    return 0;
+}
+
+AWS_TEST_CASE(test_lru_cache_weighted_policies, s_test_lru_cache_weighted_policies_fn)
+
+static int s_test_lru_cache_weighted_pool_growth_fn(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    static const enum aws_lru_cache_policy policies[] = {
+        AWS_LRU_CACHE_POLICY_LRU, AWS_LRU_CACHE_POLICY_SIEVE, AWS_LRU_CACHE_POLICY_TINYLFU};
+
+    enum { MAX_WEIGHT = 1000 };
+
+    for (size_t p = 0; p < AWS_ARRAY_SIZE(policies); p++) {
+        struct aws_tracking_allocator_options tracking_options = {.tag = "lru_cache"};
+        struct aws_allocator *tracking = aws_tracking_allocator_new(allocator, &tracking_options);
+        ASSERT_NOT_NULL(tracking);
+
+        /* With no limit on the count, only the budget decides how many nodes are needed */
+        struct aws_lru_cache_options options = {.policy = policies[p], .max_weight = MAX_WEIGHT};
+        struct aws_lru_cache cache;
+        ASSERT_SUCCESS(
+            aws_lru_cache_init_with_options(&cache, tracking, s_hash_int, s_int_eq, NULL, NULL, SIZE_MAX, &options));
+
+        for (size_t key = 1; key <= 10 * MAX_WEIGHT; key++) {
+            if (key % 2) {
+                ASSERT_SUCCESS(aws_lru_cache_put(&cache, (void *)key, (void *)key));
+            } else {
+                ASSERT_SUCCESS(aws_lru_cache_put_with_ttl(&cache, (void *)key, (void *)key, UINT64_MAX));
+            }
+        }
+        ASSERT_UINT_EQUALS(MAX_WEIGHT, aws_lru_cache_get_element_count(&cache));
+        ASSERT_UINT_EQUALS(9 * MAX_WEIGHT, aws_lru_cache_get_eviction_count(&cache));
+
+        /* Once full, the pool stops growing */
+        struct aws_tracking_allocator_stats stats;
+        aws_tracking_allocator_get_stats(tracking, &stats);
+        size_t allocations = stats.total_allocations;
+        for (size_t key = 1; key <= 1000; key++) {
+            ASSERT_SUCCESS(aws_lru_cache_put(&cache, (void *)key, (void *)key));
+        }
+        aws_tracking_allocator_get_stats(tracking, &stats);
+        ASSERT_UINT_EQUALS(allocations, stats.total_allocations);
+        ASSERT_TRUE(stats.peak_bytes < 256 * 1024);
+
+        aws_lru_cache_clean_up(&cache);
+        aws_tracking_allocator_get_stats(tracking, &stats);
+        ASSERT_UINT_EQUALS(0, stats.live_bytes);
+        aws_tracking_allocator_destroy(tracking);
+    }
+
+    return 0;
+}
+
+AWS_TEST_CASE(test_lru_cache_weighted_pool_growth, s_test_lru_cache_weighted_pool_growth_fn)
@@ -0,0 +1,145 @@
+/*
+ * Copyright 2010-2018 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *  http://aws.amazon.com/apache2.0
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#include <aws/common/mmap_allocator.h>
+
+#include <aws/common/byte_buf.h>
+
+#include <aws/testing/aws_test_harness.h>
+
+#define TEST_THRESHOLD (64 * 1024)
+
+static void s_fill(uint8_t *buf, size_t len) {
+    for (size_t i = 0; i < len; i++) {
+        buf[i] = (uint8_t)(i * 7 + (i >> 12));
+    }
+}
+
+static int s_check(const uint8_t *buf, size_t len) {
+    for (size_t i = 0; i < len; i++) {
+        ASSERT_UINT_EQUALS((uint8_t)(i * 7 + (i >> 12)), buf[i]);
+    }
+    return 0;
+}
+
+static int s_test_mmap_allocator_options(struct aws_allocator *allocator, struct aws_mmap_allocator_options *options) {
+    struct aws_allocator *large = aws_mmap_allocator_new(allocator, options);
+    ASSERT_NOT_NULL(large);
+
+    /* Below the threshold, from the parent, which the harness checks for leaks */
+    uint8_t *small = aws_mem_acquire(large, 1000);
+    ASSERT_NOT_NULL(small);
+    s_fill(small, 1000);
+
+    uint8_t *mapped = aws_mem_acquire(large, 3 * 1024 * 1024);
+    ASSERT_NOT_NULL(mapped);
+    ASSERT_UINT_EQUALS(0, (uintptr_t)mapped % AWS_CACHE_LINE);
+    s_fill(mapped, 3 * 1024 * 1024);
+
+    ASSERT_SUCCESS(s_check(small, 1000));
+    ASSERT_SUCCESS(s_check(mapped, 3 * 1024 * 1024));
+
+    aws_mem_release(large, small);
+    aws_mem_release(large, mapped);
+    aws_mem_release(large, NULL);
+    aws_mmap_allocator_destroy(large);
+    return 0;
+}
+
+static int s_test_mmap_allocator_acquire_fn(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    struct aws_mmap_allocator_options options = {.threshold = TEST_THRESHOLD};
+    ASSERT_SUCCESS(s_test_mmap_allocator_options(allocator, &options));
+
+    /* Every option works, or quietly falls back where the system doesn't support it */
+    options.transparent_huge_pages = true;
+    ASSERT_SUCCESS(s_test_mmap_allocator_options(allocator, &options));
+    options.prefault = true;
+    ASSERT_SUCCESS(s_test_mmap_allocator_options(allocator, &options));
+    options.explicit_huge_pages = true;
+    ASSERT_SUCCESS(s_test_mmap_allocator_options(allocator, &options));
+
+    return 0;
+}
+
+AWS_TEST_CASE(test_mmap_allocator_acquire, s_test_mmap_allocator_acquire_fn)
+
+static int s_test_mmap_allocator_realloc_fn(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    struct aws_mmap_allocator_options options = {.threshold = TEST_THRESHOLD, .prefault = true};
+    struct aws_allocator *large = aws_mmap_allocator_new(allocator, &options);
+    ASSERT_NOT_NULL(large);
+
+    /* Grow from the parent, across the threshold, and on through several mapping sizes */
+    size_t size = 100;
+    void *buf = aws_mem_acquire(large, size);
+    ASSERT_NOT_NULL(buf);
+    s_fill(buf, size);
+    const size_t sizes[] = {1000, TEST_THRESHOLD - 1, TEST_THRESHOLD, 1024 * 1024, 1024 * 1024 + 1, 8 * 1024 * 1024};
+    for (size_t i = 0; i < AWS_ARRAY_SIZE(sizes); i++) {
+        ASSERT_SUCCESS(aws_mem_realloc(large, &buf, size, sizes[i]));
+        ASSERT_SUCCESS(s_check(buf, size));
+        s_fill(buf, sizes[i]);
+        size = sizes[i];
+    }
+
+    /* Then shrink it back down into the parent */
+    const size_t shrink_sizes[] = {2 * 1024 * 1024, TEST_THRESHOLD, 500};
+    for (size_t i = 0; i < AWS_ARRAY_SIZE(shrink_sizes); i++) {
+        ASSERT_SUCCESS(aws_mem_realloc(large, &buf, size, shrink_sizes[i]));
+        size = shrink_sizes[i];
+        ASSERT_SUCCESS(s_check(buf, size));
+    }
+
+    aws_mem_release(large, buf);
+    aws_mmap_allocator_destroy(large);
+    return 0;
+}
+
+AWS_TEST_CASE(test_mmap_allocator_realloc, s_test_mmap_allocator_realloc_fn)
+
+static int s_test_mmap_allocator_byte_buf_fn(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    struct aws_mmap_allocator_options options = {.threshold = TEST_THRESHOLD};
+    struct aws_allocator *large = aws_mmap_allocator_new(allocator, &options);
+    ASSERT_NOT_NULL(large);
+
+    /* An upload part growing by doubling, from well below the threshold */
+    struct aws_byte_buf part;
+    ASSERT_SUCCESS(aws_byte_buf_init(&part, large, 4096));
+    uint8_t chunk[4096];
+    while (part.len < 16 * 1024 * 1024) {
+        if (part.capacity - part.len < sizeof(chunk)) {
+            ASSERT_SUCCESS(aws_byte_buf_reserve(&part, part.capacity * 2));
+        }
+        memset(chunk, (int)(part.len / sizeof(chunk)), sizeof(chunk));
+        struct aws_byte_cursor cursor = aws_byte_cursor_from_array(chunk, sizeof(chunk));
+        ASSERT_SUCCESS(aws_byte_buf_append(&part, &cursor));
+    }
+    ASSERT_UINT_EQUALS(16 * 1024 * 1024, part.capacity);
+    for (size_t i = 0; i < part.len; i += sizeof(chunk)) {
+        ASSERT_UINT_EQUALS((uint8_t)(i / sizeof(chunk)), part.buffer[i]);
+        ASSERT_UINT_EQUALS((uint8_t)(i / sizeof(chunk)), part.buffer[i + sizeof(chunk) - 1]);
+    }
+
+    aws_byte_buf_clean_up(&part);
+    aws_mmap_allocator_destroy(large);
+    return 0;
+}
+
+AWS_TEST_CASE(test_mmap_allocator_byte_buf, s_test_mmap_allocator_byte_buf_fn)
@@ -0,0 +1,262 @@
+/*
+ * Copyright 2010-2018 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *  http://aws.amazon.com/apache2.0
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#include <aws/common/pool_allocator.h>
+
+#include <aws/common/atomics.h>
+#include <aws/common/thread.h>
+#include <aws/common/tracking_allocator.h>
+
+#include <aws/testing/aws_test_harness.h>
+
+#define SIZES_TESTED 1100
+
+static int s_test_pool_allocator_sizes_fn(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    struct aws_allocator *pool = aws_pool_allocator_new(allocator);
+    ASSERT_NOT_NULL(pool);
+
+    /* Every size, small and large, gets aligned memory of its own */
+    uint8_t **objects = aws_mem_acquire(allocator, sizeof(uint8_t *) * SIZES_TESTED);
+    ASSERT_NOT_NULL(objects);
+    for (size_t size = 0; size < SIZES_TESTED; size++) {
+        objects[size] = aws_mem_acquire(pool, size);
+        ASSERT_NOT_NULL(objects[size]);
+        ASSERT_UINT_EQUALS(0, (uintptr_t)objects[size] & 15);
+        memset(objects[size], (int)(size & 0xFF), size);
+    }
+    for (size_t size = 0; size < SIZES_TESTED; size++) {
+        for (size_t i = 0; i < size; i++) {
+            ASSERT_UINT_EQUALS(size & 0xFF, objects[size][i]);
+        }
+        aws_mem_release(pool, objects[size]);
+    }
+
+    /* Released objects are handed out again, newest first */
+    void *first = aws_mem_acquire(pool, 40);
+    aws_mem_release(pool, first);
+    ASSERT_PTR_EQUALS(first, aws_mem_acquire(pool, 48));
+    aws_mem_release(pool, first);
+    aws_mem_release(pool, NULL);
+
+    aws_mem_release(allocator, objects);
+    aws_pool_allocator_destroy(pool);
+    return 0;
+}
+
+AWS_TEST_CASE(test_pool_allocator_sizes, s_test_pool_allocator_sizes_fn)
+
+static int s_test_pool_allocator_realloc_fn(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    struct aws_allocator *pool = aws_pool_allocator_new(allocator);
+    ASSERT_NOT_NULL(pool);
+
+    /* Growing within the size class keeps the pointer */
+    void *ptr = aws_mem_acquire(pool, 20);
+    void *original = ptr;
+    memset(ptr, 0x5A, 20);
+    ASSERT_SUCCESS(aws_mem_realloc(pool, &ptr, 20, 32));
+    ASSERT_PTR_EQUALS(original, ptr);
+
+    /* Growing past it, including into a large allocation, copies */
+    ASSERT_SUCCESS(aws_mem_realloc(pool, &ptr, 32, 100));
+    ASSERT_TRUE(ptr != original);
+    ASSERT_SUCCESS(aws_mem_realloc(pool, &ptr, 100, 5000));
+    for (size_t i = 0; i < 20; i++) {
+        ASSERT_UINT_EQUALS(0x5A, ((uint8_t *)ptr)[i]);
+    }
+    ASSERT_SUCCESS(aws_mem_realloc(pool, &ptr, 5000, 10));
+    for (size_t i = 0; i < 10; i++) {
+        ASSERT_UINT_EQUALS(0x5A, ((uint8_t *)ptr)[i]);
+    }
+    aws_mem_release(pool, ptr);
+
+    aws_pool_allocator_destroy(pool);
+    return 0;
+}
+
+AWS_TEST_CASE(test_pool_allocator_realloc, s_test_pool_allocator_realloc_fn)
+
+static int s_test_pool_allocator_many_pools_fn(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    /* More pools than a thread has cache slots for, some of them destroyed and replaced along the way */
+    struct aws_allocator *pools[8];
+    for (size_t round = 0; round < 3; round++) {
+        for (size_t i = 0; i < AWS_ARRAY_SIZE(pools); i++) {
+            pools[i] = aws_pool_allocator_new(allocator);
+            ASSERT_NOT_NULL(pools[i]);
+        }
+
+        void *objects[AWS_ARRAY_SIZE(pools)][100];
+        for (size_t n = 0; n < 100; n++) {
+            for (size_t i = 0; i < AWS_ARRAY_SIZE(pools); i++) {
+                objects[i][n] = aws_mem_acquire(pools[i], 8 + n);
+                ASSERT_NOT_NULL(objects[i][n]);
+                memset(objects[i][n], (int)i, 8 + n);
+            }
+        }
+        for (size_t n = 0; n < 100; n++) {
+            for (size_t i = 0; i < AWS_ARRAY_SIZE(pools); i++) {
+                ASSERT_UINT_EQUALS(i, ((uint8_t *)objects[i][n])[7 + n]);
+                aws_mem_release(pools[i], objects[i][n]);
+            }
+        }
+
+        for (size_t i = 0; i < AWS_ARRAY_SIZE(pools); i++) {
+            aws_pool_allocator_destroy(pools[i]);
+        }
+    }
+
+    return 0;
+}
+
+AWS_TEST_CASE(test_pool_allocator_many_pools, s_test_pool_allocator_many_pools_fn)
+
+#define POOL_THREADS 4
+#define POOL_SLOTS 256
+#define POOL_OPS_PER_THREAD 50000
+
+/* Threads swap objects in and out of shared slots, so most objects are released by another thread */
+struct pool_thread_data {
+    struct aws_allocator *pool;
+    struct aws_atomic_var *slots;
+    struct aws_atomic_var *failures;
+    uint64_t seed;
+};
+
+static void s_pool_churn_thread_fn(void *arg) {
+    struct pool_thread_data *data = arg;
+    uint64_t state = data->seed;
+    for (size_t op = 0; op < POOL_OPS_PER_THREAD; op++) {
+        state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+        size_t size = 1 + (size_t)(state >> 33) % 250;
+        size_t slot = (size_t)(state >> 20) % POOL_SLOTS;
+
+        uint8_t *object = aws_mem_acquire(data->pool, size);
+        if (!object) {
+            aws_atomic_fetch_add(data->failures, 1);
+            continue;
+        }
+        /* The first byte records the size, and the last repeats it */
+        object[0] = (uint8_t)size;
+        object[size - 1] = (uint8_t)size;
+
+        uint8_t *old = aws_atomic_exchange_ptr(&data->slots[slot], object);
+        if (old) {
+            if (old[old[0] - 1] != old[0]) {
+                aws_atomic_fetch_add(data->failures, 1);
+            }
+            aws_mem_release(data->pool, old);
+        }
+    }
+}
+
+static int s_test_pool_allocator_threaded_fn(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    struct aws_allocator *pool = aws_pool_allocator_new(allocator);
+    ASSERT_NOT_NULL(pool);
+
+    struct aws_atomic_var slots[POOL_SLOTS];
+    for (size_t i = 0; i < POOL_SLOTS; i++) {
+        aws_atomic_init_ptr(&slots[i], NULL);
+    }
+    struct aws_atomic_var failures;
+    aws_atomic_init_int(&failures, 0);
+
+    struct aws_thread threads[POOL_THREADS];
+    struct pool_thread_data data[POOL_THREADS];
+    for (size_t i = 0; i < POOL_THREADS; i++) {
+        data[i].pool = pool;
+        data[i].slots = slots;
+        data[i].failures = &failures;
+        data[i].seed = i + 1;
+        ASSERT_SUCCESS(aws_thread_init(&threads[i], allocator));
+        ASSERT_SUCCESS(aws_thread_launch(&threads[i], s_pool_churn_thread_fn, &data[i], NULL));
+    }
+    for (size_t i = 0; i < POOL_THREADS; i++) {
+        ASSERT_SUCCESS(aws_thread_join(&threads[i]));
+        aws_thread_clean_up(&threads[i]);
+    }
+
+    ASSERT_UINT_EQUALS(0, aws_atomic_load_int(&failures));
+    for (size_t i = 0; i < POOL_SLOTS; i++) {
+        aws_mem_release(pool, aws_atomic_load_ptr(&slots[i]));
+    }
+
+    aws_pool_allocator_destroy(pool);
+    return 0;
+}
+
+AWS_TEST_CASE(test_pool_allocator_threaded, s_test_pool_allocator_threaded_fn)
+
+#define EXIT_TEST_THREADS 50
+#define EXIT_TEST_OBJECTS 200
+
+static void s_pool_alloc_free_thread_fn(void *arg) {
+    struct pool_thread_data *data = arg;
+    void *objects[EXIT_TEST_OBJECTS];
+    for (size_t i = 0; i < EXIT_TEST_OBJECTS; i++) {
+        objects[i] = aws_mem_acquire(data->pool, 64);
+        if (!objects[i]) {
+            aws_atomic_fetch_add(data->failures, 1);
+            return;
+        }
+    }
+    for (size_t i = 0; i < EXIT_TEST_OBJECTS; i++) {
+        aws_mem_release(data->pool, objects[i]);
+    }
+}
+
+static int s_test_pool_allocator_thread_exit_fn(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    struct aws_tracking_allocator_options options = {.tag = "pool parent"};
+    struct aws_allocator *parent = aws_tracking_allocator_new(allocator, &options);
+    ASSERT_NOT_NULL(parent);
+    struct aws_allocator *pool = aws_pool_allocator_new(parent);
+    ASSERT_NOT_NULL(pool);
+
+    struct aws_atomic_var failures;
+    aws_atomic_init_int(&failures, 0);
+    struct pool_thread_data data = {.pool = pool, .failures = &failures};
+
+    /* Each thread leaves objects in its cache; once it exits, the next thread can have them */
+    size_t first_live_bytes = 0;
+    for (size_t i = 0; i < EXIT_TEST_THREADS; i++) {
+        struct aws_thread thread;
+        ASSERT_SUCCESS(aws_thread_init(&thread, allocator));
+        ASSERT_SUCCESS(aws_thread_launch(&thread, s_pool_alloc_free_thread_fn, &data, NULL));
+        ASSERT_SUCCESS(aws_thread_join(&thread));
+        aws_thread_clean_up(&thread);
+
+        struct aws_tracking_allocator_stats stats;
+        aws_tracking_allocator_get_stats(parent, &stats);
+        if (i == 0) {
+            first_live_bytes = stats.live_bytes;
+        }
+        ASSERT_UINT_EQUALS(first_live_bytes, stats.live_bytes);
+    }
+    ASSERT_UINT_EQUALS(0, aws_atomic_load_int(&failures));
+
+    aws_pool_allocator_destroy(pool);
+    aws_tracking_allocator_destroy(parent);
+    return 0;
+}
+
+AWS_TEST_CASE(test_pool_allocator_thread_exit, s_test_pool_allocator_thread_exit_fn)
@@ -270,3 +270,72 @@ static int s_test_acquire_many_fn(struct aws_allocator *allocator, void *ctx) {
 
     return 0;
 }
+
+AWS_TEST_CASE(test_acquire_aligned_fallback, s_test_acquire_aligned_fallback_fn)
+static int s_test_acquire_aligned_fallback_fn(struct aws_allocator *allocator, void *ctx) {
+    (void)allocator;
+    (void)ctx;
+
+    struct aws_allocator test_allocator = {
+        .mem_acquire = s_test_alloc_acquire,
+        .mem_release = s_test_alloc_release,
+    };
+
+    s_call_ct_malloc = s_call_ct_free = 0;
+
+    for (size_t alignment = 1; alignment <= 4096; alignment *= 2) {
+        uint8_t *buf = aws_mem_acquire_aligned(&test_allocator, alignment, 100);
+        ASSERT_NOT_NULL(buf);
+        ASSERT_UINT_EQUALS(0, (uintptr_t)buf % alignment);
+        memset(buf, 0xA5, 100);
+        aws_mem_release_aligned(&test_allocator, buf);
+    }
+    ASSERT_INT_EQUALS(s_call_ct_malloc, 13);
+    ASSERT_INT_EQUALS(s_call_ct_free, 13);
+    ASSERT_INT_EQUALS(s_alloc_counter, 0);
+
+    aws_mem_release_aligned(&test_allocator, NULL);
+    ASSERT_INT_EQUALS(s_call_ct_free, 13);
+
+    ASSERT_NULL(aws_mem_acquire_aligned(&test_allocator, 48, 100));
+    ASSERT_INT_EQUALS(AWS_ERROR_INVALID_ARGUMENT, aws_last_error());
+    ASSERT_NULL(aws_mem_acquire_aligned(&test_allocator, 0, 100));
+    ASSERT_INT_EQUALS(AWS_ERROR_INVALID_ARGUMENT, aws_last_error());
+
+    test_allocator.mem_acquire = s_test_malloc_failing;
+    ASSERT_NULL(aws_mem_acquire_aligned(&test_allocator, 64, 100));
+    ASSERT_INT_EQUALS(AWS_ERROR_OOM, aws_last_error());
+
+    return 0;
+}
+
+AWS_TEST_CASE(test_acquire_aligned_default, s_test_acquire_aligned_default_fn)
+static int s_test_acquire_aligned_default_fn(struct aws_allocator *allocator, void *ctx) {
+    (void)allocator;
+    (void)ctx;
+
+    struct aws_allocator *default_allocator = aws_default_allocator();
+
+    void *buffers[8];
+    for (size_t i = 0; i < AWS_ARRAY_SIZE(buffers); i++) {
+        buffers[i] = aws_mem_acquire_aligned(default_allocator, AWS_CACHE_LINE, 24 + i * 40);
+        ASSERT_NOT_NULL(buffers[i]);
+        ASSERT_UINT_EQUALS(0, (uintptr_t)buffers[i] % AWS_CACHE_LINE);
+    }
+    for (size_t i = 0; i < AWS_ARRAY_SIZE(buffers); i++) {
+        aws_mem_release_aligned(default_allocator, buffers[i]);
+    }
+
+    void *page = aws_mem_acquire_aligned(default_allocator, 4096, 10);
+    ASSERT_NOT_NULL(page);
+    ASSERT_UINT_EQUALS(0, (uintptr_t)page % 4096);
+    aws_mem_release_aligned(default_allocator, page);
+
+    /* Zero bytes still gets memory of its own, rather than an out of memory error */
+    void *empty = aws_mem_acquire_aligned(default_allocator, AWS_CACHE_LINE, 0);
+    ASSERT_NOT_NULL(empty);
+    ASSERT_UINT_EQUALS(0, (uintptr_t)empty % AWS_CACHE_LINE);
+    aws_mem_release_aligned(default_allocator, empty);
+
+    return 0;
+}
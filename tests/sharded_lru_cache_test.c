@@ -0,0 +1,224 @@
+/*
+ * Copyright 2010-2018 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *  http://aws.amazon.com/apache2.0
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#include <aws/common/sharded_lru_cache.h>
+
+#include <aws/common/atomics.h>
+#include <aws/common/thread.h>
+
+#include <aws/testing/aws_test_harness.h>
+
+static uint64_t s_hash_int(const void *key) {
+    return (uint64_t)(uintptr_t)key;
+}
+
+static bool s_int_eq(const void *a, const void *b) {
+    return a == b;
+}
+
+#define INT_PTR(i) ((void *)(uintptr_t)(i))
+
+static int s_test_sharded_lru_cache_single_shard_fn(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    struct aws_sharded_lru_cache cache;
+    ASSERT_SUCCESS(aws_sharded_lru_cache_init(&cache, allocator, s_hash_int, s_int_eq, NULL, NULL, 3, 1));
+    ASSERT_UINT_EQUALS(1, cache.shard_count);
+
+    ASSERT_SUCCESS(aws_sharded_lru_cache_put(&cache, INT_PTR(1), INT_PTR(10)));
+    ASSERT_SUCCESS(aws_sharded_lru_cache_put(&cache, INT_PTR(2), INT_PTR(20)));
+    ASSERT_SUCCESS(aws_sharded_lru_cache_put(&cache, INT_PTR(3), INT_PTR(30)));
+
+    /* Touch 1, so that 2 is the least recently used */
+    void *value = NULL;
+    ASSERT_SUCCESS(aws_sharded_lru_cache_find(&cache, INT_PTR(1), &value));
+    ASSERT_PTR_EQUALS(INT_PTR(10), value);
+
+    /* Replacing doesn't evict */
+    ASSERT_SUCCESS(aws_sharded_lru_cache_put(&cache, INT_PTR(3), INT_PTR(31)));
+    ASSERT_SUCCESS(aws_sharded_lru_cache_put(&cache, INT_PTR(4), INT_PTR(40)));
+
+    ASSERT_SUCCESS(aws_sharded_lru_cache_find(&cache, INT_PTR(2), &value));
+    ASSERT_NULL(value);
+    ASSERT_SUCCESS(aws_sharded_lru_cache_find(&cache, INT_PTR(3), &value));
+    ASSERT_PTR_EQUALS(INT_PTR(31), value);
+
+    bool found = false;
+    ASSERT_SUCCESS(aws_sharded_lru_cache_find_with(&cache, INT_PTR(5), NULL, NULL, &found));
+    ASSERT_FALSE(found);
+
+    struct aws_sharded_lru_cache_stats stats;
+    aws_sharded_lru_cache_get_stats(&cache, &stats);
+    ASSERT_UINT_EQUALS(3, stats.element_count);
+    ASSERT_UINT_EQUALS(2, stats.hits);
+    ASSERT_UINT_EQUALS(2, stats.misses);
+    ASSERT_UINT_EQUALS(1, stats.evictions);
+
+    ASSERT_SUCCESS(aws_sharded_lru_cache_remove(&cache, INT_PTR(4)));
+    ASSERT_UINT_EQUALS(2, aws_sharded_lru_cache_get_element_count(&cache));
+    aws_sharded_lru_cache_clear(&cache);
+    ASSERT_UINT_EQUALS(0, aws_sharded_lru_cache_get_element_count(&cache));
+
+    aws_sharded_lru_cache_clean_up(&cache);
+    aws_sharded_lru_cache_clean_up(&cache);
+    return 0;
+}
+
+AWS_TEST_CASE(test_sharded_lru_cache_single_shard, s_test_sharded_lru_cache_single_shard_fn)
+
+static int s_test_sharded_lru_cache_capacity_fn(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    struct aws_sharded_lru_cache cache;
+
+    /* Shard counts are rounded up to a power of two, but never exceed the capacity */
+    ASSERT_SUCCESS(aws_sharded_lru_cache_init(&cache, allocator, s_hash_int, s_int_eq, NULL, NULL, 5, 64));
+    ASSERT_UINT_EQUALS(4, cache.shard_count);
+    aws_sharded_lru_cache_clean_up(&cache);
+
+    ASSERT_SUCCESS(aws_sharded_lru_cache_init(&cache, allocator, s_hash_int, s_int_eq, NULL, NULL, 100, 0));
+    ASSERT_TRUE(cache.shard_count >= 1);
+    aws_sharded_lru_cache_clean_up(&cache);
+
+    ASSERT_SUCCESS(aws_sharded_lru_cache_init(&cache, allocator, s_hash_int, s_int_eq, NULL, NULL, 100, 6));
+    ASSERT_UINT_EQUALS(8, cache.shard_count);
+
+    enum { KEYS = 1000 };
+    for (size_t i = 1; i <= KEYS; i++) {
+        ASSERT_SUCCESS(aws_sharded_lru_cache_put(&cache, INT_PTR(i), INT_PTR(i)));
+    }
+
+    /* Every shard fills up to its share of 100 / 8, rounded up */
+    struct aws_sharded_lru_cache_stats stats;
+    aws_sharded_lru_cache_get_stats(&cache, &stats);
+    ASSERT_UINT_EQUALS(8 * 13, stats.element_count);
+    ASSERT_UINT_EQUALS(KEYS - stats.element_count, stats.evictions);
+
+    /* Anything present has the right value, and the last key put survived */
+    size_t present = 0;
+    for (size_t i = 1; i <= KEYS; i++) {
+        void *value = NULL;
+        ASSERT_SUCCESS(aws_sharded_lru_cache_find(&cache, INT_PTR(i), &value));
+        if (value) {
+            ASSERT_PTR_EQUALS(INT_PTR(i), value);
+            present++;
+        }
+    }
+    ASSERT_UINT_EQUALS(stats.element_count, present);
+    void *value = NULL;
+    ASSERT_SUCCESS(aws_sharded_lru_cache_find(&cache, INT_PTR(KEYS), &value));
+    ASSERT_NOT_NULL(value);
+
+    aws_sharded_lru_cache_clean_up(&cache);
+    return 0;
+}
+
+AWS_TEST_CASE(test_sharded_lru_cache_capacity, s_test_sharded_lru_cache_capacity_fn)
+
+struct counted_value {
+    size_t key;
+    struct aws_atomic_var *destroyed;
+};
+
+static void s_destroy_counted_value(void *value) {
+    struct counted_value *counted = value;
+    aws_atomic_fetch_add(counted->destroyed, 1);
+    aws_mem_release(aws_default_allocator(), counted);
+}
+
+struct sharded_thread_data {
+    struct aws_sharded_lru_cache *cache;
+    struct aws_atomic_var *destroyed;
+    struct aws_atomic_var *created;
+    struct aws_atomic_var *failures;
+    size_t thread_index;
+};
+
+static void s_copy_key(void *value, void *user_data) {
+    *(size_t *)user_data = ((struct counted_value *)value)->key;
+}
+
+enum { THREADS = 4, OPS_PER_THREAD = 20000, THREAD_KEY_SPACE = 300 };
+
+static void s_sharded_thread_fn(void *arg) {
+    struct sharded_thread_data *data = arg;
+    uint64_t rand_state = data->thread_index + 1;
+
+    for (size_t op = 0; op < OPS_PER_THREAD; op++) {
+        rand_state = rand_state * 6364136223846793005ULL + 1442695040888963407ULL;
+        size_t key = (size_t)(rand_state >> 33) % THREAD_KEY_SPACE + 1;
+
+        if ((rand_state >> 20) % 4 == 0) {
+            struct counted_value *value = aws_mem_acquire(aws_default_allocator(), sizeof(struct counted_value));
+            value->key = key;
+            value->destroyed = data->destroyed;
+            aws_atomic_fetch_add(data->created, 1);
+            aws_sharded_lru_cache_put(data->cache, INT_PTR(key), value);
+        } else {
+            /* Values may be evicted and destroyed by other threads, so only look at them under the lock */
+            size_t found_key = 0;
+            bool found = false;
+            aws_sharded_lru_cache_find_with(data->cache, INT_PTR(key), s_copy_key, &found_key, &found);
+            if (found && found_key != key) {
+                aws_atomic_fetch_add(data->failures, 1);
+            }
+        }
+    }
+}
+
+static int s_test_sharded_lru_cache_threaded_fn(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    struct aws_atomic_var destroyed;
+    struct aws_atomic_var created;
+    struct aws_atomic_var failures;
+    aws_atomic_init_int(&destroyed, 0);
+    aws_atomic_init_int(&created, 0);
+    aws_atomic_init_int(&failures, 0);
+
+    struct aws_sharded_lru_cache cache;
+    ASSERT_SUCCESS(
+        aws_sharded_lru_cache_init(&cache, allocator, s_hash_int, s_int_eq, NULL, s_destroy_counted_value, 128, 8));
+
+    struct aws_thread threads[THREADS];
+    struct sharded_thread_data data[THREADS];
+    for (size_t i = 0; i < THREADS; i++) {
+        data[i].cache = &cache;
+        data[i].destroyed = &destroyed;
+        data[i].created = &created;
+        data[i].failures = &failures;
+        data[i].thread_index = i;
+        ASSERT_SUCCESS(aws_thread_init(&threads[i], allocator));
+        ASSERT_SUCCESS(aws_thread_launch(&threads[i], s_sharded_thread_fn, &data[i], NULL));
+    }
+    for (size_t i = 0; i < THREADS; i++) {
+        ASSERT_SUCCESS(aws_thread_join(&threads[i]));
+        aws_thread_clean_up(&threads[i]);
+    }
+
+    ASSERT_UINT_EQUALS(0, aws_atomic_load_int(&failures));
+
+    struct aws_sharded_lru_cache_stats stats;
+    aws_sharded_lru_cache_get_stats(&cache, &stats);
+    ASSERT_TRUE(stats.element_count <= 128);
+    ASSERT_UINT_EQUALS(THREADS * OPS_PER_THREAD - aws_atomic_load_int(&created), stats.hits + stats.misses);
+    ASSERT_UINT_EQUALS(aws_atomic_load_int(&created) - stats.element_count, aws_atomic_load_int(&destroyed));
+
+    aws_sharded_lru_cache_clean_up(&cache);
+    ASSERT_UINT_EQUALS(aws_atomic_load_int(&created), aws_atomic_load_int(&destroyed));
+    return 0;
+}
+
+AWS_TEST_CASE(test_sharded_lru_cache_threaded, s_test_sharded_lru_cache_threaded_fn)
@@ -13,6 +13,8 @@
  * permissions and limitations under the License.
  */
 
+#include <aws/common/atomics.h>
+#include <aws/common/config.h>
 #include <aws/common/task_scheduler.h>
 #include <aws/common/thread.h>
 #include <aws/testing/aws_test_harness.h>
@@ -532,6 +534,598 @@ static int s_test_scheduler_schedule_cancellation(struct aws_allocator *allocato
     return 0;
 }
 
+
+struct wheel_test_task {
+    struct aws_task task;
+    struct aws_task_scheduler *scheduler;
+    uint64_t timestamp;
+    size_t runs;
+    size_t cancels;
+    /* Index of the run_all call which scheduled the task, and the one which ran it */
+    size_t scheduled_in;
+    size_t ran_in;
+    /* If set, running the task schedules this one, for the time of the current run */
+    struct wheel_test_task *follow_up;
+};
+
+static size_t s_wheel_run_index;
+static uint64_t s_wheel_run_time;
+static uint64_t s_wheel_last_tick;
+static size_t s_wheel_early_runs;
+static size_t s_wheel_out_of_order_runs;
+
+#define WHEEL_TEST_RESOLUTION 10
+
+static void s_wheel_task_fn(struct aws_task *task, void *arg, enum aws_task_status status) {
+    (void)task;
+    struct wheel_test_task *test_task = arg;
+
+    if (status == AWS_TASK_STATUS_CANCELED) {
+        test_task->cancels++;
+        return;
+    }
+
+    test_task->runs++;
+    test_task->ran_in = s_wheel_run_index;
+    if (test_task->timestamp > s_wheel_run_time) {
+        s_wheel_early_runs++;
+    }
+    uint64_t tick = test_task->timestamp / WHEEL_TEST_RESOLUTION;
+    if (tick < s_wheel_last_tick) {
+        s_wheel_out_of_order_runs++;
+    }
+    s_wheel_last_tick = tick;
+
+    struct wheel_test_task *follow_up = test_task->follow_up;
+    if (follow_up) {
+        follow_up->timestamp = s_wheel_run_time;
+        follow_up->scheduled_in = s_wheel_run_index;
+        aws_task_scheduler_schedule_future(test_task->scheduler, &follow_up->task, follow_up->timestamp);
+    }
+}
+
+static uint64_t s_wheel_rand(uint64_t *state) {
+    *state = *state * 6364136223846793005ULL + 1442695040888963407ULL;
+    return *state >> 11;
+}
+
+static int s_test_scheduler_wheel_model(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    struct aws_task_scheduler_options options = {
+        .timers = AWS_TASK_SCHEDULER_TIMERS_WHEEL,
+        .wheel_resolution = WHEEL_TEST_RESOLUTION,
+    };
+    struct aws_task_scheduler scheduler;
+    ASSERT_SUCCESS(aws_task_scheduler_init_with_options(&scheduler, allocator, &options));
+
+    enum { TASKS = 3000, FOLLOW_UPS = 100, RUNS = 300 };
+    size_t tasks_size = sizeof(struct wheel_test_task) * (TASKS + FOLLOW_UPS);
+    struct wheel_test_task *tasks = aws_mem_acquire(allocator, tasks_size);
+    ASSERT_NOT_NULL(tasks);
+    memset(tasks, 0, tasks_size);
+
+    /* Timestamps spread over every level of the wheel, including ones the runs will never reach */
+    uint64_t rand_state = 1;
+    for (size_t i = 0; i < TASKS + FOLLOW_UPS; i++) {
+        struct wheel_test_task *test_task = &tasks[i];
+        test_task->scheduler = &scheduler;
+        aws_task_init(&test_task->task, s_wheel_task_fn, test_task);
+        if (i >= TASKS) {
+            continue;
+        }
+
+        uint64_t r = s_wheel_rand(&rand_state);
+        switch (r % 4) {
+            case 0:
+                test_task->timestamp = r % 5000;
+                break;
+            case 1:
+                test_task->timestamp = r % 10000000;
+                break;
+            case 2:
+                test_task->timestamp = r % 1000000000000ULL;
+                break;
+            default:
+                test_task->timestamp = UINT64_MAX - r % 1000;
+                break;
+        }
+        if (i < FOLLOW_UPS) {
+            test_task->follow_up = &tasks[TASKS + i];
+        }
+        aws_task_scheduler_schedule_future(&scheduler, &test_task->task, test_task->timestamp);
+    }
+
+    /* Run at times growing roughly geometrically, so that every level cascades, canceling some tasks as we go */
+    uint64_t now = 0;
+    for (s_wheel_run_index = 1; s_wheel_run_index <= RUNS; s_wheel_run_index++) {
+        for (size_t c = 0; c < 5; c++) {
+            struct wheel_test_task *test_task = &tasks[s_wheel_rand(&rand_state) % TASKS];
+            if (!test_task->runs && !test_task->cancels) {
+                aws_task_scheduler_cancel_task(&scheduler, &test_task->task);
+            }
+        }
+
+        now += s_wheel_rand(&rand_state) % (now / 8 + 100);
+        s_wheel_run_time = now;
+        s_wheel_last_tick = 0;
+        aws_task_scheduler_run_all(&scheduler, now);
+
+        uint64_t earliest_pending = UINT64_MAX;
+        for (size_t i = 0; i < TASKS + FOLLOW_UPS; i++) {
+            struct wheel_test_task *test_task = &tasks[i];
+            ASSERT_TRUE(test_task->runs + test_task->cancels <= 1);
+
+            bool scheduled = i < TASKS || test_task->scheduled_in;
+            if (!scheduled || test_task->cancels) {
+                continue;
+            }
+
+            if (i >= TASKS && test_task->runs) {
+                /* Tasks scheduled during a run wait for the next one, even when they're already due */
+                ASSERT_UINT_EQUALS(test_task->scheduled_in + 1, test_task->ran_in);
+            }
+
+            if (!test_task->runs) {
+                ASSERT_TRUE(test_task->timestamp > now || test_task->scheduled_in == s_wheel_run_index);
+                if (test_task->timestamp < earliest_pending) {
+                    earliest_pending = test_task->timestamp;
+                }
+            }
+        }
+
+        /* The wheel may report the start of the slot holding the next task, which is early, but never late */
+        uint64_t next_task_time = 0;
+        ASSERT_TRUE(aws_task_scheduler_has_tasks(&scheduler, &next_task_time));
+        ASSERT_TRUE(next_task_time <= earliest_pending);
+    }
+
+    ASSERT_UINT_EQUALS(0, s_wheel_early_runs);
+    ASSERT_UINT_EQUALS(0, s_wheel_out_of_order_runs);
+
+    /* Some tasks were left for each level to cascade through */
+    size_t ran = 0;
+    for (size_t i = 0; i < TASKS; i++) {
+        ran += tasks[i].runs;
+    }
+    ASSERT_TRUE(ran > TASKS / 4);
+    ASSERT_TRUE(ran < TASKS);
+
+    aws_task_scheduler_clean_up(&scheduler);
+    for (size_t i = 0; i < TASKS; i++) {
+        ASSERT_UINT_EQUALS(1, tasks[i].runs + tasks[i].cancels);
+    }
+
+    aws_mem_release(allocator, tasks);
+    return 0;
+}
+
+static int s_test_scheduler_wheel_reentrant_safe(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    struct aws_task_scheduler_options options = {.timers = AWS_TASK_SCHEDULER_TIMERS_WHEEL};
+    struct aws_task_scheduler scheduler;
+    ASSERT_SUCCESS(aws_task_scheduler_init_with_options(&scheduler, allocator, &options));
+
+    /* When task1 executes, it schedules task2 */
+    struct task_scheduler_reentrancy_args task2_args;
+    s_reentrancy_args_init(&task2_args, &scheduler, NULL);
+
+    struct task_scheduler_reentrancy_args task1_args;
+    s_reentrancy_args_init(&task1_args, &scheduler, &task2_args);
+
+    /* Partway through a tick of the default 1ms resolution */
+    aws_task_scheduler_schedule_future(&scheduler, &task1_args.task, 1500);
+    aws_task_scheduler_run_all(&scheduler, 1499);
+    ASSERT_FALSE(task1_args.executed);
+
+    aws_task_scheduler_run_all(&scheduler, 1500);
+    ASSERT_TRUE(task1_args.executed);
+    ASSERT_FALSE(task2_args.executed);
+
+    aws_task_scheduler_run_all(&scheduler, 1500);
+    ASSERT_TRUE(task2_args.executed);
+
+    /* Cancellation from the wheel, and clean up with tasks still in it */
+    struct cancellation_args canceled_args = {.status = 100000};
+    struct aws_task canceled_task;
+    aws_task_init(&canceled_task, s_cancellation_fn, &canceled_args);
+    aws_task_scheduler_schedule_future(&scheduler, &canceled_task, 5000000);
+    aws_task_scheduler_cancel_task(&scheduler, &canceled_task);
+    ASSERT_INT_EQUALS(AWS_TASK_STATUS_CANCELED, canceled_args.status);
+    ASSERT_FALSE(aws_task_scheduler_has_tasks(&scheduler, NULL));
+
+    struct cancellation_args future_args = {.status = 100000};
+    struct aws_task future_task;
+    aws_task_init(&future_task, s_cancellation_fn, &future_args);
+    aws_task_scheduler_schedule_future(&scheduler, &future_task, 9999999999999);
+
+    aws_task_scheduler_clean_up(&scheduler);
+    ASSERT_INT_EQUALS(AWS_TASK_STATUS_CANCELED, future_args.status);
+    return 0;
+}
+
+static void s_count_wake(struct aws_task_scheduler *scheduler, void *user_data) {
+    (void)scheduler;
+    aws_atomic_fetch_add(user_data, 1);
+}
+
+static int s_test_scheduler_threadsafe_submission(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+    s_executed_tasks_n = 0;
+
+    struct aws_atomic_var wakes;
+    aws_atomic_init_int(&wakes, 0);
+    struct aws_task_scheduler_options options = {.wake_fn = s_count_wake, .wake_user_data = &wakes};
+    struct aws_task_scheduler scheduler;
+    ASSERT_SUCCESS(aws_task_scheduler_init_with_options(&scheduler, allocator, &options));
+
+    struct aws_task task1;
+    aws_task_init(&task1, s_task_n_fn, (void *)1);
+    struct aws_task task2;
+    aws_task_init(&task2, s_task_n_fn, (void *)2);
+    struct aws_task task3;
+    aws_task_init(&task3, s_task_n_fn, (void *)3);
+    struct aws_task task4;
+    aws_task_init(&task4, s_task_n_fn, (void *)4);
+
+    /* Only the first submission before a run wakes the owner */
+    aws_task_scheduler_schedule_future_threadsafe(&scheduler, &task3, 500);
+    aws_task_scheduler_schedule_now_threadsafe(&scheduler, &task1);
+    aws_task_scheduler_schedule_now_threadsafe(&scheduler, &task2);
+    ASSERT_UINT_EQUALS(1, aws_atomic_load_int(&wakes));
+
+    uint64_t next_task_time = UINT64_MAX;
+    ASSERT_TRUE(aws_task_scheduler_has_tasks(&scheduler, &next_task_time));
+    ASSERT_UINT_EQUALS(0, next_task_time);
+
+    /* Now tasks run in submission order, future ones when due */
+    aws_task_scheduler_run_all(&scheduler, 100);
+    ASSERT_UINT_EQUALS(2, s_executed_tasks_n);
+    ASSERT_PTR_EQUALS(&task1, s_executed_tasks[0].task);
+    ASSERT_PTR_EQUALS(&task2, s_executed_tasks[1].task);
+    ASSERT_TRUE(aws_task_scheduler_has_tasks(&scheduler, &next_task_time));
+    ASSERT_UINT_EQUALS(500, next_task_time);
+
+    /* A submitted task can be canceled before any run picks it up */
+    aws_task_scheduler_schedule_now_threadsafe(&scheduler, &task4);
+    ASSERT_UINT_EQUALS(2, aws_atomic_load_int(&wakes));
+    aws_task_scheduler_cancel_task(&scheduler, &task4);
+    ASSERT_UINT_EQUALS(3, s_executed_tasks_n);
+    ASSERT_PTR_EQUALS(&task4, s_executed_tasks[2].task);
+    ASSERT_INT_EQUALS(AWS_TASK_STATUS_CANCELED, s_executed_tasks[2].status);
+
+    aws_task_scheduler_run_all(&scheduler, 500);
+    ASSERT_UINT_EQUALS(4, s_executed_tasks_n);
+    ASSERT_PTR_EQUALS(&task3, s_executed_tasks[3].task);
+    ASSERT_INT_EQUALS(AWS_TASK_STATUS_RUN_READY, s_executed_tasks[3].status);
+
+    aws_task_scheduler_clean_up(&scheduler);
+    return 0;
+}
+
+enum { THREADSAFE_PRODUCERS = 4, THREADSAFE_TASKS_PER_PRODUCER = 5000 };
+
+struct threadsafe_test_task {
+    struct aws_task task;
+    size_t producer;
+    size_t sequence;
+    size_t runs;
+};
+
+struct threadsafe_test_state {
+    struct aws_task_scheduler scheduler;
+    struct threadsafe_test_task *tasks;
+    size_t executed;
+    /* Sequence number of the last now-task run from each producer, plus one */
+    size_t next_sequence[THREADSAFE_PRODUCERS];
+    size_t out_of_order;
+};
+
+static struct threadsafe_test_state s_threadsafe_state;
+
+static void s_threadsafe_task_fn(struct aws_task *task, void *arg, enum aws_task_status status) {
+    (void)task;
+    (void)status;
+    struct threadsafe_test_task *test_task = arg;
+    test_task->runs++;
+    s_threadsafe_state.executed++;
+
+    /* Each producer's now-tasks run in the order it submitted them */
+    if (test_task->sequence % 2 == 0) {
+        if (test_task->sequence < s_threadsafe_state.next_sequence[test_task->producer]) {
+            s_threadsafe_state.out_of_order++;
+        }
+        s_threadsafe_state.next_sequence[test_task->producer] = test_task->sequence + 1;
+    }
+}
+
+static void s_threadsafe_producer_fn(void *arg) {
+    size_t producer = (size_t)(uintptr_t)arg;
+    for (size_t i = 0; i < THREADSAFE_TASKS_PER_PRODUCER; i++) {
+        struct threadsafe_test_task *test_task =
+            &s_threadsafe_state.tasks[producer * THREADSAFE_TASKS_PER_PRODUCER + i];
+        if (i % 2 == 0) {
+            aws_task_scheduler_schedule_now_threadsafe(&s_threadsafe_state.scheduler, &test_task->task);
+        } else {
+            aws_task_scheduler_schedule_future_threadsafe(&s_threadsafe_state.scheduler, &test_task->task, i);
+        }
+    }
+}
+
+static int s_test_scheduler_threadsafe_producers(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    for (int wheel = 0; wheel < 2; wheel++) {
+        AWS_ZERO_STRUCT(s_threadsafe_state);
+        struct aws_task_scheduler_options options = {
+            .timers = wheel ? AWS_TASK_SCHEDULER_TIMERS_WHEEL : AWS_TASK_SCHEDULER_TIMERS_HEAP,
+        };
+        ASSERT_SUCCESS(aws_task_scheduler_init_with_options(&s_threadsafe_state.scheduler, allocator, &options));
+
+        size_t task_count = THREADSAFE_PRODUCERS * THREADSAFE_TASKS_PER_PRODUCER;
+        s_threadsafe_state.tasks = aws_mem_acquire(allocator, task_count * sizeof(struct threadsafe_test_task));
+        ASSERT_NOT_NULL(s_threadsafe_state.tasks);
+        for (size_t i = 0; i < task_count; i++) {
+            struct threadsafe_test_task *test_task = &s_threadsafe_state.tasks[i];
+            aws_task_init(&test_task->task, s_threadsafe_task_fn, test_task);
+            test_task->producer = i / THREADSAFE_TASKS_PER_PRODUCER;
+            test_task->sequence = i % THREADSAFE_TASKS_PER_PRODUCER;
+            test_task->runs = 0;
+        }
+
+        struct aws_thread threads[THREADSAFE_PRODUCERS];
+        for (size_t i = 0; i < THREADSAFE_PRODUCERS; i++) {
+            ASSERT_SUCCESS(aws_thread_init(&threads[i], allocator));
+            ASSERT_SUCCESS(aws_thread_launch(&threads[i], s_threadsafe_producer_fn, (void *)(uintptr_t)i, NULL));
+        }
+
+        /* Run while the producers are submitting, until everything has run */
+        while (s_threadsafe_state.executed < task_count) {
+            aws_task_scheduler_run_all(&s_threadsafe_state.scheduler, UINT64_MAX - 1);
+        }
+
+        for (size_t i = 0; i < THREADSAFE_PRODUCERS; i++) {
+            ASSERT_SUCCESS(aws_thread_join(&threads[i]));
+            aws_thread_clean_up(&threads[i]);
+        }
+
+        ASSERT_FALSE(aws_task_scheduler_has_tasks(&s_threadsafe_state.scheduler, NULL));
+        ASSERT_UINT_EQUALS(0, s_threadsafe_state.out_of_order);
+        for (size_t i = 0; i < task_count; i++) {
+            ASSERT_UINT_EQUALS(1, s_threadsafe_state.tasks[i].runs);
+        }
+
+        aws_task_scheduler_clean_up(&s_threadsafe_state.scheduler);
+        aws_mem_release(allocator, s_threadsafe_state.tasks);
+    }
+
+    return 0;
+}
+
+static int s_test_scheduler_slack_coalescing(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    enum aws_task_scheduler_timers timers[] = {AWS_TASK_SCHEDULER_TIMERS_HEAP, AWS_TASK_SCHEDULER_TIMERS_WHEEL};
+    for (size_t t = 0; t < AWS_ARRAY_SIZE(timers); t++) {
+        s_executed_tasks_n = 0;
+
+        struct aws_task_scheduler_options options = {.timers = timers[t], .wheel_resolution = 10};
+        struct aws_task_scheduler scheduler;
+        ASSERT_SUCCESS(aws_task_scheduler_init_with_options(&scheduler, allocator, &options));
+
+        /* Windows [100, 150], [120, 220] and [140, 160] overlap, so one run at 150 satisfies all three */
+        struct aws_task tasks[4];
+        for (size_t i = 0; i < AWS_ARRAY_SIZE(tasks); i++) {
+            aws_task_init(&tasks[i], s_task_n_fn, (void *)i);
+        }
+        aws_task_scheduler_schedule_future_with_slack(&scheduler, &tasks[1], 120, 100);
+        aws_task_scheduler_schedule_future_with_slack(&scheduler, &tasks[0], 100, 50);
+        aws_task_scheduler_schedule_future_with_slack(&scheduler, &tasks[2], 140, 20);
+
+        uint64_t next_task_time = 0;
+        ASSERT_TRUE(aws_task_scheduler_has_tasks(&scheduler, &next_task_time));
+        ASSERT_UINT_EQUALS(150, next_task_time);
+
+        /* A task without slack still wakes the scheduler at its timestamp */
+        aws_task_scheduler_schedule_future(&scheduler, &tasks[3], 110);
+        ASSERT_TRUE(aws_task_scheduler_has_tasks(&scheduler, &next_task_time));
+        ASSERT_UINT_EQUALS(110, next_task_time);
+
+        /* Nothing runs before its timestamp, even though it has slack */
+        aws_task_scheduler_run_all(&scheduler, 99);
+        ASSERT_UINT_EQUALS(0, s_executed_tasks_n);
+
+        /* The run for task 3 takes task 0 along, whose window has opened, in timestamp order after the others */
+        aws_task_scheduler_run_all(&scheduler, 110);
+        ASSERT_UINT_EQUALS(2, s_executed_tasks_n);
+        ASSERT_PTR_EQUALS(&tasks[3], s_executed_tasks[0].task);
+        ASSERT_PTR_EQUALS(&tasks[0], s_executed_tasks[1].task);
+
+        ASSERT_TRUE(aws_task_scheduler_has_tasks(&scheduler, &next_task_time));
+        ASSERT_UINT_EQUALS(160, next_task_time);
+
+        aws_task_scheduler_run_all(&scheduler, 160);
+        ASSERT_UINT_EQUALS(4, s_executed_tasks_n);
+        ASSERT_PTR_EQUALS(&tasks[1], s_executed_tasks[2].task);
+        ASSERT_PTR_EQUALS(&tasks[2], s_executed_tasks[3].task);
+        ASSERT_INT_EQUALS(AWS_TASK_STATUS_RUN_READY, s_executed_tasks[3].status);
+        ASSERT_FALSE(aws_task_scheduler_has_tasks(&scheduler, &next_task_time));
+        ASSERT_UINT_EQUALS(UINT64_MAX, next_task_time);
+
+        /* Slack of 0 is an ordinary timed task, and a huge slack saturates instead of wrapping */
+        s_executed_tasks_n = 0;
+        aws_task_scheduler_schedule_future_with_slack(&scheduler, &tasks[0], 200, 0);
+        aws_task_scheduler_schedule_future_with_slack(&scheduler, &tasks[1], 300, UINT64_MAX);
+        ASSERT_TRUE(aws_task_scheduler_has_tasks(&scheduler, &next_task_time));
+        ASSERT_UINT_EQUALS(200, next_task_time);
+        aws_task_scheduler_run_all(&scheduler, 200);
+        ASSERT_TRUE(aws_task_scheduler_has_tasks(&scheduler, &next_task_time));
+        ASSERT_UINT_EQUALS(UINT64_MAX, next_task_time);
+
+        aws_task_scheduler_clean_up(&scheduler);
+        ASSERT_UINT_EQUALS(2, s_executed_tasks_n);
+        ASSERT_PTR_EQUALS(&tasks[1], s_executed_tasks[1].task);
+        ASSERT_INT_EQUALS(AWS_TASK_STATUS_CANCELED, s_executed_tasks[1].status);
+    }
+
+    return 0;
+}
+
+static int s_test_scheduler_slack_cancellation(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+    s_executed_tasks_n = 0;
+
+    struct aws_task_scheduler scheduler;
+    ASSERT_SUCCESS(aws_task_scheduler_init(&scheduler, allocator));
+
+    struct aws_task tasks[3];
+    for (size_t i = 0; i < AWS_ARRAY_SIZE(tasks); i++) {
+        aws_task_init(&tasks[i], s_task_n_fn, (void *)i);
+        aws_task_scheduler_schedule_future_with_slack(&scheduler, &tasks[i], 100 + i * 10, 100);
+    }
+    struct aws_task timed_task;
+    aws_task_init(&timed_task, s_task_n_fn, (void *)3);
+    aws_task_scheduler_schedule_future(&scheduler, &timed_task, 500);
+
+    /* Canceling the earliest deadline moves the next wake-up out to the next one */
+    aws_task_scheduler_cancel_task(&scheduler, &tasks[0]);
+    ASSERT_UINT_EQUALS(1, s_executed_tasks_n);
+    ASSERT_PTR_EQUALS(&tasks[0], s_executed_tasks[0].task);
+    ASSERT_INT_EQUALS(AWS_TASK_STATUS_CANCELED, s_executed_tasks[0].status);
+
+    uint64_t next_task_time = 0;
+    ASSERT_TRUE(aws_task_scheduler_has_tasks(&scheduler, &next_task_time));
+    ASSERT_UINT_EQUALS(210, next_task_time);
+
+    /* A canceled task can be rescheduled without slack, and canceled again */
+    aws_task_scheduler_cancel_task(&scheduler, &tasks[1]);
+    aws_task_scheduler_schedule_future(&scheduler, &tasks[1], 400);
+    aws_task_scheduler_cancel_task(&scheduler, &tasks[1]);
+    aws_task_scheduler_cancel_task(&scheduler, &timed_task);
+    ASSERT_UINT_EQUALS(4, s_executed_tasks_n);
+
+    ASSERT_TRUE(aws_task_scheduler_has_tasks(&scheduler, &next_task_time));
+    ASSERT_UINT_EQUALS(220, next_task_time);
+    aws_task_scheduler_run_all(&scheduler, 220);
+    ASSERT_UINT_EQUALS(5, s_executed_tasks_n);
+    ASSERT_PTR_EQUALS(&tasks[2], s_executed_tasks[4].task);
+    ASSERT_INT_EQUALS(AWS_TASK_STATUS_RUN_READY, s_executed_tasks[4].status);
+    ASSERT_FALSE(aws_task_scheduler_has_tasks(&scheduler, NULL));
+
+    aws_task_scheduler_clean_up(&scheduler);
+    return 0;
+}
+
+#ifdef AWS_ENABLE_TASK_SCHEDULER_STATS
+static void s_slow_task_fn(struct aws_task *task, void *arg, enum aws_task_status status) {
+    (void)task;
+    (void)arg;
+    (void)status;
+    aws_thread_current_sleep(2000000);
+}
+#endif
+
+static int s_test_scheduler_stats(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    struct aws_task_scheduler_stats stats;
+    struct aws_task_scheduler_fn_stats fn_stats[4];
+    size_t fn_count = 0;
+
+    /* Schedulers record nothing unless asked to */
+    struct aws_task_scheduler scheduler;
+    ASSERT_SUCCESS(aws_task_scheduler_init(&scheduler, allocator));
+    ASSERT_ERROR(AWS_ERROR_UNSUPPORTED_OPERATION, aws_task_scheduler_get_stats(&scheduler, &stats));
+    ASSERT_ERROR(
+        AWS_ERROR_UNSUPPORTED_OPERATION,
+        aws_task_scheduler_get_fn_stats(&scheduler, fn_stats, AWS_ARRAY_SIZE(fn_stats), &fn_count));
+    aws_task_scheduler_reset_stats(&scheduler);
+    aws_task_scheduler_clean_up(&scheduler);
+
+    enum aws_task_scheduler_timers timers[] = {AWS_TASK_SCHEDULER_TIMERS_HEAP, AWS_TASK_SCHEDULER_TIMERS_WHEEL};
+    for (size_t t = 0; t < AWS_ARRAY_SIZE(timers); t++) {
+        s_executed_tasks_n = 0;
+
+        struct aws_task_scheduler_options options = {.timers = timers[t], .wheel_resolution = 1, .enable_stats = true};
+        ASSERT_SUCCESS(aws_task_scheduler_init_with_options(&scheduler, allocator, &options));
+
+#ifdef AWS_ENABLE_TASK_SCHEDULER_STATS
+        struct aws_task tasks[5];
+        for (size_t i = 0; i < AWS_ARRAY_SIZE(tasks); i++) {
+            aws_task_init(&tasks[i], s_task_n_fn, (void *)i);
+        }
+        struct aws_task slow_task;
+        aws_task_init(&slow_task, s_slow_task_fn, NULL);
+
+        aws_task_scheduler_schedule_now(&scheduler, &tasks[0]);
+        aws_task_scheduler_schedule_now(&scheduler, &slow_task);
+        aws_task_scheduler_schedule_future(&scheduler, &tasks[1], 100);
+        aws_task_scheduler_schedule_future(&scheduler, &tasks[2], 97);
+        aws_task_scheduler_schedule_future_with_slack(&scheduler, &tasks[3], 200, 50);
+        aws_task_scheduler_schedule_future(&scheduler, &tasks[4], 300);
+
+        ASSERT_SUCCESS(aws_task_scheduler_get_stats(&scheduler, &stats));
+        ASSERT_UINT_EQUALS(2, stats.asap_count);
+        ASSERT_UINT_EQUALS(4, stats.timed_count);
+        ASSERT_UINT_EQUALS(0, stats.run_count);
+
+        /* Lateness 0 for task 1 and 3 for task 2, which land in buckets 0 and 2 */
+        aws_task_scheduler_run_all(&scheduler, 100);
+        aws_task_scheduler_run_all(&scheduler, 210);
+        aws_task_scheduler_cancel_task(&scheduler, &tasks[4]);
+
+        ASSERT_SUCCESS(aws_task_scheduler_get_stats(&scheduler, &stats));
+        ASSERT_UINT_EQUALS(0, stats.asap_count);
+        ASSERT_UINT_EQUALS(0, stats.timed_count);
+        ASSERT_UINT_EQUALS(2, stats.run_count);
+        ASSERT_UINT_EQUALS(5, stats.tasks_run);
+        ASSERT_UINT_EQUALS(1, stats.tasks_canceled);
+        ASSERT_UINT_EQUALS(4, stats.max_batch_size);
+        ASSERT_UINT_EQUALS(10, stats.max_lateness);
+        ASSERT_UINT_EQUALS(1, stats.lateness_histogram[0]);
+        ASSERT_UINT_EQUALS(1, stats.lateness_histogram[2]);
+        ASSERT_UINT_EQUALS(1, stats.lateness_histogram[4]);
+        ASSERT_TRUE(stats.max_task_ns >= 2000000);
+        ASSERT_TRUE(stats.max_run_all_ns >= stats.max_task_ns);
+
+        uint64_t run_time_total = 0;
+        for (size_t i = 0; i < AWS_TASK_SCHEDULER_STATS_HISTOGRAM_SIZE; i++) {
+            run_time_total += stats.run_time_histogram[i];
+        }
+        ASSERT_UINT_EQUALS(5, run_time_total);
+
+        /* The slow function comes first, and canceled runs aren't counted */
+        ASSERT_SUCCESS(aws_task_scheduler_get_fn_stats(&scheduler, fn_stats, AWS_ARRAY_SIZE(fn_stats), &fn_count));
+        ASSERT_UINT_EQUALS(2, fn_count);
+        ASSERT_TRUE(fn_stats[0].fn == s_slow_task_fn);
+        ASSERT_UINT_EQUALS(1, fn_stats[0].run_count);
+        ASSERT_TRUE(fn_stats[0].total_ns >= 2000000);
+        ASSERT_UINT_EQUALS(fn_stats[0].total_ns, fn_stats[0].max_ns);
+        ASSERT_TRUE(fn_stats[1].fn == s_task_n_fn);
+        ASSERT_UINT_EQUALS(4, fn_stats[1].run_count);
+        ASSERT_TRUE(fn_stats[1].max_ns <= fn_stats[1].total_ns);
+
+        ASSERT_SUCCESS(aws_task_scheduler_get_fn_stats(&scheduler, fn_stats, 1, &fn_count));
+        ASSERT_UINT_EQUALS(1, fn_count);
+
+        aws_task_scheduler_reset_stats(&scheduler);
+        ASSERT_SUCCESS(aws_task_scheduler_get_stats(&scheduler, &stats));
+        ASSERT_UINT_EQUALS(0, stats.run_count);
+        ASSERT_UINT_EQUALS(0, stats.tasks_run);
+        ASSERT_UINT_EQUALS(0, stats.lateness_histogram[0]);
+        ASSERT_SUCCESS(aws_task_scheduler_get_fn_stats(&scheduler, fn_stats, AWS_ARRAY_SIZE(fn_stats), &fn_count));
+        ASSERT_UINT_EQUALS(0, fn_count);
+#else
+        ASSERT_ERROR(AWS_ERROR_UNSUPPORTED_OPERATION, aws_task_scheduler_get_stats(&scheduler, &stats));
+#endif
+
+        aws_task_scheduler_clean_up(&scheduler);
+    }
+
+    return 0;
+}
+
 AWS_TEST_CASE(scheduler_pops_task_late_test, s_test_scheduler_pops_task_fashionably_late);
 AWS_TEST_CASE(scheduler_ordering_test, s_test_scheduler_ordering);
 AWS_TEST_CASE(scheduler_has_tasks_test, s_test_scheduler_has_tasks);
@@ -540,3 +1134,10 @@ AWS_TEST_CASE(scheduler_cleanup_cancellation, s_test_scheduler_cleanup_cancellat
 AWS_TEST_CASE(scheduler_cleanup_reentrants, s_test_scheduler_cleanup_reentrants);
 AWS_TEST_CASE(scheduler_oom_still_works, s_test_scheduler_oom_still_works);
 AWS_TEST_CASE(scheduler_schedule_cancellation, s_test_scheduler_schedule_cancellation);
+AWS_TEST_CASE(scheduler_wheel_model, s_test_scheduler_wheel_model);
+AWS_TEST_CASE(scheduler_wheel_reentrant_safe, s_test_scheduler_wheel_reentrant_safe);
+AWS_TEST_CASE(scheduler_threadsafe_submission, s_test_scheduler_threadsafe_submission);
+AWS_TEST_CASE(scheduler_threadsafe_producers, s_test_scheduler_threadsafe_producers);
+AWS_TEST_CASE(scheduler_slack_coalescing, s_test_scheduler_slack_coalescing);
+AWS_TEST_CASE(scheduler_slack_cancellation, s_test_scheduler_slack_cancellation);
+AWS_TEST_CASE(scheduler_stats, s_test_scheduler_stats);
@@ -0,0 +1,278 @@
+/*
+ * Copyright 2010-2018 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *  http://aws.amazon.com/apache2.0
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#include <aws/common/thread_pool.h>
+
+#include <aws/common/atomics.h>
+#include <aws/common/condition_variable.h>
+#include <aws/common/mutex.h>
+#include <aws/common/thread.h>
+
+#include <aws/testing/aws_test_harness.h>
+
+/* Counts finished tasks, and lets the test thread wait for a number of them */
+struct pool_test_tracker {
+    struct aws_mutex lock;
+    struct aws_condition_variable done_signal;
+    size_t expected;
+    struct aws_atomic_var ran;
+    struct aws_atomic_var canceled;
+    struct aws_atomic_var finished;
+};
+
+static void s_tracker_init(struct pool_test_tracker *tracker, size_t expected) {
+    aws_mutex_init(&tracker->lock);
+    aws_condition_variable_init(&tracker->done_signal);
+    tracker->expected = expected;
+    aws_atomic_init_int(&tracker->ran, 0);
+    aws_atomic_init_int(&tracker->canceled, 0);
+    aws_atomic_init_int(&tracker->finished, 0);
+}
+
+static void s_tracker_clean_up(struct pool_test_tracker *tracker) {
+    aws_condition_variable_clean_up(&tracker->done_signal);
+    aws_mutex_clean_up(&tracker->lock);
+}
+
+static void s_tracker_finish(struct pool_test_tracker *tracker, enum aws_task_status status) {
+    aws_atomic_fetch_add(status == AWS_TASK_STATUS_RUN_READY ? &tracker->ran : &tracker->canceled, 1);
+    if (aws_atomic_fetch_add(&tracker->finished, 1) + 1 == tracker->expected) {
+        aws_mutex_lock(&tracker->lock);
+        aws_condition_variable_notify_all(&tracker->done_signal);
+        aws_mutex_unlock(&tracker->lock);
+    }
+}
+
+static bool s_tracker_done_pred(void *arg) {
+    struct pool_test_tracker *tracker = arg;
+    return aws_atomic_load_int(&tracker->finished) == tracker->expected;
+}
+
+static void s_tracker_wait(struct pool_test_tracker *tracker) {
+    aws_mutex_lock(&tracker->lock);
+    aws_condition_variable_wait_pred(&tracker->done_signal, &tracker->lock, s_tracker_done_pred, tracker);
+    aws_mutex_unlock(&tracker->lock);
+}
+
+struct counted_task {
+    struct aws_task task;
+    struct pool_test_tracker *tracker;
+    struct aws_atomic_var runs;
+};
+
+static void s_counted_task_fn(struct aws_task *task, void *arg, enum aws_task_status status) {
+    (void)task;
+    struct counted_task *counted = arg;
+    aws_atomic_fetch_add(&counted->runs, 1);
+    s_tracker_finish(counted->tracker, status);
+}
+
+#define EXTERNAL_TASKS 10000
+
+static int s_test_thread_pool_external_submission_fn(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    struct aws_thread_pool_options options = {.worker_count = 4, .deque_capacity = 16};
+    struct aws_thread_pool pool;
+    ASSERT_SUCCESS(aws_thread_pool_init(&pool, allocator, &options));
+    ASSERT_UINT_EQUALS(4, aws_thread_pool_get_worker_count(&pool));
+
+    struct pool_test_tracker tracker;
+    s_tracker_init(&tracker, EXTERNAL_TASKS);
+
+    struct counted_task *tasks = aws_mem_acquire(allocator, sizeof(struct counted_task) * EXTERNAL_TASKS);
+    ASSERT_NOT_NULL(tasks);
+    for (size_t i = 0; i < EXTERNAL_TASKS; i++) {
+        aws_task_init(&tasks[i].task, s_counted_task_fn, &tasks[i]);
+        tasks[i].tracker = &tracker;
+        aws_atomic_init_int(&tasks[i].runs, 0);
+        aws_thread_pool_submit(&pool, &tasks[i].task);
+    }
+
+    s_tracker_wait(&tracker);
+    ASSERT_UINT_EQUALS(EXTERNAL_TASKS, aws_atomic_load_int(&tracker.ran));
+    ASSERT_UINT_EQUALS(0, aws_atomic_load_int(&tracker.canceled));
+    for (size_t i = 0; i < EXTERNAL_TASKS; i++) {
+        ASSERT_UINT_EQUALS(1, aws_atomic_load_int(&tasks[i].runs));
+    }
+
+    aws_thread_pool_clean_up(&pool);
+    aws_thread_pool_clean_up(&pool);
+    aws_mem_release(allocator, tasks);
+    s_tracker_clean_up(&tracker);
+    return 0;
+}
+
+AWS_TEST_CASE(test_thread_pool_external_submission, s_test_thread_pool_external_submission_fn)
+
+/*
+ * Tasks forming an implicit binary tree, node i having children 2i + 1 and 2i + 2. Each interior task submits its
+ * children from the worker running it, so they go on that worker's deque and the rest of the pool has to steal them.
+ */
+struct split_tree {
+    struct aws_thread_pool *pool;
+    struct pool_test_tracker *tracker;
+    struct split_task *tasks;
+    size_t count;
+};
+
+struct split_task {
+    struct aws_task task;
+    struct split_tree *tree;
+    size_t index;
+    uint64_t thread_id;
+};
+
+#define SPLIT_DEPTH 14
+#define SPLIT_TASKS ((1 << (SPLIT_DEPTH + 1)) - 1)
+
+static void s_split_task_fn(struct aws_task *task, void *arg, enum aws_task_status status) {
+    (void)task;
+    struct split_task *split = arg;
+    struct split_tree *tree = split->tree;
+    split->thread_id = aws_thread_current_thread_id();
+
+    size_t child = split->index * 2 + 1;
+    if (status == AWS_TASK_STATUS_RUN_READY && child < tree->count) {
+        aws_thread_pool_submit(tree->pool, &tree->tasks[child].task);
+        aws_thread_pool_submit(tree->pool, &tree->tasks[child + 1].task);
+    }
+    s_tracker_finish(tree->tracker, status);
+}
+
+static int s_test_thread_pool_nested_submission_fn(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    struct aws_thread_pool_options options = {.worker_count = 4, .deque_capacity = 64};
+    struct aws_thread_pool pool;
+    ASSERT_SUCCESS(aws_thread_pool_init(&pool, allocator, &options));
+
+    struct pool_test_tracker tracker;
+    s_tracker_init(&tracker, SPLIT_TASKS);
+
+    struct split_tree tree = {
+        .pool = &pool,
+        .tracker = &tracker,
+        .tasks = aws_mem_acquire(allocator, sizeof(struct split_task) * SPLIT_TASKS),
+        .count = SPLIT_TASKS,
+    };
+    ASSERT_NOT_NULL(tree.tasks);
+    for (size_t i = 0; i < SPLIT_TASKS; i++) {
+        aws_task_init(&tree.tasks[i].task, s_split_task_fn, &tree.tasks[i]);
+        tree.tasks[i].tree = &tree;
+        tree.tasks[i].index = i;
+        tree.tasks[i].thread_id = 0;
+    }
+
+    aws_thread_pool_submit(&pool, &tree.tasks[0].task);
+    s_tracker_wait(&tracker);
+    ASSERT_UINT_EQUALS(SPLIT_TASKS, aws_atomic_load_int(&tracker.ran));
+
+    /* Everything ran on a worker, never on this thread */
+    uint64_t test_thread_id = aws_thread_current_thread_id();
+    for (size_t i = 0; i < SPLIT_TASKS; i++) {
+        ASSERT_TRUE(tree.tasks[i].thread_id != 0);
+        ASSERT_TRUE(tree.tasks[i].thread_id != test_thread_id);
+    }
+
+    aws_thread_pool_clean_up(&pool);
+    aws_mem_release(allocator, tree.tasks);
+    s_tracker_clean_up(&tracker);
+    return 0;
+}
+
+AWS_TEST_CASE(test_thread_pool_nested_submission, s_test_thread_pool_nested_submission_fn)
+
+/* Holds the pool's only worker until released, so that everything submitted behind it is still pending */
+struct blocking_task {
+    struct aws_task task;
+    struct aws_atomic_var started;
+    struct aws_atomic_var release;
+};
+
+static void s_blocking_task_fn(struct aws_task *task, void *arg, enum aws_task_status status) {
+    (void)task;
+    (void)status;
+    struct blocking_task *blocker = arg;
+    aws_atomic_store_int(&blocker->started, 1);
+    while (!aws_atomic_load_int(&blocker->release)) {
+        aws_thread_current_sleep(1000000);
+    }
+}
+
+struct clean_up_thread_data {
+    struct aws_thread_pool *pool;
+    struct aws_atomic_var done;
+};
+
+static void s_clean_up_thread_fn(void *arg) {
+    struct clean_up_thread_data *data = arg;
+    aws_thread_pool_clean_up(data->pool);
+    aws_atomic_store_int(&data->done, 1);
+}
+
+#define PENDING_TASKS 100
+
+static int s_test_thread_pool_clean_up_cancels_fn(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    struct aws_thread_pool_options options = {.worker_count = 1};
+    struct aws_thread_pool pool;
+    ASSERT_SUCCESS(aws_thread_pool_init(&pool, allocator, &options));
+
+    struct blocking_task blocker;
+    aws_task_init(&blocker.task, s_blocking_task_fn, &blocker);
+    aws_atomic_init_int(&blocker.started, 0);
+    aws_atomic_init_int(&blocker.release, 0);
+    aws_thread_pool_submit(&pool, &blocker.task);
+    while (!aws_atomic_load_int(&blocker.started)) {
+        aws_thread_current_sleep(1000000);
+    }
+
+    struct pool_test_tracker tracker;
+    s_tracker_init(&tracker, PENDING_TASKS);
+    struct counted_task tasks[PENDING_TASKS];
+    for (size_t i = 0; i < PENDING_TASKS; i++) {
+        aws_task_init(&tasks[i].task, s_counted_task_fn, &tasks[i]);
+        tasks[i].tracker = &tracker;
+        aws_atomic_init_int(&tasks[i].runs, 0);
+        aws_thread_pool_submit(&pool, &tasks[i].task);
+    }
+
+    /* clean_up waits for the running blocker, so call it from another thread, and release the blocker once it's
+     * had time to stop the worker */
+    struct clean_up_thread_data data = {.pool = &pool};
+    aws_atomic_init_int(&data.done, 0);
+    struct aws_thread clean_up_thread;
+    ASSERT_SUCCESS(aws_thread_init(&clean_up_thread, allocator));
+    ASSERT_SUCCESS(aws_thread_launch(&clean_up_thread, s_clean_up_thread_fn, &data, NULL));
+    aws_thread_current_sleep(50000000);
+    ASSERT_UINT_EQUALS(0, aws_atomic_load_int(&data.done));
+    aws_atomic_store_int(&blocker.release, 1);
+    ASSERT_SUCCESS(aws_thread_join(&clean_up_thread));
+    aws_thread_clean_up(&clean_up_thread);
+
+    /* Every pending task still ran exactly once, whether it was canceled or the worker got to it first */
+    ASSERT_UINT_EQUALS(PENDING_TASKS, aws_atomic_load_int(&tracker.finished));
+    for (size_t i = 0; i < PENDING_TASKS; i++) {
+        ASSERT_UINT_EQUALS(1, aws_atomic_load_int(&tasks[i].runs));
+    }
+    ASSERT_TRUE(aws_atomic_load_int(&tracker.canceled) > 0);
+
+    s_tracker_clean_up(&tracker);
+    return 0;
+}
+
+AWS_TEST_CASE(test_thread_pool_clean_up_cancels, s_test_thread_pool_clean_up_cancels_fn)
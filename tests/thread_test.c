@@ -53,3 +53,51 @@ static int s_test_thread_creation_join_fn(struct aws_allocator *allocator, void
 }
 
 AWS_TEST_CASE(thread_creation_join_test, s_test_thread_creation_join_fn)
+
+struct thread_atexit_test_data {
+    size_t calls;
+    size_t calls_before_exit;
+    /* The order each callback was called in, starting at 1 */
+    size_t first_order;
+    size_t second_order;
+};
+
+static void s_thread_atexit_first(void *user_data) {
+    struct thread_atexit_test_data *test_data = user_data;
+    test_data->first_order = ++test_data->calls;
+}
+
+static void s_thread_atexit_second(void *user_data) {
+    struct thread_atexit_test_data *test_data = user_data;
+    test_data->second_order = ++test_data->calls;
+}
+
+static void s_thread_atexit_fn(void *arg) {
+    if (aws_thread_current_at_exit(s_thread_atexit_first, arg) ||
+        aws_thread_current_at_exit(s_thread_atexit_second, arg)) {
+        return;
+    }
+    struct thread_atexit_test_data *test_data = arg;
+    test_data->calls_before_exit = test_data->calls;
+}
+
+static int s_test_thread_atexit_fn(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+    struct thread_atexit_test_data test_data = {0};
+
+    struct aws_thread thread;
+    aws_thread_init(&thread, allocator);
+    ASSERT_SUCCESS(aws_thread_launch(&thread, s_thread_atexit_fn, &test_data, 0));
+    ASSERT_SUCCESS(aws_thread_join(&thread));
+    aws_thread_clean_up(&thread);
+
+    /* Nothing ran until the thread exited, and then the newest callback ran first */
+    ASSERT_UINT_EQUALS(0, test_data.calls_before_exit);
+    ASSERT_UINT_EQUALS(2, test_data.calls);
+    ASSERT_UINT_EQUALS(2, test_data.first_order);
+    ASSERT_UINT_EQUALS(1, test_data.second_order);
+
+    return 0;
+}
+
+AWS_TEST_CASE(thread_atexit_test, s_test_thread_atexit_fn)
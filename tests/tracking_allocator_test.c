@@ -0,0 +1,183 @@
+/*
+ * Copyright 2010-2018 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *  http://aws.amazon.com/apache2.0
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#include <aws/common/tracking_allocator.h>
+
+#include <aws/common/thread.h>
+
+#include <aws/testing/aws_test_harness.h>
+
+static int s_test_tracking_allocator_counters_fn(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    struct aws_tracking_allocator_options options = {.tag = "counters"};
+    struct aws_allocator *tracker = aws_tracking_allocator_new(allocator, &options);
+    ASSERT_NOT_NULL(tracker);
+
+    void *a = aws_mem_acquire(tracker, 100);
+    void *b = aws_mem_acquire(tracker, 50);
+    ASSERT_NOT_NULL(a);
+    ASSERT_NOT_NULL(b);
+    ASSERT_UINT_EQUALS(0, (uintptr_t)a & (sizeof(void *) - 1));
+
+    struct aws_tracking_allocator_stats stats;
+    aws_tracking_allocator_get_stats(tracker, &stats);
+    ASSERT_STR_EQUALS("counters", stats.tag);
+    ASSERT_UINT_EQUALS(150, stats.live_bytes);
+    ASSERT_UINT_EQUALS(2, stats.live_allocations);
+    ASSERT_UINT_EQUALS(150, stats.peak_bytes);
+
+    /* Growing counts the growth, shrinking gives it back, and the contents survive both */
+    memset(a, 0x3C, 100);
+    ASSERT_SUCCESS(aws_mem_realloc(tracker, &a, 100, 300));
+    ASSERT_SUCCESS(aws_mem_realloc(tracker, &a, 300, 20));
+    for (size_t i = 0; i < 20; i++) {
+        ASSERT_UINT_EQUALS(0x3C, ((uint8_t *)a)[i]);
+    }
+    aws_tracking_allocator_get_stats(tracker, &stats);
+    ASSERT_UINT_EQUALS(70, stats.live_bytes);
+    ASSERT_UINT_EQUALS(350, stats.peak_bytes);
+
+    aws_mem_release(tracker, b);
+    aws_tracking_allocator_get_stats(tracker, &stats);
+    ASSERT_UINT_EQUALS(20, stats.live_bytes);
+    ASSERT_UINT_EQUALS(1, stats.live_allocations);
+    ASSERT_UINT_EQUALS(350, stats.peak_bytes);
+    ASSERT_UINT_EQUALS(2, stats.total_allocations);
+    ASSERT_UINT_EQUALS(350, stats.total_bytes);
+
+    aws_tracking_allocator_reset_peak(tracker);
+    aws_tracking_allocator_get_stats(tracker, &stats);
+    ASSERT_UINT_EQUALS(20, stats.peak_bytes);
+
+    aws_mem_release(tracker, a);
+    aws_mem_release(tracker, NULL);
+    aws_tracking_allocator_get_stats(tracker, &stats);
+    ASSERT_UINT_EQUALS(0, stats.live_bytes);
+    ASSERT_UINT_EQUALS(0, stats.live_allocations);
+
+    size_t count = 0;
+    ASSERT_ERROR(AWS_ERROR_UNSUPPORTED_OPERATION, aws_tracking_allocator_get_call_sites(tracker, NULL, 0, &count));
+
+    aws_tracking_allocator_destroy(tracker);
+    return 0;
+}
+
+AWS_TEST_CASE(test_tracking_allocator_counters, s_test_tracking_allocator_counters_fn)
+
+#define TRACKING_THREADS 4
+#define TRACKING_OPS_PER_THREAD 20000
+
+static void s_tracking_churn_fn(void *arg) {
+    struct aws_allocator *tracker = arg;
+    void *held[16] = {NULL};
+    for (size_t op = 0; op < TRACKING_OPS_PER_THREAD; op++) {
+        size_t slot = op % AWS_ARRAY_SIZE(held);
+        aws_mem_release(tracker, held[slot]);
+        held[slot] = aws_mem_acquire(tracker, 1 + op % 200);
+    }
+    for (size_t i = 0; i < AWS_ARRAY_SIZE(held); i++) {
+        aws_mem_release(tracker, held[i]);
+    }
+}
+
+static int s_test_tracking_allocator_threaded_fn(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    struct aws_tracking_allocator_options options = {.tag = "threaded", .call_site_sample_interval = 7};
+    struct aws_allocator *tracker = aws_tracking_allocator_new(allocator, &options);
+    ASSERT_NOT_NULL(tracker);
+
+    struct aws_thread threads[TRACKING_THREADS];
+    for (size_t i = 0; i < TRACKING_THREADS; i++) {
+        ASSERT_SUCCESS(aws_thread_init(&threads[i], allocator));
+        ASSERT_SUCCESS(aws_thread_launch(&threads[i], s_tracking_churn_fn, tracker, NULL));
+    }
+    for (size_t i = 0; i < TRACKING_THREADS; i++) {
+        ASSERT_SUCCESS(aws_thread_join(&threads[i]));
+        aws_thread_clean_up(&threads[i]);
+    }
+
+    struct aws_tracking_allocator_stats stats;
+    aws_tracking_allocator_get_stats(tracker, &stats);
+    ASSERT_UINT_EQUALS(0, stats.live_bytes);
+    ASSERT_UINT_EQUALS(0, stats.live_allocations);
+    ASSERT_UINT_EQUALS(TRACKING_THREADS * TRACKING_OPS_PER_THREAD, stats.total_allocations);
+    ASSERT_TRUE(stats.peak_bytes > 0);
+    ASSERT_TRUE(stats.peak_bytes <= TRACKING_THREADS * 16 * 200);
+
+    aws_tracking_allocator_destroy(tracker);
+    return 0;
+}
+
+AWS_TEST_CASE(test_tracking_allocator_threaded, s_test_tracking_allocator_threaded_fn)
+
+static int s_test_tracking_allocator_call_sites_fn(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    struct aws_tracking_allocator_options options = {
+        .tag = "call sites",
+        .call_site_sample_interval = 1,
+        .max_call_sites = 2,
+    };
+    struct aws_allocator *tracker = aws_tracking_allocator_new(allocator, &options);
+    ASSERT_NOT_NULL(tracker);
+
+    /* Each line acquiring memory is a call site of its own */
+    void *small[3];
+    for (size_t i = 0; i < AWS_ARRAY_SIZE(small); i++) {
+        small[i] = aws_mem_acquire(tracker, 10);
+    }
+    void *large = aws_mem_acquire(tracker, 1000);
+    /* A third call site is over the limit */
+    void *dropped = aws_mem_acquire(tracker, 5);
+
+    struct aws_tracking_allocator_call_site sites[4];
+    size_t count = 0;
+    if (aws_tracking_allocator_get_call_sites(tracker, sites, AWS_ARRAY_SIZE(sites), &count)) {
+        /* No stack walking on this platform */
+        ASSERT_INT_EQUALS(AWS_ERROR_UNSUPPORTED_OPERATION, aws_last_error());
+    } else {
+        ASSERT_UINT_EQUALS(2, count);
+        ASSERT_UINT_EQUALS(1000, sites[0].live_bytes);
+        ASSERT_UINT_EQUALS(1, sites[0].live_allocations);
+        ASSERT_UINT_EQUALS(30, sites[1].live_bytes);
+        ASSERT_UINT_EQUALS(3, sites[1].live_allocations);
+        ASSERT_TRUE(sites[0].frame_count > 0);
+
+        struct aws_tracking_allocator_stats stats;
+        aws_tracking_allocator_get_stats(tracker, &stats);
+        ASSERT_UINT_EQUALS(1, stats.dropped_samples);
+
+        /* Releasing takes the bytes off the site, which stays for the record */
+        aws_mem_release(tracker, large);
+        large = NULL;
+        ASSERT_SUCCESS(aws_tracking_allocator_get_call_sites(tracker, sites, 1, &count));
+        ASSERT_UINT_EQUALS(1, count);
+        ASSERT_UINT_EQUALS(30, sites[0].live_bytes);
+        ASSERT_UINT_EQUALS(3, sites[0].total_allocations);
+    }
+
+    for (size_t i = 0; i < AWS_ARRAY_SIZE(small); i++) {
+        aws_mem_release(tracker, small[i]);
+    }
+    aws_mem_release(tracker, large);
+    aws_mem_release(tracker, dropped);
+
+    aws_tracking_allocator_destroy(tracker);
+    return 0;
+}
+
+AWS_TEST_CASE(test_tracking_allocator_call_sites, s_test_tracking_allocator_call_sites_fn)